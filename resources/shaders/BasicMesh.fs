@@ -16,12 +16,14 @@ uniform sampler2D NormalMap;
 
 void main()
 {
-    vec3 normalSample = texture(NormalMap, In.UVs).rgb;
+    // NOTE: Cooked normal maps are BC5 and only store XY, so Z is always rebuilt from them
+    vec2 normalSample = texture(NormalMap, In.UVs).rg;
     vec3 normal;
     // TODO: more efficient way to do this?
-    if (normalSample.r > 0.0 || normalSample.g > 0.0 || normal.b > 0.0)
+    if (normalSample.r > 0.0 || normalSample.g > 0.0)
     {
-        normal = normalize(normalSample * 2.0 - 1.0);
+        vec2 normalXY = normalSample * 2.0 - 1.0;
+        normal = vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0)));
     }
     else
     {
@@ -0,0 +1,11 @@
+// NOTE: frame_globals in Shader.h, filled once per frame (or view) by UploadFrameGlobals. std140,
+//       so every vec3 is followed by a float to fill out its 16 bytes.
+layout (std140) uniform FrameGlobals
+{
+    mat4 Projection;
+    mat4 View;
+    vec3 ViewPosition;
+    float Time;
+    vec3 LightDirection;
+    float FrameGlobalsPadding;
+};
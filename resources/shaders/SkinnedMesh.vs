@@ -15,16 +15,13 @@ out vertex_shader_out
     vec3 FragmentPositionTangentSpace;
 } Out;
 
-uniform mat4 Projection;
-uniform mat4 View;
+#include "FrameGlobals.glsl"
+
 uniform mat4 Model;
 
 #define MAX_BONES 128
 uniform mat4 BoneTransforms[MAX_BONES];
 
-uniform vec3 LightDirection;
-uniform vec3 ViewPosition;
-
 void main()
 {
     mat4 boneTransform = mat4(0.0);
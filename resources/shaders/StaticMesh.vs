@@ -4,6 +4,9 @@ layout (location = 1) in vec2 In_UVs;
 layout (location = 2) in vec3 In_Normal;
 layout (location = 3) in vec3 In_Tangent;
 layout (location = 4) in vec3 In_Bitangent;
+// NOTE: Per instance (mesh_instance in Model.h)
+layout (location = 5) in mat4 In_Model;
+layout (location = 9) in mat3 In_NormalMatrix;
 
 out vertex_shader_out
 {
@@ -13,25 +16,18 @@ out vertex_shader_out
     vec3 FragmentPositionTangentSpace;
 } Out;
 
-uniform mat4 Projection;
-uniform mat4 View;
-uniform mat4 Model;
-
-uniform vec3 LightDirection;
-uniform vec3 ViewPosition;
+#include "FrameGlobals.glsl"
 
 void main()
 {
-    vec4 transformedPosition = Model * vec4(In_Position, 1.0);
+    vec4 transformedPosition = In_Model * vec4(In_Position, 1.0);
     gl_Position = Projection * View * transformedPosition;
     Out.UVs = In_UVs;
 
-    // TODO: Once skeletal animation scaling is gone, do this on CPU once per frame 
-    mat3 normalMatrix = mat3(transpose(inverse(Model)));
-    vec3 tangent = normalize(normalMatrix * In_Tangent);
+    vec3 tangent = normalize(In_NormalMatrix * In_Tangent);
     // TODO: Once models are used for primitives, bitangent should already be calculated
-//    vec3 bitangent = normalize(normalMatrix * In_Bitangent);
-    vec3 normal = normalize(normalMatrix * In_Normal);
+//    vec3 bitangent = normalize(In_NormalMatrix * In_Bitangent);
+    vec3 normal = normalize(In_NormalMatrix * In_Normal);
     tangent = normalize(tangent - dot(tangent, normal) * normal);
     vec3 bitangent = cross(tangent, normal);
 
@@ -0,0 +1,242 @@
+#include "AssetLoader.h"
+
+#include <SDL2/SDL.h>
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+#include "Jobs.h"
+#include "Memory.h"
+#include "Texture.h"
+
+#define MAX_PENDING_ASSET_LOADS 256
+
+enum asset_load_state
+{
+    ASSET_LOAD_QUEUED,
+    ASSET_LOAD_PREPARED,
+    ASSET_LOAD_FAILED,
+};
+
+struct asset_load_request
+{
+    char Path[MAX_PATH_LENGTH];
+    bool IsSkinned;
+    bool GenerateMipmap;
+    bool KeepCPUData;
+
+    // NOTE: Only touched on the GL thread
+    model *Model;
+    skinned_model *SkinnedModel;
+
+    // NOTE: Written by the worker before State is set to ASSET_LOAD_PREPARED
+    model_load_data *LoadData;
+    SDL_atomic_t State;
+};
+
+struct asset_loader
+{
+    job_queue *Queue;
+
+    // NOTE: In request order; only touched on the GL thread
+    i32 RequestCount;
+    asset_load_request *Requests[MAX_PENDING_ASSET_LOADS];
+    memory_pool RequestPool;
+};
+
+static asset_loader AssetLoader;
+
+static asset_load_request *
+AddAssetLoadRequest(const char *Path, bool IsSkinned, bool GenerateMipmap, bool KeepCPUData);
+static void
+PrepareAssetJob(void *Data);
+
+void
+InitializeAssetLoader(i32 ThreadCount)
+{
+    Assert(!AssetLoader.Queue);
+    AssetLoader.Queue = CreateJobQueue(ThreadCount);
+    InitializePool(&AssetLoader.RequestPool, sizeof(asset_load_request), MAX_PENDING_ASSET_LOADS);
+    InitializeTextureStreaming(AssetLoader.Queue);
+    printf("Asset loader started with %d worker thread(s)\n", GetJobQueueThreadCount(AssetLoader.Queue));
+}
+
+void
+ShutdownAssetLoader()
+{
+    if (AssetLoader.Queue)
+    {
+        DestroyJobQueue(AssetLoader.Queue);
+        AssetLoader.Queue = 0;
+    }
+    ShutdownTextureStreaming();
+
+    for (i32 RequestIndex = 0; RequestIndex < AssetLoader.RequestCount; ++RequestIndex)
+    {
+        asset_load_request *Request = AssetLoader.Requests[RequestIndex];
+        if (Request->LoadData)
+        {
+            FreeModelLoadData(Request->LoadData);
+        }
+    }
+    AssetLoader.RequestCount = 0;
+    FreePool(&AssetLoader.RequestPool);
+}
+
+job_queue *
+GetAssetLoaderQueue()
+{
+    return AssetLoader.Queue;
+}
+
+void
+LoadModelAsync(const char *Path, bool GenerateMipmap, bool KeepCPUData, model *Out_Model)
+{
+    *Out_Model = { };
+
+    asset_load_request *Request = AddAssetLoadRequest(Path, false, GenerateMipmap, KeepCPUData);
+    Request->Model = Out_Model;
+    AddJob(AssetLoader.Queue, PrepareAssetJob, Request);
+}
+
+void
+LoadSkinnedModelAsync(const char *Path, bool GenerateMipmap, bool KeepCPUData, skinned_model *Out_Model)
+{
+    *Out_Model = { };
+
+    asset_load_request *Request = AddAssetLoadRequest(Path, true, GenerateMipmap, KeepCPUData);
+    Request->SkinnedModel = Out_Model;
+    AddJob(AssetLoader.Queue, PrepareAssetJob, Request);
+}
+
+bool
+IsModelLoadPending(model *Model)
+{
+    for (i32 RequestIndex = 0; RequestIndex < AssetLoader.RequestCount; ++RequestIndex)
+    {
+        if (AssetLoader.Requests[RequestIndex]->Model == Model)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool
+IsSkinnedModelLoadPending(skinned_model *Model)
+{
+    for (i32 RequestIndex = 0; RequestIndex < AssetLoader.RequestCount; ++RequestIndex)
+    {
+        if (AssetLoader.Requests[RequestIndex]->SkinnedModel == Model)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+ProcessAssetUploads(f64 BudgetMilliseconds)
+{
+    u64 PerfCounterFrequency = SDL_GetPerformanceFrequency();
+    u64 StartCounter = SDL_GetPerformanceCounter();
+    u64 BudgetCounter = (u64) (BudgetMilliseconds * 0.001 * (f64) PerfCounterFrequency);
+
+    // NOTE: Doesn't count against the budget; it never waits and the staging ring bounds how
+    //       many uploads it can have in flight
+    ProcessTextureStreaming();
+
+    bool IsOverBudget = false;
+    i32 RemainingCount = 0;
+
+    for (i32 RequestIndex = 0; RequestIndex < AssetLoader.RequestCount; ++RequestIndex)
+    {
+        asset_load_request *Request = AssetLoader.Requests[RequestIndex];
+        i32 State = SDL_AtomicGet(&Request->State);
+
+        bool IsDone = false;
+        if (State == ASSET_LOAD_FAILED)
+        {
+            fprintf(stderr, "Couldn't load %s, keeping the placeholder\n", Request->Path);
+            IsDone = true;
+        }
+        else if (State == ASSET_LOAD_PREPARED && !IsOverBudget)
+        {
+            bool IsUploaded = false;
+            do
+            {
+                IsUploaded = UploadModelLoadDataStep(Request->LoadData);
+                IsOverBudget = (SDL_GetPerformanceCounter() - StartCounter >= BudgetCounter);
+            } while (!IsUploaded && !IsOverBudget);
+
+            if (IsUploaded)
+            {
+                if (Request->IsSkinned)
+                {
+                    FinishSkinnedModelLoad(Request->LoadData, Request->SkinnedModel);
+                }
+                else
+                {
+                    FinishModelLoad(Request->LoadData, Request->Model);
+                }
+                Request->LoadData = 0;
+                IsDone = true;
+            }
+        }
+
+        if (IsDone)
+        {
+            FreeToPool(&AssetLoader.RequestPool, Request);
+        }
+        else
+        {
+            AssetLoader.Requests[RemainingCount++] = Request;
+        }
+    }
+
+    AssetLoader.RequestCount = RemainingCount;
+}
+
+i32
+GetPendingAssetLoadCount()
+{
+    return AssetLoader.RequestCount + GetPendingTextureStreamCount();
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+static asset_load_request *
+AddAssetLoadRequest(const char *Path, bool IsSkinned, bool GenerateMipmap, bool KeepCPUData)
+{
+    Assert(AssetLoader.Queue);
+    Assert(AssetLoader.RequestCount < MAX_PENDING_ASSET_LOADS);
+
+    asset_load_request *Request = (asset_load_request *) AllocateFromPool(&AssetLoader.RequestPool);
+    Assert(Request);
+    strncpy_s(Request->Path, Path, MAX_PATH_LENGTH - 1);
+    Request->IsSkinned = IsSkinned;
+    Request->GenerateMipmap = GenerateMipmap;
+    Request->KeepCPUData = KeepCPUData;
+    SDL_AtomicSet(&Request->State, ASSET_LOAD_QUEUED);
+
+    AssetLoader.Requests[AssetLoader.RequestCount++] = Request;
+
+    return Request;
+}
+
+static void
+PrepareAssetJob(void *Data)
+{
+    asset_load_request *Request = (asset_load_request *) Data;
+
+    printf("Loading %smodel at: %s\n", Request->IsSkinned ? "skinned " : "", Request->Path);
+
+    Request->LoadData = PrepareModelLoadData(Request->Path, Request->IsSkinned, Request->GenerateMipmap,
+                                             Request->KeepCPUData);
+
+    // NOTE: SDL_AtomicSet is a full barrier, so LoadData is visible before the state changes
+    SDL_AtomicSet(&Request->State, Request->LoadData ? ASSET_LOAD_PREPARED : ASSET_LOAD_FAILED);
+}
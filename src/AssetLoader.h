@@ -0,0 +1,40 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include "Common.h"
+#include "Model.h"
+
+// NOTE: ThreadCount <= 0 means one worker per logical core, minus the GL thread
+void
+InitializeAssetLoader(i32 ThreadCount);
+void
+ShutdownAssetLoader();
+
+struct job_queue;
+
+// NOTE: For other loading work that should share the loader's workers (pack decompression)
+job_queue *
+GetAssetLoaderQueue();
+
+// NOTE: Returns right away; the model is parsed on a worker thread and uploaded by
+//       ProcessAssetUploads. It draws as a placeholder until IsReady is set.
+//       If loading fails, it stays a placeholder. Out_Model is zeroed here and has to stay where
+//       it is (and can't be freed) while the load is pending; Resource.h owns the models this way.
+void
+LoadModelAsync(const char *Path, bool GenerateMipmap, bool KeepCPUData, model *Out_Model);
+void
+LoadSkinnedModelAsync(const char *Path, bool GenerateMipmap, bool KeepCPUData, skinned_model *Out_Model);
+bool
+IsModelLoadPending(model *Model);
+bool
+IsSkinnedModelLoadPending(skinned_model *Model);
+
+// NOTE: Call once a frame on the GL thread. Uploads meshes of finished loads until
+//       BudgetMilliseconds is used up (at least one upload per call, so loads always progress).
+//       Textures stream in through Texture.h's staging buffers, which also run from here.
+void
+ProcessAssetUploads(f64 BudgetMilliseconds);
+i32
+GetPendingAssetLoadCount();
+
+#endif
@@ -0,0 +1,362 @@
+#include "BlockCompression.h"
+
+#include <cmath>
+#include <cstring>
+
+static void
+BC_GatherBlock(const u8 *Pixels, i32 Width, i32 Height, i32 BlockX, i32 BlockY, u8 *Out_Texels);
+static void
+BC_CompressColorBlock(const u8 *Texels, u8 *Out_Block);
+static void
+BC_CompressChannelBlock(const u8 *Texels, i32 Channel, u8 *Out_Block);
+static u16
+BC_PackColor565(const f32 *Color);
+static void
+BC_UnpackColor565(u16 Packed, i32 *Out_Color);
+static u32
+BC_FindColorIndices(const u8 *Texels, u16 Color0, u16 Color1, i32 *Out_Error);
+static bool
+BC_RefineColorEndpoints(const u8 *Texels, u32 Indices, f32 *Out_Color0, f32 *Out_Color1);
+
+i32
+GetCompressedBlockSize(block_compression_format Format)
+{
+    return (Format == BLOCK_COMPRESSION_BC1 || Format == BLOCK_COMPRESSION_BC4) ? 8 : 16;
+}
+
+size_t
+GetCompressedImageSize(block_compression_format Format, i32 Width, i32 Height)
+{
+    size_t BlocksX = (size_t) ((Width + 3) / 4);
+    size_t BlocksY = (size_t) ((Height + 3) / 4);
+    return BlocksX * BlocksY * GetCompressedBlockSize(Format);
+}
+
+void
+CompressImage(block_compression_format Format, const u8 *Pixels, i32 Width, i32 Height, u8 *Out_Blocks)
+{
+    i32 BlocksX = (Width + 3) / 4;
+    i32 BlocksY = (Height + 3) / 4;
+    i32 BlockSize = GetCompressedBlockSize(Format);
+
+    u8 Texels[16 * 4];
+    u8 *Block = Out_Blocks;
+    for (i32 BlockY = 0; BlockY < BlocksY; ++BlockY)
+    {
+        for (i32 BlockX = 0; BlockX < BlocksX; ++BlockX)
+        {
+            BC_GatherBlock(Pixels, Width, Height, BlockX, BlockY, Texels);
+
+            switch (Format)
+            {
+                case BLOCK_COMPRESSION_BC1:
+                {
+                    BC_CompressColorBlock(Texels, Block);
+                } break;
+
+                case BLOCK_COMPRESSION_BC3:
+                {
+                    BC_CompressChannelBlock(Texels, 3, Block);
+                    BC_CompressColorBlock(Texels, Block + 8);
+                } break;
+
+                case BLOCK_COMPRESSION_BC4:
+                {
+                    BC_CompressChannelBlock(Texels, 0, Block);
+                } break;
+
+                case BLOCK_COMPRESSION_BC5:
+                {
+                    BC_CompressChannelBlock(Texels, 0, Block);
+                    BC_CompressChannelBlock(Texels, 1, Block + 8);
+                } break;
+            }
+
+            Block += BlockSize;
+        }
+    }
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+static void
+BC_GatherBlock(const u8 *Pixels, i32 Width, i32 Height, i32 BlockX, i32 BlockY, u8 *Out_Texels)
+{
+    for (i32 Y = 0; Y < 4; ++Y)
+    {
+        i32 PixelY = BlockY * 4 + Y;
+        if (PixelY >= Height) PixelY = Height - 1;
+
+        for (i32 X = 0; X < 4; ++X)
+        {
+            i32 PixelX = BlockX * 4 + X;
+            if (PixelX >= Width) PixelX = Width - 1;
+
+            memcpy(&Out_Texels[(Y * 4 + X) * 4], &Pixels[((size_t) PixelY * Width + PixelX) * 4], 4);
+        }
+    }
+}
+
+// NOTE: Endpoints from the extremes along the principal axis of the block's colors, inset a bit,
+//       then one least squares pass given the chosen indices. Always 4-color mode (Color0 > Color1),
+//       so the same block works as the color half of BC3.
+static void
+BC_CompressColorBlock(const u8 *Texels, u8 *Out_Block)
+{
+    f32 Mean[3] = { };
+    f32 Min[3] = { 255.0f, 255.0f, 255.0f };
+    f32 Max[3] = { };
+    for (i32 TexelIndex = 0; TexelIndex < 16; ++TexelIndex)
+    {
+        for (i32 Channel = 0; Channel < 3; ++Channel)
+        {
+            f32 Value = (f32) Texels[TexelIndex * 4 + Channel];
+            Mean[Channel] += Value;
+            if (Value < Min[Channel]) Min[Channel] = Value;
+            if (Value > Max[Channel]) Max[Channel] = Value;
+        }
+    }
+    for (i32 Channel = 0; Channel < 3; ++Channel)
+    {
+        Mean[Channel] /= 16.0f;
+    }
+
+    // Covariance (xx, xy, xz, yy, yz, zz)
+    // -----------------------------------
+    f32 Covariance[6] = { };
+    for (i32 TexelIndex = 0; TexelIndex < 16; ++TexelIndex)
+    {
+        f32 R = (f32) Texels[TexelIndex * 4 + 0] - Mean[0];
+        f32 G = (f32) Texels[TexelIndex * 4 + 1] - Mean[1];
+        f32 B = (f32) Texels[TexelIndex * 4 + 2] - Mean[2];
+        Covariance[0] += R * R;
+        Covariance[1] += R * G;
+        Covariance[2] += R * B;
+        Covariance[3] += G * G;
+        Covariance[4] += G * B;
+        Covariance[5] += B * B;
+    }
+
+    // Principal axis by power iteration, starting from the bounding box diagonal
+    // --------------------------------------------------------------------------
+    f32 Axis[3] = { Max[0] - Min[0], Max[1] - Min[1], Max[2] - Min[2] };
+    for (i32 Iteration = 0; Iteration < 4; ++Iteration)
+    {
+        f32 NewAxis[3] = {
+            Covariance[0] * Axis[0] + Covariance[1] * Axis[1] + Covariance[2] * Axis[2],
+            Covariance[1] * Axis[0] + Covariance[3] * Axis[1] + Covariance[4] * Axis[2],
+            Covariance[2] * Axis[0] + Covariance[4] * Axis[1] + Covariance[5] * Axis[2],
+        };
+        f32 Largest = fmaxf(fabsf(NewAxis[0]), fmaxf(fabsf(NewAxis[1]), fabsf(NewAxis[2])));
+        if (Largest < 1e-6f)
+        {
+            break;
+        }
+        Axis[0] = NewAxis[0] / Largest;
+        Axis[1] = NewAxis[1] / Largest;
+        Axis[2] = NewAxis[2] / Largest;
+    }
+
+    i32 MinTexel = 0;
+    i32 MaxTexel = 0;
+    f32 MinDot = 1e30f;
+    f32 MaxDot = -1e30f;
+    for (i32 TexelIndex = 0; TexelIndex < 16; ++TexelIndex)
+    {
+        const u8 *Texel = &Texels[TexelIndex * 4];
+        f32 Dot = Texel[0] * Axis[0] + Texel[1] * Axis[1] + Texel[2] * Axis[2];
+        if (Dot < MinDot) { MinDot = Dot; MinTexel = TexelIndex; }
+        if (Dot > MaxDot) { MaxDot = Dot; MaxTexel = TexelIndex; }
+    }
+
+    // NOTE: The extremes rarely deserve an exact palette entry; pulling them in by 1/16 of the
+    //       range moves the interpolated entries closer to where most texels are
+    f32 High[3];
+    f32 Low[3];
+    for (i32 Channel = 0; Channel < 3; ++Channel)
+    {
+        High[Channel] = (f32) Texels[MaxTexel * 4 + Channel];
+        Low[Channel] = (f32) Texels[MinTexel * 4 + Channel];
+        f32 Inset = (High[Channel] - Low[Channel]) / 16.0f;
+        High[Channel] -= Inset;
+        Low[Channel] += Inset;
+    }
+
+    u16 Color0 = BC_PackColor565(High);
+    u16 Color1 = BC_PackColor565(Low);
+    i32 Error;
+    u32 Indices = BC_FindColorIndices(Texels, Color0, Color1, &Error);
+
+    f32 RefinedHigh[3];
+    f32 RefinedLow[3];
+    if (BC_RefineColorEndpoints(Texels, Indices, RefinedHigh, RefinedLow))
+    {
+        u16 RefinedColor0 = BC_PackColor565(RefinedHigh);
+        u16 RefinedColor1 = BC_PackColor565(RefinedLow);
+        i32 RefinedError;
+        u32 RefinedIndices = BC_FindColorIndices(Texels, RefinedColor0, RefinedColor1, &RefinedError);
+        if (RefinedError < Error)
+        {
+            Color0 = RefinedColor0;
+            Color1 = RefinedColor1;
+            Indices = RefinedIndices;
+        }
+    }
+
+    // NOTE: Swapping the endpoints maps indices 0<->1 and 2<->3
+    if (Color0 < Color1)
+    {
+        u16 Swap = Color0;
+        Color0 = Color1;
+        Color1 = Swap;
+        Indices ^= 0x55555555;
+    }
+    else if (Color0 == Color1)
+    {
+        Indices = 0;
+    }
+
+    memcpy(Out_Block + 0, &Color0, sizeof(u16));
+    memcpy(Out_Block + 2, &Color1, sizeof(u16));
+    memcpy(Out_Block + 4, &Indices, sizeof(u32));
+}
+
+// NOTE: Always the 8 value mode; the palette is evenly spaced between the block's min and max
+static void
+BC_CompressChannelBlock(const u8 *Texels, i32 Channel, u8 *Out_Block)
+{
+    i32 Min = 255;
+    i32 Max = 0;
+    for (i32 TexelIndex = 0; TexelIndex < 16; ++TexelIndex)
+    {
+        i32 Value = Texels[TexelIndex * 4 + Channel];
+        if (Value < Min) Min = Value;
+        if (Value > Max) Max = Value;
+    }
+
+    Out_Block[0] = (u8) Max;
+    Out_Block[1] = (u8) Min;
+
+    u64 Bits = 0;
+    if (Max > Min)
+    {
+        i32 Range = Max - Min;
+        for (i32 TexelIndex = 0; TexelIndex < 16; ++TexelIndex)
+        {
+            // NOTE: Step 0 is Min (index 1), step 7 is Max (index 0), step s in between is index 8 - s
+            i32 Value = Texels[TexelIndex * 4 + Channel];
+            i32 Step = ((Value - Min) * 7 + Range / 2) / Range;
+            u64 Index = (Step == 7) ? 0 : (Step == 0) ? 1 : (u64) (8 - Step);
+            Bits |= Index << (3 * TexelIndex);
+        }
+    }
+
+    memcpy(Out_Block + 2, &Bits, 6);
+}
+
+static u16
+BC_PackColor565(const f32 *Color)
+{
+    i32 R = (i32) (Color[0] * (31.0f / 255.0f) + 0.5f);
+    i32 G = (i32) (Color[1] * (63.0f / 255.0f) + 0.5f);
+    i32 B = (i32) (Color[2] * (31.0f / 255.0f) + 0.5f);
+    R = (R < 0) ? 0 : (R > 31) ? 31 : R;
+    G = (G < 0) ? 0 : (G > 63) ? 63 : G;
+    B = (B < 0) ? 0 : (B > 31) ? 31 : B;
+
+    return (u16) ((R << 11) | (G << 5) | B);
+}
+
+static void
+BC_UnpackColor565(u16 Packed, i32 *Out_Color)
+{
+    i32 R = (Packed >> 11) & 31;
+    i32 G = (Packed >> 5) & 63;
+    i32 B = Packed & 31;
+    Out_Color[0] = (R << 3) | (R >> 2);
+    Out_Color[1] = (G << 2) | (G >> 4);
+    Out_Color[2] = (B << 3) | (B >> 2);
+}
+
+static u32
+BC_FindColorIndices(const u8 *Texels, u16 Color0, u16 Color1, i32 *Out_Error)
+{
+    i32 Palette[4][3];
+    BC_UnpackColor565(Color0, Palette[0]);
+    BC_UnpackColor565(Color1, Palette[1]);
+    for (i32 Channel = 0; Channel < 3; ++Channel)
+    {
+        Palette[2][Channel] = (2 * Palette[0][Channel] + Palette[1][Channel]) / 3;
+        Palette[3][Channel] = (Palette[0][Channel] + 2 * Palette[1][Channel]) / 3;
+    }
+
+    u32 Indices = 0;
+    i32 Error = 0;
+    for (i32 TexelIndex = 0; TexelIndex < 16; ++TexelIndex)
+    {
+        const u8 *Texel = &Texels[TexelIndex * 4];
+        i32 BestIndex = 0;
+        i32 BestDistance = 0x7FFFFFFF;
+        for (i32 PaletteIndex = 0; PaletteIndex < 4; ++PaletteIndex)
+        {
+            i32 R = Texel[0] - Palette[PaletteIndex][0];
+            i32 G = Texel[1] - Palette[PaletteIndex][1];
+            i32 B = Texel[2] - Palette[PaletteIndex][2];
+            i32 Distance = R * R + G * G + B * B;
+            if (Distance < BestDistance)
+            {
+                BestDistance = Distance;
+                BestIndex = PaletteIndex;
+            }
+        }
+
+        Indices |= (u32) BestIndex << (2 * TexelIndex);
+        Error += BestDistance;
+    }
+
+    *Out_Error = Error;
+    return Indices;
+}
+
+static bool
+BC_RefineColorEndpoints(const u8 *Texels, u32 Indices, f32 *Out_Color0, f32 *Out_Color1)
+{
+    // NOTE: Weight of Color0 for each index (Color0, Color1, 2/3 Color0, 1/3 Color0)
+    f32 Weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+    f32 AA = 0.0f;
+    f32 AB = 0.0f;
+    f32 BB = 0.0f;
+    f32 AX[3] = { };
+    f32 BX[3] = { };
+    for (i32 TexelIndex = 0; TexelIndex < 16; ++TexelIndex)
+    {
+        f32 A = Weights[(Indices >> (2 * TexelIndex)) & 3];
+        f32 B = 1.0f - A;
+        AA += A * A;
+        AB += A * B;
+        BB += B * B;
+        for (i32 Channel = 0; Channel < 3; ++Channel)
+        {
+            f32 Value = (f32) Texels[TexelIndex * 4 + Channel];
+            AX[Channel] += A * Value;
+            BX[Channel] += B * Value;
+        }
+    }
+
+    f32 Determinant = AA * BB - AB * AB;
+    if (fabsf(Determinant) < 1e-6f)
+    {
+        return false;
+    }
+
+    for (i32 Channel = 0; Channel < 3; ++Channel)
+    {
+        Out_Color0[Channel] = (BB * AX[Channel] - AB * BX[Channel]) / Determinant;
+        Out_Color1[Channel] = (AA * BX[Channel] - AB * AX[Channel]) / Determinant;
+    }
+
+    return true;
+}
@@ -0,0 +1,27 @@
+#ifndef BLOCK_COMPRESSION_H
+#define BLOCK_COMPRESSION_H
+
+#include <cstddef>
+
+#include "Common.h"
+
+// NOTE: CPU encoders for the BCn block formats GL can sample directly. Every 4x4 texel block
+//       becomes 8 (BC1, BC4) or 16 (BC3, BC5) bytes; edge blocks of images that aren't a multiple
+//       of 4 repeat the last row/column. Slow enough that it's only meant for cook time.
+enum block_compression_format
+{
+    BLOCK_COMPRESSION_BC1, // RGB, 4 bpp
+    BLOCK_COMPRESSION_BC3, // RGB + separately coded alpha, 8 bpp
+    BLOCK_COMPRESSION_BC4, // R, 4 bpp
+    BLOCK_COMPRESSION_BC5, // RG, 8 bpp (tangent space normal XY)
+};
+
+i32
+GetCompressedBlockSize(block_compression_format Format);
+size_t
+GetCompressedImageSize(block_compression_format Format, i32 Width, i32 Height);
+// NOTE: Pixels are 8 bit RGBA; BC4 reads R, BC5 reads R and G
+void
+CompressImage(block_compression_format Format, const u8 *Pixels, i32 Width, i32 Height, u8 *Out_Blocks);
+
+#endif
@@ -0,0 +1,1020 @@
+// NOTE: Standalone asset cooker (sdlogl-cook). Walks the resources directory, hashes every source
+//       file on all cores, compares against the manifest from the previous run and recooks only
+//       the assets whose source or dependencies changed.
+//
+//       Usage: sdlogl-cook [-j ThreadCount] [-force] [-pack] [-bench] [ResourcesDirectory]
+//
+//       -pack also writes every source and cooked file into ResourcesDirectory.pack next to the
+//       directory (see PackFormat.h), which the game mounts in place of the loose files.
+//       -bench times the image kernels (SIMD and scalar) on a synthetic image, checks and times the
+//       occlusion buffer on synthetic occluders, and exits.
+
+#include "Common.h"
+
+#include <cfloat>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "FileIO.h"
+#include "Hash.h"
+#include "ImageProcessing.h"
+#include "Jobs.h"
+#include "Model.h"
+#include "ModelFormat.h"
+#include "Occlusion.h"
+#include "Pack.h"
+#include "PackFormat.h"
+#include "Texture.h"
+#include "TextureFormat.h"
+#include "Util.h"
+
+#define COOK_MANIFEST_FILENAME "cook.manifest"
+#define COOK_MANIFEST_VERSION 1
+#define MAX_COOK_ASSET_COUNT 4096
+// NOTE: Power of two, and at least twice the asset count so the table stays at most half full
+#define COOK_ASSET_SLOT_COUNT (MAX_COOK_ASSET_COUNT * 2)
+
+enum cook_asset_type
+{
+    COOK_ASSET_OTHER,
+    COOK_ASSET_MODEL,
+    COOK_ASSET_TEXTURE,
+    COOK_ASSET_FONT,
+    COOK_ASSET_SKIPPED,
+};
+
+struct cook_manifest_entry
+{
+    bool IsValid;
+    u64 SourceHash;
+    u32 Version;
+    i32 DependencyCount;
+    u64 DependencyHashes[MAX_COOK_DEPENDENCY_COUNT];
+    char DependencyPaths[MAX_COOK_DEPENDENCY_COUNT][MAX_PATH_LENGTH];
+};
+
+struct cook_asset
+{
+    char Path[MAX_PATH_LENGTH];
+    cook_asset_type Type;
+    u32 Version;
+    u64 SourceHash;
+
+    cook_manifest_entry Previous;
+
+    bool NeedsCook;
+    bool CookFailed;
+    cook_dependencies Dependencies;
+    u64 DependencyHashes[MAX_COOK_DEPENDENCY_COUNT];
+};
+
+// NOTE: Open addressing with linear probing, keyed by the hash of the path; PathHash 0 is an empty
+//       slot. Filled while the assets are collected and only read after that, so the jobs can
+//       look things up without a lock.
+struct cook_asset_slot
+{
+    u64 PathHash;
+    i32 AssetIndex;
+};
+
+struct cook_state
+{
+    char ResourcesDirectory[MAX_PATH_LENGTH];
+    bool Force;
+    bool WritePack;
+
+    i32 AssetCount;
+    cook_asset *Assets;
+    cook_asset_slot *AssetSlots;
+};
+
+// ------------------------------
+// INTERNAL FUNCTION DECLARATIONS
+// ------------------------------
+
+static void
+COOK_CollectAssets(cook_state *State, const char *Directory);
+static void
+COOK_AddAsset(cook_state *State, const char *Path);
+static cook_asset_type
+COOK_GetAssetType(const char *Path, u32 *Out_Version);
+static cook_asset *
+COOK_FindAsset(cook_state *State, const char *Path);
+static u64
+COOK_GetPathHash(const char *Path);
+static cook_asset_slot *
+COOK_FindAssetSlot(cook_state *State, u64 PathHash);
+
+static void
+COOK_HashAssetJob(void *Data);
+static void
+COOK_CookModelJob(void *Data);
+static void
+COOK_CookTextureJob(void *Data);
+static void
+COOK_GetCookedPath(cook_asset *Asset, char *Out_CookedPath);
+
+static u64
+COOK_GetDependencyHash(cook_state *State, const char *Path);
+static bool
+COOK_IsOutOfDate(cook_state *State, cook_asset *Asset);
+
+static void
+COOK_ReadManifest(cook_state *State, const char *ManifestPath);
+static bool
+COOK_WriteManifest(cook_state *State, const char *ManifestPath);
+
+static bool
+COOK_WritePack(cook_state *State, job_queue *Queue);
+
+static bool
+COOK_BenchmarkImageKernels();
+static f64
+COOK_TimeImageKernel(i32 Kernel, u8 *Pixels, u8 *RGBPixels, u8 *Scratch);
+static bool
+COOK_BenchmarkOcclusion();
+
+// ------------------
+// COOKER ENTRY POINT
+// ------------------
+
+int
+main(int Argc, char *Argv[])
+{
+    std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+
+    cook_state State = {};
+    strncpy_s(State.ResourcesDirectory, "resources", MAX_PATH_LENGTH - 1);
+    i32 ThreadCount = 0;
+
+    for (i32 ArgIndex = 1; ArgIndex < Argc; ++ArgIndex)
+    {
+        if (strcmp(Argv[ArgIndex], "-j") == 0 && ArgIndex + 1 < Argc)
+        {
+            ThreadCount = atoi(Argv[++ArgIndex]);
+        }
+        else if (strcmp(Argv[ArgIndex], "-force") == 0)
+        {
+            State.Force = true;
+        }
+        else if (strcmp(Argv[ArgIndex], "-pack") == 0)
+        {
+            State.WritePack = true;
+        }
+        else if (strcmp(Argv[ArgIndex], "-bench") == 0)
+        {
+            bool ImageKernelsMatch = COOK_BenchmarkImageKernels();
+            bool OcclusionIsRight = COOK_BenchmarkOcclusion();
+            return (ImageKernelsMatch && OcclusionIsRight) ? 0 : 1;
+        }
+        else if (Argv[ArgIndex][0] != '-')
+        {
+            strncpy_s(State.ResourcesDirectory, Argv[ArgIndex], MAX_PATH_LENGTH - 1);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [-j ThreadCount] [-force] [-pack] [-bench] [ResourcesDirectory]\n", Argv[0]);
+            return 1;
+        }
+    }
+
+    State.Assets = (cook_asset *) calloc(MAX_COOK_ASSET_COUNT, sizeof(cook_asset));
+    State.AssetSlots = (cook_asset_slot *) calloc(COOK_ASSET_SLOT_COUNT, sizeof(cook_asset_slot));
+    Assert(State.Assets && State.AssetSlots);
+
+    COOK_CollectAssets(&State, State.ResourcesDirectory);
+    if (State.AssetCount == 0)
+    {
+        fprintf(stderr, "No assets found in %s\n", State.ResourcesDirectory);
+        return 1;
+    }
+
+    char ManifestPath[MAX_PATH_LENGTH];
+    sprintf_s(ManifestPath, "%s/%s", State.ResourcesDirectory, COOK_MANIFEST_FILENAME);
+    COOK_ReadManifest(&State, ManifestPath);
+
+    job_queue *Queue = CreateJobQueue(ThreadCount);
+
+    // NOTE: Hash every source up front, so dependency checks below are lookups, not file reads
+    for (i32 AssetIndex = 0; AssetIndex < State.AssetCount; ++AssetIndex)
+    {
+        AddJob(Queue, COOK_HashAssetJob, &State.Assets[AssetIndex]);
+    }
+    CompleteAllJobs(Queue);
+
+    i32 CookCount = 0;
+    i32 UpToDateCount = 0;
+    for (i32 AssetIndex = 0; AssetIndex < State.AssetCount; ++AssetIndex)
+    {
+        cook_asset *Asset = &State.Assets[AssetIndex];
+        if (Asset->Type == COOK_ASSET_MODEL || Asset->Type == COOK_ASSET_TEXTURE)
+        {
+            if (COOK_IsOutOfDate(&State, Asset))
+            {
+                Asset->NeedsCook = true;
+                ++CookCount;
+                AddJob(Queue, (Asset->Type == COOK_ASSET_MODEL) ? COOK_CookModelJob : COOK_CookTextureJob, Asset);
+            }
+            else
+            {
+                ++UpToDateCount;
+            }
+        }
+    }
+    CompleteAllJobs(Queue);
+
+    i32 FailedCount = 0;
+    for (i32 AssetIndex = 0; AssetIndex < State.AssetCount; ++AssetIndex)
+    {
+        cook_asset *Asset = &State.Assets[AssetIndex];
+        if (Asset->NeedsCook && !Asset->CookFailed)
+        {
+            for (i32 DependencyIndex = 0; DependencyIndex < Asset->Dependencies.Count; ++DependencyIndex)
+            {
+                Asset->DependencyHashes[DependencyIndex] =
+                    COOK_GetDependencyHash(&State, Asset->Dependencies.Paths[DependencyIndex]);
+            }
+        }
+        else if (Asset->CookFailed)
+        {
+            ++FailedCount;
+        }
+    }
+
+    bool ManifestWritten = COOK_WriteManifest(&State, ManifestPath);
+
+    // NOTE: Only from a complete set of cooked files, so the pack never has stale ones
+    bool PackWritten = true;
+    if (State.WritePack)
+    {
+        PackWritten = (FailedCount == 0 && COOK_WritePack(&State, Queue));
+    }
+
+    i32 WorkerCount = GetJobQueueThreadCount(Queue);
+    DestroyJobQueue(Queue);
+
+    f64 ElapsedSeconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - StartTime).count();
+    printf("Cooked %d asset(s), %d up to date, %d failed; %d source file(s) hashed on %d worker(s) in %.2fs\n",
+           CookCount - FailedCount, UpToDateCount, FailedCount, State.AssetCount, WorkerCount + 1, ElapsedSeconds);
+
+    return (FailedCount == 0 && ManifestWritten && PackWritten) ? 0 : 1;
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+// Asset collection
+// ----------------
+
+static void
+COOK_CollectAssets(cook_state *State, const char *Directory)
+{
+    char ChildPath[MAX_PATH_LENGTH];
+
+#ifdef _WIN32
+    char SearchPattern[MAX_PATH_LENGTH];
+    sprintf_s(SearchPattern, "%s/*", Directory);
+
+    WIN32_FIND_DATAA FindData;
+    HANDLE FindHandle = FindFirstFileA(SearchPattern, &FindData);
+    if (FindHandle == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    do
+    {
+        if (strcmp(FindData.cFileName, ".") == 0 || strcmp(FindData.cFileName, "..") == 0)
+        {
+            continue;
+        }
+
+        sprintf_s(ChildPath, "%s/%s", Directory, FindData.cFileName);
+        if (FindData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        {
+            COOK_CollectAssets(State, ChildPath);
+        }
+        else
+        {
+            COOK_AddAsset(State, ChildPath);
+        }
+    } while (FindNextFileA(FindHandle, &FindData));
+
+    FindClose(FindHandle);
+#else
+    DIR *DirectoryHandle = opendir(Directory);
+    if (!DirectoryHandle)
+    {
+        return;
+    }
+
+    struct dirent *Entry;
+    while ((Entry = readdir(DirectoryHandle)) != 0)
+    {
+        if (strcmp(Entry->d_name, ".") == 0 || strcmp(Entry->d_name, "..") == 0)
+        {
+            continue;
+        }
+
+        snprintf(ChildPath, MAX_PATH_LENGTH, "%s/%s", Directory, Entry->d_name);
+        struct stat FileStat;
+        if (stat(ChildPath, &FileStat) != 0)
+        {
+            continue;
+        }
+
+        if (S_ISDIR(FileStat.st_mode))
+        {
+            COOK_CollectAssets(State, ChildPath);
+        }
+        else
+        {
+            COOK_AddAsset(State, ChildPath);
+        }
+    }
+
+    closedir(DirectoryHandle);
+#endif
+}
+
+static void
+COOK_AddAsset(cook_state *State, const char *Path)
+{
+    u32 Version;
+    cook_asset_type Type = COOK_GetAssetType(Path, &Version);
+    if (Type == COOK_ASSET_SKIPPED)
+    {
+        return;
+    }
+
+    if (State->AssetCount >= MAX_COOK_ASSET_COUNT)
+    {
+        fprintf(stderr, "Too many assets, skipping %s\n", Path);
+        return;
+    }
+
+    u64 PathHash = COOK_GetPathHash(Path);
+    cook_asset_slot *Slot = COOK_FindAssetSlot(State, PathHash);
+    if (Slot->PathHash != 0)
+    {
+        fprintf(stderr, "%s has the same path hash as %s, skipping it\n", Path,
+                State->Assets[Slot->AssetIndex].Path);
+        return;
+    }
+
+    Slot->PathHash = PathHash;
+    Slot->AssetIndex = State->AssetCount;
+
+    cook_asset *Asset = &State->Assets[State->AssetCount++];
+    strncpy_s(Asset->Path, Path, MAX_PATH_LENGTH - 1);
+    Asset->Type = Type;
+    Asset->Version = Version;
+}
+
+static cook_asset_type
+COOK_GetAssetType(const char *Path, u32 *Out_Version)
+{
+    *Out_Version = 0;
+
+    // NOTE: Cooker outputs are never inputs
+    if (HasFileExtension(Path, COOKED_MODEL_EXTENSION) || HasFileExtension(Path, COOKED_TEXTURE_EXTENSION) ||
+        HasFileExtension(Path, COOK_MANIFEST_FILENAME) || HasFileExtension(Path, PACK_EXTENSION))
+    {
+        return COOK_ASSET_SKIPPED;
+    }
+
+    if (HasFileExtension(Path, ".gltf") || HasFileExtension(Path, ".glb") ||
+        HasFileExtension(Path, ".objm") || HasFileExtension(Path, ".obj") ||
+        HasFileExtension(Path, ".fbx"))
+    {
+        *Out_Version = COOKED_MODEL_VERSION;
+        return COOK_ASSET_MODEL;
+    }
+
+    if (HasFileExtension(Path, ".png") || HasFileExtension(Path, ".jpg") || HasFileExtension(Path, ".jpeg") ||
+        HasFileExtension(Path, ".tga") || HasFileExtension(Path, ".bmp"))
+    {
+        *Out_Version = COOKED_TEXTURE_VERSION;
+        return COOK_ASSET_TEXTURE;
+    }
+
+    // NOTE: Fonts are only tracked as dependencies (and packed); they're rasterized from the
+    //       source file at runtime, since the sizes are picked in code
+    if (HasFileExtension(Path, ".ttf"))
+    {
+        return COOK_ASSET_FONT;
+    }
+
+    return COOK_ASSET_OTHER;
+}
+
+static cook_asset *
+COOK_FindAsset(cook_state *State, const char *Path)
+{
+    cook_asset_slot *Slot = COOK_FindAssetSlot(State, COOK_GetPathHash(Path));
+    if (Slot->PathHash == 0 || strcmp(State->Assets[Slot->AssetIndex].Path, Path) != 0)
+    {
+        return 0;
+    }
+
+    return &State->Assets[Slot->AssetIndex];
+}
+
+static u64
+COOK_GetPathHash(const char *Path)
+{
+    u64 Result = HashBytes64(Path, strlen(Path), 0);
+    return (Result != 0) ? Result : 1;
+}
+
+// NOTE: The slot holding PathHash, or the empty slot where it would go
+static cook_asset_slot *
+COOK_FindAssetSlot(cook_state *State, u64 PathHash)
+{
+    u32 SlotMask = COOK_ASSET_SLOT_COUNT - 1;
+    u32 Slot = (u32) PathHash & SlotMask;
+    while (State->AssetSlots[Slot].PathHash != 0 && State->AssetSlots[Slot].PathHash != PathHash)
+    {
+        Slot = (Slot + 1) & SlotMask;
+    }
+
+    return &State->AssetSlots[Slot];
+}
+
+// Jobs
+// ----
+
+static void
+COOK_HashAssetJob(void *Data)
+{
+    cook_asset *Asset = (cook_asset *) Data;
+    Asset->SourceHash = HashFile64(Asset->Path);
+}
+
+static void
+COOK_CookModelJob(void *Data)
+{
+    cook_asset *Asset = (cook_asset *) Data;
+
+    char CookedPath[MAX_PATH_LENGTH];
+    COOK_GetCookedPath(Asset, CookedPath);
+
+    // NOTE: CookModel finds the dependencies (material libraries, buffers, textures) itself
+    if (CookModel(Asset->Path, CookedPath, &Asset->Dependencies))
+    {
+        printf("Cooked %s\n", Asset->Path);
+    }
+    else
+    {
+        fprintf(stderr, "Couldn't cook %s\n", Asset->Path);
+        Asset->CookFailed = true;
+    }
+}
+
+static void
+COOK_CookTextureJob(void *Data)
+{
+    cook_asset *Asset = (cook_asset *) Data;
+
+    char CookedPath[MAX_PATH_LENGTH];
+    COOK_GetCookedPath(Asset, CookedPath);
+
+    // NOTE: A texture is a single file, it has no dependencies of its own
+    Asset->Dependencies.Count = 0;
+
+    if (CookTexture(Asset->Path, CookedPath))
+    {
+        printf("Cooked %s\n", Asset->Path);
+    }
+    else
+    {
+        fprintf(stderr, "Couldn't cook %s\n", Asset->Path);
+        Asset->CookFailed = true;
+    }
+}
+
+static void
+COOK_GetCookedPath(cook_asset *Asset, char *Out_CookedPath)
+{
+    if (Asset->Type == COOK_ASSET_TEXTURE)
+    {
+        GetCookedTexturePath(Asset->Path, Out_CookedPath, MAX_PATH_LENGTH);
+    }
+    else
+    {
+        GetCookedModelPath(Asset->Path, Out_CookedPath, MAX_PATH_LENGTH);
+    }
+}
+
+// Dependencies
+// ------------
+
+static u64
+COOK_GetDependencyHash(cook_state *State, const char *Path)
+{
+    cook_asset *Dependency = COOK_FindAsset(State, Path);
+    if (Dependency)
+    {
+        return Dependency->SourceHash;
+    }
+
+    // NOTE: Outside of the resources directory, so it wasn't hashed up front
+    return HashFile64(Path);
+}
+
+static bool
+COOK_IsOutOfDate(cook_state *State, cook_asset *Asset)
+{
+    cook_manifest_entry *Previous = &Asset->Previous;
+
+    if (State->Force || !Previous->IsValid ||
+        Previous->SourceHash != Asset->SourceHash || Previous->Version != Asset->Version)
+    {
+        return true;
+    }
+
+    char CookedPath[MAX_PATH_LENGTH];
+    COOK_GetCookedPath(Asset, CookedPath);
+    if (!FileExists(CookedPath))
+    {
+        return true;
+    }
+
+    for (i32 DependencyIndex = 0; DependencyIndex < Previous->DependencyCount; ++DependencyIndex)
+    {
+        if (COOK_GetDependencyHash(State, Previous->DependencyPaths[DependencyIndex]) !=
+            Previous->DependencyHashes[DependencyIndex])
+        {
+            return true;
+        }
+    }
+
+    // NOTE: Carry the dependencies over, so the next manifest still has them
+    Asset->Dependencies.Count = Previous->DependencyCount;
+    for (i32 DependencyIndex = 0; DependencyIndex < Previous->DependencyCount; ++DependencyIndex)
+    {
+        strncpy_s(Asset->Dependencies.Paths[DependencyIndex], Previous->DependencyPaths[DependencyIndex],
+                  MAX_PATH_LENGTH - 1);
+        Asset->DependencyHashes[DependencyIndex] = Previous->DependencyHashes[DependencyIndex];
+    }
+
+    return false;
+}
+
+// Manifest
+// --------
+//
+// NOTE: Text, so it diffs and can be inspected by hand:
+//
+//       CookManifest <version>
+//       S <source hash> <cooked version> <path>
+//       D <dependency hash> <path>         (zero or more per S line)
+
+static void
+COOK_ReadManifest(cook_state *State, const char *ManifestPath)
+{
+    FILE *File;
+    if (fopen_s(&File, ManifestPath, "rb") != 0)
+    {
+        return;
+    }
+
+    u32 ManifestVersion = 0;
+    if (fscanf_s(File, "CookManifest %u\n", &ManifestVersion) != 1 || ManifestVersion != COOK_MANIFEST_VERSION)
+    {
+        // NOTE: Unknown manifest; everything gets recooked and the manifest rewritten
+        fclose(File);
+        return;
+    }
+
+    cook_manifest_entry *CurrentEntry = 0;
+    char Line[MAX_PATH_LENGTH + 64];
+    while (fgets(Line, sizeof(Line), File))
+    {
+        char Path[MAX_PATH_LENGTH];
+        unsigned long long Hash;
+        u32 Version;
+
+        if (sscanf_s(Line, "S %llx %u %255[^\r\n]", &Hash, &Version, Path, (unsigned) MAX_PATH_LENGTH) == 3)
+        {
+            CurrentEntry = 0;
+            cook_asset *Asset = COOK_FindAsset(State, Path);
+            if (Asset)
+            {
+                CurrentEntry = &Asset->Previous;
+                CurrentEntry->IsValid = true;
+                CurrentEntry->SourceHash = Hash;
+                CurrentEntry->Version = Version;
+                CurrentEntry->DependencyCount = 0;
+            }
+        }
+        else if (sscanf_s(Line, "D %llx %255[^\r\n]", &Hash, Path, (unsigned) MAX_PATH_LENGTH) == 2)
+        {
+            if (CurrentEntry && CurrentEntry->DependencyCount < MAX_COOK_DEPENDENCY_COUNT)
+            {
+                i32 DependencyIndex = CurrentEntry->DependencyCount++;
+                CurrentEntry->DependencyHashes[DependencyIndex] = Hash;
+                strncpy_s(CurrentEntry->DependencyPaths[DependencyIndex], Path, MAX_PATH_LENGTH - 1);
+            }
+        }
+    }
+
+    fclose(File);
+}
+
+static bool
+COOK_WriteManifest(cook_state *State, const char *ManifestPath)
+{
+    FILE *File;
+    if (fopen_s(&File, ManifestPath, "wb") != 0)
+    {
+        fprintf(stderr, "Couldn't write cook manifest %s\n", ManifestPath);
+        return false;
+    }
+
+    fprintf(File, "CookManifest %u\n", COOK_MANIFEST_VERSION);
+
+    for (i32 AssetIndex = 0; AssetIndex < State->AssetCount; ++AssetIndex)
+    {
+        cook_asset *Asset = &State->Assets[AssetIndex];
+
+        // NOTE: Leave failed cooks out, so they're retried next time
+        if (Asset->CookFailed)
+        {
+            continue;
+        }
+
+        fprintf(File, "S %016llx %u %s\n", (unsigned long long) Asset->SourceHash, Asset->Version, Asset->Path);
+        for (i32 DependencyIndex = 0; DependencyIndex < Asset->Dependencies.Count; ++DependencyIndex)
+        {
+            fprintf(File, "D %016llx %s\n", (unsigned long long) Asset->DependencyHashes[DependencyIndex],
+                    Asset->Dependencies.Paths[DependencyIndex]);
+        }
+    }
+
+    fclose(File);
+
+    return true;
+}
+
+// Pack
+// ----
+
+static bool
+COOK_WritePack(cook_state *State, job_queue *Queue)
+{
+    // NOTE: Sources go in next to their cooked files; the game still checks one against the other
+    //       and hashes the sources, it just finds both in the pack
+    pack_input *Inputs = (pack_input *) calloc(State->AssetCount * 2, sizeof(pack_input));
+    Assert(Inputs);
+
+    i32 InputCount = 0;
+    for (i32 AssetIndex = 0; AssetIndex < State->AssetCount; ++AssetIndex)
+    {
+        cook_asset *Asset = &State->Assets[AssetIndex];
+        strncpy_s(Inputs[InputCount++].Path, Asset->Path, MAX_PATH_LENGTH - 1);
+
+        if (Asset->Type == COOK_ASSET_MODEL || Asset->Type == COOK_ASSET_TEXTURE)
+        {
+            char CookedPath[MAX_PATH_LENGTH];
+            COOK_GetCookedPath(Asset, CookedPath);
+            if (FileExists(CookedPath))
+            {
+                pack_input *Input = &Inputs[InputCount++];
+                strncpy_s(Input->Path, CookedPath, MAX_PATH_LENGTH - 1);
+                // NOTE: Cooked textures stream their mips straight out of the mapping
+                Input->KeepUncompressed = (Asset->Type == COOK_ASSET_TEXTURE);
+            }
+        }
+    }
+
+    // NOTE: Normalized first, so "resources/" doesn't turn into "resources/.pack"
+    char PackPath[MAX_PATH_LENGTH];
+    bool Result = NormalizePath(State->ResourcesDirectory, PackPath, MAX_PATH_LENGTH - (i32) sizeof(PACK_EXTENSION));
+    if (Result)
+    {
+        strcat_s(PackPath, PACK_EXTENSION);
+        Result = WritePack(PackPath, Inputs, InputCount, Queue);
+    }
+    free(Inputs);
+
+    return Result;
+}
+
+// Benchmarks
+// ----------
+
+#define COOK_BENCH_IMAGE_SIZE 2048
+#define COOK_BENCH_RUN_COUNT 8
+
+static f64
+COOK_TimeImageKernel(i32 Kernel, u8 *Pixels, u8 *RGBPixels, u8 *Scratch)
+{
+    size_t PixelCount = (size_t) COOK_BENCH_IMAGE_SIZE * COOK_BENCH_IMAGE_SIZE;
+
+    std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+    for (i32 RunIndex = 0; RunIndex < COOK_BENCH_RUN_COUNT; ++RunIndex)
+    {
+        switch (Kernel)
+        {
+            case 0: DownsampleImage(Pixels, COOK_BENCH_IMAGE_SIZE, COOK_BENCH_IMAGE_SIZE,
+                                    IMAGE_FILTER_BOX, IMAGE_SRGB | IMAGE_ALPHA_WEIGHTED, Scratch); break;
+            case 1: DownsampleImage(Pixels, COOK_BENCH_IMAGE_SIZE, COOK_BENCH_IMAGE_SIZE,
+                                    IMAGE_FILTER_KAISER, IMAGE_SRGB | IMAGE_ALPHA_WEIGHTED, Scratch); break;
+            case 2: DownsampleImage(Pixels, COOK_BENCH_IMAGE_SIZE, COOK_BENCH_IMAGE_SIZE,
+                                    IMAGE_FILTER_KAISER, IMAGE_NORMAL_MAP, Scratch); break;
+            case 3: ExpandRGBToRGBA(RGBPixels, PixelCount, Scratch); break;
+            case 4:
+            {
+                memcpy(Scratch, Pixels, PixelCount * 4);
+                PremultiplyAlpha(Scratch, PixelCount);
+            } break;
+        }
+    }
+    f64 ElapsedSeconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - StartTime).count();
+
+    // NOTE: Megabytes of source pixels per second
+    f64 SourceBytes = (f64) PixelCount * ((Kernel == 3) ? 3 : 4) * COOK_BENCH_RUN_COUNT;
+    return SourceBytes / (1024.0 * 1024.0) / ElapsedSeconds;
+}
+
+static bool
+COOK_BenchmarkImageKernels()
+{
+    const char *KernelNames[] = {
+        "Box downsample (sRGB, alpha)",
+        "Kaiser downsample (sRGB, alpha)",
+        "Kaiser downsample (normal map)",
+        "Expand RGB to RGBA",
+        "Premultiply alpha",
+    };
+    i32 KernelCount = (i32) (sizeof(KernelNames) / sizeof(KernelNames[0]));
+
+    size_t PixelCount = (size_t) COOK_BENCH_IMAGE_SIZE * COOK_BENCH_IMAGE_SIZE;
+    u8 *Pixels = (u8 *) malloc(PixelCount * 4);
+    u8 *RGBPixels = (u8 *) malloc(PixelCount * 3);
+    u8 *Scratch = (u8 *) malloc(PixelCount * 4);
+    u8 *SIMDOutput = (u8 *) malloc(PixelCount * 4);
+    Assert(Pixels && RGBPixels && Scratch && SIMDOutput);
+
+    // NOTE: Noise rather than a flat color, so nothing short-circuits
+    u32 State = 0x9E3779B9;
+    for (size_t ByteIndex = 0; ByteIndex < PixelCount * 4; ++ByteIndex)
+    {
+        State ^= State << 13;
+        State ^= State >> 17;
+        State ^= State << 5;
+        Pixels[ByteIndex] = (u8) State;
+    }
+    for (size_t PixelIndex = 0; PixelIndex < PixelCount; ++PixelIndex)
+    {
+        memcpy(&RGBPixels[PixelIndex * 3], &Pixels[PixelIndex * 4], 3);
+    }
+
+    printf("Image kernels on %dx%d, %d run(s) each:\n", COOK_BENCH_IMAGE_SIZE, COOK_BENCH_IMAGE_SIZE,
+           COOK_BENCH_RUN_COUNT);
+    printf("  %-34s %11s %11s %8s %10s\n", "Kernel", "SIMD MB/s", "Scalar MB/s", "Speedup", "Mismatches");
+    i32 MismatchedKernelCount = 0;
+    for (i32 KernelIndex = 0; KernelIndex < KernelCount; ++KernelIndex)
+    {
+        // NOTE: The downsamples only write the half size image
+        size_t OutputSize = (KernelIndex <= 2) ? PixelCount : PixelCount * 4;
+
+        SetImageSIMDEnabled(true);
+        f64 SIMDRate = COOK_TimeImageKernel(KernelIndex, Pixels, RGBPixels, Scratch);
+        memcpy(SIMDOutput, Scratch, OutputSize);
+        SetImageSIMDEnabled(false);
+        f64 ScalarRate = COOK_TimeImageKernel(KernelIndex, Pixels, RGBPixels, Scratch);
+
+        // NOTE: The scalar kernels are the reference, so the SIMD ones have to match them byte for byte
+        size_t MismatchCount = 0;
+        if (memcmp(SIMDOutput, Scratch, OutputSize) != 0)
+        {
+            for (size_t ByteIndex = 0; ByteIndex < OutputSize; ++ByteIndex)
+            {
+                MismatchCount += (SIMDOutput[ByteIndex] != Scratch[ByteIndex]);
+            }
+            ++MismatchedKernelCount;
+        }
+        printf("  %-34s %11.1f %11.1f %7.2fx %10zu\n", KernelNames[KernelIndex], SIMDRate, ScalarRate,
+               SIMDRate / ScalarRate, MismatchCount);
+    }
+    SetImageSIMDEnabled(true);
+
+    if (MismatchedKernelCount > 0)
+    {
+        fprintf(stderr, "%d image kernel(s) differ between SIMD and scalar\n", MismatchedKernelCount);
+    }
+
+    free(SIMDOutput);
+    free(Scratch);
+    free(RGBPixels);
+    free(Pixels);
+
+    return (MismatchedKernelCount == 0);
+}
+
+// NOTE: Occluder scenes for the occlusion check, all seen from the origin looking down -Z
+enum cook_occlusion_scene
+{
+    COOK_OCCLUSION_WALL,         // 10x6 wall facing the camera at Z = -10
+    COOK_OCCLUSION_SLANTED_WALL, // From X = -4, Z = -8 to X = 4, Z = -16; Z = -12 straight ahead
+    COOK_OCCLUSION_BACK_WALL,    // The first wall turned around
+    COOK_OCCLUSION_FLOOR,        // Floor at Y = -1 from behind the camera to Z = -30
+};
+
+struct cook_occlusion_case
+{
+    const char *Name;
+    cook_occlusion_scene Scene;
+    glm::vec3 Min;
+    glm::vec3 Max;
+    bool ExpectVisible;
+};
+
+#define COOK_BENCH_OCCLUDER_COUNT 512
+#define COOK_BENCH_OCCLUSION_BOX_COUNT 4096
+#define COOK_BENCH_OCCLUSION_RUN_COUNT 64
+
+static void
+COOK_AddOccluderQuad(occlusion_buffer *Buffer, glm::vec3 A, glm::vec3 B, glm::vec3 C, glm::vec3 D)
+{
+    f32 Positions[4 * POSITIONS_PER_VERTEX] = { A.x, A.y, A.z, B.x, B.y, B.z, C.x, C.y, C.z, D.x, D.y, D.z };
+    i32 Indices[6] = { 0, 1, 2, 0, 2, 3 };
+    AddOccluderMesh(Buffer, Positions, Indices, 6, glm::mat4(1.0f));
+}
+
+static void
+COOK_AddOcclusionScene(occlusion_buffer *Buffer, cook_occlusion_scene Scene)
+{
+    // NOTE: Corners go counter-clockwise as seen from the camera, except for the back wall
+    switch (Scene)
+    {
+        case COOK_OCCLUSION_WALL:
+        {
+            COOK_AddOccluderQuad(Buffer, glm::vec3(-5.0f, -3.0f, -10.0f), glm::vec3(5.0f, -3.0f, -10.0f),
+                                 glm::vec3(5.0f, 3.0f, -10.0f), glm::vec3(-5.0f, 3.0f, -10.0f));
+        } break;
+        case COOK_OCCLUSION_SLANTED_WALL:
+        {
+            COOK_AddOccluderQuad(Buffer, glm::vec3(-4.0f, -3.0f, -8.0f), glm::vec3(4.0f, -3.0f, -16.0f),
+                                 glm::vec3(4.0f, 3.0f, -16.0f), glm::vec3(-4.0f, 3.0f, -8.0f));
+        } break;
+        case COOK_OCCLUSION_BACK_WALL:
+        {
+            COOK_AddOccluderQuad(Buffer, glm::vec3(-5.0f, 3.0f, -10.0f), glm::vec3(5.0f, 3.0f, -10.0f),
+                                 glm::vec3(5.0f, -3.0f, -10.0f), glm::vec3(-5.0f, -3.0f, -10.0f));
+        } break;
+        case COOK_OCCLUSION_FLOOR:
+        {
+            COOK_AddOccluderQuad(Buffer, glm::vec3(-10.0f, -1.0f, 5.0f), glm::vec3(10.0f, -1.0f, 5.0f),
+                                 glm::vec3(10.0f, -1.0f, -30.0f), glm::vec3(-10.0f, -1.0f, -30.0f));
+        } break;
+    }
+}
+
+// NOTE: Checks the occlusion buffer against boxes whose visibility is known, then times it on a
+//       made up scene at the default resolution, with the band jobs. Returns false if a box came
+//       out wrong.
+static bool
+COOK_BenchmarkOcclusion()
+{
+    // NOTE: The slanted wall is straight ahead at Z = -12. Interpolating depth linearly on screen
+    //       instead of 1/w would put it at Z = -13.3 there, so the first of its boxes would show.
+    cook_occlusion_case Cases[] = {
+        { "Behind the wall", COOK_OCCLUSION_WALL, glm::vec3(-1.0f, -1.0f, -16.0f), glm::vec3(1.0f, 1.0f, -14.0f), false },
+        { "Past the wall's edge", COOK_OCCLUSION_WALL, glm::vec3(6.0f, -1.0f, -16.0f), glm::vec3(9.0f, 1.0f, -14.0f), true },
+        { "Beside the wall", COOK_OCCLUSION_WALL, glm::vec3(-9.0f, -1.0f, -16.0f), glm::vec3(-8.0f, 1.0f, -14.0f), true },
+        { "In front of the wall", COOK_OCCLUSION_WALL, glm::vec3(-1.0f, -1.0f, -6.0f), glm::vec3(1.0f, 1.0f, -4.0f), true },
+        { "Through the near plane", COOK_OCCLUSION_WALL, glm::vec3(-0.5f, -0.5f, -1.0f), glm::vec3(0.5f, 0.5f, 0.5f), true },
+        { "Just behind the slanted wall", COOK_OCCLUSION_SLANTED_WALL, glm::vec3(-0.1f, -0.1f, -12.9f), glm::vec3(0.1f, 0.1f, -12.7f), false },
+        { "Just in front of the slanted wall", COOK_OCCLUSION_SLANTED_WALL, glm::vec3(-0.1f, -0.1f, -11.5f), glm::vec3(0.1f, 0.1f, -11.3f), true },
+        { "Behind a back face", COOK_OCCLUSION_BACK_WALL, glm::vec3(-1.0f, -1.0f, -16.0f), glm::vec3(1.0f, 1.0f, -14.0f), true },
+        { "Under the floor", COOK_OCCLUSION_FLOOR, glm::vec3(-1.0f, -3.0f, -12.0f), glm::vec3(1.0f, -2.5f, -10.0f), false },
+        { "On the floor", COOK_OCCLUSION_FLOOR, glm::vec3(-1.0f, -1.0f, -12.0f), glm::vec3(1.0f, 1.0f, -10.0f), true },
+    };
+    i32 CaseCount = (i32) (sizeof(Cases) / sizeof(Cases[0]));
+
+    occlusion_buffer Buffer;
+    InitializeOcclusionBuffer(&Buffer);
+    f32 Aspect = (f32) DEFAULT_OCCLUSION_BUFFER_WIDTH / (f32) DEFAULT_OCCLUSION_BUFFER_HEIGHT;
+    glm::mat4 ViewProjection = glm::perspective(glm::radians(60.0f), Aspect, 0.1f, 1000.0f);
+
+    printf("Occlusion checks on %dx%d:\n", Buffer.Width, Buffer.Height);
+    i32 FailedCount = 0;
+    for (i32 CaseIndex = 0; CaseIndex < CaseCount; ++CaseIndex)
+    {
+        cook_occlusion_case *Case = &Cases[CaseIndex];
+        BeginOcclusionFrame(&Buffer, ViewProjection);
+        COOK_AddOcclusionScene(&Buffer, Case->Scene);
+        RasterizeOccluders(&Buffer);
+
+        bool IsVisible = IsBoxUnoccluded(&Buffer, Case->Min, Case->Max);
+        printf("  %-34s %-8s %s\n", Case->Name, IsVisible ? "visible" : "hidden",
+               (IsVisible == Case->ExpectVisible) ? "ok" : "FAILED");
+        FailedCount += (IsVisible != Case->ExpectVisible);
+    }
+
+    // NOTE: The top of the pyramid has the farthest and nearest depth in the whole buffer
+    {
+        i32 TopLevel = Buffer.LevelCount - 1;
+        f32 Farthest = FLT_MAX;
+        f32 Nearest = 0.0f;
+        for (i32 PixelIndex = 0; PixelIndex < Buffer.Width * Buffer.Height; ++PixelIndex)
+        {
+            Farthest = glm::min(Farthest, Buffer.FarthestLevels[0][PixelIndex]);
+            Nearest = glm::max(Nearest, Buffer.NearestLevels[0][PixelIndex]);
+        }
+        bool IsPyramidRight = (Buffer.LevelWidths[TopLevel] == 1 && Buffer.LevelHeights[TopLevel] == 1 &&
+                               Buffer.FarthestLevels[TopLevel][0] == Farthest &&
+                               Buffer.NearestLevels[TopLevel][0] == Nearest && Nearest > 0.0f);
+        printf("  %-34s %-8s %s\n", "Pyramid top", "", IsPyramidRight ? "ok" : "FAILED");
+        FailedCount += !IsPyramidRight;
+    }
+
+    // NOTE: Timing: walls scattered in front of the camera and boxes behind and between them
+    u32 State = 0x9E3779B9;
+    f32 *Walls = (f32 *) malloc(COOK_BENCH_OCCLUDER_COUNT * sizeof(f32) * 3);
+    glm::vec3 *Boxes = (glm::vec3 *) malloc(COOK_BENCH_OCCLUSION_BOX_COUNT * sizeof(glm::vec3));
+    Assert(Walls && Boxes);
+    for (i32 Index = 0; Index < COOK_BENCH_OCCLUDER_COUNT * 3 + COOK_BENCH_OCCLUSION_BOX_COUNT * 3; ++Index)
+    {
+        State ^= State << 13;
+        State ^= State >> 17;
+        State ^= State << 5;
+        f32 Random = (f32) (State & 0xFFFF) / 65535.0f;
+        if (Index < COOK_BENCH_OCCLUDER_COUNT * 3)
+        {
+            Walls[Index] = Random;
+        }
+        else
+        {
+            i32 BoxIndex = (Index - COOK_BENCH_OCCLUDER_COUNT * 3) / 3;
+            Boxes[BoxIndex][Index % 3] = Random;
+        }
+    }
+
+    std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+    for (i32 RunIndex = 0; RunIndex < COOK_BENCH_OCCLUSION_RUN_COUNT; ++RunIndex)
+    {
+        BeginOcclusionFrame(&Buffer, ViewProjection);
+        for (i32 WallIndex = 0; WallIndex < COOK_BENCH_OCCLUDER_COUNT; ++WallIndex)
+        {
+            f32 *Wall = &Walls[WallIndex * 3];
+            glm::vec3 Center((Wall[0] - 0.5f) * 80.0f, 0.0f, -5.0f - Wall[1] * 60.0f);
+            f32 HalfWidth = 1.0f + Wall[2] * 3.0f;
+            COOK_AddOccluderQuad(&Buffer, Center + glm::vec3(-HalfWidth, -2.0f, 0.0f),
+                                 Center + glm::vec3(HalfWidth, -2.0f, 0.0f), Center + glm::vec3(HalfWidth, 2.0f, 0.0f),
+                                 Center + glm::vec3(-HalfWidth, 2.0f, 0.0f));
+        }
+        RasterizeOccluders(&Buffer);
+    }
+    f64 RasterizeSeconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - StartTime).count();
+
+    i32 OccludedCount = 0;
+    StartTime = std::chrono::steady_clock::now();
+    for (i32 RunIndex = 0; RunIndex < COOK_BENCH_OCCLUSION_RUN_COUNT; ++RunIndex)
+    {
+        for (i32 BoxIndex = 0; BoxIndex < COOK_BENCH_OCCLUSION_BOX_COUNT; ++BoxIndex)
+        {
+            glm::vec3 Center((Boxes[BoxIndex].x - 0.5f) * 80.0f, (Boxes[BoxIndex].y - 0.5f) * 3.0f,
+                             -5.0f - Boxes[BoxIndex].z * 80.0f);
+            OccludedCount += !IsBoxUnoccluded(&Buffer, Center - glm::vec3(0.5f), Center + glm::vec3(0.5f));
+        }
+    }
+    f64 TestSeconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - StartTime).count();
+
+    printf("Occlusion timing on %dx%d, %d band(s), %d run(s) each:\n", Buffer.Width, Buffer.Height,
+           Buffer.BandCount, COOK_BENCH_OCCLUSION_RUN_COUNT);
+    printf("  Rasterize %d triangles: %.3f ms\n", Buffer.Stats.OccluderTriangles,
+           RasterizeSeconds * 1000.0 / COOK_BENCH_OCCLUSION_RUN_COUNT);
+    printf("  Test %d boxes: %.3f ms (%d%% occluded)\n", COOK_BENCH_OCCLUSION_BOX_COUNT,
+           TestSeconds * 1000.0 / COOK_BENCH_OCCLUSION_RUN_COUNT,
+           OccludedCount * 100 / (COOK_BENCH_OCCLUSION_BOX_COUNT * COOK_BENCH_OCCLUSION_RUN_COUNT));
+
+    free(Boxes);
+    free(Walls);
+    FreeOcclusionBuffer(&Buffer);
+
+    if (FailedCount > 0)
+    {
+        fprintf(stderr, "%d occlusion check(s) failed\n", FailedCount);
+    }
+
+    return (FailedCount == 0);
+}
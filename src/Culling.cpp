@@ -0,0 +1,526 @@
+#include "Culling.h"
+
+#include <emmintrin.h>
+
+#include <cmath>
+#include <cstdlib>
+
+#include "Memory.h"
+
+#define CULL_ALL_PLANES 0x3F
+
+struct bvh_cull_entry
+{
+    i32 Node;
+    // NOTE: Planes the node isn't known to be entirely inside of yet
+    u32 PlaneMask;
+};
+
+static i32
+BVH_AllocateNode(scene_bvh *BVH);
+static void
+BVH_FreeNode(scene_bvh *BVH, i32 NodeIndex);
+static void
+BVH_InsertLeaf(scene_bvh *BVH, i32 Leaf);
+static void
+BVH_RemoveLeaf(scene_bvh *BVH, i32 Leaf);
+static void
+BVH_RefitAncestors(scene_bvh *BVH, i32 NodeIndex);
+static inline f32
+BVH_SurfaceArea(glm::vec3 Min, glm::vec3 Max);
+static inline bool
+BVH_IsLeaf(bvh_node *Node);
+static i32
+BVH_EmitSubtree(scene_bvh *BVH, i32 NodeIndex, i32 *Stack, i32 *Out_UserIndices);
+
+// -----------------------------
+// EXTERNAL FUNCTION DEFINITIONS
+// -----------------------------
+
+// Bounds
+// ------
+
+// NOTE: Gribb/Hartmann: each plane is the last row of the matrix plus or minus one of the others
+//       (GL clip space, so near is -1)
+frustum
+MakeFrustum(glm::mat4 ViewProjection)
+{
+    glm::vec4 Rows[4];
+    for (i32 Row = 0; Row < 4; ++Row)
+    {
+        Rows[Row] = glm::vec4(ViewProjection[0][Row], ViewProjection[1][Row],
+                              ViewProjection[2][Row], ViewProjection[3][Row]);
+    }
+
+    frustum Result;
+    Result.Planes[0] = Rows[3] + Rows[0];
+    Result.Planes[1] = Rows[3] - Rows[0];
+    Result.Planes[2] = Rows[3] + Rows[1];
+    Result.Planes[3] = Rows[3] - Rows[1];
+    Result.Planes[4] = Rows[3] + Rows[2];
+    Result.Planes[5] = Rows[3] - Rows[2];
+    for (i32 PlaneIndex = 0; PlaneIndex < 6; ++PlaneIndex)
+    {
+        glm::vec4 *Plane = &Result.Planes[PlaneIndex];
+        f32 Length = glm::length(glm::vec3(*Plane));
+        if (Length > 0.0f)
+        {
+            *Plane = *Plane * (1.0f / Length);
+        }
+    }
+
+    return Result;
+}
+
+// NOTE: Arvo: the center goes through the transform, and each new half extent is the old ones
+//       weighted by the absolute values of the matrix row
+void
+TransformBounds(glm::vec3 Min, glm::vec3 Max, glm::mat4 Transform, glm::vec3 *Out_Min, glm::vec3 *Out_Max)
+{
+    glm::vec3 Center = (Min + Max) * 0.5f;
+    glm::vec3 Extent = (Max - Min) * 0.5f;
+
+    glm::vec3 NewCenter = glm::vec3(Transform * glm::vec4(Center, 1.0f));
+    glm::vec3 NewExtent;
+    for (i32 Axis = 0; Axis < 3; ++Axis)
+    {
+        NewExtent[Axis] = (fabsf(Transform[0][Axis]) * Extent.x +
+                           fabsf(Transform[1][Axis]) * Extent.y +
+                           fabsf(Transform[2][Axis]) * Extent.z);
+    }
+
+    *Out_Min = NewCenter - NewExtent;
+    *Out_Max = NewCenter + NewExtent;
+}
+
+bool
+IsBoxInFrustum(frustum *Frustum, glm::vec3 Min, glm::vec3 Max)
+{
+    glm::vec3 Center = (Min + Max) * 0.5f;
+    glm::vec3 Extent = (Max - Min) * 0.5f;
+
+    for (i32 PlaneIndex = 0; PlaneIndex < 6; ++PlaneIndex)
+    {
+        glm::vec4 Plane = Frustum->Planes[PlaneIndex];
+        f32 Distance = glm::dot(glm::vec3(Plane), Center) + Plane.w;
+        f32 Radius = glm::dot(glm::abs(glm::vec3(Plane)), Extent);
+        if (Distance < -Radius)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Scene BVH
+// ---------
+
+void
+InitializeSceneBVH(scene_bvh *BVH, i32 InitialCapacity, f32 FatMargin)
+{
+    Assert(InitialCapacity > 0 && FatMargin >= 0.0f);
+
+    *BVH = { };
+    BVH->Root = -1;
+    BVH->FreeList = -1;
+    BVH->FatMargin = FatMargin;
+    BVH->NodeCapacity = InitialCapacity;
+    BVH->Nodes = (bvh_node *) malloc(InitialCapacity * sizeof(bvh_node));
+    Assert(BVH->Nodes);
+}
+
+void
+FreeSceneBVH(scene_bvh *BVH)
+{
+    free(BVH->Nodes);
+    *BVH = { };
+    BVH->Root = -1;
+    BVH->FreeList = -1;
+}
+
+i32
+InsertBVHProxy(scene_bvh *BVH, glm::vec3 Min, glm::vec3 Max, i32 UserIndex)
+{
+    i32 Leaf = BVH_AllocateNode(BVH);
+    bvh_node *Node = &BVH->Nodes[Leaf];
+    Node->Min = Min - glm::vec3(BVH->FatMargin);
+    Node->Max = Max + glm::vec3(BVH->FatMargin);
+    Node->UserIndex = UserIndex;
+
+    BVH_InsertLeaf(BVH, Leaf);
+    ++BVH->ProxyCount;
+
+    return Leaf;
+}
+
+void
+RemoveBVHProxy(scene_bvh *BVH, i32 Proxy)
+{
+    Assert(Proxy >= 0 && Proxy < BVH->NodesUsed && BVH_IsLeaf(&BVH->Nodes[Proxy]));
+
+    BVH_RemoveLeaf(BVH, Proxy);
+    BVH_FreeNode(BVH, Proxy);
+    --BVH->ProxyCount;
+}
+
+bool
+MoveBVHProxy(scene_bvh *BVH, i32 Proxy, glm::vec3 Min, glm::vec3 Max)
+{
+    Assert(Proxy >= 0 && Proxy < BVH->NodesUsed && BVH_IsLeaf(&BVH->Nodes[Proxy]));
+
+    bvh_node *Node = &BVH->Nodes[Proxy];
+    if (Min.x >= Node->Min.x && Min.y >= Node->Min.y && Min.z >= Node->Min.z &&
+        Max.x <= Node->Max.x && Max.y <= Node->Max.y && Max.z <= Node->Max.z)
+    {
+        return false;
+    }
+
+    BVH_RemoveLeaf(BVH, Proxy);
+    Node = &BVH->Nodes[Proxy];
+    Node->Min = Min - glm::vec3(BVH->FatMargin);
+    Node->Max = Max + glm::vec3(BVH->FatMargin);
+    BVH_InsertLeaf(BVH, Proxy);
+
+    return true;
+}
+
+// NOTE: Pops nodes off the stack 4 at a time and tests them together against each plane as
+//       center/extent boxes (SSE2, one box per lane). The stack never holds a node twice, so it
+//       can't outgrow the node array.
+i32 *
+CullSceneBVH(scene_bvh *BVH, frustum *Frustum, i32 *Out_VisibleCount, cull_stats *Out_Stats)
+{
+    cull_stats Stats = { };
+    Stats.Tested = BVH->ProxyCount;
+
+    memory_arena *Arena = GetFrameArena();
+    i32 *Visible = PushArray(Arena, BVH->ProxyCount > 0 ? BVH->ProxyCount : 1, i32);
+    i32 VisibleCount = 0;
+
+    if (BVH->Root != -1)
+    {
+        temporary_memory StackMemory = BeginTemporaryMemory(Arena);
+        bvh_cull_entry *Stack = PushArray(Arena, BVH->NodesUsed, bvh_cull_entry);
+        i32 *SubtreeStack = PushArray(Arena, BVH->NodesUsed, i32);
+        i32 StackCount = 0;
+        Stack[StackCount++] = { BVH->Root, CULL_ALL_PLANES };
+
+        __m128 PlaneX[6], PlaneY[6], PlaneZ[6], PlaneW[6];
+        __m128 AbsPlaneX[6], AbsPlaneY[6], AbsPlaneZ[6];
+        for (i32 PlaneIndex = 0; PlaneIndex < 6; ++PlaneIndex)
+        {
+            glm::vec4 Plane = Frustum->Planes[PlaneIndex];
+            PlaneX[PlaneIndex] = _mm_set1_ps(Plane.x);
+            PlaneY[PlaneIndex] = _mm_set1_ps(Plane.y);
+            PlaneZ[PlaneIndex] = _mm_set1_ps(Plane.z);
+            PlaneW[PlaneIndex] = _mm_set1_ps(Plane.w);
+            AbsPlaneX[PlaneIndex] = _mm_set1_ps(fabsf(Plane.x));
+            AbsPlaneY[PlaneIndex] = _mm_set1_ps(fabsf(Plane.y));
+            AbsPlaneZ[PlaneIndex] = _mm_set1_ps(fabsf(Plane.z));
+        }
+        __m128 Half = _mm_set1_ps(0.5f);
+        __m128 Zero = _mm_setzero_ps();
+
+        while (StackCount > 0)
+        {
+            // NOTE: Lanes past LaneCount repeat the first node and are ignored
+            i32 LaneCount = (StackCount < 4) ? StackCount : 4;
+            bvh_cull_entry Lanes[4];
+            u32 ActivePlanes = 0;
+            for (i32 Lane = 0; Lane < 4; ++Lane)
+            {
+                Lanes[Lane] = (Lane < LaneCount) ? Stack[StackCount - 1 - Lane] : Lanes[0];
+                ActivePlanes |= Lanes[Lane].PlaneMask;
+            }
+            StackCount -= LaneCount;
+
+            bvh_node *Nodes[4];
+            for (i32 Lane = 0; Lane < 4; ++Lane)
+            {
+                Nodes[Lane] = &BVH->Nodes[Lanes[Lane].Node];
+            }
+            __m128 MinX = _mm_setr_ps(Nodes[0]->Min.x, Nodes[1]->Min.x, Nodes[2]->Min.x, Nodes[3]->Min.x);
+            __m128 MinY = _mm_setr_ps(Nodes[0]->Min.y, Nodes[1]->Min.y, Nodes[2]->Min.y, Nodes[3]->Min.y);
+            __m128 MinZ = _mm_setr_ps(Nodes[0]->Min.z, Nodes[1]->Min.z, Nodes[2]->Min.z, Nodes[3]->Min.z);
+            __m128 MaxX = _mm_setr_ps(Nodes[0]->Max.x, Nodes[1]->Max.x, Nodes[2]->Max.x, Nodes[3]->Max.x);
+            __m128 MaxY = _mm_setr_ps(Nodes[0]->Max.y, Nodes[1]->Max.y, Nodes[2]->Max.y, Nodes[3]->Max.y);
+            __m128 MaxZ = _mm_setr_ps(Nodes[0]->Max.z, Nodes[1]->Max.z, Nodes[2]->Max.z, Nodes[3]->Max.z);
+            __m128 CenterX = _mm_mul_ps(_mm_add_ps(MinX, MaxX), Half);
+            __m128 CenterY = _mm_mul_ps(_mm_add_ps(MinY, MaxY), Half);
+            __m128 CenterZ = _mm_mul_ps(_mm_add_ps(MinZ, MaxZ), Half);
+            __m128 ExtentX = _mm_mul_ps(_mm_sub_ps(MaxX, MinX), Half);
+            __m128 ExtentY = _mm_mul_ps(_mm_sub_ps(MaxY, MinY), Half);
+            __m128 ExtentZ = _mm_mul_ps(_mm_sub_ps(MaxZ, MinZ), Half);
+
+            i32 OutsideLanes = 0;
+            for (i32 PlaneIndex = 0; PlaneIndex < 6; ++PlaneIndex)
+            {
+                u32 PlaneBit = 1u << PlaneIndex;
+                if (!(ActivePlanes & PlaneBit))
+                {
+                    continue;
+                }
+
+                __m128 Distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(PlaneX[PlaneIndex], CenterX),
+                                                        _mm_mul_ps(PlaneY[PlaneIndex], CenterY)),
+                                             _mm_add_ps(_mm_mul_ps(PlaneZ[PlaneIndex], CenterZ),
+                                                        PlaneW[PlaneIndex]));
+                __m128 Radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(AbsPlaneX[PlaneIndex], ExtentX),
+                                                      _mm_mul_ps(AbsPlaneY[PlaneIndex], ExtentY)),
+                                           _mm_mul_ps(AbsPlaneZ[PlaneIndex], ExtentZ));
+                i32 Outside = _mm_movemask_ps(_mm_cmplt_ps(Distance, _mm_sub_ps(Zero, Radius)));
+                i32 Inside = _mm_movemask_ps(_mm_cmpge_ps(Distance, Radius));
+
+                for (i32 Lane = 0; Lane < LaneCount; ++Lane)
+                {
+                    if (!(Lanes[Lane].PlaneMask & PlaneBit))
+                    {
+                        continue;
+                    }
+                    if (Outside & (1 << Lane))
+                    {
+                        OutsideLanes |= 1 << Lane;
+                    }
+                    else if (Inside & (1 << Lane))
+                    {
+                        Lanes[Lane].PlaneMask &= ~PlaneBit;
+                    }
+                }
+            }
+            Stats.NodesTested += LaneCount;
+
+            for (i32 Lane = 0; Lane < LaneCount; ++Lane)
+            {
+                if (OutsideLanes & (1 << Lane))
+                {
+                    continue;
+                }
+
+                bvh_node *Node = Nodes[Lane];
+                if (Lanes[Lane].PlaneMask == 0)
+                {
+                    VisibleCount += BVH_EmitSubtree(BVH, Lanes[Lane].Node, SubtreeStack, &Visible[VisibleCount]);
+                }
+                else if (BVH_IsLeaf(Node))
+                {
+                    Visible[VisibleCount++] = Node->UserIndex;
+                }
+                else
+                {
+                    Stack[StackCount++] = { Node->Children[0], Lanes[Lane].PlaneMask };
+                    Stack[StackCount++] = { Node->Children[1], Lanes[Lane].PlaneMask };
+                }
+            }
+        }
+
+        EndTemporaryMemory(StackMemory);
+    }
+
+    Stats.Visible = VisibleCount;
+    Stats.Culled = Stats.Tested - VisibleCount;
+    if (Out_Stats)
+    {
+        *Out_Stats = Stats;
+    }
+
+    *Out_VisibleCount = VisibleCount;
+    return Visible;
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+static i32
+BVH_AllocateNode(scene_bvh *BVH)
+{
+    if (BVH->FreeList == -1)
+    {
+        if (BVH->NodesUsed == BVH->NodeCapacity)
+        {
+            i32 NewCapacity = BVH->NodeCapacity * 2;
+            bvh_node *NewNodes = (bvh_node *) realloc(BVH->Nodes, NewCapacity * sizeof(bvh_node));
+            Assert(NewNodes);
+            BVH->Nodes = NewNodes;
+            BVH->NodeCapacity = NewCapacity;
+        }
+
+        BVH->FreeList = BVH->NodesUsed++;
+        BVH->Nodes[BVH->FreeList].Parent = -1;
+    }
+
+    i32 Result = BVH->FreeList;
+    bvh_node *Node = &BVH->Nodes[Result];
+    BVH->FreeList = Node->Parent;
+
+    *Node = { };
+    Node->Parent = -1;
+    Node->Children[0] = -1;
+    Node->Children[1] = -1;
+    Node->UserIndex = -1;
+
+    return Result;
+}
+
+static void
+BVH_FreeNode(scene_bvh *BVH, i32 NodeIndex)
+{
+    BVH->Nodes[NodeIndex].Parent = BVH->FreeList;
+    BVH->FreeList = NodeIndex;
+}
+
+// NOTE: Walks down from the root to the node that's cheapest to pair the leaf with: staying at a
+//       node costs the area of a new parent over both, going down costs the growth of every box
+//       on the way plus the same at the child
+static void
+BVH_InsertLeaf(scene_bvh *BVH, i32 Leaf)
+{
+    if (BVH->Root == -1)
+    {
+        BVH->Root = Leaf;
+        BVH->Nodes[Leaf].Parent = -1;
+        return;
+    }
+
+    glm::vec3 LeafMin = BVH->Nodes[Leaf].Min;
+    glm::vec3 LeafMax = BVH->Nodes[Leaf].Max;
+
+    i32 Sibling = BVH->Root;
+    while (!BVH_IsLeaf(&BVH->Nodes[Sibling]))
+    {
+        bvh_node *Node = &BVH->Nodes[Sibling];
+
+        f32 Area = BVH_SurfaceArea(Node->Min, Node->Max);
+        f32 CombinedArea = BVH_SurfaceArea(glm::min(Node->Min, LeafMin), glm::max(Node->Max, LeafMax));
+        f32 Cost = 2.0f * CombinedArea;
+        f32 InheritedCost = 2.0f * (CombinedArea - Area);
+
+        f32 ChildCosts[2];
+        for (i32 ChildIndex = 0; ChildIndex < 2; ++ChildIndex)
+        {
+            bvh_node *Child = &BVH->Nodes[Node->Children[ChildIndex]];
+            f32 ChildCombinedArea = BVH_SurfaceArea(glm::min(Child->Min, LeafMin), glm::max(Child->Max, LeafMax));
+            ChildCosts[ChildIndex] = ChildCombinedArea + InheritedCost;
+            if (!BVH_IsLeaf(Child))
+            {
+                ChildCosts[ChildIndex] -= BVH_SurfaceArea(Child->Min, Child->Max);
+            }
+        }
+
+        if (Cost < ChildCosts[0] && Cost < ChildCosts[1])
+        {
+            break;
+        }
+        Sibling = (ChildCosts[0] <= ChildCosts[1]) ? Node->Children[0] : Node->Children[1];
+    }
+
+    // NOTE: Can move the node array, so no node pointers are held across it
+    i32 NewParent = BVH_AllocateNode(BVH);
+    i32 OldParent = BVH->Nodes[Sibling].Parent;
+
+    bvh_node *ParentNode = &BVH->Nodes[NewParent];
+    ParentNode->Parent = OldParent;
+    ParentNode->Min = glm::min(BVH->Nodes[Sibling].Min, LeafMin);
+    ParentNode->Max = glm::max(BVH->Nodes[Sibling].Max, LeafMax);
+    ParentNode->Children[0] = Sibling;
+    ParentNode->Children[1] = Leaf;
+
+    if (OldParent == -1)
+    {
+        BVH->Root = NewParent;
+    }
+    else
+    {
+        bvh_node *OldParentNode = &BVH->Nodes[OldParent];
+        OldParentNode->Children[(OldParentNode->Children[0] == Sibling) ? 0 : 1] = NewParent;
+    }
+    BVH->Nodes[Sibling].Parent = NewParent;
+    BVH->Nodes[Leaf].Parent = NewParent;
+
+    BVH_RefitAncestors(BVH, OldParent);
+}
+
+// NOTE: The leaf's parent goes with it; the sibling takes the parent's place
+static void
+BVH_RemoveLeaf(scene_bvh *BVH, i32 Leaf)
+{
+    if (Leaf == BVH->Root)
+    {
+        BVH->Root = -1;
+        return;
+    }
+
+    i32 Parent = BVH->Nodes[Leaf].Parent;
+    bvh_node *ParentNode = &BVH->Nodes[Parent];
+    i32 GrandParent = ParentNode->Parent;
+    i32 Sibling = (ParentNode->Children[0] == Leaf) ? ParentNode->Children[1] : ParentNode->Children[0];
+
+    if (GrandParent == -1)
+    {
+        BVH->Root = Sibling;
+        BVH->Nodes[Sibling].Parent = -1;
+    }
+    else
+    {
+        bvh_node *GrandParentNode = &BVH->Nodes[GrandParent];
+        GrandParentNode->Children[(GrandParentNode->Children[0] == Parent) ? 0 : 1] = Sibling;
+        BVH->Nodes[Sibling].Parent = GrandParent;
+    }
+
+    BVH_FreeNode(BVH, Parent);
+    BVH->Nodes[Leaf].Parent = -1;
+    BVH_RefitAncestors(BVH, GrandParent);
+}
+
+static void
+BVH_RefitAncestors(scene_bvh *BVH, i32 NodeIndex)
+{
+    while (NodeIndex != -1)
+    {
+        bvh_node *Node = &BVH->Nodes[NodeIndex];
+        bvh_node *Child0 = &BVH->Nodes[Node->Children[0]];
+        bvh_node *Child1 = &BVH->Nodes[Node->Children[1]];
+        Node->Min = glm::min(Child0->Min, Child1->Min);
+        Node->Max = glm::max(Child0->Max, Child1->Max);
+        NodeIndex = Node->Parent;
+    }
+}
+
+static inline f32
+BVH_SurfaceArea(glm::vec3 Min, glm::vec3 Max)
+{
+    glm::vec3 Size = Max - Min;
+    f32 Result = 2.0f * (Size.x * Size.y + Size.y * Size.z + Size.z * Size.x);
+    return Result;
+}
+
+static inline bool
+BVH_IsLeaf(bvh_node *Node)
+{
+    bool Result = (Node->Children[0] == -1);
+    return Result;
+}
+
+static i32
+BVH_EmitSubtree(scene_bvh *BVH, i32 NodeIndex, i32 *Stack, i32 *Out_UserIndices)
+{
+    i32 Count = 0;
+    i32 StackCount = 0;
+    Stack[StackCount++] = NodeIndex;
+    while (StackCount > 0)
+    {
+        bvh_node *Node = &BVH->Nodes[Stack[--StackCount]];
+        if (BVH_IsLeaf(Node))
+        {
+            Out_UserIndices[Count++] = Node->UserIndex;
+        }
+        else
+        {
+            Stack[StackCount++] = Node->Children[0];
+            Stack[StackCount++] = Node->Children[1];
+        }
+    }
+
+    return Count;
+}
@@ -0,0 +1,100 @@
+#ifndef CULLING_H
+#define CULLING_H
+
+#include <glm/glm.hpp>
+
+#include "Common.h"
+
+// NOTE: Plane equations facing into the frustum and normalized, so dot(Plane.xyz, P) + Plane.w is
+//       P's distance inside it. Built from a projection * view matrix, so they're in world space.
+struct frustum
+{
+    glm::vec4 Planes[6];
+};
+
+// NOTE: Dynamic AABB tree over world space boxes (scene instances). Leaves hold a box enlarged by
+//       the tree's fat margin, so something that moves a little stays inside its leaf and the tree
+//       isn't touched; only when it leaves the fat box is the leaf taken out and put back in,
+//       refitting the boxes above it on the way. Inserts go down the side that grows the least
+//       surface area. Nodes live in one growable array and are addressed by index; removed ones
+//       go on a free list.
+#define DEFAULT_BVH_NODE_CAPACITY 64
+#define DEFAULT_BVH_FAT_MARGIN 0.2f
+
+struct bvh_node
+{
+    glm::vec3 Min;
+    glm::vec3 Max;
+    // NOTE: Next node on the free list while the node is free
+    i32 Parent;
+    // NOTE: -1 for leaves
+    i32 Children[2];
+    // NOTE: Leaves only: what the proxy was inserted with, handed back by CullSceneBVH
+    i32 UserIndex;
+};
+
+struct scene_bvh
+{
+    i32 Root;
+    i32 NodeCapacity;
+    i32 NodesUsed;
+    bvh_node *Nodes;
+    i32 FreeList;
+
+    i32 ProxyCount;
+    f32 FatMargin;
+};
+
+struct cull_stats
+{
+    // NOTE: Proxies in the tree
+    i32 Tested;
+    i32 Visible;
+    i32 Culled;
+    // NOTE: In the frustum but hidden behind occluders; not counted in Visible
+    i32 Occluded;
+    // NOTE: Node boxes tested against the frustum's planes (in groups of 4)
+    i32 NodesTested;
+};
+
+// ---------------------
+// FUNCTION DECLARATIONS
+// ---------------------
+
+// Bounds
+// ------
+
+frustum
+MakeFrustum(glm::mat4 ViewProjection);
+// NOTE: Box around the transformed box, no bigger than it has to be
+void
+TransformBounds(glm::vec3 Min, glm::vec3 Max, glm::mat4 Transform, glm::vec3 *Out_Min, glm::vec3 *Out_Max);
+// NOTE: Conservative: boxes near a frustum corner can pass without being in view
+bool
+IsBoxInFrustum(frustum *Frustum, glm::vec3 Min, glm::vec3 Max);
+
+// Scene BVH
+// ---------
+
+void
+InitializeSceneBVH(scene_bvh *BVH, i32 InitialCapacity = DEFAULT_BVH_NODE_CAPACITY,
+                   f32 FatMargin = DEFAULT_BVH_FAT_MARGIN);
+void
+FreeSceneBVH(scene_bvh *BVH);
+
+// NOTE: Returns the proxy (a leaf index) to move and remove it by
+i32
+InsertBVHProxy(scene_bvh *BVH, glm::vec3 Min, glm::vec3 Max, i32 UserIndex);
+void
+RemoveBVHProxy(scene_bvh *BVH, i32 Proxy);
+// NOTE: Returns whether the tree changed, i.e. the box left the proxy's fat box
+bool
+MoveBVHProxy(scene_bvh *BVH, i32 Proxy, glm::vec3 Min, glm::vec3 Max);
+
+// NOTE: User indices of the proxies that touch the frustum, in the frame arena. Subtrees that are
+//       entirely inside a plane aren't tested against it again, and subtrees entirely inside the
+//       frustum aren't tested at all.
+i32 *
+CullSceneBVH(scene_bvh *BVH, frustum *Frustum, i32 *Out_VisibleCount, cull_stats *Out_Stats);
+
+#endif
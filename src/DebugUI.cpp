@@ -3,7 +3,10 @@
 #include <glad/glad.h>
 #include <cstring>
 
+#include "GLState.h"
+#include "Resource.h"
 #include "Shader.h"
+#include "StreamBuffer.h"
 #include "Text.h"
 #include "Util.h"
 
@@ -28,7 +31,7 @@ i32 gScreenHeight;
 
 u32 gShader;
 u32 gVAO;
-u32 gVBO;
+// NOTE: Room for every string at full length
 size_t gVertCount;
 f32 *gVertPosBuffer;
 f32 *gVertUVBuffer;
@@ -46,27 +49,26 @@ DEBUG_InitializeDebugUI(i32 X, i32 Y, i32 ScreenWidth, i32 ScreenHeight, u32 Tex
     
     // 2. Load font
     // ------------
-    gFont = RasterizeAndProcessFont("resources/fonts/ContrailOne-Regular.ttf", 24);
+    // NOTE: Shares the atlas with anything else that uses the same font at the same size
+    gFont = GetFont(LoadFontResource("resources/fonts/ContrailOne-Regular.ttf", 24, 0));
 
     // 3. Allocate buffers for transient render data
     // ---------------------------------------------
-    size_t BufferSize = DEBUG_STRING_MAX_LENGTH;
-    gVertCount = BufferSize * 6;
+    gVertCount = DEBUG_STRING_MAX_COUNT * DEBUG_STRING_MAX_LENGTH * 6;
     gVertPosBuffer = (f32 *) malloc(gVertCount * 2 * sizeof(f32));
     gVertUVBuffer = (f32 *) malloc(gVertCount * 2 * sizeof(f32));
 
     // 4. Prepare render data on GPU
     // -----------------------------
+    // NOTE: Vertices are streamed every frame; the attributes are pointed at them before drawing
     glGenVertexArrays(1, &gVAO);
-    glGenBuffers(1, &gVBO);
-    glBindVertexArray(gVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, gVBO);
-    glBufferData(GL_ARRAY_BUFFER, (2 + 2) * gVertCount * sizeof(f32), NULL, GL_DYNAMIC_DRAW);
+    BindVertexArray(gVAO);
+    BindBuffer(GL_ARRAY_BUFFER, GetStreamBuffer());
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(f32), (void *) 0);
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(f32), (void *) (2 * gVertCount * sizeof(f32)));
-    glBindVertexArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(f32), (void *) 0);
+    BindVertexArray(0);
 }
 
 void
@@ -91,31 +93,42 @@ DEBUG_RenderAllDebugStrings()
 {
     if (gDebugStringCount > 0)
     {
-        UseShader(gShader);
-
-        glBindVertexArray(gVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, gVBO);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, gFont->AtlasGLID);
-
+        // NOTE: All the strings go up in one allocation (every string's positions, then every
+        //       string's UVs) and are drawn together
+        size_t VertexCount = 0;
         for (i32 StringIndex = 0; StringIndex < gDebugStringCount; ++StringIndex)
         {
             debug_string *DebugString = &gDebugStrings[StringIndex];
 
             PrepareRenderDataForString(DebugString->Buffer, (i32) DebugString->Length, (i32) DebugString->Length, gFont,
-                                       gX, gY, gScreenWidth, gScreenHeight, StringIndex, gVertPosBuffer, gVertUVBuffer);
-
-            glBufferSubData(GL_ARRAY_BUFFER, 0,
-                            DebugString->Length * 6 * 2 * sizeof(f32), gVertPosBuffer);
-            glBufferSubData(GL_ARRAY_BUFFER, 2 * gVertCount * sizeof(f32),
-                            DebugString->Length * 6 * 2 * sizeof(f32), gVertUVBuffer);
+                                       gX, gY, gScreenWidth, gScreenHeight, StringIndex,
+                                       gVertPosBuffer + VertexCount * 2, gVertUVBuffer + VertexCount * 2);
+            VertexCount += DebugString->Length * 6;
+        }
+        if (VertexCount == 0)
+        {
+            return;
+        }
 
-            glDrawArrays(GL_TRIANGLES, 0, (i32) DebugString->Length * 6);
+        size_t AttributeSize = VertexCount * 2 * sizeof(f32);
+        stream_allocation Allocation = BeginStreamWrite(2 * AttributeSize, STREAM_USAGE_VERTEX);
+        if (!Allocation.Data)
+        {
+            return;
         }
+        memcpy(Allocation.Data, gVertPosBuffer, AttributeSize);
+        memcpy(Allocation.Data + AttributeSize, gVertUVBuffer, AttributeSize);
+        EndStreamWrite(&Allocation);
+
+        UseShader(gShader);
+
+        BindVertexArray(gVAO);
+        BindBuffer(GL_ARRAY_BUFFER, Allocation.Buffer);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(f32), (void *) Allocation.Offset);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(f32), (void *) (Allocation.Offset + AttributeSize));
+        BindTexture2D(0, gFont->AtlasGLID);
 
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+        DrawArrays(GL_TRIANGLES, 0, (i32) VertexCount);
     }
 }
 
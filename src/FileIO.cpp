@@ -0,0 +1,543 @@
+#include "FileIO.h"
+
+#include <SDL2/SDL.h>
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include <sys/stat.h>
+
+#include "Hash.h"
+#include "Jobs.h"
+#include "Pack.h"
+#include "Util.h"
+
+// NOTE: Reads go straight to the OS with positional reads (pread, or ReadFile with an offset in
+//       the OVERLAPPED on Windows), so many jobs can read from different files, or different
+//       ranges of one file, without sharing a FILE * or a file position
+struct file_read_batch
+{
+    SDL_atomic_t RemainingCount;
+    SDL_sem *Done;
+
+    i32 ReadCount;
+    struct file_read_job *Jobs;
+};
+
+struct file_read_job
+{
+    file_read_batch *Batch;
+    file_read *Read;
+};
+
+// NOTE: Larger reads are split, Windows can't read more than 4 GB in one call
+#define FILE_READ_CHUNK_SIZE (1u << 30)
+
+// NOTE: Paths someone has locked with LockFilePath, by the hash of their normalized spelling.
+//       Only cooks on load lock paths, so there are never many at once.
+#define MAX_LOCKED_FILE_PATH_COUNT 64
+struct locked_file_paths
+{
+    SDL_SpinLock Lock;
+    i32 Count;
+    u64 PathHashes[MAX_LOCKED_FILE_PATH_COUNT];
+};
+
+static locked_file_paths LockedFilePaths;
+
+static u8 *
+ReadFileRange(const char *Path, u64 Offset, size_t Size, size_t *Out_BytesRead, bool *Out_IsComplete);
+static void
+FileReadJob(void *Data);
+static u64
+HashFilePath(const char *Path);
+
+// ------------------------
+// WHOLE FILES ------------
+// ------------------------
+
+char *
+ReadFile(const char *Path, size_t *Out_Size)
+{
+    *Out_Size = 0;
+
+    bool Complete;
+    size_t Size;
+    u8 *Data = ReadFileRange(Path, 0, 0, &Size, &Complete);
+    if (!Complete)
+    {
+        fprintf(stderr, "Couldn't read file: %s\n", Path);
+        free(Data);
+        return 0;
+    }
+
+    *Out_Size = Size;
+    return (char *) Data;
+}
+
+// ------------------------
+// MAPPED VIEWS -----------
+// ------------------------
+
+bool
+MapFileReadOnly(const char *Path, mapped_file *Out_MappedFile)
+{
+    *Out_MappedFile = { };
+
+    packed_file PackedFile;
+    if (FindPackedFile(Path, &PackedFile))
+    {
+        if (PackedFile.Size == 0)
+        {
+            return false;
+        }
+
+        u8 *Data = (u8 *) PackedFile.Data;
+        if (!Data)
+        {
+            Data = (u8 *) malloc((size_t) PackedFile.Size);
+            Assert(Data);
+            if (!ReadPackedFile(&PackedFile, 0, (size_t) PackedFile.Size, Data))
+            {
+                fprintf(stderr, "Couldn't read packed file: %s\n", Path);
+                free(Data);
+                return false;
+            }
+            Out_MappedFile->IsHeapCopy = true;
+        }
+
+        Out_MappedFile->Data = Data;
+        Out_MappedFile->Size = (size_t) PackedFile.Size;
+        Out_MappedFile->IsPacked = true;
+        return true;
+    }
+
+#ifdef _WIN32
+    HANDLE File = CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 0);
+    if (File == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER FileSize;
+    if (!GetFileSizeEx(File, &FileSize) || FileSize.QuadPart == 0)
+    {
+        CloseHandle(File);
+        return false;
+    }
+
+    HANDLE Mapping = CreateFileMappingA(File, 0, PAGE_READONLY, 0, 0, 0);
+    if (!Mapping)
+    {
+        CloseHandle(File);
+        return false;
+    }
+
+    void *Data = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!Data)
+    {
+        CloseHandle(Mapping);
+        CloseHandle(File);
+        return false;
+    }
+
+    Out_MappedFile->Data = (u8 *) Data;
+    Out_MappedFile->Size = (size_t) FileSize.QuadPart;
+    Out_MappedFile->FileHandle = File;
+    Out_MappedFile->MappingHandle = Mapping;
+#else
+    int File = open(Path, O_RDONLY);
+    if (File < 0)
+    {
+        return false;
+    }
+
+    struct stat FileStat;
+    if (fstat(File, &FileStat) != 0 || FileStat.st_size == 0)
+    {
+        close(File);
+        return false;
+    }
+
+    void *Data = mmap(0, (size_t) FileStat.st_size, PROT_READ, MAP_PRIVATE, File, 0);
+    close(File);
+    if (Data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    Out_MappedFile->Data = (u8 *) Data;
+    Out_MappedFile->Size = (size_t) FileStat.st_size;
+#endif
+
+    return true;
+}
+
+void
+UnmapFile(mapped_file *MappedFile)
+{
+    if (MappedFile->IsHeapCopy)
+    {
+        free(MappedFile->Data);
+    }
+    else if (MappedFile->Data && !MappedFile->IsPacked)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(MappedFile->Data);
+        CloseHandle((HANDLE) MappedFile->MappingHandle);
+        CloseHandle((HANDLE) MappedFile->FileHandle);
+#else
+        munmap(MappedFile->Data, MappedFile->Size);
+#endif
+    }
+
+    *MappedFile = { };
+}
+
+// ------------------------
+// FILE INFO --------------
+// ------------------------
+
+bool
+FileExists(const char *Path)
+{
+    packed_file PackedFile;
+    if (FindPackedFile(Path, &PackedFile))
+    {
+        return true;
+    }
+
+    FILE *File;
+    fopen_s(&File, Path, "rb");
+    if (File)
+    {
+        fclose(File);
+        return true;
+    }
+
+    return false;
+}
+
+u64
+GetFileModificationTime(const char *Path)
+{
+    u64 Size;
+    u64 ModificationTime;
+    return GetFileInfo(Path, &Size, &ModificationTime) ? ModificationTime : 0;
+}
+
+bool
+GetFileInfo(const char *Path, u64 *Out_Size, u64 *Out_ModificationTime)
+{
+    packed_file PackedFile;
+    if (FindPackedFile(Path, &PackedFile))
+    {
+        *Out_Size = PackedFile.Size;
+        *Out_ModificationTime = PackedFile.ModificationTime;
+        return true;
+    }
+
+#ifdef _WIN32
+    struct _stat64 FileStat;
+    if (_stat64(Path, &FileStat) != 0)
+    {
+        return false;
+    }
+#else
+    struct stat FileStat;
+    if (stat(Path, &FileStat) != 0)
+    {
+        return false;
+    }
+#endif
+
+    *Out_Size = (u64) FileStat.st_size;
+    *Out_ModificationTime = (u64) FileStat.st_mtime;
+    return true;
+}
+
+// ------------------------
+// REPLACING WRITES -------
+// ------------------------
+
+FILE *
+OpenReplacingFile(const char *Path)
+{
+    char TemporaryPath[MAX_PATH_LENGTH];
+    sprintf_s(TemporaryPath, "%s.tmp", Path);
+
+    FILE *File;
+    fopen_s(&File, TemporaryPath, "wb");
+    return File;
+}
+
+bool
+CloseReplacingFile(FILE *File, const char *Path, bool Success)
+{
+    char TemporaryPath[MAX_PATH_LENGTH];
+    sprintf_s(TemporaryPath, "%s.tmp", Path);
+
+    Success = (fclose(File) == 0 && Success);
+    if (Success)
+    {
+#ifdef _WIN32
+        Success = (MoveFileExA(TemporaryPath, Path, MOVEFILE_REPLACE_EXISTING) != 0);
+#else
+        Success = (rename(TemporaryPath, Path) == 0);
+#endif
+    }
+
+    if (!Success)
+    {
+        remove(TemporaryPath);
+    }
+
+    return Success;
+}
+
+void
+LockFilePath(const char *Path)
+{
+    u64 PathHash = HashFilePath(Path);
+
+    for (;;)
+    {
+        SDL_AtomicLock(&LockedFilePaths.Lock);
+
+        bool IsLocked = false;
+        for (i32 PathIndex = 0; PathIndex < LockedFilePaths.Count; ++PathIndex)
+        {
+            if (LockedFilePaths.PathHashes[PathIndex] == PathHash)
+            {
+                IsLocked = true;
+                break;
+            }
+        }
+
+        if (!IsLocked && LockedFilePaths.Count < MAX_LOCKED_FILE_PATH_COUNT)
+        {
+            LockedFilePaths.PathHashes[LockedFilePaths.Count++] = PathHash;
+            SDL_AtomicUnlock(&LockedFilePaths.Lock);
+            return;
+        }
+
+        SDL_AtomicUnlock(&LockedFilePaths.Lock);
+
+        // NOTE: Whoever holds it is writing a whole file; polling is plenty
+        SDL_Delay(1);
+    }
+}
+
+void
+UnlockFilePath(const char *Path)
+{
+    u64 PathHash = HashFilePath(Path);
+
+    SDL_AtomicLock(&LockedFilePaths.Lock);
+
+    for (i32 PathIndex = 0; PathIndex < LockedFilePaths.Count; ++PathIndex)
+    {
+        if (LockedFilePaths.PathHashes[PathIndex] == PathHash)
+        {
+            LockedFilePaths.PathHashes[PathIndex] = LockedFilePaths.PathHashes[--LockedFilePaths.Count];
+            break;
+        }
+    }
+
+    SDL_AtomicUnlock(&LockedFilePaths.Lock);
+}
+
+// ------------------------
+// ASYNCHRONOUS READS -----
+// ------------------------
+
+file_read_batch *
+ReadFilesAsync(job_queue *Queue, file_read *Reads, i32 ReadCount)
+{
+    file_read_batch *Batch = (file_read_batch *) calloc(1, sizeof(file_read_batch));
+    Assert(Batch);
+    Batch->ReadCount = ReadCount;
+    Batch->Jobs = (file_read_job *) calloc((ReadCount > 0) ? ReadCount : 1, sizeof(file_read_job));
+    Batch->Done = SDL_CreateSemaphore(0);
+    Assert(Batch->Jobs && Batch->Done);
+
+    SDL_AtomicSet(&Batch->RemainingCount, ReadCount);
+    if (ReadCount == 0)
+    {
+        SDL_SemPost(Batch->Done);
+    }
+
+    for (i32 ReadIndex = 0; ReadIndex < ReadCount; ++ReadIndex)
+    {
+        file_read_job *Job = &Batch->Jobs[ReadIndex];
+        Job->Batch = Batch;
+        Job->Read = &Reads[ReadIndex];
+        AddJob(Queue, FileReadJob, Job);
+    }
+
+    return Batch;
+}
+
+bool
+IsFileReadBatchDone(file_read_batch *Batch)
+{
+    return (SDL_AtomicGet(&Batch->RemainingCount) == 0);
+}
+
+void
+WaitForFileReadBatch(file_read_batch *Batch)
+{
+    // NOTE: Not from one of the queue's own jobs; if every worker waited, nothing would run the reads
+    SDL_SemWait(Batch->Done);
+
+    SDL_DestroySemaphore(Batch->Done);
+    free(Batch->Jobs);
+    free(Batch);
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+// NOTE: Size 0 means to the end of the file. Returns what could be read (null terminated, 0 if the
+//       file couldn't be opened); Out_IsComplete is false when that's less than was asked for.
+static u8 *
+ReadFileRange(const char *Path, u64 Offset, size_t Size, size_t *Out_BytesRead, bool *Out_IsComplete)
+{
+    *Out_BytesRead = 0;
+    *Out_IsComplete = false;
+
+    packed_file PackedFile;
+    if (FindPackedFile(Path, &PackedFile))
+    {
+        u64 PackedAvailable = (Offset < PackedFile.Size) ? PackedFile.Size - Offset : 0;
+        size_t PackedWanted = (Size == 0) ? (size_t) PackedAvailable : Size;
+        size_t PackedToRead = (PackedWanted < PackedAvailable) ? PackedWanted : (size_t) PackedAvailable;
+
+        u8 *PackedData = (u8 *) malloc(PackedToRead + 1);
+        Assert(PackedData);
+        if (!ReadPackedFile(&PackedFile, Offset, PackedToRead, PackedData))
+        {
+            free(PackedData);
+            return 0;
+        }
+
+        PackedData[PackedToRead] = '\0';
+        *Out_BytesRead = PackedToRead;
+        *Out_IsComplete = (PackedToRead == PackedWanted);
+        return PackedData;
+    }
+
+#ifdef _WIN32
+    HANDLE File = CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 0);
+    if (File == INVALID_HANDLE_VALUE)
+    {
+        return 0;
+    }
+
+    LARGE_INTEGER FileSizeOnDisk;
+    u64 FileSize = GetFileSizeEx(File, &FileSizeOnDisk) ? (u64) FileSizeOnDisk.QuadPart : 0;
+#else
+    int File = open(Path, O_RDONLY);
+    if (File < 0)
+    {
+        return 0;
+    }
+
+    struct stat FileStat;
+    u64 FileSize = (fstat(File, &FileStat) == 0) ? (u64) FileStat.st_size : 0;
+#endif
+
+    u64 Available = (Offset < FileSize) ? FileSize - Offset : 0;
+    size_t Wanted = (Size == 0) ? (size_t) Available : Size;
+    size_t ToRead = (Wanted < Available) ? Wanted : (size_t) Available;
+
+    u8 *Data = (u8 *) malloc(ToRead + 1);
+    Assert(Data);
+
+    size_t BytesRead = 0;
+    while (BytesRead < ToRead)
+    {
+        size_t ChunkSize = ToRead - BytesRead;
+        ChunkSize = (ChunkSize > FILE_READ_CHUNK_SIZE) ? FILE_READ_CHUNK_SIZE : ChunkSize;
+        u64 Position = Offset + BytesRead;
+
+#ifdef _WIN32
+        OVERLAPPED Overlapped = { };
+        Overlapped.Offset = (DWORD) Position;
+        Overlapped.OffsetHigh = (DWORD) (Position >> 32);
+        DWORD ChunkRead = 0;
+        if (!::ReadFile(File, Data + BytesRead, (DWORD) ChunkSize, &ChunkRead, &Overlapped) || ChunkRead == 0)
+        {
+            break;
+        }
+#else
+        ssize_t ChunkRead = pread(File, Data + BytesRead, ChunkSize, (off_t) Position);
+        if (ChunkRead <= 0)
+        {
+            break;
+        }
+#endif
+        BytesRead += (size_t) ChunkRead;
+    }
+
+#ifdef _WIN32
+    CloseHandle(File);
+#else
+    close(File);
+#endif
+
+    Data[BytesRead] = '\0';
+    *Out_BytesRead = BytesRead;
+    *Out_IsComplete = (BytesRead == Wanted);
+    return Data;
+}
+
+static void
+FileReadJob(void *Data)
+{
+    file_read_job *Job = (file_read_job *) Data;
+    file_read *Read = Job->Read;
+    file_read_batch *Batch = Job->Batch;
+
+    Read->Data = ReadFileRange(Read->Path, Read->Offset, Read->Size, &Read->BytesRead, &Read->Succeeded);
+    if (!Read->Succeeded)
+    {
+        fprintf(stderr, "Couldn't read file: %s\n", Read->Path);
+    }
+    if (Read->Callback)
+    {
+        Read->Callback(Read);
+    }
+
+    // NOTE: Job and Batch can be freed by the waiting thread as soon as the semaphore is posted
+    if (SDL_AtomicAdd(&Batch->RemainingCount, -1) == 1)
+    {
+        SDL_SemPost(Batch->Done);
+    }
+}
+
+static u64
+HashFilePath(const char *Path)
+{
+    // NOTE: One file, one lock, however the path is spelled
+    char NormalizedPath[MAX_PATH_LENGTH];
+    if (!NormalizePath(Path, NormalizedPath, MAX_PATH_LENGTH))
+    {
+        return HashBytes64(Path, strlen(Path), 0);
+    }
+
+    return HashBytes64(NormalizedPath, strlen(NormalizedPath), 0);
+}
@@ -0,0 +1,108 @@
+#ifndef FILE_IO_H
+#define FILE_IO_H
+
+#include "Common.h"
+
+#include <cstdio>
+
+// Whole files
+// -----------
+
+// NOTE: Heap copy with a null terminator past Size, for text that has to be handed on as a
+//       C string (shader sources). Returns 0 if the file can't be read. Prefer MapFileReadOnly
+//       for anything big.
+char *
+ReadFile(const char *Path, size_t *Out_Size);
+
+// Mapped views
+// ------------
+
+struct mapped_file
+{
+    u8 *Data;
+    size_t Size;
+
+    void *FileHandle;
+    void *MappingHandle;
+
+    // NOTE: Files from a mounted pack (see Pack.h) point straight into the pack's mapping when
+    //       they're stored, or at a decompressed heap copy (IsHeapCopy) when they're compressed
+    bool IsPacked;
+    bool IsHeapCopy;
+};
+
+// NOTE: Read-only, zero-copy view of the whole file; pages are read in on first touch. Fails for
+//       empty files.
+bool
+MapFileReadOnly(const char *Path, mapped_file *Out_MappedFile);
+void
+UnmapFile(mapped_file *MappedFile);
+
+// File info
+// ---------
+
+bool
+FileExists(const char *Path);
+u64
+GetFileModificationTime(const char *Path);
+// NOTE: False if the file doesn't exist. Packed files report the size and modification time the
+//       file had when it was packed.
+bool
+GetFileInfo(const char *Path, u64 *Out_Size, u64 *Out_ModificationTime);
+
+// Replacing writes
+// ----------------
+
+// NOTE: The data goes to Path.tmp, which CloseReplacingFile moves over Path once everything is
+//       written (Success), so nobody maps a half written Path, and a crash leaves the old file. On
+//       failure the temporary file is deleted and Path left alone.
+FILE *
+OpenReplacingFile(const char *Path);
+bool
+CloseReplacingFile(FILE *File, const char *Path, bool Success);
+
+// NOTE: Serializes writers of one path across threads (the same asset cooked on load by two
+//       workers): the second blocks until the first unlocks, and should then check whether the
+//       file is already there before writing it again. Not reentrant.
+void
+LockFilePath(const char *Path);
+void
+UnlockFilePath(const char *Path);
+
+// Asynchronous reads
+// ------------------
+
+struct file_read;
+struct file_read_batch;
+struct job_queue;
+
+typedef void file_read_callback(file_read *Read);
+
+struct file_read
+{
+    // NOTE: Filled in by the caller. Size 0 reads from Offset to the end of the file.
+    char Path[MAX_PATH_LENGTH];
+    u64 Offset;
+    size_t Size;
+    file_read_callback *Callback;
+    void *UserData;
+
+    // NOTE: Filled in before Callback runs. Data is malloc'd with a null terminator past
+    //       BytesRead (0 on failure) and belongs to whoever handles the read; free it.
+    bool Succeeded;
+    u8 *Data;
+    size_t BytesRead;
+};
+
+// NOTE: Every read runs as a job on Queue's workers and its callback runs on the same worker right
+//       after the read, so one file is parsed while the next ones are still being read. Reads
+//       has to stay valid until the batch is done.
+file_read_batch *
+ReadFilesAsync(job_queue *Queue, file_read *Reads, i32 ReadCount);
+bool
+IsFileReadBatchDone(file_read_batch *Batch);
+// NOTE: Blocks until every read and callback of the batch has finished, then frees the batch
+void
+WaitForFileReadBatch(file_read_batch *Batch);
+
+#endif
@@ -0,0 +1,378 @@
+#include "GLState.h"
+
+#include <glad/glad.h>
+
+// NOTE: Shadow values that don't match anything GL could hold, so the first set always goes through
+#define GLSTATE_UNKNOWN 0xFFFFFFFF
+#define GLSTATE_UNKNOWN_FLAG -1
+
+enum gl_state_buffer_slot
+{
+    GLSTATE_ARRAY_BUFFER,
+    GLSTATE_PIXEL_UNPACK_BUFFER,
+    GLSTATE_UNIFORM_BUFFER,
+    GLSTATE_COPY_READ_BUFFER,
+    GLSTATE_COPY_WRITE_BUFFER,
+
+    GLSTATE_BUFFER_SLOT_COUNT
+};
+
+enum gl_state_capability
+{
+    GLSTATE_DEPTH_TEST,
+    GLSTATE_CULL_FACE,
+    GLSTATE_BLEND,
+
+    GLSTATE_CAPABILITY_COUNT
+};
+
+struct gl_state
+{
+    u32 Program;
+    u32 VAO;
+    u32 Buffers[GLSTATE_BUFFER_SLOT_COUNT];
+    u32 ActiveTextureUnit;
+    u32 Textures[MAX_TRACKED_TEXTURE_UNITS];
+
+    i8 Capabilities[GLSTATE_CAPABILITY_COUNT];
+    i8 DepthWrite;
+    u32 BlendSourceFactor;
+    u32 BlendDestinationFactor;
+
+    gl_state_stats Stats;
+};
+
+static gl_state GLState;
+
+static i32
+GLSTATE_GetBufferSlot(u32 Target);
+static void
+GLSTATE_SetCapability(gl_state_capability Capability, GLenum Cap, bool IsEnabled);
+static void
+GLSTATE_SetActiveTextureUnit(i32 Unit);
+
+// -----------------------------
+// EXTERNAL FUNCTION DEFINITIONS
+// -----------------------------
+
+void
+InitializeGLState()
+{
+    GLState.Program = GLSTATE_UNKNOWN;
+    GLState.VAO = GLSTATE_UNKNOWN;
+    for (i32 SlotIndex = 0; SlotIndex < GLSTATE_BUFFER_SLOT_COUNT; ++SlotIndex)
+    {
+        GLState.Buffers[SlotIndex] = GLSTATE_UNKNOWN;
+    }
+    GLState.ActiveTextureUnit = GLSTATE_UNKNOWN;
+    for (i32 Unit = 0; Unit < MAX_TRACKED_TEXTURE_UNITS; ++Unit)
+    {
+        GLState.Textures[Unit] = GLSTATE_UNKNOWN;
+    }
+
+    for (i32 CapabilityIndex = 0; CapabilityIndex < GLSTATE_CAPABILITY_COUNT; ++CapabilityIndex)
+    {
+        GLState.Capabilities[CapabilityIndex] = GLSTATE_UNKNOWN_FLAG;
+    }
+    GLState.DepthWrite = GLSTATE_UNKNOWN_FLAG;
+    GLState.BlendSourceFactor = GLSTATE_UNKNOWN;
+    GLState.BlendDestinationFactor = GLSTATE_UNKNOWN;
+
+    GLState.Stats = { };
+}
+
+// Binding
+// -------
+
+void
+BindProgram(u32 Program)
+{
+    if (GLState.Program == Program)
+    {
+        ++GLState.Stats.RedundantCallsSkipped;
+        return;
+    }
+
+    glUseProgram(Program);
+    GLState.Program = Program;
+    ++GLState.Stats.ProgramBinds;
+}
+
+void
+BindVertexArray(u32 VAO)
+{
+    if (GLState.VAO == VAO)
+    {
+        ++GLState.Stats.RedundantCallsSkipped;
+        return;
+    }
+
+    glBindVertexArray(VAO);
+    GLState.VAO = VAO;
+    ++GLState.Stats.VertexArrayBinds;
+}
+
+void
+BindBuffer(u32 Target, u32 Buffer)
+{
+    i32 Slot = GLSTATE_GetBufferSlot(Target);
+    if (Slot != -1)
+    {
+        if (GLState.Buffers[Slot] == Buffer)
+        {
+            ++GLState.Stats.RedundantCallsSkipped;
+            return;
+        }
+        GLState.Buffers[Slot] = Buffer;
+    }
+
+    glBindBuffer(Target, Buffer);
+    ++GLState.Stats.BufferBinds;
+}
+
+void
+BindBufferRange(u32 Target, u32 Index, u32 Buffer, size_t Offset, size_t Size)
+{
+    glBindBufferRange(Target, Index, Buffer, Offset, Size);
+    i32 Slot = GLSTATE_GetBufferSlot(Target);
+    if (Slot != -1)
+    {
+        GLState.Buffers[Slot] = Buffer;
+    }
+    ++GLState.Stats.BufferBinds;
+}
+
+void
+BindTexture2D(i32 Unit, u32 Texture)
+{
+    Assert(Unit >= 0 && Unit < MAX_TRACKED_TEXTURE_UNITS);
+
+    if (GLState.Textures[Unit] == Texture)
+    {
+        ++GLState.Stats.RedundantCallsSkipped;
+        return;
+    }
+
+    GLSTATE_SetActiveTextureUnit(Unit);
+    glBindTexture(GL_TEXTURE_2D, Texture);
+    GLState.Textures[Unit] = Texture;
+    ++GLState.Stats.TextureBinds;
+}
+
+void
+DeleteTexture(u32 *Texture)
+{
+    for (i32 Unit = 0; Unit < MAX_TRACKED_TEXTURE_UNITS; ++Unit)
+    {
+        if (GLState.Textures[Unit] == *Texture)
+        {
+            GLState.Textures[Unit] = 0;
+        }
+    }
+
+    glDeleteTextures(1, Texture);
+    *Texture = 0;
+}
+
+void
+DeleteBuffer(u32 *Buffer)
+{
+    for (i32 SlotIndex = 0; SlotIndex < GLSTATE_BUFFER_SLOT_COUNT; ++SlotIndex)
+    {
+        if (GLState.Buffers[SlotIndex] == *Buffer)
+        {
+            GLState.Buffers[SlotIndex] = 0;
+        }
+    }
+
+    glDeleteBuffers(1, Buffer);
+    *Buffer = 0;
+}
+
+void
+DeleteVertexArray(u32 *VAO)
+{
+    if (GLState.VAO == *VAO)
+    {
+        GLState.VAO = 0;
+    }
+
+    glDeleteVertexArrays(1, VAO);
+    *VAO = 0;
+}
+
+// Fixed function state
+// --------------------
+
+void
+SetDepthTest(bool IsEnabled)
+{
+    GLSTATE_SetCapability(GLSTATE_DEPTH_TEST, GL_DEPTH_TEST, IsEnabled);
+}
+
+void
+SetDepthWrite(bool IsEnabled)
+{
+    if (GLState.DepthWrite == (i8) IsEnabled)
+    {
+        ++GLState.Stats.RedundantCallsSkipped;
+        return;
+    }
+
+    glDepthMask(IsEnabled ? GL_TRUE : GL_FALSE);
+    GLState.DepthWrite = (i8) IsEnabled;
+    ++GLState.Stats.StateChanges;
+}
+
+void
+SetFaceCulling(bool IsEnabled)
+{
+    GLSTATE_SetCapability(GLSTATE_CULL_FACE, GL_CULL_FACE, IsEnabled);
+}
+
+void
+SetBlending(bool IsEnabled)
+{
+    GLSTATE_SetCapability(GLSTATE_BLEND, GL_BLEND, IsEnabled);
+}
+
+void
+SetBlendFunc(u32 SourceFactor, u32 DestinationFactor)
+{
+    if (GLState.BlendSourceFactor == SourceFactor && GLState.BlendDestinationFactor == DestinationFactor)
+    {
+        ++GLState.Stats.RedundantCallsSkipped;
+        return;
+    }
+
+    glBlendFunc(SourceFactor, DestinationFactor);
+    GLState.BlendSourceFactor = SourceFactor;
+    GLState.BlendDestinationFactor = DestinationFactor;
+    ++GLState.Stats.StateChanges;
+}
+
+// Draws and uploads
+// -----------------
+
+void
+DrawElements(u32 Mode, i32 IndexCount, u32 IndexType, size_t IndexOffset)
+{
+    glDrawElements(Mode, IndexCount, IndexType, (void *) IndexOffset);
+    ++GLState.Stats.DrawCalls;
+    ++GLState.Stats.InstancesDrawn;
+    if (Mode == GL_TRIANGLES)
+    {
+        GLState.Stats.TrianglesDrawn += IndexCount / 3;
+    }
+}
+
+void
+DrawElementsInstanced(u32 Mode, i32 IndexCount, u32 IndexType, size_t IndexOffset, i32 InstanceCount)
+{
+    glDrawElementsInstanced(Mode, IndexCount, IndexType, (void *) IndexOffset, InstanceCount);
+    ++GLState.Stats.DrawCalls;
+    GLState.Stats.InstancesDrawn += InstanceCount;
+    if (Mode == GL_TRIANGLES)
+    {
+        GLState.Stats.TrianglesDrawn += (u64) (IndexCount / 3) * InstanceCount;
+    }
+}
+
+void
+DrawArrays(u32 Mode, i32 First, i32 VertexCount)
+{
+    glDrawArrays(Mode, First, VertexCount);
+    ++GLState.Stats.DrawCalls;
+    ++GLState.Stats.InstancesDrawn;
+    if (Mode == GL_TRIANGLES)
+    {
+        GLState.Stats.TrianglesDrawn += VertexCount / 3;
+    }
+}
+
+void
+BufferData(u32 Target, size_t Size, const void *Data, u32 Usage)
+{
+    glBufferData(Target, Size, Data, Usage);
+    if (Data)
+    {
+        GLState.Stats.UploadedBytes += Size;
+    }
+}
+
+void
+BufferSubData(u32 Target, size_t Offset, size_t Size, const void *Data)
+{
+    glBufferSubData(Target, Offset, Size, Data);
+    GLState.Stats.UploadedBytes += Size;
+}
+
+void
+CountUploadedBytes(size_t Size)
+{
+    GLState.Stats.UploadedBytes += Size;
+}
+
+// Frame stats
+// -----------
+
+void
+BeginGLStateFrame()
+{
+    GLState.Stats = { };
+}
+
+gl_state_stats
+EndGLStateFrame()
+{
+    return GLState.Stats;
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+static i32
+GLSTATE_GetBufferSlot(u32 Target)
+{
+    switch (Target)
+    {
+        case GL_ARRAY_BUFFER: return GLSTATE_ARRAY_BUFFER;
+        case GL_PIXEL_UNPACK_BUFFER: return GLSTATE_PIXEL_UNPACK_BUFFER;
+        case GL_UNIFORM_BUFFER: return GLSTATE_UNIFORM_BUFFER;
+        case GL_COPY_READ_BUFFER: return GLSTATE_COPY_READ_BUFFER;
+        case GL_COPY_WRITE_BUFFER: return GLSTATE_COPY_WRITE_BUFFER;
+        default: return -1;
+    }
+}
+
+static void
+GLSTATE_SetCapability(gl_state_capability Capability, GLenum Cap, bool IsEnabled)
+{
+    if (GLState.Capabilities[Capability] == (i8) IsEnabled)
+    {
+        ++GLState.Stats.RedundantCallsSkipped;
+        return;
+    }
+
+    if (IsEnabled)
+    {
+        glEnable(Cap);
+    }
+    else
+    {
+        glDisable(Cap);
+    }
+    GLState.Capabilities[Capability] = (i8) IsEnabled;
+    ++GLState.Stats.StateChanges;
+}
+
+static void
+GLSTATE_SetActiveTextureUnit(i32 Unit)
+{
+    if (GLState.ActiveTextureUnit != (u32) Unit)
+    {
+        glActiveTexture(GL_TEXTURE0 + Unit);
+        GLState.ActiveTextureUnit = (u32) Unit;
+    }
+}
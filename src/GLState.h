@@ -0,0 +1,105 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <cstddef>
+
+#include "Common.h"
+
+// NOTE: Shadow of the GL state the renderer touches. Binds and state changes go through here and
+//       are dropped when GL already has that value, so callers can bind what they need without
+//       unbinding it afterwards. Anything that binds one of these behind its back (or deletes a
+//       bound object without the Delete* below) makes the shadow wrong, so there mustn't be any.
+//       GL thread only.
+#define MAX_TRACKED_TEXTURE_UNITS 16
+
+struct gl_state_stats
+{
+    i32 ProgramBinds;
+    i32 VertexArrayBinds;
+    i32 BufferBinds;
+    i32 TextureBinds;
+    // NOTE: Enable/disable, blend func, depth mask
+    i32 StateChanges;
+    // NOTE: Binds and state changes that were dropped because GL already had the value
+    i32 RedundantCallsSkipped;
+
+    i32 DrawCalls;
+    // NOTE: Every instance of an instanced draw counts, a plain draw counts as one
+    i32 InstancesDrawn;
+    u64 TrianglesDrawn;
+    // NOTE: Buffer data, texture images and uniforms
+    u64 UploadedBytes;
+};
+
+// NOTE: Right after the context is made current; everything is treated as unknown until first set
+void
+InitializeGLState();
+
+// Binding
+// -------
+
+void
+BindProgram(u32 Program);
+void
+BindVertexArray(u32 VAO);
+// NOTE: GL_ELEMENT_ARRAY_BUFFER belongs to the bound VAO, so binds to it always go through
+void
+BindBuffer(u32 Target, u32 Buffer);
+// NOTE: Indexed binding (uniform buffer binding points). Also binds Target, the same as GL does;
+//       the indexed bindings themselves aren't shadowed.
+void
+BindBufferRange(u32 Target, u32 Index, u32 Buffer, size_t Offset, size_t Size);
+// NOTE: GL_TEXTURE_2D on texture unit Unit
+void
+BindTexture2D(i32 Unit, u32 Texture);
+
+// NOTE: GL unbinds a deleted object from wherever it's bound; these do the same to the shadow
+void
+DeleteTexture(u32 *Texture);
+void
+DeleteBuffer(u32 *Buffer);
+void
+DeleteVertexArray(u32 *VAO);
+
+// Fixed function state
+// --------------------
+
+void
+SetDepthTest(bool IsEnabled);
+void
+SetDepthWrite(bool IsEnabled);
+void
+SetFaceCulling(bool IsEnabled);
+void
+SetBlending(bool IsEnabled);
+void
+SetBlendFunc(u32 SourceFactor, u32 DestinationFactor);
+
+// Draws and uploads
+// -----------------
+
+void
+DrawElements(u32 Mode, i32 IndexCount, u32 IndexType, size_t IndexOffset);
+void
+DrawElementsInstanced(u32 Mode, i32 IndexCount, u32 IndexType, size_t IndexOffset, i32 InstanceCount);
+void
+DrawArrays(u32 Mode, i32 First, i32 VertexCount);
+// NOTE: Into the buffer bound to Target
+void
+BufferData(u32 Target, size_t Size, const void *Data, u32 Usage);
+void
+BufferSubData(u32 Target, size_t Offset, size_t Size, const void *Data);
+// NOTE: For uploads made straight through GL (texture images, uniforms)
+void
+CountUploadedBytes(size_t Size);
+
+// Frame stats
+// -----------
+
+// NOTE: Counters cover everything between BeginGLStateFrame and EndGLStateFrame
+void
+BeginGLStateFrame();
+gl_state_stats
+EndGLStateFrame();
+
+#endif
@@ -0,0 +1,264 @@
+#include "Hash.h"
+
+#include <SDL2/SDL.h>
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+#include "FileIO.h"
+
+// NOTE: XXH64 (https://github.com/Cyan4973/xxHash). Produces the same values as the reference
+//       implementation, so hashes can be checked against the xxhsum tool.
+
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3 0x165667B19E3779F9ULL
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ULL
+
+struct file_hash_entry
+{
+    u64 PathHash;
+    u64 Size;
+    u64 ModificationTime;
+    u64 ContentHash;
+};
+
+// NOTE: Open addressing with linear probing, keyed by the hash of the path; PathHash 0 is an empty
+//       slot. Entries are never removed, there's one per file ever asked about.
+struct file_hash_cache
+{
+    SDL_SpinLock Lock;
+    u32 SlotCount;
+    u32 EntryCount;
+    file_hash_entry *Slots;
+};
+
+static file_hash_cache FileHashCache;
+
+static inline u64
+RotateLeft64(u64 Value, i32 Amount);
+static inline u64
+Read64(const u8 *Bytes);
+static inline u32
+Read32(const u8 *Bytes);
+static inline u64
+XXH64_Round(u64 Accumulator, u64 Input);
+static inline u64
+XXH64_MergeRound(u64 Accumulator, u64 Value);
+static file_hash_entry *
+FindFileHashSlot(file_hash_entry *Slots, u32 SlotCount, u64 PathHash);
+
+u64
+HashBytes64(const void *Data, size_t Size, u64 Seed)
+{
+    const u8 *Bytes = (const u8 *) Data;
+    const u8 *End = Bytes + Size;
+    u64 Result;
+
+    if (Size >= 32)
+    {
+        const u8 *Limit = End - 32;
+        u64 V1 = Seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+        u64 V2 = Seed + XXH_PRIME64_2;
+        u64 V3 = Seed;
+        u64 V4 = Seed - XXH_PRIME64_1;
+
+        do
+        {
+            V1 = XXH64_Round(V1, Read64(Bytes)); Bytes += 8;
+            V2 = XXH64_Round(V2, Read64(Bytes)); Bytes += 8;
+            V3 = XXH64_Round(V3, Read64(Bytes)); Bytes += 8;
+            V4 = XXH64_Round(V4, Read64(Bytes)); Bytes += 8;
+        } while (Bytes <= Limit);
+
+        Result = RotateLeft64(V1, 1) + RotateLeft64(V2, 7) + RotateLeft64(V3, 12) + RotateLeft64(V4, 18);
+        Result = XXH64_MergeRound(Result, V1);
+        Result = XXH64_MergeRound(Result, V2);
+        Result = XXH64_MergeRound(Result, V3);
+        Result = XXH64_MergeRound(Result, V4);
+    }
+    else
+    {
+        Result = Seed + XXH_PRIME64_5;
+    }
+
+    Result += (u64) Size;
+
+    while (Bytes + 8 <= End)
+    {
+        Result ^= XXH64_Round(0, Read64(Bytes));
+        Result = RotateLeft64(Result, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+        Bytes += 8;
+    }
+
+    if (Bytes + 4 <= End)
+    {
+        Result ^= (u64) Read32(Bytes) * XXH_PRIME64_1;
+        Result = RotateLeft64(Result, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        Bytes += 4;
+    }
+
+    while (Bytes < End)
+    {
+        Result ^= (*Bytes) * XXH_PRIME64_5;
+        Result = RotateLeft64(Result, 11) * XXH_PRIME64_1;
+        ++Bytes;
+    }
+
+    // Avalanche
+    Result ^= Result >> 33;
+    Result *= XXH_PRIME64_2;
+    Result ^= Result >> 29;
+    Result *= XXH_PRIME64_3;
+    Result ^= Result >> 32;
+
+    return Result;
+}
+
+u64
+HashFile64(const char *Path)
+{
+    // NOTE: Returns 0 for files that can't be read, so a missing file never matches a stored hash.
+    //       Hashes straight out of a mapped view instead of copying the file into the heap first.
+    mapped_file File;
+    if (!MapFileReadOnly(Path, &File))
+    {
+        // NOTE: Empty files can't be mapped but still hash to something
+        u64 Size;
+        u64 ModificationTime;
+        return (GetFileInfo(Path, &Size, &ModificationTime) && Size == 0) ? HashBytes64(0, 0, 0) : 0;
+    }
+
+    u64 Result = HashBytes64(File.Data, File.Size, 0);
+    UnmapFile(&File);
+
+    return Result;
+}
+
+u64
+GetFileContentHash(const char *Path)
+{
+    u64 Size;
+    u64 ModificationTime;
+    if (!GetFileInfo(Path, &Size, &ModificationTime))
+    {
+        return 0;
+    }
+
+    u64 PathHash = HashBytes64(Path, strlen(Path), 0);
+    PathHash = (PathHash != 0) ? PathHash : 1;
+
+    SDL_AtomicLock(&FileHashCache.Lock);
+    file_hash_entry *Entry = FileHashCache.Slots ?
+                             FindFileHashSlot(FileHashCache.Slots, FileHashCache.SlotCount, PathHash) : 0;
+    bool IsCached = (Entry && Entry->PathHash == PathHash &&
+                     Entry->Size == Size && Entry->ModificationTime == ModificationTime);
+    u64 Result = IsCached ? Entry->ContentHash : 0;
+    SDL_AtomicUnlock(&FileHashCache.Lock);
+
+    if (IsCached)
+    {
+        return Result;
+    }
+
+    // NOTE: Hashed without holding the lock; two threads asking about the same new file both read
+    //       it and store the same result
+    Result = HashFile64(Path);
+    if (Result == 0)
+    {
+        return 0;
+    }
+
+    SDL_AtomicLock(&FileHashCache.Lock);
+    if ((FileHashCache.EntryCount + 1) * 2 > FileHashCache.SlotCount)
+    {
+        u32 NewSlotCount = (FileHashCache.SlotCount > 0) ? FileHashCache.SlotCount * 2 : 256;
+        file_hash_entry *NewSlots = (file_hash_entry *) calloc(NewSlotCount, sizeof(file_hash_entry));
+        Assert(NewSlots);
+        for (u32 Slot = 0; Slot < FileHashCache.SlotCount; ++Slot)
+        {
+            if (FileHashCache.Slots[Slot].PathHash != 0)
+            {
+                *FindFileHashSlot(NewSlots, NewSlotCount, FileHashCache.Slots[Slot].PathHash) =
+                    FileHashCache.Slots[Slot];
+            }
+        }
+        free(FileHashCache.Slots);
+        FileHashCache.Slots = NewSlots;
+        FileHashCache.SlotCount = NewSlotCount;
+    }
+
+    Entry = FindFileHashSlot(FileHashCache.Slots, FileHashCache.SlotCount, PathHash);
+    if (Entry->PathHash == 0)
+    {
+        ++FileHashCache.EntryCount;
+    }
+    Entry->PathHash = PathHash;
+    Entry->Size = Size;
+    Entry->ModificationTime = ModificationTime;
+    Entry->ContentHash = Result;
+    SDL_AtomicUnlock(&FileHashCache.Lock);
+
+    return Result;
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+// NOTE: The slot holding PathHash, or the empty slot where it would go
+static file_hash_entry *
+FindFileHashSlot(file_hash_entry *Slots, u32 SlotCount, u64 PathHash)
+{
+    u32 SlotMask = SlotCount - 1;
+    u32 Slot = (u32) PathHash & SlotMask;
+    while (Slots[Slot].PathHash != 0 && Slots[Slot].PathHash != PathHash)
+    {
+        Slot = (Slot + 1) & SlotMask;
+    }
+
+    return &Slots[Slot];
+}
+
+static inline u64
+RotateLeft64(u64 Value, i32 Amount)
+{
+    return (Value << Amount) | (Value >> (64 - Amount));
+}
+
+static inline u64
+Read64(const u8 *Bytes)
+{
+    // NOTE: memcpy so unaligned reads are fine; the targets we care about are little-endian
+    u64 Result;
+    memcpy(&Result, Bytes, sizeof(Result));
+    return Result;
+}
+
+static inline u32
+Read32(const u8 *Bytes)
+{
+    u32 Result;
+    memcpy(&Result, Bytes, sizeof(Result));
+    return Result;
+}
+
+static inline u64
+XXH64_Round(u64 Accumulator, u64 Input)
+{
+    Accumulator += Input * XXH_PRIME64_2;
+    Accumulator = RotateLeft64(Accumulator, 31);
+    Accumulator *= XXH_PRIME64_1;
+    return Accumulator;
+}
+
+static inline u64
+XXH64_MergeRound(u64 Accumulator, u64 Value)
+{
+    Value = XXH64_Round(0, Value);
+    Accumulator ^= Value;
+    Accumulator = Accumulator * XXH_PRIME64_1 + XXH_PRIME64_4;
+    return Accumulator;
+}
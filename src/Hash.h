@@ -0,0 +1,15 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include "Common.h"
+
+u64
+HashBytes64(const void *Data, size_t Size, u64 Seed);
+u64
+HashFile64(const char *Path);
+// NOTE: HashFile64, remembered per path with the file's size and modification time and only
+//       computed again when one of them changes. Safe to call from any thread.
+u64
+GetFileContentHash(const char *Path);
+
+#endif
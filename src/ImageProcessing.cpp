@@ -0,0 +1,616 @@
+#include "ImageProcessing.h"
+
+#include <emmintrin.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+// NOTE: [0, 1] floats are turned back into bytes through tables at 1/16383 steps, which is fine
+//       enough for the darkest sRGB values to still land on their own bytes
+#define IMAGE_ENCODE_TABLE_SIZE 16384
+#define IMAGE_KAISER_TAP_COUNT 8
+#define IMAGE_KAISER_ALPHA 4.0
+// NOTE: Rows are decoded to and filtered as 4 floats per pixel
+#define IMAGE_FLOATS_PER_PIXEL 4
+// NOTE: RenormalizeNormalMap works through the image this many pixels at a time
+#define IMAGE_CHUNK_PIXEL_COUNT 1024
+
+struct image_tables
+{
+    // NOTE: Byte to float for each way a channel can be stored
+    f32 SRGBToLinear[256];
+    f32 UnitToFloat[256];
+    f32 SignedToFloat[256];
+
+    u8 LinearToSRGB[IMAGE_ENCODE_TABLE_SIZE];
+    u8 FloatToUnit[IMAGE_ENCODE_TABLE_SIZE];
+
+    f32 BoxWeights[2];
+    f32 KaiserWeights[IMAGE_KAISER_TAP_COUNT];
+};
+
+// NOTE: What a row is decoded with and encoded back with
+struct image_row_format
+{
+    const f32 *DecodeRGB;
+    const f32 *DecodeAlpha;
+    const u8 *EncodeRGB;
+    const u8 *EncodeAlpha;
+    bool IsAlphaWeighted;
+    bool IsNormalMap;
+};
+
+static bool ImageSIMDEnabled = true;
+
+// ------------------------------
+// INTERNAL FUNCTION DECLARATIONS
+// ------------------------------
+
+static image_tables
+IMAGE_BuildTables();
+static const image_tables *
+IMAGE_GetTables();
+static image_row_format
+IMAGE_GetRowFormat(const image_tables *Tables, u32 Flags);
+static f64
+IMAGE_BesselI0(f64 X);
+
+static void
+IMAGE_DecodeRow(const u8 *Pixels, i32 PixelCount, image_row_format *Format, f32 *Out_Row);
+static void
+IMAGE_FilterRow(const f32 *Row, i32 Width, i32 OutWidth, const f32 *Weights, i32 TapCount, f32 *Out_Row);
+static void
+IMAGE_FilterColumns(const f32 **Rows, const f32 *Weights, i32 TapCount, i32 Width, f32 *Out_Row);
+static void
+IMAGE_EncodeRow(const f32 *Row, i32 PixelCount, image_row_format *Format, u8 *Out_Pixels);
+
+static void
+IMAGE_DecodeRowSSE2(const u8 *Pixels, i32 PixelCount, image_row_format *Format, f32 *Out_Row);
+static void
+IMAGE_FilterRowSSE2(const f32 *Row, i32 Width, i32 OutWidth, const f32 *Weights, i32 TapCount, f32 *Out_Row);
+static void
+IMAGE_FilterColumnsSSE2(const f32 **Rows, const f32 *Weights, i32 TapCount, i32 Width, f32 *Out_Row);
+static void
+IMAGE_EncodeRowSSE2(const f32 *Row, i32 PixelCount, image_row_format *Format, u8 *Out_Pixels);
+
+// ------------------------
+
+void
+DownsampleImage(const u8 *Pixels, i32 Width, i32 Height, image_filter Filter, u32 Flags, u8 *Out_Pixels)
+{
+    const image_tables *Tables = IMAGE_GetTables();
+    image_row_format Format = IMAGE_GetRowFormat(Tables, Flags);
+
+    i32 OutWidth = (Width > 1) ? Width / 2 : 1;
+    i32 OutHeight = (Height > 1) ? Height / 2 : 1;
+
+    // NOTE: Output texel X covers source texels 2X and 2X + 1, so its taps are centered between them
+    const f32 *Weights;
+    i32 TapCount;
+    if (Filter == IMAGE_FILTER_KAISER)
+    {
+        Weights = Tables->KaiserWeights;
+        TapCount = IMAGE_KAISER_TAP_COUNT;
+    }
+    else
+    {
+        Weights = Tables->BoxWeights;
+        TapCount = 2;
+    }
+    i32 FirstTap = 1 - TapCount / 2;
+
+    // NOTE: Separable: every source row is decoded and filtered horizontally once, into a ring of
+    //       TapCount rows; a source row Y lives in slot Y % TapCount. The rows an output row needs
+    //       are TapCount consecutive ones (clamped at the edges), so they never share a slot.
+    size_t RowFloatCount = (size_t) Width * IMAGE_FLOATS_PER_PIXEL;
+    size_t OutRowFloatCount = (size_t) OutWidth * IMAGE_FLOATS_PER_PIXEL;
+    f32 *Scratch = (f32 *) malloc((RowFloatCount + OutRowFloatCount * (TapCount + 1)) * sizeof(f32));
+    Assert(Scratch);
+    f32 *DecodedRow = Scratch;
+    f32 *FilteredRows = DecodedRow + RowFloatCount;
+    f32 *OutRow = FilteredRows + OutRowFloatCount * TapCount;
+
+    i32 SlotRows[IMAGE_KAISER_TAP_COUNT];
+    for (i32 SlotIndex = 0; SlotIndex < TapCount; ++SlotIndex)
+    {
+        SlotRows[SlotIndex] = -1;
+    }
+
+    for (i32 Y = 0; Y < OutHeight; ++Y)
+    {
+        const f32 *TapRows[IMAGE_KAISER_TAP_COUNT];
+        for (i32 TapIndex = 0; TapIndex < TapCount; ++TapIndex)
+        {
+            i32 SourceY = Y * 2 + FirstTap + TapIndex;
+            SourceY = (SourceY < 0) ? 0 : (SourceY >= Height) ? Height - 1 : SourceY;
+
+            i32 SlotIndex = SourceY % TapCount;
+            f32 *FilteredRow = FilteredRows + OutRowFloatCount * SlotIndex;
+            if (SlotRows[SlotIndex] != SourceY)
+            {
+                const u8 *SourceRow = Pixels + (size_t) SourceY * Width * 4;
+                if (ImageSIMDEnabled)
+                {
+                    IMAGE_DecodeRowSSE2(SourceRow, Width, &Format, DecodedRow);
+                    IMAGE_FilterRowSSE2(DecodedRow, Width, OutWidth, Weights, TapCount, FilteredRow);
+                }
+                else
+                {
+                    IMAGE_DecodeRow(SourceRow, Width, &Format, DecodedRow);
+                    IMAGE_FilterRow(DecodedRow, Width, OutWidth, Weights, TapCount, FilteredRow);
+                }
+                SlotRows[SlotIndex] = SourceY;
+            }
+            TapRows[TapIndex] = FilteredRow;
+        }
+
+        u8 *OutPixels = Out_Pixels + (size_t) Y * OutWidth * 4;
+        if (ImageSIMDEnabled)
+        {
+            IMAGE_FilterColumnsSSE2(TapRows, Weights, TapCount, OutWidth, OutRow);
+            IMAGE_EncodeRowSSE2(OutRow, OutWidth, &Format, OutPixels);
+        }
+        else
+        {
+            IMAGE_FilterColumns(TapRows, Weights, TapCount, OutWidth, OutRow);
+            IMAGE_EncodeRow(OutRow, OutWidth, &Format, OutPixels);
+        }
+    }
+
+    free(Scratch);
+}
+
+i32
+GetImageMipCount(i32 Width, i32 Height)
+{
+    i32 MipCount = 1;
+    while (Width > 1 || Height > 1)
+    {
+        Width = (Width > 1) ? Width / 2 : 1;
+        Height = (Height > 1) ? Height / 2 : 1;
+        ++MipCount;
+    }
+
+    return MipCount;
+}
+
+void
+ExpandRGBToRGBA(const u8 *Pixels, size_t PixelCount, u8 *Out_Pixels)
+{
+    size_t PixelIndex = 0;
+    if (ImageSIMDEnabled)
+    {
+        // NOTE: A 16 byte load covers 4 pixels and 4 bytes past them, so it stops 2 pixels early
+        //       rather than read past the end
+        __m128i AlphaMask = _mm_set1_epi32((i32) 0xFF000000);
+        for (; PixelIndex + 6 <= PixelCount; PixelIndex += 4)
+        {
+            __m128i Bytes = _mm_loadu_si128((const __m128i *) (Pixels + PixelIndex * 3));
+            __m128i Pixels01 = _mm_unpacklo_epi32(Bytes, _mm_srli_si128(Bytes, 3));
+            __m128i Pixels23 = _mm_unpacklo_epi32(_mm_srli_si128(Bytes, 6), _mm_srli_si128(Bytes, 9));
+            __m128i Result = _mm_or_si128(_mm_unpacklo_epi64(Pixels01, Pixels23), AlphaMask);
+            _mm_storeu_si128((__m128i *) (Out_Pixels + PixelIndex * 4), Result);
+        }
+    }
+
+    for (; PixelIndex < PixelCount; ++PixelIndex)
+    {
+        Out_Pixels[PixelIndex * 4 + 0] = Pixels[PixelIndex * 3 + 0];
+        Out_Pixels[PixelIndex * 4 + 1] = Pixels[PixelIndex * 3 + 1];
+        Out_Pixels[PixelIndex * 4 + 2] = Pixels[PixelIndex * 3 + 2];
+        Out_Pixels[PixelIndex * 4 + 3] = 255;
+    }
+}
+
+void
+PremultiplyAlpha(u8 *Pixels, size_t PixelCount)
+{
+    // NOTE: (X * A + 128 + ((X * A + 128) >> 8)) >> 8 is X * A / 255 rounded, exactly
+    size_t PixelIndex = 0;
+    if (ImageSIMDEnabled)
+    {
+        __m128i Zero = _mm_setzero_si128();
+        __m128i AlphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+        __m128i AlphaLaneFactor = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+        __m128i Rounding = _mm_set1_epi16(128);
+        for (; PixelIndex + 4 <= PixelCount; PixelIndex += 4)
+        {
+            __m128i Bytes = _mm_loadu_si128((const __m128i *) (Pixels + PixelIndex * 4));
+            __m128i Halves[2] = { _mm_unpacklo_epi8(Bytes, Zero), _mm_unpackhi_epi8(Bytes, Zero) };
+            for (i32 HalfIndex = 0; HalfIndex < 2; ++HalfIndex)
+            {
+                // NOTE: Alpha itself is multiplied by 255, which leaves it as it was
+                __m128i Alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(Halves[HalfIndex], 0xFF), 0xFF);
+                __m128i Factor = _mm_or_si128(_mm_andnot_si128(AlphaLanes, Alpha), AlphaLaneFactor);
+                __m128i Product = _mm_add_epi16(_mm_mullo_epi16(Halves[HalfIndex], Factor), Rounding);
+                Halves[HalfIndex] = _mm_srli_epi16(_mm_add_epi16(Product, _mm_srli_epi16(Product, 8)), 8);
+            }
+            _mm_storeu_si128((__m128i *) (Pixels + PixelIndex * 4), _mm_packus_epi16(Halves[0], Halves[1]));
+        }
+    }
+
+    for (; PixelIndex < PixelCount; ++PixelIndex)
+    {
+        u8 *Pixel = Pixels + PixelIndex * 4;
+        for (i32 Channel = 0; Channel < 3; ++Channel)
+        {
+            u32 Product = (u32) Pixel[Channel] * Pixel[3] + 128;
+            Pixel[Channel] = (u8) ((Product + (Product >> 8)) >> 8);
+        }
+    }
+}
+
+void
+RenormalizeNormalMap(u8 *Pixels, size_t PixelCount)
+{
+    image_row_format Format = IMAGE_GetRowFormat(IMAGE_GetTables(), IMAGE_NORMAL_MAP);
+
+    f32 Row[IMAGE_CHUNK_PIXEL_COUNT * IMAGE_FLOATS_PER_PIXEL];
+    for (size_t PixelIndex = 0; PixelIndex < PixelCount; PixelIndex += IMAGE_CHUNK_PIXEL_COUNT)
+    {
+        i32 ChunkCount = (i32) ((PixelCount - PixelIndex < IMAGE_CHUNK_PIXEL_COUNT) ?
+                                PixelCount - PixelIndex : IMAGE_CHUNK_PIXEL_COUNT);
+        u8 *Chunk = Pixels + PixelIndex * 4;
+        if (ImageSIMDEnabled)
+        {
+            IMAGE_DecodeRowSSE2(Chunk, ChunkCount, &Format, Row);
+            IMAGE_EncodeRowSSE2(Row, ChunkCount, &Format, Chunk);
+        }
+        else
+        {
+            IMAGE_DecodeRow(Chunk, ChunkCount, &Format, Row);
+            IMAGE_EncodeRow(Row, ChunkCount, &Format, Chunk);
+        }
+    }
+}
+
+void
+SetImageSIMDEnabled(bool IsEnabled)
+{
+    ImageSIMDEnabled = IsEnabled;
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+// Tables
+// ------
+
+static image_tables
+IMAGE_BuildTables()
+{
+    image_tables Tables;
+
+    for (i32 Value = 0; Value < 256; ++Value)
+    {
+        f32 Unit = Value / 255.0f;
+        Tables.SRGBToLinear[Value] = (Unit <= 0.04045f) ? Unit / 12.92f : powf((Unit + 0.055f) / 1.055f, 2.4f);
+        Tables.UnitToFloat[Value] = Unit;
+        Tables.SignedToFloat[Value] = Value / 127.5f - 1.0f;
+    }
+
+    for (i32 Index = 0; Index < IMAGE_ENCODE_TABLE_SIZE; ++Index)
+    {
+        f32 Linear = Index / (f32) (IMAGE_ENCODE_TABLE_SIZE - 1);
+        f32 SRGB = (Linear <= 0.0031308f) ? Linear * 12.92f : 1.055f * powf(Linear, 1.0f / 2.4f) - 0.055f;
+        Tables.LinearToSRGB[Index] = (u8) (SRGB * 255.0f + 0.5f);
+        Tables.FloatToUnit[Index] = (u8) (Linear * 255.0f + 0.5f);
+    }
+
+    Tables.BoxWeights[0] = 0.5f;
+    Tables.BoxWeights[1] = 0.5f;
+
+    // NOTE: sinc with its first zero at the output texel spacing (2 source texels), windowed to a
+    //       radius of 4 source texels; taps sit at -3.5 .. 3.5 source texels from the center
+    f64 WeightSum = 0.0;
+    f64 Weights[IMAGE_KAISER_TAP_COUNT];
+    for (i32 TapIndex = 0; TapIndex < IMAGE_KAISER_TAP_COUNT; ++TapIndex)
+    {
+        f64 Distance = TapIndex - (IMAGE_KAISER_TAP_COUNT - 1) * 0.5;
+        f64 SincX = 3.14159265358979 * Distance * 0.5;
+        f64 Sinc = sin(SincX) / SincX;
+        f64 WindowX = Distance / (IMAGE_KAISER_TAP_COUNT * 0.5);
+        f64 Window = IMAGE_BesselI0(IMAGE_KAISER_ALPHA * sqrt(1.0 - WindowX * WindowX)) /
+                     IMAGE_BesselI0(IMAGE_KAISER_ALPHA);
+        Weights[TapIndex] = Sinc * Window;
+        WeightSum += Weights[TapIndex];
+    }
+    for (i32 TapIndex = 0; TapIndex < IMAGE_KAISER_TAP_COUNT; ++TapIndex)
+    {
+        Tables.KaiserWeights[TapIndex] = (f32) (Weights[TapIndex] / WeightSum);
+    }
+
+    return Tables;
+}
+
+// NOTE: Built on first use; the static is initialized once even with several cook workers
+static const image_tables *
+IMAGE_GetTables()
+{
+    static image_tables Tables = IMAGE_BuildTables();
+    return &Tables;
+}
+
+static image_row_format
+IMAGE_GetRowFormat(const image_tables *Tables, u32 Flags)
+{
+    image_row_format Format;
+    Format.IsNormalMap = (Flags & IMAGE_NORMAL_MAP) != 0;
+    Format.IsAlphaWeighted = !Format.IsNormalMap && (Flags & IMAGE_ALPHA_WEIGHTED) != 0;
+    Format.DecodeAlpha = Tables->UnitToFloat;
+    Format.EncodeAlpha = Tables->FloatToUnit;
+    if (Format.IsNormalMap)
+    {
+        Format.DecodeRGB = Tables->SignedToFloat;
+        Format.EncodeRGB = Tables->FloatToUnit;
+    }
+    else if (Flags & IMAGE_SRGB)
+    {
+        Format.DecodeRGB = Tables->SRGBToLinear;
+        Format.EncodeRGB = Tables->LinearToSRGB;
+    }
+    else
+    {
+        Format.DecodeRGB = Tables->UnitToFloat;
+        Format.EncodeRGB = Tables->FloatToUnit;
+    }
+
+    return Format;
+}
+
+// NOTE: Modified Bessel function of the first kind, order 0 (power series)
+static f64
+IMAGE_BesselI0(f64 X)
+{
+    f64 Sum = 1.0;
+    f64 Term = 1.0;
+    f64 HalfXSquared = X * X * 0.25;
+    for (i32 K = 1; K < 32; ++K)
+    {
+        Term *= HalfXSquared / ((f64) K * K);
+        Sum += Term;
+    }
+
+    return Sum;
+}
+
+// Scalar kernels
+// --------------
+
+static void
+IMAGE_DecodeRow(const u8 *Pixels, i32 PixelCount, image_row_format *Format, f32 *Out_Row)
+{
+    for (i32 PixelIndex = 0; PixelIndex < PixelCount; ++PixelIndex)
+    {
+        const u8 *Pixel = Pixels + PixelIndex * 4;
+        f32 *Out = Out_Row + PixelIndex * IMAGE_FLOATS_PER_PIXEL;
+        f32 Alpha = Format->DecodeAlpha[Pixel[3]];
+        f32 Weight = Format->IsAlphaWeighted ? Alpha : 1.0f;
+        Out[0] = Format->DecodeRGB[Pixel[0]] * Weight;
+        Out[1] = Format->DecodeRGB[Pixel[1]] * Weight;
+        Out[2] = Format->DecodeRGB[Pixel[2]] * Weight;
+        Out[3] = Alpha;
+    }
+}
+
+static void
+IMAGE_FilterRow(const f32 *Row, i32 Width, i32 OutWidth, const f32 *Weights, i32 TapCount, f32 *Out_Row)
+{
+    i32 FirstTap = 1 - TapCount / 2;
+    for (i32 X = 0; X < OutWidth; ++X)
+    {
+        f32 Sum[IMAGE_FLOATS_PER_PIXEL] = { };
+        for (i32 TapIndex = 0; TapIndex < TapCount; ++TapIndex)
+        {
+            i32 SourceX = X * 2 + FirstTap + TapIndex;
+            SourceX = (SourceX < 0) ? 0 : (SourceX >= Width) ? Width - 1 : SourceX;
+            const f32 *Source = Row + SourceX * IMAGE_FLOATS_PER_PIXEL;
+            for (i32 Channel = 0; Channel < IMAGE_FLOATS_PER_PIXEL; ++Channel)
+            {
+                Sum[Channel] += Weights[TapIndex] * Source[Channel];
+            }
+        }
+        memcpy(Out_Row + X * IMAGE_FLOATS_PER_PIXEL, Sum, sizeof(Sum));
+    }
+}
+
+static void
+IMAGE_FilterColumns(const f32 **Rows, const f32 *Weights, i32 TapCount, i32 Width, f32 *Out_Row)
+{
+    for (i32 Index = 0; Index < Width * IMAGE_FLOATS_PER_PIXEL; ++Index)
+    {
+        f32 Sum = 0.0f;
+        for (i32 TapIndex = 0; TapIndex < TapCount; ++TapIndex)
+        {
+            Sum += Weights[TapIndex] * Rows[TapIndex][Index];
+        }
+        Out_Row[Index] = Sum;
+    }
+}
+
+static void
+IMAGE_EncodeRow(const f32 *Row, i32 PixelCount, image_row_format *Format, u8 *Out_Pixels)
+{
+    for (i32 PixelIndex = 0; PixelIndex < PixelCount; ++PixelIndex)
+    {
+        f32 Value[IMAGE_FLOATS_PER_PIXEL];
+        memcpy(Value, Row + PixelIndex * IMAGE_FLOATS_PER_PIXEL, sizeof(Value));
+
+        if (Format->IsAlphaWeighted)
+        {
+            f32 InverseAlpha = (Value[3] > 1e-6f) ? 1.0f / Value[3] : 0.0f;
+            Value[0] *= InverseAlpha;
+            Value[1] *= InverseAlpha;
+            Value[2] *= InverseAlpha;
+        }
+
+        if (Format->IsNormalMap)
+        {
+            f32 LengthSquared = Value[0] * Value[0] + Value[1] * Value[1] + Value[2] * Value[2];
+            if (LengthSquared > 1e-12f)
+            {
+                f32 InverseLength = 1.0f / sqrtf(LengthSquared);
+                Value[0] *= InverseLength;
+                Value[1] *= InverseLength;
+                Value[2] *= InverseLength;
+            }
+            else
+            {
+                Value[0] = 0.0f;
+                Value[1] = 0.0f;
+                Value[2] = 1.0f;
+            }
+            Value[0] = Value[0] * 0.5f + 0.5f;
+            Value[1] = Value[1] * 0.5f + 0.5f;
+            Value[2] = Value[2] * 0.5f + 0.5f;
+        }
+
+        u8 *Out = Out_Pixels + PixelIndex * 4;
+        for (i32 Channel = 0; Channel < IMAGE_FLOATS_PER_PIXEL; ++Channel)
+        {
+            f32 Clamped = (Value[Channel] < 0.0f) ? 0.0f : (Value[Channel] > 1.0f) ? 1.0f : Value[Channel];
+            i32 Index = (i32) (Clamped * (IMAGE_ENCODE_TABLE_SIZE - 1) + 0.5f);
+            Out[Channel] = (Channel < 3) ? Format->EncodeRGB[Index] : Format->EncodeAlpha[Index];
+        }
+    }
+}
+
+// SSE2 kernels
+// ------------
+// NOTE: A pixel is one __m128 (RGBA), so every kernel works on all four channels at once
+
+static void
+IMAGE_DecodeRowSSE2(const u8 *Pixels, i32 PixelCount, image_row_format *Format, f32 *Out_Row)
+{
+    __m128 RGBMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    __m128 OneInAlpha = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+    for (i32 PixelIndex = 0; PixelIndex < PixelCount; ++PixelIndex)
+    {
+        const u8 *Pixel = Pixels + PixelIndex * 4;
+        __m128 Value = _mm_set_ps(Format->DecodeAlpha[Pixel[3]], Format->DecodeRGB[Pixel[2]],
+                                  Format->DecodeRGB[Pixel[1]], Format->DecodeRGB[Pixel[0]]);
+        if (Format->IsAlphaWeighted)
+        {
+            __m128 Alpha = _mm_shuffle_ps(Value, Value, _MM_SHUFFLE(3, 3, 3, 3));
+            Value = _mm_mul_ps(Value, _mm_or_ps(_mm_and_ps(Alpha, RGBMask), OneInAlpha));
+        }
+        _mm_storeu_ps(Out_Row + PixelIndex * IMAGE_FLOATS_PER_PIXEL, Value);
+    }
+}
+
+static void
+IMAGE_FilterRowSSE2(const f32 *Row, i32 Width, i32 OutWidth, const f32 *Weights, i32 TapCount, f32 *Out_Row)
+{
+    i32 FirstTap = 1 - TapCount / 2;
+    __m128 TapWeights[IMAGE_KAISER_TAP_COUNT];
+    for (i32 TapIndex = 0; TapIndex < TapCount; ++TapIndex)
+    {
+        TapWeights[TapIndex] = _mm_set1_ps(Weights[TapIndex]);
+    }
+
+    for (i32 X = 0; X < OutWidth; ++X)
+    {
+        i32 SourceX = X * 2 + FirstTap;
+        __m128 Sum = _mm_setzero_ps();
+        if (SourceX >= 0 && SourceX + TapCount <= Width)
+        {
+            const f32 *Source = Row + SourceX * IMAGE_FLOATS_PER_PIXEL;
+            for (i32 TapIndex = 0; TapIndex < TapCount; ++TapIndex)
+            {
+                Sum = _mm_add_ps(Sum, _mm_mul_ps(TapWeights[TapIndex],
+                                                 _mm_loadu_ps(Source + TapIndex * IMAGE_FLOATS_PER_PIXEL)));
+            }
+        }
+        else
+        {
+            for (i32 TapIndex = 0; TapIndex < TapCount; ++TapIndex)
+            {
+                i32 ClampedX = SourceX + TapIndex;
+                ClampedX = (ClampedX < 0) ? 0 : (ClampedX >= Width) ? Width - 1 : ClampedX;
+                Sum = _mm_add_ps(Sum, _mm_mul_ps(TapWeights[TapIndex],
+                                                 _mm_loadu_ps(Row + ClampedX * IMAGE_FLOATS_PER_PIXEL)));
+            }
+        }
+        _mm_storeu_ps(Out_Row + X * IMAGE_FLOATS_PER_PIXEL, Sum);
+    }
+}
+
+static void
+IMAGE_FilterColumnsSSE2(const f32 **Rows, const f32 *Weights, i32 TapCount, i32 Width, f32 *Out_Row)
+{
+    __m128 TapWeights[IMAGE_KAISER_TAP_COUNT];
+    for (i32 TapIndex = 0; TapIndex < TapCount; ++TapIndex)
+    {
+        TapWeights[TapIndex] = _mm_set1_ps(Weights[TapIndex]);
+    }
+
+    for (i32 Index = 0; Index < Width * IMAGE_FLOATS_PER_PIXEL; Index += IMAGE_FLOATS_PER_PIXEL)
+    {
+        __m128 Sum = _mm_setzero_ps();
+        for (i32 TapIndex = 0; TapIndex < TapCount; ++TapIndex)
+        {
+            Sum = _mm_add_ps(Sum, _mm_mul_ps(TapWeights[TapIndex], _mm_loadu_ps(Rows[TapIndex] + Index)));
+        }
+        _mm_storeu_ps(Out_Row + Index, Sum);
+    }
+}
+
+static void
+IMAGE_EncodeRowSSE2(const f32 *Row, i32 PixelCount, image_row_format *Format, u8 *Out_Pixels)
+{
+    __m128 Zero = _mm_setzero_ps();
+    __m128 One = _mm_set1_ps(1.0f);
+    __m128 RGBMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    __m128 OneInAlpha = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+    __m128 UnitZ = _mm_set_ps(0.0f, 1.0f, 0.0f, 0.0f);
+    __m128 NormalScale = _mm_set_ps(1.0f, 0.5f, 0.5f, 0.5f);
+    __m128 NormalBias = _mm_set_ps(0.0f, 0.5f, 0.5f, 0.5f);
+    __m128 TableScale = _mm_set1_ps((f32) (IMAGE_ENCODE_TABLE_SIZE - 1));
+    __m128 Half = _mm_set1_ps(0.5f);
+
+    for (i32 PixelIndex = 0; PixelIndex < PixelCount; ++PixelIndex)
+    {
+        __m128 Value = _mm_loadu_ps(Row + PixelIndex * IMAGE_FLOATS_PER_PIXEL);
+
+        if (Format->IsAlphaWeighted)
+        {
+            __m128 Alpha = _mm_shuffle_ps(Value, Value, _MM_SHUFFLE(3, 3, 3, 3));
+            __m128 InverseAlpha = _mm_and_ps(_mm_div_ps(One, Alpha), _mm_cmpgt_ps(Alpha, _mm_set1_ps(1e-6f)));
+            Value = _mm_mul_ps(Value, _mm_or_ps(_mm_and_ps(InverseAlpha, RGBMask), OneInAlpha));
+        }
+
+        if (Format->IsNormalMap)
+        {
+            // NOTE: (X² + Y²) + Z² in that order, same as the scalar path, then broadcast, so the
+            //       rounding (and so the encoded bytes) matches it exactly
+            __m128 Squared = _mm_mul_ps(Value, Value);
+            __m128 LengthSquared = _mm_add_ps(_mm_add_ps(Squared, _mm_shuffle_ps(Squared, Squared, _MM_SHUFFLE(1, 1, 1, 1))),
+                                              _mm_shuffle_ps(Squared, Squared, _MM_SHUFFLE(2, 2, 2, 2)));
+            LengthSquared = _mm_shuffle_ps(LengthSquared, LengthSquared, _MM_SHUFFLE(0, 0, 0, 0));
+            __m128 IsLongEnough = _mm_and_ps(_mm_cmpgt_ps(LengthSquared, _mm_set1_ps(1e-12f)), RGBMask);
+
+            // NOTE: A real sqrt and divide rather than rsqrt, which wouldn't round like 1 / sqrtf
+            __m128 SafeLengthSquared = _mm_or_ps(_mm_and_ps(IsLongEnough, LengthSquared), _mm_andnot_ps(IsLongEnough, One));
+            __m128 InverseLength = _mm_div_ps(One, _mm_sqrt_ps(SafeLengthSquared));
+
+            __m128 Normal = _mm_mul_ps(Value, InverseLength);
+            __m128 IsZero = _mm_andnot_ps(IsLongEnough, RGBMask);
+            Normal = _mm_or_ps(_mm_and_ps(IsLongEnough, Normal), _mm_and_ps(IsZero, UnitZ));
+            Value = _mm_or_ps(Normal, _mm_andnot_ps(RGBMask, Value));
+            Value = _mm_add_ps(_mm_mul_ps(Value, NormalScale), NormalBias);
+        }
+
+        Value = _mm_min_ps(_mm_max_ps(Value, Zero), One);
+        __m128i Indices = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(Value, TableScale), Half));
+
+        i32 IndexValues[4];
+        _mm_storeu_si128((__m128i *) IndexValues, Indices);
+        u8 *Out = Out_Pixels + PixelIndex * 4;
+        Out[0] = Format->EncodeRGB[IndexValues[0]];
+        Out[1] = Format->EncodeRGB[IndexValues[1]];
+        Out[2] = Format->EncodeRGB[IndexValues[2]];
+        Out[3] = Format->EncodeAlpha[IndexValues[3]];
+    }
+}
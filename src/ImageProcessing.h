@@ -0,0 +1,44 @@
+#ifndef IMAGE_PROCESSING_H
+#define IMAGE_PROCESSING_H
+
+#include <cstddef>
+
+#include "Common.h"
+
+// NOTE: CPU image kernels shared by the texture cooker and the runtime loader. Everything works on
+//       tightly packed 8 bit RGBA unless it says otherwise. The kernels have SSE2 and scalar
+//       versions; the scalar ones are the reference and are only used when SIMD is turned off.
+enum image_filter
+{
+    IMAGE_FILTER_BOX,    // 2x2 average, cheap enough for load time
+    IMAGE_FILTER_KAISER, // 8 tap Kaiser windowed sinc per axis, sharper; for the cooker
+};
+
+// NOTE: How DownsampleImage treats the channels
+#define IMAGE_SRGB 0x1           // RGB is sRGB encoded and filtered in linear light
+#define IMAGE_NORMAL_MAP 0x2     // RGB is a tangent space normal and renormalized after filtering
+#define IMAGE_ALPHA_WEIGHTED 0x4 // RGB is weighted by alpha while filtering (premultiplied), so
+                                 // fully transparent texels don't bleed their color into the mips
+
+// NOTE: Halves each dimension (down to 1). Out_Pixels has to hold the smaller image.
+void
+DownsampleImage(const u8 *Pixels, i32 Width, i32 Height, image_filter Filter, u32 Flags, u8 *Out_Pixels);
+i32
+GetImageMipCount(i32 Width, i32 Height);
+
+// NOTE: Alpha is set to 255. Pixels and Out_Pixels can't overlap.
+void
+ExpandRGBToRGBA(const u8 *Pixels, size_t PixelCount, u8 *Out_Pixels);
+// NOTE: In place, in the stored (gamma) space, rounded to nearest
+void
+PremultiplyAlpha(u8 *Pixels, size_t PixelCount);
+// NOTE: In place; XYZ decoded from [0, 255] to [-1, 1], zero length normals become +Z
+void
+RenormalizeNormalMap(u8 *Pixels, size_t PixelCount);
+
+// NOTE: Only for comparing the SIMD kernels with the scalar ones (sdlogl-cook -bench); not
+//       thread safe, so don't flip it while images are being processed
+void
+SetImageSIMDEnabled(bool IsEnabled);
+
+#endif
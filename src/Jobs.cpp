@@ -0,0 +1,196 @@
+#include "Jobs.h"
+
+#include <SDL2/SDL.h>
+
+#include <cstdlib>
+#include <cstdio>
+
+#define MAX_JOB_COUNT 1024
+#define MAX_JOB_THREAD_COUNT 64
+
+struct job
+{
+    job_callback *Callback;
+    void *Data;
+};
+
+struct job_queue
+{
+    SDL_mutex *Mutex;
+    SDL_cond *JobAdded;
+    SDL_cond *JobFinished;
+
+    // NOTE: Ring buffer; guarded by Mutex
+    job Jobs[MAX_JOB_COUNT];
+    i32 ReadIndex;
+    i32 QueuedCount;
+    i32 InFlightCount;
+    bool ShouldQuit;
+
+    i32 ThreadCount;
+    SDL_Thread *Threads[MAX_JOB_THREAD_COUNT];
+};
+
+static int
+JobThreadProc(void *Data);
+static bool
+TakeJob(job_queue *Queue, job *Out_Job, bool Wait);
+static void
+FinishJob(job_queue *Queue);
+
+job_queue *
+CreateJobQueue(i32 ThreadCount)
+{
+    if (ThreadCount <= 0)
+    {
+        ThreadCount = SDL_GetCPUCount() - 1;
+        if (ThreadCount < 1)
+        {
+            ThreadCount = 1;
+        }
+    }
+    if (ThreadCount > MAX_JOB_THREAD_COUNT)
+    {
+        ThreadCount = MAX_JOB_THREAD_COUNT;
+    }
+
+    job_queue *Queue = (job_queue *) calloc(1, sizeof(job_queue));
+    Assert(Queue);
+
+    Queue->Mutex = SDL_CreateMutex();
+    Queue->JobAdded = SDL_CreateCond();
+    Queue->JobFinished = SDL_CreateCond();
+    Assert(Queue->Mutex && Queue->JobAdded && Queue->JobFinished);
+
+    for (i32 ThreadIndex = 0; ThreadIndex < ThreadCount; ++ThreadIndex)
+    {
+        SDL_Thread *Thread = SDL_CreateThread(JobThreadProc, "JobWorker", Queue);
+        if (!Thread)
+        {
+            fprintf(stderr, "Couldn't create job worker thread: %s\n", SDL_GetError());
+            break;
+        }
+        Queue->Threads[Queue->ThreadCount++] = Thread;
+    }
+
+    return Queue;
+}
+
+void
+DestroyJobQueue(job_queue *Queue)
+{
+    CompleteAllJobs(Queue);
+
+    SDL_LockMutex(Queue->Mutex);
+    Queue->ShouldQuit = true;
+    SDL_CondBroadcast(Queue->JobAdded);
+    SDL_UnlockMutex(Queue->Mutex);
+
+    for (i32 ThreadIndex = 0; ThreadIndex < Queue->ThreadCount; ++ThreadIndex)
+    {
+        SDL_WaitThread(Queue->Threads[ThreadIndex], 0);
+    }
+
+    SDL_DestroyCond(Queue->JobFinished);
+    SDL_DestroyCond(Queue->JobAdded);
+    SDL_DestroyMutex(Queue->Mutex);
+    free(Queue);
+}
+
+void
+AddJob(job_queue *Queue, job_callback *Callback, void *Data)
+{
+    SDL_LockMutex(Queue->Mutex);
+
+    // NOTE: Wait for space instead of growing the ring; the jobs are expected to be coarse
+    while (Queue->QueuedCount >= MAX_JOB_COUNT)
+    {
+        SDL_CondWait(Queue->JobFinished, Queue->Mutex);
+    }
+
+    i32 WriteIndex = (Queue->ReadIndex + Queue->QueuedCount) % MAX_JOB_COUNT;
+    Queue->Jobs[WriteIndex].Callback = Callback;
+    Queue->Jobs[WriteIndex].Data = Data;
+    ++Queue->QueuedCount;
+
+    SDL_CondSignal(Queue->JobAdded);
+    SDL_UnlockMutex(Queue->Mutex);
+}
+
+void
+CompleteAllJobs(job_queue *Queue)
+{
+    job Job;
+    while (TakeJob(Queue, &Job, false))
+    {
+        Job.Callback(Job.Data);
+        FinishJob(Queue);
+    }
+
+    SDL_LockMutex(Queue->Mutex);
+    while (Queue->QueuedCount > 0 || Queue->InFlightCount > 0)
+    {
+        SDL_CondWait(Queue->JobFinished, Queue->Mutex);
+    }
+    SDL_UnlockMutex(Queue->Mutex);
+}
+
+i32
+GetJobQueueThreadCount(job_queue *Queue)
+{
+    return Queue->ThreadCount;
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+static int
+JobThreadProc(void *Data)
+{
+    job_queue *Queue = (job_queue *) Data;
+
+    job Job;
+    while (TakeJob(Queue, &Job, true))
+    {
+        Job.Callback(Job.Data);
+        FinishJob(Queue);
+    }
+
+    return 0;
+}
+
+static bool
+TakeJob(job_queue *Queue, job *Out_Job, bool Wait)
+{
+    bool Result = false;
+
+    SDL_LockMutex(Queue->Mutex);
+
+    while (Wait && Queue->QueuedCount == 0 && !Queue->ShouldQuit)
+    {
+        SDL_CondWait(Queue->JobAdded, Queue->Mutex);
+    }
+
+    if (Queue->QueuedCount > 0)
+    {
+        *Out_Job = Queue->Jobs[Queue->ReadIndex];
+        Queue->ReadIndex = (Queue->ReadIndex + 1) % MAX_JOB_COUNT;
+        --Queue->QueuedCount;
+        ++Queue->InFlightCount;
+        Result = true;
+    }
+
+    SDL_UnlockMutex(Queue->Mutex);
+
+    return Result;
+}
+
+static void
+FinishJob(job_queue *Queue)
+{
+    SDL_LockMutex(Queue->Mutex);
+    --Queue->InFlightCount;
+    SDL_CondBroadcast(Queue->JobFinished);
+    SDL_UnlockMutex(Queue->Mutex);
+}
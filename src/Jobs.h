@@ -0,0 +1,25 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include "Common.h"
+
+typedef void job_callback(void *Data);
+
+struct job_queue;
+
+// NOTE: ThreadCount <= 0 means one worker per logical core, minus the calling thread
+job_queue *
+CreateJobQueue(i32 ThreadCount);
+void
+DestroyJobQueue(job_queue *Queue);
+
+void
+AddJob(job_queue *Queue, job_callback *Callback, void *Data);
+// NOTE: The calling thread helps with the remaining jobs until all of them are done
+void
+CompleteAllJobs(job_queue *Queue);
+
+i32
+GetJobQueueThreadCount(job_queue *Queue);
+
+#endif
@@ -0,0 +1,346 @@
+#include "Json.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+#define MAX_JSON_DEPTH 64
+#define JSON_INITIAL_TOKEN_CAPACITY 256
+
+static i32
+AddJSONToken(json_document *Document, i32 *TokenCapacity, json_token_type Type, i32 Start);
+static inline bool
+IsJSONWhitespace(char Char);
+
+bool
+ParseJSON(const char *Text, size_t TextSize, json_document *Out_Document)
+{
+    *Out_Document = { };
+    Out_Document->Text = Text;
+
+    i32 TokenCapacity = JSON_INITIAL_TOKEN_CAPACITY;
+    Out_Document->Tokens = (json_token *) malloc(TokenCapacity * sizeof(json_token));
+    Assert(Out_Document->Tokens);
+
+    // NOTE: Open objects and arrays; for objects, whether the next token is a member's value
+    i32 ContainerStack[MAX_JSON_DEPTH];
+    bool AwaitingValue[MAX_JSON_DEPTH];
+    i32 Depth = 0;
+
+    i32 Size = (i32) TextSize;
+    for (i32 Cursor = 0; Cursor < Size; ++Cursor)
+    {
+        char Char = Text[Cursor];
+        if (IsJSONWhitespace(Char) || Char == ':' || Char == ',')
+        {
+            continue;
+        }
+
+        if (Char == '}' || Char == ']')
+        {
+            if (Depth == 0)
+            {
+                FreeJSON(Out_Document);
+                return false;
+            }
+
+            // NOTE: An object can't close between a key and its value ({"a"} or {"a":}); lookups
+            //       take the token after every key to be its value
+            json_token *Container = &Out_Document->Tokens[ContainerStack[--Depth]];
+            if ((Char == '}') != (Container->Type == JSON_OBJECT) ||
+                (Container->Type == JSON_OBJECT && AwaitingValue[Depth]))
+            {
+                FreeJSON(Out_Document);
+                return false;
+            }
+            Container->End = Cursor + 1;
+            Container->Next = Out_Document->TokenCount;
+            continue;
+        }
+
+        // Every other token is a value (or an object key) of the innermost container
+        // ---------------------------------------------------------------------------
+        if (Depth > 0)
+        {
+            json_token *Parent = &Out_Document->Tokens[ContainerStack[Depth - 1]];
+            if (Parent->Type == JSON_ARRAY)
+            {
+                ++Parent->ChildCount;
+            }
+            else if (!AwaitingValue[Depth - 1])
+            {
+                if (Char != '"')
+                {
+                    FreeJSON(Out_Document);
+                    return false;
+                }
+                ++Parent->ChildCount;
+                AwaitingValue[Depth - 1] = true;
+            }
+            else
+            {
+                AwaitingValue[Depth - 1] = false;
+            }
+        }
+
+        if (Char == '{' || Char == '[')
+        {
+            if (Depth >= MAX_JSON_DEPTH)
+            {
+                FreeJSON(Out_Document);
+                return false;
+            }
+
+            i32 Token = AddJSONToken(Out_Document, &TokenCapacity, (Char == '{') ? JSON_OBJECT : JSON_ARRAY, Cursor);
+            ContainerStack[Depth] = Token;
+            AwaitingValue[Depth] = false;
+            ++Depth;
+        }
+        else if (Char == '"')
+        {
+            i32 Token = AddJSONToken(Out_Document, &TokenCapacity, JSON_STRING, Cursor + 1);
+            ++Cursor;
+            while (Cursor < Size && Text[Cursor] != '"')
+            {
+                if (Text[Cursor] == '\\')
+                {
+                    ++Cursor;
+                }
+                ++Cursor;
+            }
+            if (Cursor >= Size)
+            {
+                FreeJSON(Out_Document);
+                return false;
+            }
+            Out_Document->Tokens[Token].End = Cursor;
+        }
+        else
+        {
+            i32 Token = AddJSONToken(Out_Document, &TokenCapacity, JSON_PRIMITIVE, Cursor);
+            while (Cursor + 1 < Size &&
+                   !IsJSONWhitespace(Text[Cursor + 1]) &&
+                   Text[Cursor + 1] != ',' && Text[Cursor + 1] != '}' && Text[Cursor + 1] != ']')
+            {
+                ++Cursor;
+            }
+            Out_Document->Tokens[Token].End = Cursor + 1;
+        }
+    }
+
+    if (Depth != 0 || Out_Document->TokenCount == 0)
+    {
+        FreeJSON(Out_Document);
+        return false;
+    }
+
+    return true;
+}
+
+void
+FreeJSON(json_document *Document)
+{
+    free(Document->Tokens);
+    *Document = { };
+}
+
+i32
+GetJSONMember(json_document *Document, i32 ObjectToken, const char *Key)
+{
+    if (ObjectToken < 0 || Document->Tokens[ObjectToken].Type != JSON_OBJECT)
+    {
+        return -1;
+    }
+
+    i32 KeyToken = ObjectToken + 1;
+    for (i32 MemberIndex = 0; MemberIndex < Document->Tokens[ObjectToken].ChildCount; ++MemberIndex)
+    {
+        i32 ValueToken = KeyToken + 1;
+        if (IsJSONString(Document, KeyToken, Key))
+        {
+            return ValueToken;
+        }
+        KeyToken = Document->Tokens[ValueToken].Next;
+    }
+
+    return -1;
+}
+
+i32
+GetJSONElement(json_document *Document, i32 ArrayToken, i32 ElementIndex)
+{
+    if (ArrayToken < 0 || Document->Tokens[ArrayToken].Type != JSON_ARRAY ||
+        ElementIndex < 0 || ElementIndex >= Document->Tokens[ArrayToken].ChildCount)
+    {
+        return -1;
+    }
+
+    i32 Token = ArrayToken + 1;
+    for (i32 Index = 0; Index < ElementIndex; ++Index)
+    {
+        Token = Document->Tokens[Token].Next;
+    }
+
+    return Token;
+}
+
+i32
+GetJSONChildCount(json_document *Document, i32 Token)
+{
+    if (Token < 0)
+    {
+        return 0;
+    }
+
+    return Document->Tokens[Token].ChildCount;
+}
+
+i32
+GetJSONInt(json_document *Document, i32 Token, i32 Default)
+{
+    // NOTE: Out of range (or NaN) is as good as missing; casting it would be undefined
+    f64 Value = GetJSONFloat(Document, Token, (f64) Default);
+    if (!(Value >= (f64) INT32_MIN && Value <= (f64) INT32_MAX))
+    {
+        return Default;
+    }
+
+    return (i32) Value;
+}
+
+f64
+GetJSONFloat(json_document *Document, i32 Token, f64 Default)
+{
+    if (Token < 0 || Document->Tokens[Token].Type != JSON_PRIMITIVE)
+    {
+        return Default;
+    }
+
+    json_token *NumberToken = &Document->Tokens[Token];
+    char NumberBuffer[64];
+    i32 NumberCount = NumberToken->End - NumberToken->Start;
+    if (NumberCount <= 0 || NumberCount >= (i32) sizeof(NumberBuffer))
+    {
+        return Default;
+    }
+    memcpy(NumberBuffer, Document->Text + NumberToken->Start, NumberCount);
+    NumberBuffer[NumberCount] = '\0';
+
+    char *NumberEnd;
+    f64 Result = strtod(NumberBuffer, &NumberEnd);
+    if (NumberEnd == NumberBuffer)
+    {
+        return Default;
+    }
+
+    return Result;
+}
+
+bool
+GetJSONBool(json_document *Document, i32 Token, bool Default)
+{
+    if (Token < 0 || Document->Tokens[Token].Type != JSON_PRIMITIVE)
+    {
+        return Default;
+    }
+
+    char FirstChar = Document->Text[Document->Tokens[Token].Start];
+    if (FirstChar == 't')
+    {
+        return true;
+    }
+    if (FirstChar == 'f')
+    {
+        return false;
+    }
+
+    return Default;
+}
+
+bool
+IsJSONString(json_document *Document, i32 Token, const char *String)
+{
+    if (Token < 0 || Document->Tokens[Token].Type != JSON_STRING)
+    {
+        return false;
+    }
+
+    json_token *StringToken = &Document->Tokens[Token];
+    size_t StringCount = strlen(String);
+    return ((size_t) (StringToken->End - StringToken->Start) == StringCount &&
+            memcmp(Document->Text + StringToken->Start, String, StringCount) == 0);
+}
+
+bool
+CopyJSONString(json_document *Document, i32 Token, char *Out_String, i32 StringBufferSize)
+{
+    Out_String[0] = '\0';
+
+    if (Token < 0 || Document->Tokens[Token].Type != JSON_STRING)
+    {
+        return false;
+    }
+
+    json_token *StringToken = &Document->Tokens[Token];
+    i32 OutCount = 0;
+    for (i32 Cursor = StringToken->Start; Cursor < StringToken->End; ++Cursor)
+    {
+        char Char = Document->Text[Cursor];
+        if (Char == '\\' && Cursor + 1 < StringToken->End)
+        {
+            char Escaped = Document->Text[++Cursor];
+            switch (Escaped)
+            {
+                case 'n': Char = '\n'; break;
+                case 't': Char = '\t'; break;
+                case 'r': Char = '\r'; break;
+                case 'b': Char = '\b'; break;
+                case 'f': Char = '\f'; break;
+                case 'u': Char = '\\'; --Cursor; break;
+                default: Char = Escaped; break;
+            }
+        }
+
+        if (OutCount + 1 >= StringBufferSize)
+        {
+            Out_String[OutCount] = '\0';
+            return false;
+        }
+        Out_String[OutCount++] = Char;
+    }
+    Out_String[OutCount] = '\0';
+
+    return true;
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+static i32
+AddJSONToken(json_document *Document, i32 *TokenCapacity, json_token_type Type, i32 Start)
+{
+    if (Document->TokenCount >= *TokenCapacity)
+    {
+        *TokenCapacity *= 2;
+        Document->Tokens = (json_token *) realloc(Document->Tokens, *TokenCapacity * sizeof(json_token));
+        Assert(Document->Tokens);
+    }
+
+    i32 Token = Document->TokenCount++;
+    json_token *NewToken = &Document->Tokens[Token];
+    NewToken->Type = Type;
+    NewToken->Start = Start;
+    NewToken->End = Start;
+    NewToken->ChildCount = 0;
+    NewToken->Next = Token + 1;
+
+    return Token;
+}
+
+static inline bool
+IsJSONWhitespace(char Char)
+{
+    return (Char == ' ' || Char == '\t' || Char == '\n' || Char == '\r');
+}
@@ -0,0 +1,62 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <cstddef>
+
+#include "Common.h"
+
+// NOTE: Minimal in-place JSON tokenizer (no DOM, no copies of the text). Strings and numbers are
+//       ranges into the source text and are only converted when asked for.
+
+enum json_token_type
+{
+    JSON_OBJECT,
+    JSON_ARRAY,
+    JSON_STRING,
+    JSON_PRIMITIVE, // number, true, false, null
+};
+
+struct json_token
+{
+    json_token_type Type;
+    i32 Start;
+    i32 End;
+    // NOTE: Members of an object (key/value pairs) or elements of an array
+    i32 ChildCount;
+    // NOTE: Index of the token right after this one's subtree
+    i32 Next;
+};
+
+struct json_document
+{
+    const char *Text;
+    i32 TokenCount;
+    json_token *Tokens;
+};
+
+bool
+ParseJSON(const char *Text, size_t TextSize, json_document *Out_Document);
+void
+FreeJSON(json_document *Document);
+
+// NOTE: Lookups return -1 when the token isn't there or has the wrong type;
+//       every function accepts -1 as its token and returns the default then
+i32
+GetJSONMember(json_document *Document, i32 ObjectToken, const char *Key);
+i32
+GetJSONElement(json_document *Document, i32 ArrayToken, i32 ElementIndex);
+i32
+GetJSONChildCount(json_document *Document, i32 Token);
+i32
+GetJSONInt(json_document *Document, i32 Token, i32 Default);
+f64
+GetJSONFloat(json_document *Document, i32 Token, f64 Default);
+bool
+GetJSONBool(json_document *Document, i32 Token, bool Default);
+bool
+IsJSONString(json_document *Document, i32 Token, const char *String);
+// NOTE: Unescapes simple escapes; \u escapes are copied as is
+bool
+CopyJSONString(json_document *Document, i32 Token, char *Out_String, i32 StringBufferSize);
+
+#endif
@@ -0,0 +1,254 @@
+#include "LZ4.h"
+
+#include <cstring>
+
+#define LZ4_MIN_MATCH 4
+// NOTE: Format rules: the last 5 bytes are always literals and the last match starts at least
+//       12 bytes before the end
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MATCH_FIND_LIMIT 12
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_HASH_BITS 14
+// NOTE: Search step grows by one for every 2^LZ4_SKIP_TRIGGER bytes without a match, so
+//       incompressible data is skipped over quickly
+#define LZ4_SKIP_TRIGGER 6
+
+static u32
+LZ4_Read32(const u8 *Bytes);
+static u32
+LZ4_Hash(u32 Sequence);
+static u8 *
+LZ4_WriteLength(u8 *Dest, size_t Length);
+
+size_t
+GetLZ4CompressBound(size_t SourceSize)
+{
+    return SourceSize + (SourceSize / 255) + 16;
+}
+
+size_t
+CompressLZ4(const u8 *Source, size_t SourceSize, u8 *Out_Dest, size_t DestCapacity)
+{
+    // NOTE: Offsets from Source; 0 doubles as "empty", which only costs a failed compare
+    u32 HashTable[1 << LZ4_HASH_BITS] = { };
+
+    const u8 *Input = Source;
+    const u8 *InputEnd = Source + SourceSize;
+    const u8 *Anchor = Source;
+    u8 *Output = Out_Dest;
+    u8 *OutputEnd = Out_Dest + DestCapacity;
+
+    if (SourceSize > LZ4_MATCH_FIND_LIMIT)
+    {
+        const u8 *MatchFindLimit = InputEnd - LZ4_MATCH_FIND_LIMIT;
+        const u8 *MatchLimit = InputEnd - LZ4_LAST_LITERALS;
+
+        ++Input;
+        while (Input < MatchFindLimit)
+        {
+            u32 Sequence = LZ4_Read32(Input);
+            u32 Hash = LZ4_Hash(Sequence);
+            const u8 *Match = Source + HashTable[Hash];
+            HashTable[Hash] = (u32) (Input - Source);
+
+            if (Match >= Input || Input - Match > LZ4_MAX_OFFSET || LZ4_Read32(Match) != Sequence)
+            {
+                Input += 1 + ((Input - Anchor) >> LZ4_SKIP_TRIGGER);
+                continue;
+            }
+
+            while (Input > Anchor && Match > Source && Input[-1] == Match[-1])
+            {
+                --Input;
+                --Match;
+            }
+
+            size_t MatchLength = LZ4_MIN_MATCH;
+            while (Input + MatchLength < MatchLimit && Input[MatchLength] == Match[MatchLength])
+            {
+                ++MatchLength;
+            }
+
+            // NOTE: Token, literal length, literals, offset, match length
+            size_t LiteralLength = (size_t) (Input - Anchor);
+            size_t SequenceSize = 1 + (LiteralLength / 255 + 1) + LiteralLength + 2 + (MatchLength / 255 + 1);
+            if (SequenceSize > (size_t) (OutputEnd - Output))
+            {
+                return 0;
+            }
+
+            u8 *Token = Output++;
+            *Token = (u8) (((LiteralLength < 15) ? LiteralLength : 15) << 4);
+            if (LiteralLength >= 15)
+            {
+                Output = LZ4_WriteLength(Output, LiteralLength - 15);
+            }
+            memcpy(Output, Anchor, LiteralLength);
+            Output += LiteralLength;
+
+            u16 Offset = (u16) (Input - Match);
+            *Output++ = (u8) (Offset & 0xFF);
+            *Output++ = (u8) (Offset >> 8);
+
+            size_t MatchCode = MatchLength - LZ4_MIN_MATCH;
+            *Token |= (u8) ((MatchCode < 15) ? MatchCode : 15);
+            if (MatchCode >= 15)
+            {
+                Output = LZ4_WriteLength(Output, MatchCode - 15);
+            }
+
+            Input += MatchLength;
+            Anchor = Input;
+
+            // NOTE: Cheap way to find more of the matches right after this one
+            if (Input < MatchFindLimit)
+            {
+                HashTable[LZ4_Hash(LZ4_Read32(Input - 2))] = (u32) (Input - 2 - Source);
+            }
+        }
+    }
+
+    // NOTE: The rest goes out as literals, with an empty match part
+    size_t LiteralLength = (size_t) (InputEnd - Anchor);
+    if (1 + (LiteralLength / 255 + 1) + LiteralLength > (size_t) (OutputEnd - Output))
+    {
+        return 0;
+    }
+
+    u8 *Token = Output++;
+    *Token = (u8) (((LiteralLength < 15) ? LiteralLength : 15) << 4);
+    if (LiteralLength >= 15)
+    {
+        Output = LZ4_WriteLength(Output, LiteralLength - 15);
+    }
+    if (LiteralLength > 0)
+    {
+        memcpy(Output, Anchor, LiteralLength);
+        Output += LiteralLength;
+    }
+
+    return (size_t) (Output - Out_Dest);
+}
+
+bool
+DecompressLZ4(const u8 *Source, size_t SourceSize, u8 *Out_Dest, size_t DestSize)
+{
+    const u8 *Input = Source;
+    const u8 *InputEnd = Source + SourceSize;
+    u8 *Output = Out_Dest;
+    u8 *OutputEnd = Out_Dest + DestSize;
+
+    while (Input < InputEnd)
+    {
+        u8 Token = *Input++;
+
+        size_t LiteralLength = Token >> 4;
+        if (LiteralLength == 15)
+        {
+            u8 Byte;
+            do
+            {
+                if (Input >= InputEnd)
+                {
+                    return false;
+                }
+                Byte = *Input++;
+                LiteralLength += Byte;
+            } while (Byte == 255);
+        }
+
+        if (LiteralLength > (size_t) (InputEnd - Input) || LiteralLength > (size_t) (OutputEnd - Output))
+        {
+            return false;
+        }
+        memcpy(Output, Input, LiteralLength);
+        Input += LiteralLength;
+        Output += LiteralLength;
+
+        // NOTE: The last sequence has no match part
+        if (Input == InputEnd)
+        {
+            break;
+        }
+
+        if (InputEnd - Input < 2)
+        {
+            return false;
+        }
+        size_t Offset = (size_t) Input[0] | ((size_t) Input[1] << 8);
+        Input += 2;
+        if (Offset == 0 || Offset > (size_t) (Output - Out_Dest))
+        {
+            return false;
+        }
+
+        size_t MatchLength = Token & 15;
+        if (MatchLength == 15)
+        {
+            u8 Byte;
+            do
+            {
+                if (Input >= InputEnd)
+                {
+                    return false;
+                }
+                Byte = *Input++;
+                MatchLength += Byte;
+            } while (Byte == 255);
+        }
+        MatchLength += LZ4_MIN_MATCH;
+
+        if (MatchLength > (size_t) (OutputEnd - Output))
+        {
+            return false;
+        }
+
+        // NOTE: Matches closer than their length overlap what they write (runs), those have to go
+        //       a byte at a time
+        const u8 *Match = Output - Offset;
+        if (Offset >= MatchLength)
+        {
+            memcpy(Output, Match, MatchLength);
+        }
+        else
+        {
+            for (size_t ByteIndex = 0; ByteIndex < MatchLength; ++ByteIndex)
+            {
+                Output[ByteIndex] = Match[ByteIndex];
+            }
+        }
+        Output += MatchLength;
+    }
+
+    return (Output == OutputEnd);
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+static u32
+LZ4_Read32(const u8 *Bytes)
+{
+    u32 Result;
+    memcpy(&Result, Bytes, sizeof(Result));
+    return Result;
+}
+
+static u32
+LZ4_Hash(u32 Sequence)
+{
+    return (Sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+}
+
+static u8 *
+LZ4_WriteLength(u8 *Dest, size_t Length)
+{
+    while (Length >= 255)
+    {
+        *Dest++ = 255;
+        Length -= 255;
+    }
+    *Dest++ = (u8) Length;
+    return Dest;
+}
@@ -0,0 +1,23 @@
+#ifndef LZ4_H
+#define LZ4_H
+
+#include <cstddef>
+
+#include "Common.h"
+
+// NOTE: LZ4 block format (no frame header, no checksum), so blocks written here decode with the
+//       reference lz4 library and the other way around. The compressor is the plain greedy one:
+//       fast enough for the cooker, while decoding is little more than memcpy.
+
+// NOTE: Worst case size of a compressed block, for input that doesn't compress at all
+size_t
+GetLZ4CompressBound(size_t SourceSize);
+// NOTE: Returns the compressed size, or 0 if it doesn't fit in DestCapacity
+size_t
+CompressLZ4(const u8 *Source, size_t SourceSize, u8 *Out_Dest, size_t DestCapacity);
+// NOTE: Fails unless the block decodes to exactly DestSize bytes. Never reads or writes out of
+//       bounds, even for corrupt input.
+bool
+DecompressLZ4(const u8 *Source, size_t SourceSize, u8 *Out_Dest, size_t DestSize);
+
+#endif
@@ -0,0 +1,345 @@
+#include "Memory.h"
+
+#include <SDL2/SDL.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_MSC_VER) && defined(_DEBUG)
+#include <crtdbg.h>
+#define MEMORY_USE_CRT_ALLOC_HOOK 1
+#else
+#define MEMORY_USE_CRT_ALLOC_HOOK 0
+#endif
+
+struct memory_arena_block
+{
+    memory_arena_block *Prev;
+    size_t Size;
+    size_t Used;
+};
+
+// NOTE: Block data starts this far past the header, so it's aligned for anything up to 64 bytes
+#define MEMORY_BLOCK_HEADER_SIZE 64
+#define MAX_POOL_ALIGNMENT 16
+
+struct memory_tracking
+{
+    // NOTE: Written on the GL thread only; the hook reads them from every thread, but only ever
+    //       counts when it's running on FrameThreadID itself
+    SDL_threadID FrameThreadID;
+    bool IsInFrame;
+    bool IsHookInstalled;
+
+    i32 HeapAllocationCount;
+    u64 HeapAllocatedBytes;
+    i32 AllocatingFrameCount;
+};
+
+static memory_tracking MemoryTracking;
+static memory_arena FrameArena;
+// NOTE: Worker threads live as long as their queue; the blocks of a thread's scratch arena aren't
+//       given back when it exits, so don't use it from short-lived threads
+static thread_local memory_arena ScratchArena;
+
+static memory_arena_block *
+MEMORY_AllocateBlock(size_t Size);
+static void
+MEMORY_CountHeapAllocation(size_t Size);
+#if MEMORY_USE_CRT_ALLOC_HOOK
+static int __cdecl
+MEMORY_CRTAllocHook(int AllocType, void *UserData, size_t Size, int BlockType, long RequestNumber,
+                    const unsigned char *FileName, int LineNumber);
+#endif
+
+// -----------------------------
+// EXTERNAL FUNCTION DEFINITIONS
+// -----------------------------
+
+// Arenas
+// ------
+
+void *
+PushSize(memory_arena *Arena, size_t Size, size_t Alignment)
+{
+    Assert(Alignment > 0 && Alignment <= MEMORY_BLOCK_HEADER_SIZE && (Alignment & (Alignment - 1)) == 0);
+
+    memory_arena_block *Block = Arena->CurrentBlock;
+    size_t Offset = 0;
+    if (Block)
+    {
+        Offset = (Block->Used + (Alignment - 1)) & ~(Alignment - 1);
+    }
+
+    if (!Block || Offset + Size > Block->Size)
+    {
+        size_t MinimumBlockSize = Arena->MinimumBlockSize ? Arena->MinimumBlockSize : DEFAULT_ARENA_BLOCK_SIZE;
+        size_t BlockSize = (Size > MinimumBlockSize) ? Size : MinimumBlockSize;
+
+        Block = MEMORY_AllocateBlock(BlockSize);
+        Block->Prev = Arena->CurrentBlock;
+        Arena->CurrentBlock = Block;
+        Offset = 0;
+    }
+
+    u8 *Result = (u8 *) Block + MEMORY_BLOCK_HEADER_SIZE + Offset;
+    Block->Used = Offset + Size;
+    memset(Result, 0, Size);
+
+    return Result;
+}
+
+void
+ClearArena(memory_arena *Arena)
+{
+    memory_arena_block *Block = Arena->CurrentBlock;
+    while (Block)
+    {
+        memory_arena_block *Prev = Block->Prev;
+        free(Block);
+        Block = Prev;
+    }
+    Arena->CurrentBlock = 0;
+}
+
+void
+ResetArena(memory_arena *Arena)
+{
+    memory_arena_block *Biggest = 0;
+    for (memory_arena_block *Block = Arena->CurrentBlock; Block; Block = Block->Prev)
+    {
+        if (!Biggest || Block->Size > Biggest->Size)
+        {
+            Biggest = Block;
+        }
+    }
+
+    memory_arena_block *Block = Arena->CurrentBlock;
+    while (Block)
+    {
+        memory_arena_block *Prev = Block->Prev;
+        if (Block != Biggest)
+        {
+            free(Block);
+        }
+        Block = Prev;
+    }
+
+    Arena->CurrentBlock = Biggest;
+    if (Biggest)
+    {
+        Biggest->Prev = 0;
+        Biggest->Used = 0;
+    }
+}
+
+size_t
+GetArenaSize(memory_arena *Arena)
+{
+    size_t Result = 0;
+    for (memory_arena_block *Block = Arena->CurrentBlock; Block; Block = Block->Prev)
+    {
+        Result += Block->Used;
+    }
+    return Result;
+}
+
+temporary_memory
+BeginTemporaryMemory(memory_arena *Arena)
+{
+    temporary_memory Result;
+    Result.Arena = Arena;
+    Result.Block = Arena->CurrentBlock;
+    Result.Used = Arena->CurrentBlock ? Arena->CurrentBlock->Used : 0;
+    return Result;
+}
+
+void
+EndTemporaryMemory(temporary_memory TemporaryMemory)
+{
+    memory_arena *Arena = TemporaryMemory.Arena;
+    while (Arena->CurrentBlock != TemporaryMemory.Block)
+    {
+        Assert(Arena->CurrentBlock);
+        memory_arena_block *Block = Arena->CurrentBlock;
+        Arena->CurrentBlock = Block->Prev;
+        free(Block);
+    }
+
+    if (Arena->CurrentBlock)
+    {
+        Assert(Arena->CurrentBlock->Used >= TemporaryMemory.Used);
+        Arena->CurrentBlock->Used = TemporaryMemory.Used;
+    }
+}
+
+// Scratch and frame memory
+// ------------------------
+
+memory_arena *
+GetScratchArena()
+{
+    return &ScratchArena;
+}
+
+memory_arena *
+GetFrameArena()
+{
+    return &FrameArena;
+}
+
+// Pools
+// -----
+
+void
+InitializePool(memory_pool *Pool, size_t ElementSize, i32 Capacity)
+{
+    Assert(Capacity > 0);
+
+    // NOTE: Free elements hold the free list link
+    if (ElementSize < sizeof(void *))
+    {
+        ElementSize = sizeof(void *);
+    }
+    ElementSize = (ElementSize + (MAX_POOL_ALIGNMENT - 1)) & ~((size_t) MAX_POOL_ALIGNMENT - 1);
+
+    *Pool = { };
+    Pool->ElementSize = ElementSize;
+    Pool->Capacity = Capacity;
+    Pool->Memory = (u8 *) malloc(ElementSize * Capacity);
+    Assert(Pool->Memory);
+    MEMORY_CountHeapAllocation(ElementSize * Capacity);
+
+    for (i32 ElementIndex = Capacity - 1; ElementIndex >= 0; --ElementIndex)
+    {
+        void *Element = Pool->Memory + ElementIndex * ElementSize;
+        *(void **) Element = Pool->FirstFree;
+        Pool->FirstFree = Element;
+    }
+}
+
+void
+FreePool(memory_pool *Pool)
+{
+    free(Pool->Memory);
+    *Pool = { };
+}
+
+void *
+AllocateFromPool(memory_pool *Pool)
+{
+    void *Result = Pool->FirstFree;
+    if (Result)
+    {
+        Pool->FirstFree = *(void **) Result;
+        ++Pool->UsedCount;
+        memset(Result, 0, Pool->ElementSize);
+    }
+    return Result;
+}
+
+void
+FreeToPool(memory_pool *Pool, void *Element)
+{
+    if (Element)
+    {
+        Assert((u8 *) Element >= Pool->Memory &&
+               (u8 *) Element < Pool->Memory + Pool->ElementSize * Pool->Capacity &&
+               ((u8 *) Element - Pool->Memory) % Pool->ElementSize == 0);
+        Assert(Pool->UsedCount > 0);
+
+        *(void **) Element = Pool->FirstFree;
+        Pool->FirstFree = Element;
+        --Pool->UsedCount;
+    }
+}
+
+// Frame allocation tracking
+// -------------------------
+
+void
+BeginFrameMemory()
+{
+#if MEMORY_USE_CRT_ALLOC_HOOK
+    if (!MemoryTracking.IsHookInstalled)
+    {
+        _CrtSetAllocHook(MEMORY_CRTAllocHook);
+        MemoryTracking.IsHookInstalled = true;
+    }
+#endif
+
+    // NOTE: Before the frame starts, so growing the frame arena is charged to the frame that
+    //       needed it rather than this one
+    ResetArena(&FrameArena);
+
+    MemoryTracking.FrameThreadID = SDL_ThreadID();
+    MemoryTracking.HeapAllocationCount = 0;
+    MemoryTracking.HeapAllocatedBytes = 0;
+    MemoryTracking.IsInFrame = true;
+}
+
+frame_memory_stats
+EndFrameMemory()
+{
+    MemoryTracking.IsInFrame = false;
+    if (MemoryTracking.HeapAllocationCount > 0)
+    {
+        ++MemoryTracking.AllocatingFrameCount;
+    }
+
+    frame_memory_stats Result;
+    Result.HeapAllocationCount = MemoryTracking.HeapAllocationCount;
+    Result.HeapAllocatedBytes = MemoryTracking.HeapAllocatedBytes;
+    Result.FrameArenaBytes = GetArenaSize(&FrameArena);
+    Result.AllocatingFrameCount = MemoryTracking.AllocatingFrameCount;
+    Result.CountsEveryAllocation = (MEMORY_USE_CRT_ALLOC_HOOK != 0);
+
+    return Result;
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+static memory_arena_block *
+MEMORY_AllocateBlock(size_t Size)
+{
+    memory_arena_block *Block = (memory_arena_block *) malloc(MEMORY_BLOCK_HEADER_SIZE + Size);
+    Assert(Block);
+    MEMORY_CountHeapAllocation(MEMORY_BLOCK_HEADER_SIZE + Size);
+
+    Block->Prev = 0;
+    Block->Size = Size;
+    Block->Used = 0;
+
+    return Block;
+}
+
+static void
+MEMORY_CountHeapAllocation(size_t Size)
+{
+    // NOTE: The CRT hook already sees these
+    if (!MEMORY_USE_CRT_ALLOC_HOOK &&
+        MemoryTracking.IsInFrame && SDL_ThreadID() == MemoryTracking.FrameThreadID)
+    {
+        ++MemoryTracking.HeapAllocationCount;
+        MemoryTracking.HeapAllocatedBytes += Size;
+    }
+}
+
+#if MEMORY_USE_CRT_ALLOC_HOOK
+static int __cdecl
+MEMORY_CRTAllocHook(int AllocType, void *UserData, size_t Size, int BlockType, long RequestNumber,
+                    const unsigned char *FileName, int LineNumber)
+{
+    // NOTE: Runs inside the CRT's allocator, so nothing in here can allocate or print
+    if ((AllocType == _HOOK_ALLOC || AllocType == _HOOK_REALLOC) && BlockType != _CRT_BLOCK &&
+        MemoryTracking.IsInFrame && SDL_ThreadID() == MemoryTracking.FrameThreadID)
+    {
+        ++MemoryTracking.HeapAllocationCount;
+        MemoryTracking.HeapAllocatedBytes += Size;
+    }
+    return 1;
+}
+#endif
@@ -0,0 +1,110 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <cstddef>
+
+#include "Common.h"
+
+// Arenas
+// ------
+
+// NOTE: Linear allocator over a chain of heap blocks. Pushes are zeroed (calloc semantics) and
+//       there's no freeing individual pushes: everything goes at once with ClearArena, or back to
+//       a saved point with temporary_memory. Not synchronized; one thread at a time.
+struct memory_arena_block;
+
+struct memory_arena
+{
+    memory_arena_block *CurrentBlock;
+    // NOTE: 0 means DEFAULT_ARENA_BLOCK_SIZE. Bigger pushes get a block of their own size.
+    size_t MinimumBlockSize;
+};
+
+struct temporary_memory
+{
+    memory_arena *Arena;
+    memory_arena_block *Block;
+    size_t Used;
+};
+
+#define DEFAULT_ARENA_BLOCK_SIZE (64 * 1024)
+
+#define PushStruct(Arena, type) (type *) PushSize((Arena), sizeof(type), alignof(type))
+#define PushArray(Arena, Count, type) (type *) PushSize((Arena), (size_t) (Count) * sizeof(type), alignof(type))
+
+void *
+PushSize(memory_arena *Arena, size_t Size, size_t Alignment);
+// NOTE: Frees every block
+void
+ClearArena(memory_arena *Arena);
+// NOTE: Keeps the newest (biggest) block and rewinds it, so an arena that's reused for the same
+//       kind of work stops hitting the heap once it has grown to fit
+void
+ResetArena(memory_arena *Arena);
+size_t
+GetArenaSize(memory_arena *Arena);
+
+temporary_memory
+BeginTemporaryMemory(memory_arena *Arena);
+// NOTE: Frees the blocks added since BeginTemporaryMemory and rewinds to where it was
+void
+EndTemporaryMemory(temporary_memory TemporaryMemory);
+
+// Scratch and frame memory
+// ------------------------
+
+// NOTE: One per thread, for data that doesn't outlive the function using it (parsing temporaries,
+//       intermediate vertex data). Wrap its use in Begin/EndTemporaryMemory.
+memory_arena *
+GetScratchArena();
+// NOTE: GL thread only; everything pushed to it is gone at the next BeginFrameMemory
+memory_arena *
+GetFrameArena();
+
+// Pools
+// -----
+
+// NOTE: Fixed number of fixed-size elements in one up front allocation, with a free list through
+//       the free ones. Elements are zeroed when they're handed out.
+struct memory_pool
+{
+    u8 *Memory;
+    size_t ElementSize;
+    i32 Capacity;
+    i32 UsedCount;
+    void *FirstFree;
+};
+
+void
+InitializePool(memory_pool *Pool, size_t ElementSize, i32 Capacity);
+void
+FreePool(memory_pool *Pool);
+// NOTE: 0 when the pool is full
+void *
+AllocateFromPool(memory_pool *Pool);
+void
+FreeToPool(memory_pool *Pool, void *Element);
+
+// Frame allocation tracking
+// -------------------------
+
+// NOTE: Heap allocations on the GL thread between BeginFrameMemory and EndFrameMemory. Every
+//       allocation is counted where the CRT can report them (MSVC debug builds); elsewhere only the
+//       ones made by this module (arena blocks, pools) are.
+struct frame_memory_stats
+{
+    i32 HeapAllocationCount;
+    u64 HeapAllocatedBytes;
+    u64 FrameArenaBytes;
+    // NOTE: Frames so far that allocated from the heap at all
+    i32 AllocatingFrameCount;
+    bool CountsEveryAllocation;
+};
+
+// NOTE: Call at the start of every frame on the GL thread; resets the frame arena
+void
+BeginFrameMemory();
+frame_memory_stats
+EndFrameMemory();
+
+#endif
@@ -8,13 +8,199 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <cctype>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
 #include <cstdlib>
 #include <cstdio>
 #include <cstring>
 
+#include "Culling.h"
+#include "FileIO.h"
+#include "GLState.h"
+#include "Hash.h"
+#include "Json.h"
+#include "ModelFormat.h"
+#include "Obj.h"
 #include "Shader.h"
+#include "StreamBuffer.h"
+#include "Texture.h"
 #include "Util.h"
 
+// NOTE: Cook models that have no up-to-date cooked file when they're loaded. Convenient during
+//       development; builds that only ship cooked data can turn it off.
+#ifndef MODEL_COOK_ON_LOAD
+#define MODEL_COOK_ON_LOAD 1
+#endif
+
+// NOTE: glTF accessors point straight into the mapped .gltf/.glb and .bin files; their data goes
+//       to glBufferSubData without being converted to the planar mesh_internal_data layout
+#define MAX_GLTF_BUFFER_COUNT 8
+#define GLTF_GLB_MAGIC 0x46546C67 // 'glTF'
+#define GLTF_GLB_CHUNK_JSON 0x4E4F534A // 'JSON'
+#define GLTF_GLB_CHUNK_BIN 0x004E4942 // 'BIN\0'
+
+// NOTE: Same order as the static mesh shader attribute locations
+#define GLTF_ATTRIBUTE_POSITION 0
+#define GLTF_ATTRIBUTE_UV 1
+#define GLTF_ATTRIBUTE_NORMAL 2
+#define GLTF_ATTRIBUTE_TANGENT 3
+#define GLTF_ATTRIBUTE_COUNT 4
+
+struct gltf_buffers
+{
+    i32 Count;
+    u8 *Data[MAX_GLTF_BUFFER_COUNT];
+    size_t Sizes[MAX_GLTF_BUFFER_COUNT];
+};
+
+struct gltf_vertex_stream
+{
+    // NOTE: 0 if the primitive doesn't have this attribute
+    const u8 *Data;
+    size_t Size;
+    i32 Count;
+    i32 ComponentCount;
+    // NOTE: GL_FLOAT, GL_UNSIGNED_SHORT, etc.
+    u32 ComponentType;
+    bool IsNormalized;
+    i32 Stride;
+};
+
+struct gltf_primitive
+{
+    i32 VertexCount;
+    gltf_vertex_stream Attributes[GLTF_ATTRIBUTE_COUNT];
+    gltf_vertex_stream Indices;
+    // NOTE: Only set when the file has no tangents
+    f32 *GeneratedTangents;
+};
+
+// NOTE: Everything a model needs between the CPU stage (any thread) and the GL stage
+//       (GL thread, one texture or mesh per UploadModelLoadDataStep call)
+struct model_load_mesh
+{
+    mesh_internal_data InternalData;
+    // NOTE: True when InternalData is on the heap (OBJ meshes); otherwise it's in the load's Arena
+    //       or points into CookedFile
+    bool OwnsInternalData;
+    // NOTE: Into model_load_data::Textures, -1 if the material has no texture of that type
+    i32 TextureIndices[COOKED_MATERIAL_TEXTURE_COUNT];
+
+    // NOTE: Set instead of InternalData for meshes read by the native glTF reader; generated
+    //       tangents are in the load's Arena
+    bool IsGLTFPrimitive;
+    gltf_primitive GLTFPrimitive;
+};
+
+struct model_load_data
+{
+    char Path[MAX_PATH_LENGTH];
+    bool IsSkinned;
+    bool GenerateMipmap;
+    bool KeepCPUData;
+
+    // NOTE: Arena lives as long as the load data (load meshes, vertex data waiting for the upload,
+    //       decoded textures' bookkeeping); ModelArena is handed over to the model with what the
+    //       model keeps (UploadedMeshes, CPUMeshes, Bones, Animations)
+    memory_arena Arena;
+    memory_arena ModelArena;
+
+    mapped_file CookedFile;
+    // NOTE: glTF/GLB file and its buffers; kept mapped until the meshes are uploaded
+    i32 SourceFileCount;
+    mapped_file SourceFiles[MAX_GLTF_BUFFER_COUNT + 1];
+
+    i32 MeshCount;
+    model_load_mesh *Meshes;
+    mesh *UploadedMeshes;
+    i32 UploadedMeshCount;
+    // NOTE: Only with KeepCPUData; filled in as the meshes are uploaded
+    mesh_cpu_data *CPUMeshes;
+
+    i32 TextureCount;
+    texture_data *Textures;
+    u32 *TextureIDs;
+    i32 UploadedTextureCount;
+
+    i32 BoneCount;
+    bone *Bones;
+    // NOTE: Computed from the meshes' bone weights once they're read
+    bone_bounds *BoneBounds;
+    i32 AnimationCount;
+    animation *Animations;
+    i32 ChannelCount;
+};
+
+// NOTE: Uploaded mesh buffers and animation keys, keyed by a hash of their contents, so identical
+//       meshes and clips in different models (or in one model loaded twice) share one copy.
+//
+//       Open addressing with linear probing, like the file hash cache; ContentHash 0 is an empty
+//       slot. An entry whose last user is freed keeps its ContentHash with RefCount 0, so probes
+//       go on past it, and is reused by the next new entry on its probe path; the table is
+//       rebuilt without those when it fills up. A hash match alone is never trusted: the layout
+//       and then the bytes themselves have to compare equal too.
+enum shared_mesh_format
+{
+    SHARED_MESH_STATIC = 1,
+    SHARED_MESH_SKINNED,
+    SHARED_MESH_GLTF,
+};
+
+#define SHARED_MESH_STREAM_LAYOUT_COUNT 5
+
+// NOTE: Everything about a mesh's buffers besides their bytes. No padding, compared with memcmp.
+struct shared_mesh_layout
+{
+    u32 Format;
+    i32 VertexCount;
+    i32 IndexCount;
+    u32 IndexType;
+    u64 VertexDataSize;
+    u64 IndexDataSize;
+    // NOTE: glTF primitives only: count, component count, component type, normalized and stride of
+    //       each attribute stream
+    u32 Streams[GLTF_ATTRIBUTE_COUNT][SHARED_MESH_STREAM_LAYOUT_COUNT];
+};
+
+struct shared_mesh_entry
+{
+    u64 ContentHash;
+    i32 RefCount;
+    shared_mesh_layout Layout;
+    // NOTE: Buffers, index info and bounds; the texture IDs belong to each model's own mesh
+    mesh Mesh;
+};
+
+struct shared_clip_entry
+{
+    u64 ContentHash;
+    i32 RefCount;
+    i32 KeyCount;
+    i32 ChannelCount;
+    f32 *KeyTimes;
+    animation_key *Keys;
+};
+
+struct shared_model_data
+{
+    // NOTE: Power of two slot counts; the used slots include the ones with RefCount 0
+    u32 MeshSlotCount;
+    u32 MeshUsedSlotCount;
+    shared_mesh_entry *MeshSlots;
+
+    u32 ClipSlotCount;
+    u32 ClipUsedSlotCount;
+    shared_clip_entry *ClipSlots;
+};
+
+static shared_model_data SharedModelData;
+
+// NOTE: Every static mesh VAO's instance attributes point into the stream buffer; this is where
+//       the last UploadMeshInstances put its transforms
+static stream_allocation MeshInstanceAllocation;
+
 // ------------------------------
 // INTERNAL FUNCTION DECLARATIONS
 // ------------------------------
@@ -29,7 +215,7 @@ ASSIMP_GetArmatureInfo(aiNode *RootNode, aiNode **Out_ArmatureNode, i32 *Out_Bon
 static void
 ASSIMP_GetArmatureInfoHelper(aiNode *Node, aiNode **Out_ArmatureNode, i32 *Out_BoneCount);
 static bone *
-ASSIMP_ParseBones(aiNode *ArmatureNode, i32 BoneCount);
+ASSIMP_ParseBones(aiNode *ArmatureNode, i32 BoneCount, memory_arena *Arena);
 static void
 ASSIMP_ParseMeshVertexIndexData(aiMesh *AssimpMesh, mesh_internal_data *Out_InternalData);
 static void
@@ -46,26 +232,160 @@ static void
 ASSIMP_GetTextureFilename(aiMaterial *AssimpMaterial, aiTextureType TextureType,
                                char *Out_Filename, i32 *Out_FilenameCount,
                                i32 FilenameBufferSize);
+static void
+ASSIMP_ParseMaterial(aiMaterial *AssimpMaterial, cooked_material *Out_Material);
+static bool
+ASSIMP_PrepareModelLoadData(model_load_data *LoadData);
+
+// glTF helpers
+// ------------
+
+static bool
+GLTF_PrepareModelLoadData(model_load_data *LoadData);
+static bool
+GLTF_ReadPrimitive(json_document *JSON, i32 PrimitiveToken, gltf_buffers *Buffers, memory_arena *Arena,
+                   gltf_primitive *Out_Primitive);
+static bool
+GLTF_ReadAccessor(json_document *JSON, i32 AccessorIndex, gltf_buffers *Buffers, gltf_vertex_stream *Out_Stream);
+static void
+GLTF_ParseMaterial(json_document *JSON, i32 MaterialIndex, cooked_material *Out_Material);
+static bool
+GLTF_GetURIPath(json_document *JSON, i32 URIToken, const char *ModelPath, char *Out_Path, i32 PathBufferSize);
+static i32
+GLTF_DecodeURI(char *URI);
+static void
+GLTF_GenerateTangents(gltf_primitive *Primitive, memory_arena *Arena);
+static void
+GLTF_PrepareMeshRenderData(gltf_primitive *Primitive, mesh *Out_Mesh);
+static inline i32
+GLTF_GetComponentSize(u32 ComponentType);
+static inline void
+GLTF_ReadFloats(gltf_vertex_stream *Stream, i32 Element, f32 *Out_Values, i32 ValueCount);
+static inline u32
+GLTF_ReadIndex(gltf_vertex_stream *Indices, i32 Index);
 
-// Mesh data prep
-// --------------
+// OBJ helpers
+// -----------
+
+static bool
+OBJ_PrepareModelLoadData(model_load_data *LoadData);
+static bool
+OBJ_CookModel(obj_model *OBJModel, const char *SourcePath, const char *CookedPath,
+              cook_dependencies *Dependencies);
 
+// Cooked model helpers
+// --------------------
+
+static void
+COOKED_PrepareModelLoadData(model_load_data *LoadData);
+static bool
+COOKED_MapModel(const char *SourcePath, mapped_file *Out_MappedFile);
+static bool
+COOKED_MapCookedFile(const char *CookedPath, const char *SourcePath, mapped_file *Out_MappedFile);
+static cooked_model_header *
+COOKED_GetValidatedHeader(mapped_file *MappedFile);
+static inline bool
+COOKED_IsRangeInFile(mapped_file *MappedFile, u64 Offset, u64 Size);
 static mesh_internal_data
-InitializeMeshInternalData(i32 VertexCount, i32 IndexCount, bool IncludeBones);
+COOKED_GetMeshInternalData(u8 *FileData, cooked_mesh *CookedMesh, bool IncludeBones);
+static bool
+COOKED_WriteBlock(FILE *File, const void *Data, size_t Size, size_t Alignment,
+                  u64 *FileCursor, u64 *Out_Offset);
+static void
+COOKED_HashMaterialTextures(const char *SourcePath, cooked_material *Material, cook_dependencies *Dependencies);
+static bool
+COOKED_WriteDependencies(FILE *File, const char *SourcePath, cook_dependencies *Dependencies,
+                         cooked_model_header *Header, u64 *FileCursor);
+static bool
+COOKED_IsUpToDate(mapped_file *MappedFile, const char *SourcePath);
+static void
+COOKED_GetFileStamp(const char *Path, u64 *Out_Size, u64 *Out_ModificationTime);
+static void
+COOKED_AddSourceDependencies(const char *SourcePath, cook_dependencies *Dependencies);
+static void
+COOKED_AddGLTFDependencies(const char *SourcePath, const char *JSON, size_t JSONSize,
+                           cook_dependencies *Dependencies);
 static void
-FreeMeshInternalData(mesh_internal_data *MeshInternalData);
+COOKED_AddOBJDependencies(const char *SourcePath, const char *Source, size_t SourceSize,
+                          cook_dependencies *Dependencies);
+static void
+COOKED_AddRelativeDependency(const char *SourcePath, const char *RelativePath, i32 RelativePathCount,
+                             cook_dependencies *Dependencies);
+
+// Mesh data prep
+// --------------
+
 static void
 PrepareMeshRenderData(mesh_internal_data MeshInternalData, mesh *Out_Mesh);
 static void
 PrepareSkinnedMeshRenderData(mesh_internal_data MeshInternalData, mesh *Out_Mesh);
 static void
-LoadTexturesForMesh(mesh *Mesh, const char *ModelPath, aiMaterial *AssimpMaterial, bool GenerateMipmap);
+ComputeMeshTextureDensity(const f32 *Positions, const f32 *UVs, i32 VertexCount,
+                          const i32 *Indices, i32 IndexCount, mesh *Out_Mesh);
+static void
+GLTF_ComputeMeshTextureDensity(gltf_primitive *Primitive, mesh *Out_Mesh);
+static void
+ComputeBoneBounds(model_load_data *LoadData);
+static void
+InitializeModelLoadMeshes(model_load_data *LoadData, i32 MeshCount);
+static void
+ResetModelLoadData(model_load_data *LoadData);
+static void
+FreeMeshList(mesh *Meshes, i32 MeshCount);
+static void
+CopyMeshCPUData(model_load_mesh *LoadMesh, memory_arena *Arena, bool IncludeAttributes,
+                mesh_cpu_data *Out_CPUData);
+static void
+LayOutMeshInternalData(u8 *Data, i32 VertexCount, i32 IndexCount, bool IncludeBones,
+                       mesh_internal_data *Out_InternalData);
+static size_t
+GetMeshInternalDataSize(i32 VertexCount, i32 IndexCount, bool IncludeBones);
+static void
+DecodeTexturesForMesh(model_load_data *LoadData, model_load_mesh *LoadMesh, cooked_material *Material);
+static bool
+GetMaterialTexturePath(const char *ModelPath, cooked_material *Material, i32 TextureType,
+                       char *Out_TexturePath, i32 TexturePathBufferSize);
+
+// Shared mesh and clip data
+// -------------------------
+
+static void
+GetSharedMeshLayout(model_load_data *LoadData, model_load_mesh *LoadMesh, shared_mesh_layout *Out_Layout);
+static u64
+HashLoadMesh(shared_mesh_layout *Layout, model_load_mesh *LoadMesh);
+static bool
+AcquireSharedMesh(u64 ContentHash, shared_mesh_layout *Layout, model_load_mesh *LoadMesh, mesh *Out_Mesh);
+static bool
+IsSharedMeshContentEqual(shared_mesh_entry *Entry, model_load_mesh *LoadMesh);
+static void
+AddSharedMesh(u64 ContentHash, shared_mesh_layout *Layout, mesh *Mesh);
+static void
+RebuildSharedMeshTable();
+static void
+ReleaseMeshBuffers(mesh *Mesh);
+static void
+ShareAnimationClip(animation *Animation);
+static void
+RebuildSharedClipTable();
+static void
+ReleaseAnimationClip(animation *Animation);
 
 // Render helpers
 // --------------
 
 static inline void
 RenderMeshList(mesh *Meshes, i32 MeshCount);
+static void
+GetMeshListBounds(mesh *Meshes, i32 MeshCount, glm::vec3 *Out_Min, glm::vec3 *Out_Max);
+static void
+BindMeshTextures(mesh *Mesh);
+static void
+SetupMeshInstanceAttributes();
+static void
+PointMeshInstanceAttributes(size_t InstanceOffset);
+static void
+RequestMeshListTextureMips(mesh *Meshes, i32 MeshCount, glm::mat4 ModelTransform,
+                           glm::vec3 CameraPosition, f32 PixelsPerUnit);
 
 // Render helpers (animation)
 // --------------------------
@@ -82,6 +402,8 @@ static inline animation_key
 GetRestAnimationKeyForBone(bone Bone);
 static inline glm::mat4
 GetTransformationForAnimationKey(animation_key Key);
+static void
+UpdatePoseBounds(skinned_model *Model);
 
 // -----------------------------
 // EXTERNAL FUNCTION DEFINITIONS
@@ -97,129 +419,528 @@ LoadModel(const char *Path, bool GenerateMipmap)
 
     model Model{ };
 
-    const aiScene *AssimpScene = ASSIMP_ImportFile(Path);
+    model_load_data *LoadData = PrepareModelLoadData(Path, false, GenerateMipmap, false);
+    if (LoadData)
+    {
+        while (!UploadModelLoadDataStep(LoadData))
+        {
+        }
+        FinishModelLoad(LoadData, &Model);
+    }
+
+    return Model;
+}
 
-    // Scene mesh data
-    // ---------------
-    Model.MeshCount = AssimpScene->mNumMeshes;
-    // TODO: LEAK
-    Model.Meshes = (mesh *) calloc(1, Model.MeshCount * sizeof(mesh));
-    Assert(Model.Meshes);
+skinned_model
+LoadSkinnedModel(const char *Path, bool GenerateMipmap)
+{
+    printf("Loading skinned model at: %s\n", Path);
+
+    skinned_model Model{ };
 
-    for (i32 MeshIndex = 0; MeshIndex < Model.MeshCount; ++MeshIndex)
+    model_load_data *LoadData = PrepareModelLoadData(Path, true, GenerateMipmap, false);
+    if (LoadData)
     {
-        aiMesh *AssimpMesh = AssimpScene->mMeshes[MeshIndex];
+        while (!UploadModelLoadDataStep(LoadData))
+        {
+        }
+        FinishSkinnedModelLoad(LoadData, &Model);
+    }
+
+    return Model;
+}
 
-        mesh Mesh{ };
+void
+FreeModel(model *Model)
+{
+    FreeMeshList(Model->Meshes, Model->MeshCount);
+    ClearArena(&Model->Arena);
+    *Model = { };
+}
 
-        i32 VertexCount = AssimpMesh->mNumVertices;
-        i32 IndexCount = AssimpMesh->mNumFaces * 3;
-        mesh_internal_data InternalData = InitializeMeshInternalData(VertexCount, IndexCount, false);
+void
+FreeSkinnedModel(skinned_model *Model)
+{
+    FreeMeshList(Model->Meshes, Model->MeshCount);
+    for (i32 AnimationIndex = 0; Model->Animations && AnimationIndex < Model->AnimationCount; ++AnimationIndex)
+    {
+        ReleaseAnimationClip(&Model->Animations[AnimationIndex]);
+    }
+    ClearArena(&Model->Arena);
+    *Model = { };
+}
 
-        ASSIMP_ParseMeshVertexIndexData(AssimpMesh, &InternalData);
+// Staged model loading
+// --------------------
+
+model_load_data *
+PrepareModelLoadData(const char *Path, bool IsSkinned, bool GenerateMipmap, bool KeepCPUData)
+{
+    model_load_data *LoadData = (model_load_data *) calloc(1, sizeof(model_load_data));
+    Assert(LoadData);
+    strncpy_s(LoadData->Path, Path, MAX_PATH_LENGTH - 1);
+    LoadData->IsSkinned = IsSkinned;
+    LoadData->GenerateMipmap = GenerateMipmap;
+    LoadData->KeepCPUData = KeepCPUData;
+
+    // NOTE: Nothing the load puts in the scratch arena outlives it
+    temporary_memory LoadMemory = BeginTemporaryMemory(GetScratchArena());
+
+    // NOTE: Static glTF models are cheap enough to read directly; skinned ones still go through
+    //       the cooked file or assimp
+    if (!IsSkinned && (HasFileExtension(Path, ".gltf") || HasFileExtension(Path, ".glb")))
+    {
+        if (GLTF_PrepareModelLoadData(LoadData))
+        {
+            EndTemporaryMemory(LoadMemory);
+            return LoadData;
+        }
+
+        fprintf(stderr, "Native glTF reader can't load %s, falling back\n", Path);
+        ResetModelLoadData(LoadData);
+    }
 
-        PrepareMeshRenderData(InternalData, &Mesh);
+    if (COOKED_MapModel(Path, &LoadData->CookedFile))
+    {
+        cooked_model_header *Header = (cooked_model_header *) LoadData->CookedFile.Data;
+        if (!IsSkinned || (Header->Flags & COOKED_MODEL_FLAG_SKINNED))
+        {
+            COOKED_PrepareModelLoadData(LoadData);
+            EndTemporaryMemory(LoadMemory);
+            return LoadData;
+        }
 
-        FreeMeshInternalData(&InternalData);
+        UnmapFile(&LoadData->CookedFile);
+    }
 
-        LoadTexturesForMesh(&Mesh, Path, AssimpScene->mMaterials[AssimpMesh->mMaterialIndex], GenerateMipmap);
+    if (!IsSkinned && (HasFileExtension(Path, ".obj") || HasFileExtension(Path, ".objm")))
+    {
+        if (OBJ_PrepareModelLoadData(LoadData))
+        {
+            EndTemporaryMemory(LoadMemory);
+            return LoadData;
+        }
 
-        Model.Meshes[MeshIndex] = Mesh;
+        ResetModelLoadData(LoadData);
     }
 
-    // Done with assimp data, free
-    // ---------------------------
-    aiReleaseImport(AssimpScene);
+    fprintf(stderr, "No valid cooked %smodel for %s, importing with assimp\n", IsSkinned ? "skinned " : "", Path);
 
-    return Model;
+    if (!ASSIMP_PrepareModelLoadData(LoadData))
+    {
+        EndTemporaryMemory(LoadMemory);
+        FreeModelLoadData(LoadData);
+        return 0;
+    }
+
+    EndTemporaryMemory(LoadMemory);
+
+    return LoadData;
 }
 
-skinned_model
-LoadSkinnedModel(const char *Path, bool GenerateMipmap)
+bool
+UploadModelLoadDataStep(model_load_data *LoadData)
 {
-    printf("Loading skinned model at: %s\n", Path);
+    // NOTE: Textures first, so a mesh gets its texture IDs as soon as it's uploaded
+    if (LoadData->UploadedTextureCount < LoadData->TextureCount)
+    {
+        i32 TextureIndex = LoadData->UploadedTextureCount++;
+        texture_data *TextureData = &LoadData->Textures[TextureIndex];
+        if (IsTextureStreamingActive() && !TextureData->Pixels && !TextureData->CompressedFormat)
+        {
+            LoadData->TextureIDs[TextureIndex] = LoadTextureAsync(TextureData->Path, LoadData->GenerateMipmap);
+        }
+        else
+        {
+            LoadData->TextureIDs[TextureIndex] = UploadTexture(TextureData, LoadData->GenerateMipmap);
+        }
+    }
+    else if (LoadData->UploadedMeshCount < LoadData->MeshCount)
+    {
+        i32 MeshIndex = LoadData->UploadedMeshCount++;
+        model_load_mesh *LoadMesh = &LoadData->Meshes[MeshIndex];
+        mesh *Mesh = &LoadData->UploadedMeshes[MeshIndex];
+
+        // NOTE: Hashing is far cheaper than the upload it can save
+        shared_mesh_layout Layout;
+        GetSharedMeshLayout(LoadData, LoadMesh, &Layout);
+        u64 ContentHash = HashLoadMesh(&Layout, LoadMesh);
+        if (!AcquireSharedMesh(ContentHash, &Layout, LoadMesh, Mesh))
+        {
+            if (LoadMesh->IsGLTFPrimitive)
+            {
+                GLTF_PrepareMeshRenderData(&LoadMesh->GLTFPrimitive, Mesh);
+            }
+            else if (LoadData->IsSkinned)
+            {
+                PrepareSkinnedMeshRenderData(LoadMesh->InternalData, Mesh);
+            }
+            else
+            {
+                PrepareMeshRenderData(LoadMesh->InternalData, Mesh);
+            }
+            AddSharedMesh(ContentHash, &Layout, Mesh);
+        }
 
-    skinned_model Model{ };
+        for (i32 TextureType = 0; TextureType < COOKED_MATERIAL_TEXTURE_COUNT; ++TextureType)
+        {
+            i32 TextureIndex = LoadMesh->TextureIndices[TextureType];
+            if (TextureIndex >= 0)
+            {
+                Mesh->TextureIDs[TextureType] = LoadData->TextureIDs[TextureIndex];
+                RetainTexture(Mesh->TextureIDs[TextureType]);
+            }
+        }
 
-    const aiScene *AssimpScene = ASSIMP_ImportFile(Path);
+        if (LoadData->CPUMeshes)
+        {
+            CopyMeshCPUData(LoadMesh, &LoadData->ModelArena, !LoadData->IsSkinned,
+                            &LoadData->CPUMeshes[MeshIndex]);
+        }
 
-    // Scene armature data
-    // -------------------
+        if (LoadMesh->OwnsInternalData)
+        {
+            FreeMeshInternalData(&LoadMesh->InternalData);
+        }
+    }
+
+    return (LoadData->UploadedTextureCount == LoadData->TextureCount &&
+            LoadData->UploadedMeshCount == LoadData->MeshCount);
+}
+
+void
+FinishModelLoad(model_load_data *LoadData, model *Out_Model)
+{
+    Out_Model->MeshCount = LoadData->MeshCount;
+    Out_Model->Meshes = LoadData->UploadedMeshes;
+    LoadData->UploadedMeshes = 0;
+    Out_Model->CPUMeshes = LoadData->CPUMeshes;
+    LoadData->CPUMeshes = 0;
+    Out_Model->Arena = LoadData->ModelArena;
+    LoadData->ModelArena = { };
+
+    FreeModelLoadData(LoadData);
+
+    Out_Model->IsReady = true;
+}
+
+void
+FinishSkinnedModelLoad(model_load_data *LoadData, skinned_model *Out_Model)
+{
+    Out_Model->MeshCount = LoadData->MeshCount;
+    Out_Model->Meshes = LoadData->UploadedMeshes;
+    LoadData->UploadedMeshes = 0;
+    Out_Model->CPUMeshes = LoadData->CPUMeshes;
+    LoadData->CPUMeshes = 0;
+    Out_Model->Arena = LoadData->ModelArena;
+    LoadData->ModelArena = { };
+
+    Out_Model->BoneCount = LoadData->BoneCount;
+    Out_Model->Bones = LoadData->Bones;
+    LoadData->Bones = 0;
+    Out_Model->BoneBounds = LoadData->BoneBounds;
+    LoadData->BoneBounds = 0;
+
+    Out_Model->AnimationCount = LoadData->AnimationCount;
+    Out_Model->Animations = LoadData->Animations;
+    LoadData->Animations = 0;
+    for (i32 AnimationIndex = 0; AnimationIndex < Out_Model->AnimationCount; ++AnimationIndex)
+    {
+        ShareAnimationClip(&Out_Model->Animations[AnimationIndex]);
+    }
+
+    Out_Model->AnimationState.TransientChannelTransformData =
+        PushArray(&Out_Model->Arena, LoadData->ChannelCount, glm::mat4);
+    Out_Model->AnimationState.BonePalette = PushArray(&Out_Model->Arena, Out_Model->BoneCount, glm::mat4);
+    for (i32 BoneIndex = 0; BoneIndex < Out_Model->BoneCount; ++BoneIndex)
+    {
+        Out_Model->AnimationState.BonePalette[BoneIndex] = glm::mat4(1.0f);
+    }
+    UpdatePoseBounds(Out_Model);
+
+    FreeModelLoadData(LoadData);
+
+    Out_Model->IsReady = true;
+}
+
+void
+FreeModelLoadData(model_load_data *LoadData)
+{
+    ResetModelLoadData(LoadData);
+    free(LoadData);
+}
+
+// Model cooking
+// -------------
+
+void
+GetCookedModelPath(const char *SourcePath, char *Out_CookedPath, i32 CookedPathBufferSize)
+{
+    char SourcePathOnStack[MAX_PATH_LENGTH];
+    strncpy_s(SourcePathOnStack, SourcePath, MAX_PATH_LENGTH - 1);
+    char Extension[] = COOKED_MODEL_EXTENSION;
+    CatStrings(SourcePathOnStack, GetNullTerminatedStringLength(SourcePathOnStack),
+               Extension, GetNullTerminatedStringLength(Extension),
+               Out_CookedPath, CookedPathBufferSize);
+}
+
+void
+AddCookDependency(cook_dependencies *Dependencies, const char *Path)
+{
+    for (i32 DependencyIndex = 0; DependencyIndex < Dependencies->Count; ++DependencyIndex)
+    {
+        if (strcmp(Dependencies->Paths[DependencyIndex], Path) == 0)
+        {
+            return;
+        }
+    }
+
+    Assert(Dependencies->Count < MAX_COOK_DEPENDENCY_COUNT);
+    if (Dependencies->Count < MAX_COOK_DEPENDENCY_COUNT)
+    {
+        strncpy_s(Dependencies->Paths[Dependencies->Count++], Path, MAX_PATH_LENGTH - 1);
+    }
+}
+
+bool
+CookModel(const char *SourcePath, const char *CookedPath, cook_dependencies *Out_Dependencies)
+{
+    printf("Cooking model: %s -> %s\n", SourcePath, CookedPath);
+
+    // NOTE: Every file the model is built from besides the source. They're stamped into the
+    //       cooked file, so it's recooked when any of them changes, and the cooker keeps them in
+    //       its manifest.
+    cook_dependencies LocalDependencies;
+    cook_dependencies *Dependencies = Out_Dependencies ? Out_Dependencies : &LocalDependencies;
+    Dependencies->Count = 0;
+    COOKED_AddSourceDependencies(SourcePath, Dependencies);
+
+    // NOTE: OBJs are never skinned, and the native reader is a lot faster on big ones
+    obj_model OBJModel;
+    if ((HasFileExtension(SourcePath, ".obj") || HasFileExtension(SourcePath, ".objm")) &&
+        ParseOBJ(SourcePath, &OBJModel))
+    {
+        bool Success = OBJ_CookModel(&OBJModel, SourcePath, CookedPath, Dependencies);
+        FreeOBJ(&OBJModel);
+        return Success;
+    }
+
+    const aiScene *AssimpScene = ASSIMP_ImportFile(SourcePath);
+    if (!AssimpScene)
+    {
+        return false;
+    }
+
+    // Armature data; only models with an armature and animations are cooked as skinned
+    // --------------------------------------------------------------------------------
     aiNode *ArmatureNode = 0;
     i32 BoneCount = 0;
     ASSIMP_GetArmatureInfo(AssimpScene->mRootNode, &ArmatureNode, &BoneCount);
-    Assert(ArmatureNode);
-    Assert(BoneCount > 0);
-    Model.BoneCount = BoneCount;
-    Model.Bones = ASSIMP_ParseBones(ArmatureNode, BoneCount);
+    bool IsSkinned = (ArmatureNode && AssimpScene->mNumAnimations > 0);
 
-    // Scene mesh data
-    // ---------------
-    Model.MeshCount = AssimpScene->mNumMeshes;
-    // TODO: LEAK
-    Model.Meshes = (mesh *) calloc(1, Model.MeshCount * sizeof(mesh));
-    Assert(Model.Meshes);
+    // NOTE: Bones, tables and one mesh's vertex data at a time
+    memory_arena *Scratch = GetScratchArena();
+    temporary_memory CookMemory = BeginTemporaryMemory(Scratch);
+
+    skinned_model Skeleton{ };
+    if (IsSkinned)
+    {
+        Skeleton.BoneCount = BoneCount;
+        Skeleton.Bones = ASSIMP_ParseBones(ArmatureNode, BoneCount, Scratch);
+    }
+
+    FILE *File = OpenReplacingFile(CookedPath);
+    if (!File)
+    {
+        fprintf(stderr, "Couldn't open cooked model for writing: %s\n", CookedPath);
+        EndTemporaryMemory(CookMemory);
+        aiReleaseImport(AssimpScene);
+        return false;
+    }
 
-    for (i32 MeshIndex = 0; MeshIndex < Model.MeshCount; ++MeshIndex)
+    // Placeholder header, rewritten once all the offsets are known
+    cooked_model_header Header{ };
+    Header.Magic = COOKED_MODEL_MAGIC;
+    Header.Version = COOKED_MODEL_VERSION;
+    Header.Flags = IsSkinned ? COOKED_MODEL_FLAG_SKINNED : 0;
+    Header.MeshCount = AssimpScene->mNumMeshes;
+    Header.MaterialCount = AssimpScene->mNumMaterials;
+    Header.BoneCount = Skeleton.BoneCount;
+    Header.AnimationCount = IsSkinned ? AssimpScene->mNumAnimations : 0;
+
+    u64 FileCursor = 0;
+    u64 IgnoredOffset;
+    bool Success = COOKED_WriteBlock(File, &Header, sizeof(Header), 1, &FileCursor, &IgnoredOffset);
+
+    // Mesh vertex and index blobs
+    // ---------------------------
+    cooked_mesh *CookedMeshes = PushArray(Scratch, Header.MeshCount, cooked_mesh);
+
+    for (i32 MeshIndex = 0; Success && MeshIndex < Header.MeshCount; ++MeshIndex)
     {
         aiMesh *AssimpMesh = AssimpScene->mMeshes[MeshIndex];
-        
-        mesh Mesh{ };
+        cooked_mesh *CookedMesh = &CookedMeshes[MeshIndex];
 
+        temporary_memory MeshMemory = BeginTemporaryMemory(Scratch);
         i32 VertexCount = AssimpMesh->mNumVertices;
         i32 IndexCount = AssimpMesh->mNumFaces * 3;
-        mesh_internal_data InternalData = InitializeMeshInternalData(VertexCount, IndexCount, true);
+        mesh_internal_data InternalData = PushMeshInternalData(Scratch, VertexCount, IndexCount, IsSkinned);
 
         ASSIMP_ParseMeshVertexIndexData(AssimpMesh, &InternalData);
+        if (IsSkinned)
+        {
+            ASSIMP_ParseMeshBoneData(AssimpMesh, &Skeleton, &InternalData);
+        }
 
-        ASSIMP_ParseMeshBoneData(AssimpMesh, &Model, &InternalData);
+        CookedMesh->VertexCount = VertexCount;
+        CookedMesh->IndexCount = IndexCount;
+        CookedMesh->MaterialIndex = AssimpMesh->mMaterialIndex;
+        CookedMesh->VertexDataSize = (u8 *) InternalData.Indices - InternalData.Data;
+        CookedMesh->IndexDataSize = IndexCount * sizeof(i32);
 
-        PrepareSkinnedMeshRenderData(InternalData, &Mesh);
+        Success = (COOKED_WriteBlock(File, InternalData.Data, CookedMesh->VertexDataSize,
+                                     COOKED_MODEL_BLOB_ALIGNMENT, &FileCursor, &CookedMesh->VertexDataOffset) &&
+                   COOKED_WriteBlock(File, InternalData.Indices, CookedMesh->IndexDataSize,
+                                     COOKED_MODEL_BLOB_ALIGNMENT, &FileCursor, &CookedMesh->IndexDataOffset));
 
-        FreeMeshInternalData(&InternalData);
+        EndTemporaryMemory(MeshMemory);
+    }
 
-        LoadTexturesForMesh(&Mesh, Path, AssimpScene->mMaterials[AssimpMesh->mMaterialIndex], GenerateMipmap);
-        
-        Model.Meshes[MeshIndex] = Mesh;
+    // Animation key blobs
+    // -------------------
+    cooked_animation *CookedAnimations = 0;
+    if (Header.AnimationCount > 0)
+    {
+        CookedAnimations = PushArray(Scratch, Header.AnimationCount, cooked_animation);
     }
 
-    // Scene animation data
-    // --------------------
-    Model.AnimationCount = AssimpScene->mNumAnimations;
-    //TODO: LEAK
-    Model.Animations = (animation *) calloc(1, Model.AnimationCount * sizeof(animation));
-    Assert(Model.Animations);
+    for (i32 AnimationIndex = 0; Success && AnimationIndex < Header.AnimationCount; ++AnimationIndex)
+    {
+        animation Animation = ASSIMP_ParseAnimation(AssimpScene->mAnimations[AnimationIndex],
+                                                    Skeleton.Bones, Skeleton.BoneCount);
+        cooked_animation *CookedAnimation = &CookedAnimations[AnimationIndex];
+
+        CookedAnimation->TicksDuration = Animation.TicksDuration;
+        CookedAnimation->TicksPerSecond = Animation.TicksPerSecond;
+        CookedAnimation->KeyCount = Animation.KeyCount;
+        CookedAnimation->ChannelCount = Animation.ChannelCount;
+        strncpy_s(CookedAnimation->Name, Animation.Name, MAX_INTERNAL_NAME_LENGTH - 1);
+
+        Success = (COOKED_WriteBlock(File, Animation.KeyTimes, Animation.KeyCount * sizeof(f32),
+                                     COOKED_MODEL_BLOB_ALIGNMENT, &FileCursor, &CookedAnimation->KeyTimesOffset) &&
+                   COOKED_WriteBlock(File, Animation.Keys,
+                                     Animation.KeyCount * Animation.ChannelCount * sizeof(animation_key),
+                                     COOKED_MODEL_BLOB_ALIGNMENT, &FileCursor, &CookedAnimation->KeysOffset));
+
+        free(Animation.KeyTimes);
+        free(Animation.Keys);
+    }
 
-    i32 ModelAnimationChannelCount = AssimpScene->mAnimations[0]->mNumChannels;
-    for (i32 AnimationIndex = 0; AnimationIndex < Model.AnimationCount; ++AnimationIndex)
+    // Tables
+    // ------
+    cooked_material *CookedMaterials = PushArray(Scratch, Header.MaterialCount, cooked_material);
+    for (i32 MaterialIndex = 0; MaterialIndex < Header.MaterialCount; ++MaterialIndex)
     {
-        aiAnimation *AssimpAnimation = AssimpScene->mAnimations[AnimationIndex];
-        
-        // NOTE: An assumption I'm making: all animations for the same model have the same number of channels
-        Assert(AssimpAnimation->mNumChannels == ModelAnimationChannelCount);
-        
-        Model.Animations[AnimationIndex] = ASSIMP_ParseAnimation(AssimpAnimation, Model.Bones, Model.BoneCount);
+        cooked_material *Material = &CookedMaterials[MaterialIndex];
+        ASSIMP_ParseMaterial(AssimpScene->mMaterials[MaterialIndex], Material);
+        COOKED_HashMaterialTextures(SourcePath, Material, Dependencies);
     }
 
-    // TODO: LEAK
-    Model.AnimationState.TransientChannelTransformData = 
-        (glm::mat4 *) calloc(1, ModelAnimationChannelCount * sizeof(glm::mat4));
-    Assert(Model.AnimationState.TransientChannelTransformData);
+    Success = (Success &&
+               COOKED_WriteBlock(File, CookedMeshes, Header.MeshCount * sizeof(cooked_mesh),
+                                 COOKED_MODEL_TABLE_ALIGNMENT, &FileCursor, &Header.MeshesOffset) &&
+               COOKED_WriteBlock(File, CookedMaterials, Header.MaterialCount * sizeof(cooked_material),
+                                 COOKED_MODEL_TABLE_ALIGNMENT, &FileCursor, &Header.MaterialsOffset) &&
+               COOKED_WriteBlock(File, Skeleton.Bones, Header.BoneCount * sizeof(bone),
+                                 COOKED_MODEL_TABLE_ALIGNMENT, &FileCursor, &Header.BonesOffset) &&
+               COOKED_WriteBlock(File, CookedAnimations, Header.AnimationCount * sizeof(cooked_animation),
+                                 COOKED_MODEL_TABLE_ALIGNMENT, &FileCursor, &Header.AnimationsOffset) &&
+               COOKED_WriteDependencies(File, SourcePath, Dependencies, &Header, &FileCursor));
+
+    // Final header
+    // ------------
+    Header.FileSize = FileCursor;
+    Success = (Success &&
+               fseek(File, 0, SEEK_SET) == 0 &&
+               fwrite(&Header, sizeof(Header), 1, File) == 1);
+
+    Success = CloseReplacingFile(File, CookedPath, Success);
+    if (!Success)
+    {
+        fprintf(stderr, "Failed to write cooked model: %s\n", CookedPath);
+    }
 
-    // Done with assimp data, free
-    // ---------------------------
+    EndTemporaryMemory(CookMemory);
     aiReleaseImport(AssimpScene);
 
-    return Model;
+    return Success;
 }
 
 // Model rendering
 // ---------------
 
 void
-RenderModel(model *Model, u32 Shader)
+RenderModel(model *Model, u32 Shader, glm::mat4 Transform)
+{
+    RenderModelInstanced(Model, Shader, &Transform, 1);
+}
+
+void
+RenderModelInstanced(model *Model, u32 Shader, glm::mat4 *Transforms, i32 InstanceCount)
 {
-    glUseProgram(Shader);
+    if (InstanceCount <= 0)
+    {
+        return;
+    }
+
+    UseShader(Shader);
+
+    memory_arena *Arena = GetFrameArena();
+    temporary_memory InstanceMemory = BeginTemporaryMemory(Arena);
+    mesh_instance *Instances = PushArray(Arena, InstanceCount, mesh_instance);
+    for (i32 InstanceIndex = 0; InstanceIndex < InstanceCount; ++InstanceIndex)
+    {
+        Instances[InstanceIndex] = MakeMeshInstance(Transforms[InstanceIndex]);
+    }
+    bool Uploaded = UploadMeshInstances(Instances, InstanceCount);
+    EndTemporaryMemory(InstanceMemory);
+    if (!Uploaded)
+    {
+        return;
+    }
+
+    if (!Model->IsReady)
+    {
+        RenderMeshInstanced(GetPlaceholderMesh(false), 0, InstanceCount);
+        return;
+    }
+
+    for (i32 MeshIndex = 0; MeshIndex < Model->MeshCount; ++MeshIndex)
+    {
+        RenderMeshInstanced(&Model->Meshes[MeshIndex], 0, InstanceCount);
+    }
+}
+
+void
+RenderSkinnedModel(skinned_model *Model, u32 Shader, f32 DeltaTime)
+{
+    UseShader(Shader);
+
+    uniform_handle BoneTransformsUniform = GetUniformHandle(Shader, "BoneTransforms");
+
+    if (!Model->IsReady)
+    {
+        // NOTE: The skinned placeholder is fully weighted to bone 1, so it's drawn as is
+        glm::mat4 Identity[2] = { glm::mat4(1.0f), glm::mat4(1.0f) };
+        SetUniformMat4F(BoneTransformsUniform, glm::value_ptr(Identity[0]), 2);
+        RenderMeshList(GetPlaceholderMesh(true), 1);
+        return;
+    }
+
+    UpdateSkinnedModelAnimation(Model, DeltaTime);
+
+    // TODO: This should probably use a UBO...
+    SetUniformMat4F(BoneTransformsUniform, glm::value_ptr(Model->AnimationState.BonePalette[0]), Model->BoneCount);
 
     // Render model's meshes
     // ---------------------
@@ -227,9 +948,12 @@ RenderModel(model *Model, u32 Shader)
 }
 
 void
-RenderSkinnedModel(skinned_model *Model, u32 Shader, f32 DeltaTime)
+UpdateSkinnedModelAnimation(skinned_model *Model, f32 DeltaTime)
 {
-    glUseProgram(Shader);
+    if (!Model->IsReady)
+    {
+        return;
+    }
 
     // Process animation transforms
     // ----------------------------
@@ -281,25 +1005,162 @@ RenderSkinnedModel(skinned_model *Model, u32 Shader, f32 DeltaTime)
         Model->AnimationState.TransientChannelTransformData[ChannelIndex] = Transform;
     }
 
-    // Pass the bone transforms to the shader
+    // Build the bone palette
     // Skip bone #0 (DummyBone)
+    glm::mat4 *BonePalette = Model->AnimationState.BonePalette;
     for (i32 BoneIndex = 1; BoneIndex < Model->BoneCount; ++BoneIndex)
     {
         i32 ChannelID = BoneIndex - 1;
         Assert(ChannelID < ChannelCount);
-        glm::mat4 Transform = (Model->AnimationState.TransientChannelTransformData[ChannelID] *
-                               Model->Bones[BoneIndex].InverseBindTransform);
-
-        // TODO: This should probably use a UBO...
-        char LocationStringBuffer[32] = { };
-        // TODO: This is probably very slow...
-        sprintf_s(LocationStringBuffer, "BoneTransforms[%d]", BoneIndex);
-        SetUniformMat4F(Shader, LocationStringBuffer, false, glm::value_ptr(Transform));
+        BonePalette[BoneIndex] = (Model->AnimationState.TransientChannelTransformData[ChannelID] *
+                                  Model->Bones[BoneIndex].InverseBindTransform);
     }
 
-    // Render model's meshes
-    // ---------------------
-    RenderMeshList(Model->Meshes, Model->MeshCount);
+    UpdatePoseBounds(Model);
+}
+
+void
+RenderMesh(mesh *Mesh)
+{
+    BindMeshTextures(Mesh);
+    BindVertexArray(Mesh->VAO);
+    DrawElements(GL_TRIANGLES, Mesh->IndexCount, Mesh->IndexType, 0);
+}
+
+mesh_instance
+MakeMeshInstance(glm::mat4 Transform)
+{
+    mesh_instance Result;
+    Result.Transform = Transform;
+    Result.NormalMatrix = glm::transpose(glm::inverse(glm::mat3(Transform)));
+    return Result;
+}
+
+bool
+UploadMeshInstances(mesh_instance *Instances, i32 InstanceCount)
+{
+    MeshInstanceAllocation = StreamUpload(Instances, InstanceCount * sizeof(mesh_instance), STREAM_USAGE_VERTEX);
+    return (MeshInstanceAllocation.Buffer != 0);
+}
+
+void
+RenderMeshInstanced(mesh *Mesh, i32 FirstInstance, i32 InstanceCount)
+{
+    Assert(MeshInstanceAllocation.Buffer && FirstInstance >= 0 &&
+           (FirstInstance + InstanceCount) * sizeof(mesh_instance) <= MeshInstanceAllocation.Size);
+
+    BindMeshTextures(Mesh);
+    BindVertexArray(Mesh->VAO);
+    // NOTE: No base instance in GL 3.3, so the VAO's instance attributes are pointed at the first
+    //       instance instead
+    PointMeshInstanceAttributes(MeshInstanceAllocation.Offset + FirstInstance * sizeof(mesh_instance));
+    DrawElementsInstanced(GL_TRIANGLES, Mesh->IndexCount, Mesh->IndexType, 0, InstanceCount);
+}
+
+mesh *
+GetPlaceholderMesh(bool IsSkinned)
+{
+    // NOTE: Unit cube standing on the origin with a flat grey texture, created on first use
+    static mesh PlaceholderMeshes[2];
+    static bool IsInitialized = false;
+
+    if (!IsInitialized)
+    {
+        u8 GreyPixel[] = { 128, 128, 128, 255 };
+        u32 GreyTextureID;
+        glGenTextures(1, &GreyTextureID);
+        BindTexture2D(0, GreyTextureID);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, GreyPixel);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        // Normal and tangent per face; bitangent = cross(normal, tangent) keeps the winding CCW
+        glm::vec3 FaceNormals[] = { glm::vec3( 1, 0, 0), glm::vec3(-1, 0, 0), glm::vec3(0,  1, 0),
+                                    glm::vec3( 0,-1, 0), glm::vec3( 0, 0, 1), glm::vec3(0,  0,-1) };
+        glm::vec3 FaceTangents[] = { glm::vec3( 0, 0,-1), glm::vec3( 0, 0, 1), glm::vec3(1,  0, 0),
+                                     glm::vec3( 1, 0, 0), glm::vec3( 1, 0, 0), glm::vec3(-1, 0, 0) };
+        f32 CornerSigns[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+
+        for (i32 SkinnedIndex = 0; SkinnedIndex < 2; ++SkinnedIndex)
+        {
+            bool IncludeBones = (SkinnedIndex == 1);
+            temporary_memory ScratchMemory = BeginTemporaryMemory(GetScratchArena());
+            mesh_internal_data InternalData = PushMeshInternalData(GetScratchArena(), 6 * 4, 6 * 6, IncludeBones);
+
+            for (i32 FaceIndex = 0; FaceIndex < 6; ++FaceIndex)
+            {
+                glm::vec3 Normal = FaceNormals[FaceIndex];
+                glm::vec3 Tangent = FaceTangents[FaceIndex];
+                glm::vec3 Bitangent = glm::cross(Normal, Tangent);
+                glm::vec3 Center = Normal * 0.5f + glm::vec3(0.0f, 0.5f, 0.0f);
+
+                for (i32 CornerIndex = 0; CornerIndex < 4; ++CornerIndex)
+                {
+                    i32 Vertex = FaceIndex * 4 + CornerIndex;
+                    glm::vec3 Position = (Center +
+                                          Tangent * (0.5f * CornerSigns[CornerIndex][0]) +
+                                          Bitangent * (0.5f * CornerSigns[CornerIndex][1]));
+                    memcpy(&InternalData.Positions[Vertex * POSITIONS_PER_VERTEX], &Position[0], sizeof(glm::vec3));
+                    InternalData.UVs[Vertex * UVS_PER_VERTEX + 0] = 0.5f + 0.5f * CornerSigns[CornerIndex][0];
+                    InternalData.UVs[Vertex * UVS_PER_VERTEX + 1] = 0.5f + 0.5f * CornerSigns[CornerIndex][1];
+                    memcpy(&InternalData.Normals[Vertex * NORMALS_PER_VERTEX], &Normal[0], sizeof(glm::vec3));
+                    memcpy(&InternalData.Tangents[Vertex * TANGENTS_PER_VERTEX], &Tangent[0], sizeof(glm::vec3));
+                    memcpy(&InternalData.Bitangents[Vertex * BITANGENTS_PER_VERTEX], &Bitangent[0], sizeof(glm::vec3));
+                    if (IncludeBones)
+                    {
+                        InternalData.BoneIDs[Vertex * MAX_BONES_PER_VERTEX] = 1;
+                        InternalData.BoneWeights[Vertex * MAX_BONES_PER_VERTEX] = 1.0f;
+                    }
+                }
+
+                i32 FaceIndices[] = { 0, 1, 2, 0, 2, 3 };
+                for (i32 Index = 0; Index < 6; ++Index)
+                {
+                    InternalData.Indices[FaceIndex * 6 + Index] = FaceIndex * 4 + FaceIndices[Index];
+                }
+            }
+
+            mesh *Mesh = &PlaceholderMeshes[SkinnedIndex];
+            if (IncludeBones)
+            {
+                PrepareSkinnedMeshRenderData(InternalData, Mesh);
+            }
+            else
+            {
+                PrepareMeshRenderData(InternalData, Mesh);
+            }
+            Mesh->DiffuseMapID = GreyTextureID;
+            Mesh->BoundsMin = glm::vec3(-0.5f, 0.0f, -0.5f);
+            Mesh->BoundsMax = glm::vec3(0.5f, 1.0f, 0.5f);
+            Mesh->BoundsCenter = glm::vec3(0.0f, 0.5f, 0.0f);
+            Mesh->BoundsRadius = 0.8660254f;
+
+            EndTemporaryMemory(ScratchMemory);
+        }
+
+        IsInitialized = true;
+    }
+
+    return &PlaceholderMeshes[IsSkinned ? 1 : 0];
+}
+
+void
+RequestModelTextureMips(model *Model, glm::mat4 ModelTransform, glm::vec3 CameraPosition, f32 PixelsPerUnit)
+{
+    if (Model->IsReady)
+    {
+        RequestMeshListTextureMips(Model->Meshes, Model->MeshCount, ModelTransform, CameraPosition, PixelsPerUnit);
+    }
+}
+
+void
+RequestSkinnedModelTextureMips(skinned_model *Model, glm::mat4 ModelTransform, glm::vec3 CameraPosition,
+                               f32 PixelsPerUnit)
+{
+    if (Model->IsReady)
+    {
+        RequestMeshListTextureMips(Model->Meshes, Model->MeshCount, ModelTransform, CameraPosition, PixelsPerUnit);
+    }
 }
 
 // -----------------------------
@@ -359,15 +1220,13 @@ ASSIMP_GetArmatureInfoHelper(aiNode *Node, aiNode **Out_ArmatureNode, i32 *Out_B
 }
 
 static bone *
-ASSIMP_ParseBones(aiNode *ArmatureNode, i32 BoneCount)
+ASSIMP_ParseBones(aiNode *ArmatureNode, i32 BoneCount, memory_arena *Arena)
 {
     Assert(BoneCount > 0);
     Assert(BoneCount < 128);
 
     i32 CurrentBoneIndex = 0;
-    // TODO: LEAK
-    bone *Bones = (bone *) calloc(1, (BoneCount) * sizeof(bone));
-    Assert(Bones);
+    bone *Bones = PushArray(Arena, BoneCount, bone);
 
     aiNode *NodeQueue[128] = { };
     i32 ParentIDHelperQueue[128] = { };
@@ -537,10 +1396,9 @@ ASSIMP_ParseAnimation(aiAnimation *AssimpAnimation, bone *Bones, i32 BoneCount)
         if (firstChannel)
         {
             KeyCount = AssimpAnimationChannel->mNumPositionKeys;
-            // TODO: LEAK
+            // NOTE: On the heap, since they're handed over to (or replaced by) a shared clip
             AnimationKeyTimes = (f32 *) calloc(1, KeyCount * sizeof(f32));
             Assert(AnimationKeyTimes);
-            // TODO: LEAK
             AnimationKeys = (animation_key *) calloc(1, KeyCount * ChannelCount * sizeof(animation_key));
             Assert(AnimationKeys);
             for (i32 KeyIndex = 0; KeyIndex < KeyCount; ++KeyIndex)
@@ -656,266 +1514,2392 @@ ASSIMP_GetTextureFilename(aiMaterial *AssimpMaterial, aiTextureType TextureType,
     }
 }
 
-static mesh_internal_data
-InitializeMeshInternalData(i32 VertexCount, i32 IndexCount, bool IncludeBones)
+static void
+ASSIMP_ParseMaterial(aiMaterial *AssimpMaterial, cooked_material *Out_Material)
 {
-    // TODO: I think this needs to be reworked
-    mesh_internal_data Result{ };
+    aiTextureType TextureTypes[COOKED_MATERIAL_TEXTURE_COUNT] = {
+        aiTextureType_DIFFUSE, aiTextureType_SPECULAR,
+        aiTextureType_EMISSIVE, aiTextureType_HEIGHT };
 
-    size_t SpaceForBones = 0;
-    if (IncludeBones)
+    for (i32 TextureType = 0; TextureType < COOKED_MATERIAL_TEXTURE_COUNT; ++TextureType)
     {
-        SpaceForBones = MAX_BONES_PER_VERTEX * (sizeof(i32) + sizeof(f32));
+        i32 TextureFilenameCount;
+        ASSIMP_GetTextureFilename(AssimpMaterial, TextureTypes[TextureType],
+                                  Out_Material->TextureFilenames[TextureType], &TextureFilenameCount,
+                                  MAX_FILENAME_LENGTH);
     }
+}
 
-    size_t BytesToAllocate = VertexCount * (POSITIONS_PER_VERTEX * sizeof(f32) +
-                                            UVS_PER_VERTEX * sizeof(f32) +
-                                            NORMALS_PER_VERTEX * sizeof(f32) +
-                                            TANGENTS_PER_VERTEX * sizeof(f32) +
-                                            BITANGENTS_PER_VERTEX * sizeof(f32) +
-                                            SpaceForBones +
-                                            IndexCount * sizeof(i32));
+static void
+COOKED_PrepareModelLoadData(model_load_data *LoadData)
+{
+    u8 *FileData = LoadData->CookedFile.Data;
+    cooked_model_header *Header = (cooked_model_header *) FileData;
+    cooked_mesh *CookedMeshes = (cooked_mesh *) (FileData + Header->MeshesOffset);
+    cooked_material *CookedMaterials = (cooked_material *) (FileData + Header->MaterialsOffset);
+    bool HasBones = (Header->Flags & COOKED_MODEL_FLAG_SKINNED) != 0;
 
-    u8 *Data = (u8 *) calloc(1, BytesToAllocate);
+    // Mesh data
+    // ---------
+    InitializeModelLoadMeshes(LoadData, Header->MeshCount);
 
-    if (Data)
+    for (i32 MeshIndex = 0; MeshIndex < LoadData->MeshCount; ++MeshIndex)
     {
-        Result.Data = Data;
-        Result.VertexCount = VertexCount;
-        Result.IndexCount = IndexCount;
-        Result.Positions = (f32 *) (Data);
-        Result.UVs = (f32 *) (Result.Positions + VertexCount * POSITIONS_PER_VERTEX);
-        Result.Normals = (f32 *) (Result.UVs + VertexCount * UVS_PER_VERTEX);
-        Result.Tangents = (f32 *) (Result.Normals + VertexCount * NORMALS_PER_VERTEX);
-        Result.Bitangents = (f32 *) (Result.Tangents + VertexCount * TANGENTS_PER_VERTEX);
-        if (IncludeBones)
-        {
-            Result.BoneIDs = (i32 *) (Result.Bitangents + VertexCount * BITANGENTS_PER_VERTEX);
-            Result.BoneWeights = (f32 *) (Result.BoneIDs + VertexCount * MAX_BONES_PER_VERTEX);
-            Result.Indices = (i32 *) (Result.BoneWeights + VertexCount * MAX_BONES_PER_VERTEX);
-        }
-        else
-        {
-            Result.BoneIDs = 0;
-            Result.BoneWeights = 0;
-            Result.Indices = (i32 *) (Result.Bitangents + VertexCount * BITANGENTS_PER_VERTEX);
-        }
+        cooked_mesh *CookedMesh = &CookedMeshes[MeshIndex];
+        model_load_mesh *LoadMesh = &LoadData->Meshes[MeshIndex];
+
+        // NOTE: Vertex blob of a skinned model starts with the static layout,
+        //       so it can be drawn as a static model too. The blobs stay in the mapped file
+        //       until they're uploaded.
+        LoadMesh->InternalData = COOKED_GetMeshInternalData(FileData, CookedMesh, HasBones);
+        LoadMesh->OwnsInternalData = false;
+
+        DecodeTexturesForMesh(LoadData, LoadMesh, &CookedMaterials[CookedMesh->MaterialIndex]);
     }
-    else
+
+    if (!LoadData->IsSkinned)
     {
-        // TODO: Logging
+        return;
     }
 
-    return Result;
+    // Armature data
+    // -------------
+    LoadData->BoneCount = Header->BoneCount;
+    LoadData->Bones = PushArray(&LoadData->ModelArena, LoadData->BoneCount, bone);
+    memcpy(LoadData->Bones, FileData + Header->BonesOffset, LoadData->BoneCount * sizeof(bone));
+    ComputeBoneBounds(LoadData);
+
+    // Animation data
+    // --------------
+    cooked_animation *CookedAnimations = (cooked_animation *) (FileData + Header->AnimationsOffset);
+    LoadData->AnimationCount = Header->AnimationCount;
+    Assert(LoadData->AnimationCount > 0);
+    LoadData->Animations = PushArray(&LoadData->ModelArena, LoadData->AnimationCount, animation);
+
+    LoadData->ChannelCount = CookedAnimations[0].ChannelCount;
+    for (i32 AnimationIndex = 0; AnimationIndex < LoadData->AnimationCount; ++AnimationIndex)
+    {
+        cooked_animation *CookedAnimation = &CookedAnimations[AnimationIndex];
+        Assert(CookedAnimation->ChannelCount == LoadData->ChannelCount);
+
+        animation Animation{ };
+        Animation.TicksDuration = CookedAnimation->TicksDuration;
+        Animation.TicksPerSecond = CookedAnimation->TicksPerSecond;
+        Animation.KeyCount = CookedAnimation->KeyCount;
+        Animation.ChannelCount = CookedAnimation->ChannelCount;
+        strncpy_s(Animation.Name, CookedAnimation->Name, MAX_INTERNAL_NAME_LENGTH - 1);
+
+        size_t KeyTimesSize = Animation.KeyCount * sizeof(f32);
+        size_t KeysSize = Animation.KeyCount * Animation.ChannelCount * sizeof(animation_key);
+        // NOTE: On the heap, since they're handed over to (or replaced by) a shared clip
+        Animation.KeyTimes = (f32 *) malloc(KeyTimesSize);
+        Assert(Animation.KeyTimes);
+        memcpy(Animation.KeyTimes, FileData + CookedAnimation->KeyTimesOffset, KeyTimesSize);
+        Animation.Keys = (animation_key *) malloc(KeysSize);
+        Assert(Animation.Keys);
+        memcpy(Animation.Keys, FileData + CookedAnimation->KeysOffset, KeysSize);
+
+        LoadData->Animations[AnimationIndex] = Animation;
+    }
 }
 
-static void
-FreeMeshInternalData(mesh_internal_data *MeshInternalData)
+static bool
+ASSIMP_PrepareModelLoadData(model_load_data *LoadData)
 {
-    free(MeshInternalData->Data);
-    memset(MeshInternalData, 0, sizeof(mesh_internal_data));
-}
+    const aiScene *AssimpScene = ASSIMP_ImportFile(LoadData->Path);
+    if (!AssimpScene)
+    {
+        return false;
+    }
 
-static void
-PrepareMeshRenderData(mesh_internal_data MeshInternalData, mesh *Out_Mesh)
-{
-    u32 VAO;
-    glGenVertexArrays(1, &VAO);
-    u32 VBO;
-    glGenBuffers(1, &VBO);
-    u32 EBO;
-    glGenBuffers(1, &EBO);
+    // Scene armature data
+    // -------------------
+    skinned_model Skeleton{ };
+    if (LoadData->IsSkinned)
+    {
+        aiNode *ArmatureNode = 0;
+        i32 BoneCount = 0;
+        ASSIMP_GetArmatureInfo(AssimpScene->mRootNode, &ArmatureNode, &BoneCount);
+        Assert(ArmatureNode);
+        Assert(BoneCount > 0);
+        Skeleton.BoneCount = BoneCount;
+        Skeleton.Bones = ASSIMP_ParseBones(ArmatureNode, BoneCount, &LoadData->ModelArena);
+    }
 
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    size_t BufferSize = MeshInternalData.VertexCount * (POSITIONS_PER_VERTEX * sizeof(f32) +
-                                                        UVS_PER_VERTEX * sizeof(f32) +
-                                                        NORMALS_PER_VERTEX * sizeof(f32) +
-                                                        TANGENTS_PER_VERTEX * sizeof(f32) +
-                                                        BITANGENTS_PER_VERTEX * sizeof(f32));
-    glBufferData(GL_ARRAY_BUFFER, BufferSize, MeshInternalData.Data, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, MeshInternalData.IndexCount * sizeof(i32), MeshInternalData.Indices, GL_STATIC_DRAW);
+    // Scene mesh data
+    // ---------------
+    InitializeModelLoadMeshes(LoadData, AssimpScene->mNumMeshes);
 
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, POSITIONS_PER_VERTEX, GL_FLOAT, GL_FALSE,
-                          POSITIONS_PER_VERTEX * sizeof(f32),
-                          (void *) ((u8 *) MeshInternalData.Positions - MeshInternalData.Data));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, UVS_PER_VERTEX, GL_FLOAT, GL_FALSE,
-                          UVS_PER_VERTEX * sizeof(f32),
-                          (void *) ((u8 *) MeshInternalData.UVs - MeshInternalData.Data));
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, NORMALS_PER_VERTEX, GL_FLOAT, GL_FALSE,
-                          NORMALS_PER_VERTEX * sizeof(f32),
-                          (void *) ((u8 *) MeshInternalData.Normals - MeshInternalData.Data));
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, TANGENTS_PER_VERTEX, GL_FLOAT, GL_FALSE,
-                          TANGENTS_PER_VERTEX * sizeof(f32),
-                          (void *) ((u8 *) MeshInternalData.Tangents - MeshInternalData.Data));
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, BITANGENTS_PER_VERTEX, GL_FLOAT, GL_FALSE,
-                          BITANGENTS_PER_VERTEX * sizeof(f32),
-                          (void *) ((u8 *) MeshInternalData.Bitangents - MeshInternalData.Data));
+    for (i32 MeshIndex = 0; MeshIndex < LoadData->MeshCount; ++MeshIndex)
+    {
+        aiMesh *AssimpMesh = AssimpScene->mMeshes[MeshIndex];
+        model_load_mesh *LoadMesh = &LoadData->Meshes[MeshIndex];
 
-    glBindVertexArray(0);
+        i32 VertexCount = AssimpMesh->mNumVertices;
+        i32 IndexCount = AssimpMesh->mNumFaces * 3;
+        LoadMesh->InternalData = PushMeshInternalData(&LoadData->Arena, VertexCount, IndexCount, LoadData->IsSkinned);
 
-    Out_Mesh->VAO = VAO;
-    Out_Mesh->IndexCount = MeshInternalData.IndexCount;
-}
+        ASSIMP_ParseMeshVertexIndexData(AssimpMesh, &LoadMesh->InternalData);
+        if (LoadData->IsSkinned)
+        {
+            ASSIMP_ParseMeshBoneData(AssimpMesh, &Skeleton, &LoadMesh->InternalData);
+        }
 
-static void
-PrepareSkinnedMeshRenderData(mesh_internal_data MeshInternalData, mesh *Out_Mesh)
-{
-    u32 VAO;
-    glGenVertexArrays(1, &VAO);
-    u32 VBO;
-    glGenBuffers(1, &VBO);
-    u32 EBO;
-    glGenBuffers(1, &EBO);
+        cooked_material Material;
+        ASSIMP_ParseMaterial(AssimpScene->mMaterials[AssimpMesh->mMaterialIndex], &Material);
+        DecodeTexturesForMesh(LoadData, LoadMesh, &Material);
+    }
 
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    size_t BufferSize = MeshInternalData.VertexCount * (POSITIONS_PER_VERTEX * sizeof(f32) +
-                                                        UVS_PER_VERTEX * sizeof(f32) +
-                                                        NORMALS_PER_VERTEX * sizeof(f32) +
-                                                        TANGENTS_PER_VERTEX * sizeof(f32) +
-                                                        BITANGENTS_PER_VERTEX * sizeof(f32) +
-                                                        MAX_BONES_PER_VERTEX * sizeof(i32) +
-                                                        MAX_BONES_PER_VERTEX * sizeof(f32));
-    glBufferData(GL_ARRAY_BUFFER, BufferSize, MeshInternalData.Data, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, MeshInternalData.IndexCount * sizeof(i32), MeshInternalData.Indices, GL_STATIC_DRAW);
-    
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, POSITIONS_PER_VERTEX, GL_FLOAT, GL_FALSE,
-                          POSITIONS_PER_VERTEX * sizeof(f32),
-                          (void *) ((u8 *) MeshInternalData.Positions - MeshInternalData.Data));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, UVS_PER_VERTEX, GL_FLOAT, GL_FALSE,
-                          UVS_PER_VERTEX * sizeof(f32),
-                          (void *) ((u8 *) MeshInternalData.UVs - MeshInternalData.Data));
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, NORMALS_PER_VERTEX, GL_FLOAT, GL_FALSE,
-                          NORMALS_PER_VERTEX * sizeof(f32),
-                          (void *) ((u8 *) MeshInternalData.Normals - MeshInternalData.Data));
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, TANGENTS_PER_VERTEX, GL_FLOAT, GL_FALSE,
-                          TANGENTS_PER_VERTEX * sizeof(f32),
-                          (void *) ((u8 *) MeshInternalData.Tangents - MeshInternalData.Data));
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, BITANGENTS_PER_VERTEX, GL_FLOAT, GL_FALSE,
-                          BITANGENTS_PER_VERTEX * sizeof(f32),
-                          (void *) ((u8 *) MeshInternalData.Bitangents - MeshInternalData.Data));
-    glEnableVertexAttribArray(5);
-    glVertexAttribIPointer(5, MAX_BONES_PER_VERTEX, GL_INT,
-                           MAX_BONES_PER_VERTEX * sizeof(i32),
-                           (void *) ((u8 *) MeshInternalData.BoneIDs - MeshInternalData.Data));
-    glEnableVertexAttribArray(6);
-    glVertexAttribPointer(6, MAX_BONES_PER_VERTEX, GL_FLOAT, GL_FALSE,
-                          MAX_BONES_PER_VERTEX * sizeof(f32),
-                          (void *) ((u8 *) MeshInternalData.BoneWeights - MeshInternalData.Data));
+    // Scene animation data
+    // --------------------
+    if (LoadData->IsSkinned)
+    {
+        LoadData->BoneCount = Skeleton.BoneCount;
+        LoadData->Bones = Skeleton.Bones;
+        ComputeBoneBounds(LoadData);
 
-    glBindVertexArray(0);
+        LoadData->AnimationCount = AssimpScene->mNumAnimations;
+        LoadData->Animations = PushArray(&LoadData->ModelArena, LoadData->AnimationCount, animation);
 
-    Out_Mesh->VAO = VAO;
-    Out_Mesh->IndexCount = MeshInternalData.IndexCount;
+        LoadData->ChannelCount = AssimpScene->mAnimations[0]->mNumChannels;
+        for (i32 AnimationIndex = 0; AnimationIndex < LoadData->AnimationCount; ++AnimationIndex)
+        {
+            aiAnimation *AssimpAnimation = AssimpScene->mAnimations[AnimationIndex];
+
+            // NOTE: An assumption I'm making: all animations for the same model have the same number of channels
+            Assert(AssimpAnimation->mNumChannels == LoadData->ChannelCount);
+
+            LoadData->Animations[AnimationIndex] = ASSIMP_ParseAnimation(AssimpAnimation,
+                                                                         LoadData->Bones, LoadData->BoneCount);
+        }
+    }
+
+    // Done with assimp data, free
+    // ---------------------------
+    aiReleaseImport(AssimpScene);
+
+    return true;
 }
 
-static void
-LoadTexturesForMesh(mesh *Mesh, const char *ModelPath, aiMaterial *AssimpMaterial, bool GenerateMipmap)
+static bool
+GLTF_PrepareModelLoadData(model_load_data *LoadData)
 {
-    char ModelPathOnStack[MAX_PATH_LENGTH];
-    strncpy_s(ModelPathOnStack, ModelPath, MAX_PATH_LENGTH - 1);
-    i32 ModelPathCount = GetNullTerminatedStringLength(ModelPathOnStack);
-    char ModelDirectory[MAX_PATH_LENGTH];
-    i32 ModelDirectoryCount;
-    GetFileDirectory(ModelPathOnStack, ModelPathCount, ModelDirectory, &ModelDirectoryCount, MAX_PATH_LENGTH);
+    mapped_file *SourceFile = &LoadData->SourceFiles[LoadData->SourceFileCount];
+    if (!MapFileReadOnly(LoadData->Path, SourceFile))
+    {
+        return false;
+    }
+    ++LoadData->SourceFileCount;
 
-    aiTextureType TextureTypes[] = { 
-        aiTextureType_DIFFUSE, aiTextureType_SPECULAR,
-        aiTextureType_EMISSIVE, aiTextureType_HEIGHT };
+    // JSON chunk (and BIN chunk for GLB)
+    // ----------------------------------
+    const char *JSONText = (const char *) SourceFile->Data;
+    size_t JSONSize = SourceFile->Size;
+    u8 *BinaryChunk = 0;
+    size_t BinaryChunkSize = 0;
 
-    char TextureFilename[MAX_FILENAME_LENGTH]; i32 TextureFilenameCount;
-    char TexturePath[MAX_PATH_LENGTH];
-    for (i32 TextureType = 0; TextureType < 4; ++TextureType)
+    if (HasFileExtension(LoadData->Path, ".glb"))
     {
-        ASSIMP_GetTextureFilename(AssimpMaterial, TextureTypes[TextureType],
-                                  TextureFilename, &TextureFilenameCount, MAX_FILENAME_LENGTH);
+        // NOTE: 12 byte header (magic, version, length), then chunks of (length, type, data)
+        u32 GLBHeader[5];
+        if (SourceFile->Size < sizeof(GLBHeader))
+        {
+            return false;
+        }
+        memcpy(GLBHeader, SourceFile->Data, sizeof(GLBHeader));
+        if (GLBHeader[0] != GLTF_GLB_MAGIC || GLBHeader[1] != 2 || GLBHeader[4] != GLTF_GLB_CHUNK_JSON ||
+            GLBHeader[3] > SourceFile->Size - sizeof(GLBHeader))
+        {
+            return false;
+        }
 
-        TexturePath[0] = '\0';
+        JSONText = (const char *) SourceFile->Data + sizeof(GLBHeader);
+        JSONSize = GLBHeader[3];
 
-        if (TextureFilenameCount > 0)
+        size_t BinaryChunkOffset = sizeof(GLBHeader) + JSONSize;
+        u32 BinaryChunkHeader[2];
+        if (BinaryChunkOffset + sizeof(BinaryChunkHeader) <= SourceFile->Size)
         {
-            CatStrings(ModelDirectory, ModelDirectoryCount,
-                       TextureFilename, TextureFilenameCount,
-                       TexturePath, MAX_PATH_LENGTH);
-            Mesh->TextureIDs[TextureType] = LoadTexture(TexturePath, GenerateMipmap);
+            memcpy(BinaryChunkHeader, SourceFile->Data + BinaryChunkOffset, sizeof(BinaryChunkHeader));
+            if (BinaryChunkHeader[1] == GLTF_GLB_CHUNK_BIN &&
+                BinaryChunkHeader[0] <= SourceFile->Size - BinaryChunkOffset - sizeof(BinaryChunkHeader))
+            {
+                BinaryChunk = SourceFile->Data + BinaryChunkOffset + sizeof(BinaryChunkHeader);
+                BinaryChunkSize = BinaryChunkHeader[0];
+            }
         }
     }
-}
 
-static inline void
-RenderMeshList(mesh *Meshes, i32 MeshCount)
-{
-    for (i32 MeshIndex = 0; MeshIndex < (i32) MeshCount; ++MeshIndex)
+    json_document JSON;
+    if (!ParseJSON(JSONText, JSONSize, &JSON))
     {
-        mesh *Mesh = &Meshes[MeshIndex];
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, Mesh->DiffuseMapID);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, Mesh->SpecularMapID);
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, Mesh->EmissionMapID);
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, Mesh->NormalMapID);
-
-        glBindVertexArray(Mesh->VAO);
-        glDrawElements(GL_TRIANGLES, Mesh->IndexCount, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        fprintf(stderr, "Couldn't parse glTF JSON: %s\n", LoadData->Path);
+        return false;
     }
-}
 
-static inline void
-UpdateAnimationState(animation *Animation, f32 DeltaTime)
-{
-    // Update current animation time to the beginning of the game loop
-    Animation->CurrentTicks += DeltaTime * Animation->TicksPerSecond;
+    bool Success = true;
 
-    // Loop animation around if past end
-    if (Animation->CurrentTicks >= Animation->TicksDuration)
+    // Buffers; mapped, never copied
+    // -----------------------------
+    gltf_buffers Buffers{ };
+    i32 BuffersToken = GetJSONMember(&JSON, 0, "buffers");
+    Buffers.Count = GetJSONChildCount(&JSON, BuffersToken);
+    if (Buffers.Count > MAX_GLTF_BUFFER_COUNT)
     {
-        Animation->CurrentTicks -= Animation->TicksDuration;
+        Success = false;
     }
-}
-
-static inline i32
-FindNextAnimationKey(animation *Animation)
-{
-    i32 Result = -1;
 
-    for (i32 KeyIndex = 1; KeyIndex < Animation->KeyCount; KeyIndex++)
+    for (i32 BufferIndex = 0; Success && BufferIndex < Buffers.Count; ++BufferIndex)
     {
-        if (Animation->CurrentTicks <= Animation->KeyTimes[KeyIndex])
+        i32 BufferToken = GetJSONElement(&JSON, BuffersToken, BufferIndex);
+        i32 ByteLength = GetJSONInt(&JSON, GetJSONMember(&JSON, BufferToken, "byteLength"), -1);
+        i32 URIToken = GetJSONMember(&JSON, BufferToken, "uri");
+
+        if (URIToken < 0)
         {
-            Result = KeyIndex;
-            break;
+            // NOTE: Only the first buffer of a GLB may leave out its uri; it's the BIN chunk
+            Buffers.Data[BufferIndex] = BinaryChunk;
+            Buffers.Sizes[BufferIndex] = BinaryChunkSize;
+        }
+        else
+        {
+            char BufferPath[MAX_PATH_LENGTH];
+            mapped_file *BufferFile = &LoadData->SourceFiles[LoadData->SourceFileCount];
+            // NOTE: Embedded data: URIs are left to assimp
+            if (GLTF_GetURIPath(&JSON, URIToken, LoadData->Path, BufferPath, MAX_PATH_LENGTH) &&
+                MapFileReadOnly(BufferPath, BufferFile))
+            {
+                ++LoadData->SourceFileCount;
+                Buffers.Data[BufferIndex] = BufferFile->Data;
+                Buffers.Sizes[BufferIndex] = BufferFile->Size;
+            }
         }
-    }
-    Assert(Result >= 1 && Result < Animation->KeyCount);
 
-    return Result;
-}
+        if (!Buffers.Data[BufferIndex] || ByteLength < 0 || (size_t) ByteLength > Buffers.Sizes[BufferIndex])
+        {
+            Success = false;
+        }
+    }
+
+    // Primitives; each one is a mesh, same as assimp does it
+    // ------------------------------------------------------
+    i32 MeshesToken = GetJSONMember(&JSON, 0, "meshes");
+    i32 PrimitiveCount = 0;
+    for (i32 MeshIndex = 0; MeshIndex < GetJSONChildCount(&JSON, MeshesToken); ++MeshIndex)
+    {
+        i32 PrimitivesToken = GetJSONMember(&JSON, GetJSONElement(&JSON, MeshesToken, MeshIndex), "primitives");
+        PrimitiveCount += GetJSONChildCount(&JSON, PrimitivesToken);
+    }
+
+    if (Success && PrimitiveCount > 0)
+    {
+        InitializeModelLoadMeshes(LoadData, PrimitiveCount);
+    }
+    else
+    {
+        Success = false;
+    }
+
+    i32 LoadMeshIndex = 0;
+    for (i32 MeshIndex = 0; Success && MeshIndex < GetJSONChildCount(&JSON, MeshesToken); ++MeshIndex)
+    {
+        i32 PrimitivesToken = GetJSONMember(&JSON, GetJSONElement(&JSON, MeshesToken, MeshIndex), "primitives");
+        for (i32 PrimitiveIndex = 0; Success && PrimitiveIndex < GetJSONChildCount(&JSON, PrimitivesToken); ++PrimitiveIndex)
+        {
+            i32 PrimitiveToken = GetJSONElement(&JSON, PrimitivesToken, PrimitiveIndex);
+            model_load_mesh *LoadMesh = &LoadData->Meshes[LoadMeshIndex++];
+            LoadMesh->IsGLTFPrimitive = true;
+
+            Success = GLTF_ReadPrimitive(&JSON, PrimitiveToken, &Buffers, &LoadData->Arena, &LoadMesh->GLTFPrimitive);
+            if (Success)
+            {
+                cooked_material Material;
+                GLTF_ParseMaterial(&JSON, GetJSONInt(&JSON, GetJSONMember(&JSON, PrimitiveToken, "material"), -1),
+                                   &Material);
+                DecodeTexturesForMesh(LoadData, LoadMesh, &Material);
+            }
+        }
+    }
+
+    FreeJSON(&JSON);
+
+    return Success;
+}
+
+static bool
+GLTF_ReadPrimitive(json_document *JSON, i32 PrimitiveToken, gltf_buffers *Buffers, memory_arena *Arena,
+                   gltf_primitive *Out_Primitive)
+{
+    *Out_Primitive = { };
+
+    // NOTE: Triangle lists only (mode 4 is the default)
+    if (GetJSONInt(JSON, GetJSONMember(JSON, PrimitiveToken, "mode"), 4) != 4)
+    {
+        return false;
+    }
+
+    i32 AttributesToken = GetJSONMember(JSON, PrimitiveToken, "attributes");
+    i32 IndicesAccessor = GetJSONInt(JSON, GetJSONMember(JSON, PrimitiveToken, "indices"), -1);
+
+    // NOTE: Same order as the shader attribute locations
+    const char *AttributeNames[GLTF_ATTRIBUTE_COUNT] = { "POSITION", "TEXCOORD_0", "NORMAL", "TANGENT" };
+    i32 AttributeComponentCounts[GLTF_ATTRIBUTE_COUNT] = { POSITIONS_PER_VERTEX, UVS_PER_VERTEX, NORMALS_PER_VERTEX, 4 };
+
+    for (i32 AttributeIndex = 0; AttributeIndex < GLTF_ATTRIBUTE_COUNT; ++AttributeIndex)
+    {
+        i32 Accessor = GetJSONInt(JSON, GetJSONMember(JSON, AttributesToken, AttributeNames[AttributeIndex]), -1);
+        if (Accessor < 0)
+        {
+            continue;
+        }
+
+        gltf_vertex_stream *Stream = &Out_Primitive->Attributes[AttributeIndex];
+        if (!GLTF_ReadAccessor(JSON, Accessor, Buffers, Stream) ||
+            Stream->ComponentCount != AttributeComponentCounts[AttributeIndex])
+        {
+            return false;
+        }
+
+        // NOTE: Positions, normals and tangents are always float; UVs may also be normalized integers
+        bool IsFloat = (Stream->ComponentType == GL_FLOAT);
+        bool IsNormalizedUV = (AttributeIndex == GLTF_ATTRIBUTE_UV && Stream->IsNormalized &&
+                               (Stream->ComponentType == GL_UNSIGNED_BYTE ||
+                                Stream->ComponentType == GL_UNSIGNED_SHORT));
+        if (!IsFloat && !IsNormalizedUV)
+        {
+            return false;
+        }
+    }
+
+    gltf_vertex_stream *Positions = &Out_Primitive->Attributes[GLTF_ATTRIBUTE_POSITION];
+    gltf_vertex_stream *Normals = &Out_Primitive->Attributes[GLTF_ATTRIBUTE_NORMAL];
+    if (!Positions->Data || !Normals->Data || IndicesAccessor < 0)
+    {
+        return false;
+    }
+
+    Out_Primitive->VertexCount = Positions->Count;
+    for (i32 AttributeIndex = 0; AttributeIndex < GLTF_ATTRIBUTE_COUNT; ++AttributeIndex)
+    {
+        gltf_vertex_stream *Stream = &Out_Primitive->Attributes[AttributeIndex];
+        if (Stream->Data && Stream->Count != Out_Primitive->VertexCount)
+        {
+            return false;
+        }
+    }
+
+    // Indices
+    // -------
+    gltf_vertex_stream *Indices = &Out_Primitive->Indices;
+    if (!GLTF_ReadAccessor(JSON, IndicesAccessor, Buffers, Indices) ||
+        Indices->ComponentCount != 1 || Indices->Count % 3 != 0 ||
+        Indices->Stride != GLTF_GetComponentSize(Indices->ComponentType) ||
+        (Indices->ComponentType != GL_UNSIGNED_BYTE &&
+         Indices->ComponentType != GL_UNSIGNED_SHORT &&
+         Indices->ComponentType != GL_UNSIGNED_INT))
+    {
+        return false;
+    }
+
+    for (i32 Index = 0; Index < Indices->Count; ++Index)
+    {
+        if (GLTF_ReadIndex(Indices, Index) >= (u32) Out_Primitive->VertexCount)
+        {
+            return false;
+        }
+    }
+
+    // Tangents; the only attribute that's generated when it's missing
+    // ---------------------------------------------------------------
+    if (!Out_Primitive->Attributes[GLTF_ATTRIBUTE_TANGENT].Data)
+    {
+        GLTF_GenerateTangents(Out_Primitive, Arena);
+    }
+
+    return true;
+}
+
+static bool
+GLTF_ReadAccessor(json_document *JSON, i32 AccessorIndex, gltf_buffers *Buffers, gltf_vertex_stream *Out_Stream)
+{
+    *Out_Stream = { };
+
+    i32 AccessorToken = GetJSONElement(JSON, GetJSONMember(JSON, 0, "accessors"), AccessorIndex);
+    if (AccessorToken < 0 || GetJSONMember(JSON, AccessorToken, "sparse") >= 0)
+    {
+        return false;
+    }
+
+    i32 BufferViewIndex = GetJSONInt(JSON, GetJSONMember(JSON, AccessorToken, "bufferView"), -1);
+    i32 BufferViewToken = GetJSONElement(JSON, GetJSONMember(JSON, 0, "bufferViews"), BufferViewIndex);
+    if (BufferViewToken < 0)
+    {
+        return false;
+    }
+
+    i32 TypeToken = GetJSONMember(JSON, AccessorToken, "type");
+    if (IsJSONString(JSON, TypeToken, "SCALAR")) Out_Stream->ComponentCount = 1;
+    else if (IsJSONString(JSON, TypeToken, "VEC2")) Out_Stream->ComponentCount = 2;
+    else if (IsJSONString(JSON, TypeToken, "VEC3")) Out_Stream->ComponentCount = 3;
+    else if (IsJSONString(JSON, TypeToken, "VEC4")) Out_Stream->ComponentCount = 4;
+    else return false;
+
+    // NOTE: glTF component types are the GL enums
+    Out_Stream->ComponentType = (u32) GetJSONInt(JSON, GetJSONMember(JSON, AccessorToken, "componentType"), 0);
+    Out_Stream->IsNormalized = GetJSONBool(JSON, GetJSONMember(JSON, AccessorToken, "normalized"), false);
+    Out_Stream->Count = GetJSONInt(JSON, GetJSONMember(JSON, AccessorToken, "count"), 0);
+    i32 ComponentSize = GLTF_GetComponentSize(Out_Stream->ComponentType);
+    if (ComponentSize == 0 || Out_Stream->Count <= 0)
+    {
+        return false;
+    }
+
+    i32 BufferIndex = GetJSONInt(JSON, GetJSONMember(JSON, BufferViewToken, "buffer"), -1);
+    i64 ViewOffset = GetJSONInt(JSON, GetJSONMember(JSON, BufferViewToken, "byteOffset"), 0);
+    i64 ViewLength = GetJSONInt(JSON, GetJSONMember(JSON, BufferViewToken, "byteLength"), -1);
+    i64 AccessorOffset = GetJSONInt(JSON, GetJSONMember(JSON, AccessorToken, "byteOffset"), 0);
+    i32 ElementSize = Out_Stream->ComponentCount * ComponentSize;
+    Out_Stream->Stride = GetJSONInt(JSON, GetJSONMember(JSON, BufferViewToken, "byteStride"), ElementSize);
+
+    if (BufferIndex < 0 || BufferIndex >= Buffers->Count ||
+        ViewOffset < 0 || ViewLength < 0 || AccessorOffset < 0 || Out_Stream->Stride < ElementSize ||
+        (u64) (ViewOffset + ViewLength) > Buffers->Sizes[BufferIndex])
+    {
+        return false;
+    }
+
+    Out_Stream->Size = (size_t) (Out_Stream->Count - 1) * Out_Stream->Stride + ElementSize;
+    if ((u64) AccessorOffset + Out_Stream->Size > (u64) ViewLength)
+    {
+        return false;
+    }
+
+    Out_Stream->Data = Buffers->Data[BufferIndex] + ViewOffset + AccessorOffset;
+
+    return true;
+}
+
+static void
+GLTF_ParseMaterial(json_document *JSON, i32 MaterialIndex, cooked_material *Out_Material)
+{
+    *Out_Material = { };
+
+    i32 MaterialToken = GetJSONElement(JSON, GetJSONMember(JSON, 0, "materials"), MaterialIndex);
+    if (MaterialToken < 0)
+    {
+        return;
+    }
+
+    // NOTE: Same slots assimp fills in; glTF core has no specular texture
+    i32 PBRToken = GetJSONMember(JSON, MaterialToken, "pbrMetallicRoughness");
+    i32 TextureInfoTokens[COOKED_MATERIAL_TEXTURE_COUNT] =
+    {
+        GetJSONMember(JSON, PBRToken, "baseColorTexture"),
+        -1,
+        GetJSONMember(JSON, MaterialToken, "emissiveTexture"),
+        GetJSONMember(JSON, MaterialToken, "normalTexture"),
+    };
+
+    for (i32 TextureType = 0; TextureType < COOKED_MATERIAL_TEXTURE_COUNT; ++TextureType)
+    {
+        i32 TextureIndex = GetJSONInt(JSON, GetJSONMember(JSON, TextureInfoTokens[TextureType], "index"), -1);
+        i32 TextureToken = GetJSONElement(JSON, GetJSONMember(JSON, 0, "textures"), TextureIndex);
+        i32 ImageIndex = GetJSONInt(JSON, GetJSONMember(JSON, TextureToken, "source"), -1);
+        i32 ImageToken = GetJSONElement(JSON, GetJSONMember(JSON, 0, "images"), ImageIndex);
+        i32 URIToken = GetJSONMember(JSON, ImageToken, "uri");
+
+        char Filename[MAX_PATH_LENGTH];
+        if (CopyJSONString(JSON, URIToken, Filename, MAX_PATH_LENGTH) &&
+            strncmp(Filename, "data:", 5) != 0 &&
+            GLTF_DecodeURI(Filename) < MAX_FILENAME_LENGTH)
+        {
+            strncpy_s(Out_Material->TextureFilenames[TextureType], Filename, MAX_FILENAME_LENGTH - 1);
+        }
+    }
+}
+
+static bool
+GLTF_GetURIPath(json_document *JSON, i32 URIToken, const char *ModelPath, char *Out_Path, i32 PathBufferSize)
+{
+    char URI[MAX_PATH_LENGTH];
+    if (!CopyJSONString(JSON, URIToken, URI, MAX_PATH_LENGTH) || strncmp(URI, "data:", 5) == 0)
+    {
+        return false;
+    }
+    i32 URICount = GLTF_DecodeURI(URI);
+
+    char ModelPathOnStack[MAX_PATH_LENGTH];
+    strncpy_s(ModelPathOnStack, ModelPath, MAX_PATH_LENGTH - 1);
+    char ModelDirectory[MAX_PATH_LENGTH];
+    i32 ModelDirectoryCount;
+    GetFileDirectory(ModelPathOnStack, GetNullTerminatedStringLength(ModelPathOnStack),
+                     ModelDirectory, &ModelDirectoryCount, MAX_PATH_LENGTH);
+
+    if (ModelDirectoryCount + URICount >= PathBufferSize)
+    {
+        return false;
+    }
+    CatStrings(ModelDirectory, ModelDirectoryCount, URI, URICount, Out_Path, PathBufferSize);
+
+    return true;
+}
+
+static i32
+GLTF_DecodeURI(char *URI)
+{
+    // NOTE: In place; URIs are percent-encoded (e.g. spaces are %20)
+    i32 OutCount = 0;
+    for (i32 Cursor = 0; URI[Cursor]; ++Cursor)
+    {
+        char Char = URI[Cursor];
+        if (Char == '%' && isxdigit((u8) URI[Cursor + 1]) && isxdigit((u8) URI[Cursor + 2]))
+        {
+            char Hex[3] = { URI[Cursor + 1], URI[Cursor + 2], '\0' };
+            Char = (char) strtol(Hex, 0, 16);
+            Cursor += 2;
+        }
+        URI[OutCount++] = Char;
+    }
+    URI[OutCount] = '\0';
+
+    return OutCount;
+}
+
+static void
+GLTF_GenerateTangents(gltf_primitive *Primitive, memory_arena *Arena)
+{
+    i32 VertexCount = Primitive->VertexCount;
+    gltf_vertex_stream *Positions = &Primitive->Attributes[GLTF_ATTRIBUTE_POSITION];
+    gltf_vertex_stream *UVs = &Primitive->Attributes[GLTF_ATTRIBUTE_UV];
+    gltf_vertex_stream *Normals = &Primitive->Attributes[GLTF_ATTRIBUTE_NORMAL];
+    gltf_vertex_stream *Indices = &Primitive->Indices;
+
+    // NOTE: Kept in Arena until the upload, which reads them as the tangent stream
+    Primitive->GeneratedTangents = PushArray(Arena, VertexCount * 4, f32);
+    temporary_memory ScratchMemory = BeginTemporaryMemory(GetScratchArena());
+    glm::vec3 *Accumulated = PushArray(GetScratchArena(), VertexCount * 2, glm::vec3);
+    glm::vec3 *AccumulatedTangents = Accumulated;
+    glm::vec3 *AccumulatedBitangents = Accumulated + VertexCount;
+
+    // Per-triangle tangents from UV gradients, summed per vertex
+    // ----------------------------------------------------------
+    if (UVs->Data)
+    {
+        for (i32 Index = 0; Index < Indices->Count; Index += 3)
+        {
+            u32 Vertices[3];
+            glm::vec3 P[3];
+            glm::vec2 UV[3];
+            for (i32 Corner = 0; Corner < 3; ++Corner)
+            {
+                Vertices[Corner] = GLTF_ReadIndex(Indices, Index + Corner);
+                GLTF_ReadFloats(Positions, Vertices[Corner], &P[Corner][0], 3);
+                GLTF_ReadFloats(UVs, Vertices[Corner], &UV[Corner][0], 2);
+            }
+
+            glm::vec3 Edge1 = P[1] - P[0];
+            glm::vec3 Edge2 = P[2] - P[0];
+            glm::vec2 DeltaUV1 = UV[1] - UV[0];
+            glm::vec2 DeltaUV2 = UV[2] - UV[0];
+            f32 Determinant = DeltaUV1.x * DeltaUV2.y - DeltaUV2.x * DeltaUV1.y;
+            if (fabsf(Determinant) < 1e-12f)
+            {
+                continue;
+            }
+
+            f32 InverseDeterminant = 1.0f / Determinant;
+            glm::vec3 Tangent = (Edge1 * DeltaUV2.y - Edge2 * DeltaUV1.y) * InverseDeterminant;
+            glm::vec3 Bitangent = (Edge2 * DeltaUV1.x - Edge1 * DeltaUV2.x) * InverseDeterminant;
+            for (i32 Corner = 0; Corner < 3; ++Corner)
+            {
+                AccumulatedTangents[Vertices[Corner]] += Tangent;
+                AccumulatedBitangents[Vertices[Corner]] += Bitangent;
+            }
+        }
+    }
+
+    // Orthogonalize against the normal; w is the bitangent sign, as in glTF
+    // ---------------------------------------------------------------------
+    for (i32 Vertex = 0; Vertex < VertexCount; ++Vertex)
+    {
+        glm::vec3 Normal;
+        GLTF_ReadFloats(Normals, Vertex, &Normal[0], 3);
+
+        glm::vec3 Tangent = AccumulatedTangents[Vertex] - Normal * glm::dot(Normal, AccumulatedTangents[Vertex]);
+        if (glm::dot(Tangent, Tangent) < 1e-12f)
+        {
+            // NOTE: No UVs or degenerate UVs; any direction perpendicular to the normal will do
+            glm::vec3 Axis = (fabsf(Normal.x) > 0.9f) ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+            Tangent = glm::cross(Normal, Axis);
+        }
+        Tangent = glm::normalize(Tangent);
+        f32 Handedness = (glm::dot(glm::cross(Normal, Tangent), AccumulatedBitangents[Vertex]) < 0.0f) ? -1.0f : 1.0f;
+
+        f32 *Out = &Primitive->GeneratedTangents[Vertex * 4];
+        Out[0] = Tangent.x;
+        Out[1] = Tangent.y;
+        Out[2] = Tangent.z;
+        Out[3] = Handedness;
+    }
+
+    EndTemporaryMemory(ScratchMemory);
+
+    gltf_vertex_stream *Tangents = &Primitive->Attributes[GLTF_ATTRIBUTE_TANGENT];
+    Tangents->Data = (u8 *) Primitive->GeneratedTangents;
+    Tangents->Size = VertexCount * 4 * sizeof(f32);
+    Tangents->Count = VertexCount;
+    Tangents->ComponentCount = 4;
+    Tangents->ComponentType = GL_FLOAT;
+    Tangents->IsNormalized = false;
+    Tangents->Stride = 4 * sizeof(f32);
+}
+
+static inline i32
+GLTF_GetComponentSize(u32 ComponentType)
+{
+    switch (ComponentType)
+    {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE: return 1;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT: return 2;
+        case GL_UNSIGNED_INT:
+        case GL_FLOAT: return 4;
+        default: return 0;
+    }
+}
+
+static inline void
+GLTF_ReadFloats(gltf_vertex_stream *Stream, i32 Element, f32 *Out_Values, i32 ValueCount)
+{
+    const u8 *ElementData = Stream->Data + (size_t) Element * Stream->Stride;
+    for (i32 ValueIndex = 0; ValueIndex < ValueCount; ++ValueIndex)
+    {
+        if (Stream->ComponentType == GL_FLOAT)
+        {
+            memcpy(&Out_Values[ValueIndex], ElementData + ValueIndex * sizeof(f32), sizeof(f32));
+        }
+        else if (Stream->ComponentType == GL_UNSIGNED_SHORT)
+        {
+            u16 Value;
+            memcpy(&Value, ElementData + ValueIndex * sizeof(u16), sizeof(u16));
+            Out_Values[ValueIndex] = Value / 65535.0f;
+        }
+        else
+        {
+            Out_Values[ValueIndex] = ElementData[ValueIndex] / 255.0f;
+        }
+    }
+}
+
+static inline u32
+GLTF_ReadIndex(gltf_vertex_stream *Indices, i32 Index)
+{
+    const u8 *IndexData = Indices->Data + (size_t) Index * Indices->Stride;
+    if (Indices->ComponentType == GL_UNSIGNED_INT)
+    {
+        u32 Value;
+        memcpy(&Value, IndexData, sizeof(u32));
+        return Value;
+    }
+    if (Indices->ComponentType == GL_UNSIGNED_SHORT)
+    {
+        u16 Value;
+        memcpy(&Value, IndexData, sizeof(u16));
+        return Value;
+    }
+    return *IndexData;
+}
+
+static bool
+OBJ_PrepareModelLoadData(model_load_data *LoadData)
+{
+    obj_model OBJModel;
+    if (!ParseOBJ(LoadData->Path, &OBJModel))
+    {
+        return false;
+    }
+
+    InitializeModelLoadMeshes(LoadData, OBJModel.MeshCount);
+    for (i32 MeshIndex = 0; MeshIndex < OBJModel.MeshCount; ++MeshIndex)
+    {
+        obj_mesh *OBJMesh = &OBJModel.Meshes[MeshIndex];
+        model_load_mesh *LoadMesh = &LoadData->Meshes[MeshIndex];
+
+        LoadMesh->InternalData = OBJMesh->InternalData;
+        LoadMesh->OwnsInternalData = true;
+        OBJMesh->InternalData = { };
+
+        DecodeTexturesForMesh(LoadData, LoadMesh, &OBJMesh->Material);
+    }
+
+    FreeOBJ(&OBJModel);
+
+    return true;
+}
+
+static bool
+OBJ_CookModel(obj_model *OBJModel, const char *SourcePath, const char *CookedPath,
+              cook_dependencies *Dependencies)
+{
+    FILE *File = OpenReplacingFile(CookedPath);
+    if (!File)
+    {
+        fprintf(stderr, "Couldn't open cooked model for writing: %s\n", CookedPath);
+        return false;
+    }
+
+    // NOTE: Same layout CookModel writes for a static model; every mesh has its own material
+    cooked_model_header Header{ };
+    Header.Magic = COOKED_MODEL_MAGIC;
+    Header.Version = COOKED_MODEL_VERSION;
+    Header.MeshCount = OBJModel->MeshCount;
+    Header.MaterialCount = OBJModel->MeshCount;
+
+    u64 FileCursor = 0;
+    u64 IgnoredOffset;
+    bool Success = COOKED_WriteBlock(File, &Header, sizeof(Header), 1, &FileCursor, &IgnoredOffset);
+
+    temporary_memory TableMemory = BeginTemporaryMemory(GetScratchArena());
+    cooked_mesh *CookedMeshes = PushArray(GetScratchArena(), Header.MeshCount, cooked_mesh);
+    cooked_material *CookedMaterials = PushArray(GetScratchArena(), Header.MaterialCount, cooked_material);
+
+    for (i32 MeshIndex = 0; Success && MeshIndex < Header.MeshCount; ++MeshIndex)
+    {
+        mesh_internal_data *InternalData = &OBJModel->Meshes[MeshIndex].InternalData;
+        cooked_mesh *CookedMesh = &CookedMeshes[MeshIndex];
+
+        CookedMesh->VertexCount = InternalData->VertexCount;
+        CookedMesh->IndexCount = InternalData->IndexCount;
+        CookedMesh->MaterialIndex = MeshIndex;
+        CookedMesh->VertexDataSize = (u8 *) InternalData->Indices - InternalData->Data;
+        CookedMesh->IndexDataSize = InternalData->IndexCount * sizeof(i32);
+
+        Success = (COOKED_WriteBlock(File, InternalData->Data, CookedMesh->VertexDataSize,
+                                     COOKED_MODEL_BLOB_ALIGNMENT, &FileCursor, &CookedMesh->VertexDataOffset) &&
+                   COOKED_WriteBlock(File, InternalData->Indices, CookedMesh->IndexDataSize,
+                                     COOKED_MODEL_BLOB_ALIGNMENT, &FileCursor, &CookedMesh->IndexDataOffset));
+
+        CookedMaterials[MeshIndex] = OBJModel->Meshes[MeshIndex].Material;
+        COOKED_HashMaterialTextures(SourcePath, &CookedMaterials[MeshIndex], Dependencies);
+    }
+
+    Success = (Success &&
+               COOKED_WriteBlock(File, CookedMeshes, Header.MeshCount * sizeof(cooked_mesh),
+                                 COOKED_MODEL_TABLE_ALIGNMENT, &FileCursor, &Header.MeshesOffset) &&
+               COOKED_WriteBlock(File, CookedMaterials, Header.MaterialCount * sizeof(cooked_material),
+                                 COOKED_MODEL_TABLE_ALIGNMENT, &FileCursor, &Header.MaterialsOffset));
+
+    // NOTE: No bones or animations; their offsets just point at the end of the file
+    Header.BonesOffset = FileCursor;
+    Header.AnimationsOffset = FileCursor;
+    Success = (Success && COOKED_WriteDependencies(File, SourcePath, Dependencies, &Header, &FileCursor));
+    Header.FileSize = FileCursor;
+    Success = (Success &&
+               fseek(File, 0, SEEK_SET) == 0 &&
+               fwrite(&Header, sizeof(Header), 1, File) == 1);
+
+    Success = CloseReplacingFile(File, CookedPath, Success);
+    if (!Success)
+    {
+        fprintf(stderr, "Failed to write cooked model: %s\n", CookedPath);
+    }
+
+    EndTemporaryMemory(TableMemory);
+
+    return Success;
+}
+
+static bool
+COOKED_MapModel(const char *SourcePath, mapped_file *Out_MappedFile)
+{
+    char CookedPath[MAX_PATH_LENGTH];
+    GetCookedModelPath(SourcePath, CookedPath, MAX_PATH_LENGTH);
+
+    if (COOKED_MapCookedFile(CookedPath, SourcePath, Out_MappedFile))
+    {
+        return true;
+    }
+
+#if MODEL_COOK_ON_LOAD
+    // NOTE: Another worker may be cooking the same model; once it's done the cooked file is looked
+    //       at again instead of being cooked twice. Just cooked, it isn't checked against the
+    //       sources again.
+    LockFilePath(CookedPath);
+    bool Success = (COOKED_MapCookedFile(CookedPath, SourcePath, Out_MappedFile) ||
+                    (CookModel(SourcePath, CookedPath, 0) &&
+                     COOKED_MapCookedFile(CookedPath, 0, Out_MappedFile)));
+    UnlockFilePath(CookedPath);
+
+    if (Success)
+    {
+        return true;
+    }
+#endif
+
+    return false;
+}
+
+static bool
+COOKED_MapCookedFile(const char *CookedPath, const char *SourcePath, mapped_file *Out_MappedFile)
+{
+    if (!MapFileReadOnly(CookedPath, Out_MappedFile))
+    {
+        return false;
+    }
+
+    if (COOKED_GetValidatedHeader(Out_MappedFile) &&
+        (!SourcePath || COOKED_IsUpToDate(Out_MappedFile, SourcePath)))
+    {
+        return true;
+    }
+
+    UnmapFile(Out_MappedFile);
+    return false;
+}
+
+static cooked_model_header *
+COOKED_GetValidatedHeader(mapped_file *MappedFile)
+{
+    if (MappedFile->Size < sizeof(cooked_model_header))
+    {
+        return 0;
+    }
+
+    cooked_model_header *Header = (cooked_model_header *) MappedFile->Data;
+    if (Header->Magic != COOKED_MODEL_MAGIC ||
+        Header->Version != COOKED_MODEL_VERSION ||
+        Header->FileSize != MappedFile->Size ||
+        Header->MeshCount < 0 || Header->MaterialCount < 0 ||
+        Header->BoneCount < 0 || Header->AnimationCount < 0 || Header->DependencyCount < 1)
+    {
+        return 0;
+    }
+
+    if (!COOKED_IsRangeInFile(MappedFile, Header->MeshesOffset, Header->MeshCount * sizeof(cooked_mesh)) ||
+        !COOKED_IsRangeInFile(MappedFile, Header->MaterialsOffset, Header->MaterialCount * sizeof(cooked_material)) ||
+        !COOKED_IsRangeInFile(MappedFile, Header->BonesOffset, Header->BoneCount * sizeof(bone)) ||
+        !COOKED_IsRangeInFile(MappedFile, Header->AnimationsOffset, Header->AnimationCount * sizeof(cooked_animation)) ||
+        !COOKED_IsRangeInFile(MappedFile, Header->DependenciesOffset, Header->DependencyCount * sizeof(cooked_dependency)))
+    {
+        return 0;
+    }
+
+    cooked_dependency *Dependencies = (cooked_dependency *) (MappedFile->Data + Header->DependenciesOffset);
+    for (i32 DependencyIndex = 0; DependencyIndex < Header->DependencyCount; ++DependencyIndex)
+    {
+        if (!memchr(Dependencies[DependencyIndex].Path, '\0', MAX_PATH_LENGTH))
+        {
+            return 0;
+        }
+    }
+
+    // NOTE: The blobs' sizes have to be what their counts say, since the mesh data's pointers are
+    //       laid out from the counts (COOKED_GetMeshInternalData), and every index has to name a
+    //       vertex: a truncated or corrupt file is rejected here rather than read out of bounds
+    bool HasBones = (Header->Flags & COOKED_MODEL_FLAG_SKINNED) != 0;
+    cooked_mesh *CookedMeshes = (cooked_mesh *) (MappedFile->Data + Header->MeshesOffset);
+    for (i32 MeshIndex = 0; MeshIndex < Header->MeshCount; ++MeshIndex)
+    {
+        cooked_mesh *CookedMesh = &CookedMeshes[MeshIndex];
+        if (CookedMesh->VertexCount < 0 || CookedMesh->IndexCount < 0 ||
+            CookedMesh->VertexDataSize != GetMeshInternalDataSize(CookedMesh->VertexCount, 0, HasBones) ||
+            CookedMesh->IndexDataSize != (u64) CookedMesh->IndexCount * sizeof(i32) ||
+            !COOKED_IsRangeInFile(MappedFile, CookedMesh->VertexDataOffset, CookedMesh->VertexDataSize) ||
+            !COOKED_IsRangeInFile(MappedFile, CookedMesh->IndexDataOffset, CookedMesh->IndexDataSize) ||
+            CookedMesh->MaterialIndex < 0 || CookedMesh->MaterialIndex >= Header->MaterialCount)
+        {
+            return 0;
+        }
+
+        i32 *Indices = (i32 *) (MappedFile->Data + CookedMesh->IndexDataOffset);
+        for (i32 Index = 0; Index < CookedMesh->IndexCount; ++Index)
+        {
+            if (Indices[Index] < 0 || Indices[Index] >= CookedMesh->VertexCount)
+            {
+                return 0;
+            }
+        }
+    }
+
+    bone *Bones = (bone *) (MappedFile->Data + Header->BonesOffset);
+    for (i32 BoneIndex = 0; BoneIndex < Header->BoneCount; ++BoneIndex)
+    {
+        bone *Bone = &Bones[BoneIndex];
+        if (Bone->ParentID < 0 || Bone->ParentID >= Header->BoneCount ||
+            Bone->ChildrenCount < 0 || Bone->ChildrenCount > MAX_BONE_CHILDREN)
+        {
+            return 0;
+        }
+        for (i32 ChildIndex = 0; ChildIndex < Bone->ChildrenCount; ++ChildIndex)
+        {
+            if (Bone->ChildrenIDs[ChildIndex] < 0 || Bone->ChildrenIDs[ChildIndex] >= Header->BoneCount)
+            {
+                return 0;
+            }
+        }
+    }
+
+    // NOTE: Channels drive bones 1 and up, and every clip has to drive the same ones
+    cooked_animation *CookedAnimations = (cooked_animation *) (MappedFile->Data + Header->AnimationsOffset);
+    for (i32 AnimationIndex = 0; AnimationIndex < Header->AnimationCount; ++AnimationIndex)
+    {
+        cooked_animation *CookedAnimation = &CookedAnimations[AnimationIndex];
+        if (CookedAnimation->KeyCount < 0 || CookedAnimation->ChannelCount < 0 ||
+            CookedAnimation->ChannelCount > Header->BoneCount ||
+            CookedAnimation->ChannelCount != CookedAnimations[0].ChannelCount)
+        {
+            return 0;
+        }
+
+        u64 KeysSize = (u64) CookedAnimation->KeyCount * CookedAnimation->ChannelCount * sizeof(animation_key);
+        if (!COOKED_IsRangeInFile(MappedFile, CookedAnimation->KeyTimesOffset, CookedAnimation->KeyCount * sizeof(f32)) ||
+            !COOKED_IsRangeInFile(MappedFile, CookedAnimation->KeysOffset, KeysSize))
+        {
+            return 0;
+        }
+    }
+
+    return Header;
+}
+
+static inline bool
+COOKED_IsRangeInFile(mapped_file *MappedFile, u64 Offset, u64 Size)
+{
+    return (Offset <= MappedFile->Size && Size <= MappedFile->Size - Offset);
+}
+
+static mesh_internal_data
+COOKED_GetMeshInternalData(u8 *FileData, cooked_mesh *CookedMesh, bool IncludeBones)
+{
+    // NOTE: Same planar layout as InitializeMeshInternalData, but pointing into the mapped file
+    mesh_internal_data Result{ };
+
+    i32 VertexCount = CookedMesh->VertexCount;
+
+    Result.Data = FileData + CookedMesh->VertexDataOffset;
+    Result.VertexCount = VertexCount;
+    Result.IndexCount = CookedMesh->IndexCount;
+    Result.Positions = (f32 *) (Result.Data);
+    Result.UVs = (f32 *) (Result.Positions + VertexCount * POSITIONS_PER_VERTEX);
+    Result.Normals = (f32 *) (Result.UVs + VertexCount * UVS_PER_VERTEX);
+    Result.Tangents = (f32 *) (Result.Normals + VertexCount * NORMALS_PER_VERTEX);
+    Result.Bitangents = (f32 *) (Result.Tangents + VertexCount * TANGENTS_PER_VERTEX);
+    if (IncludeBones)
+    {
+        Result.BoneIDs = (i32 *) (Result.Bitangents + VertexCount * BITANGENTS_PER_VERTEX);
+        Result.BoneWeights = (f32 *) (Result.BoneIDs + VertexCount * MAX_BONES_PER_VERTEX);
+    }
+    Result.Indices = (i32 *) (FileData + CookedMesh->IndexDataOffset);
+
+    return Result;
+}
+
+static bool
+COOKED_WriteBlock(FILE *File, const void *Data, size_t Size, size_t Alignment,
+                  u64 *FileCursor, u64 *Out_Offset)
+{
+    static const u8 Padding[COOKED_MODEL_BLOB_ALIGNMENT] = { };
+    Assert(Alignment <= COOKED_MODEL_BLOB_ALIGNMENT);
+
+    size_t PaddingSize = (size_t) ((Alignment - (*FileCursor % Alignment)) % Alignment);
+    if (PaddingSize > 0 && fwrite(Padding, PaddingSize, 1, File) != 1)
+    {
+        return false;
+    }
+    *FileCursor += PaddingSize;
+
+    *Out_Offset = *FileCursor;
+    if (Size > 0 && fwrite(Data, Size, 1, File) != 1)
+    {
+        return false;
+    }
+    *FileCursor += Size;
+
+    return true;
+}
+
+static void
+COOKED_HashMaterialTextures(const char *SourcePath, cooked_material *Material, cook_dependencies *Dependencies)
+{
+    // NOTE: Texture contents are part of the cooked model, so editing a texture recooks the model
+    char TexturePath[MAX_PATH_LENGTH];
+    for (i32 TextureType = 0; TextureType < COOKED_MATERIAL_TEXTURE_COUNT; ++TextureType)
+    {
+        if (GetMaterialTexturePath(SourcePath, Material, TextureType, TexturePath, MAX_PATH_LENGTH))
+        {
+            Material->TextureContentHashes[TextureType] = HashFile64(TexturePath);
+            AddCookDependency(Dependencies, TexturePath);
+        }
+    }
+}
+
+static bool
+COOKED_WriteDependencies(FILE *File, const char *SourcePath, cook_dependencies *Dependencies,
+                         cooked_model_header *Header, u64 *FileCursor)
+{
+    Header->DependencyCount = Dependencies->Count + 1;
+
+    bool Success = true;
+    for (i32 DependencyIndex = 0; Success && DependencyIndex < Header->DependencyCount; ++DependencyIndex)
+    {
+        const char *Path = (DependencyIndex == 0) ? SourcePath : Dependencies->Paths[DependencyIndex - 1];
+
+        cooked_dependency Dependency{ };
+        strncpy_s(Dependency.Path, Path, MAX_PATH_LENGTH - 1);
+        COOKED_GetFileStamp(Path, &Dependency.Size, &Dependency.ModificationTime);
+
+        // NOTE: The entries are a multiple of the table alignment, so only the first one is padded
+        u64 Offset;
+        Success = COOKED_WriteBlock(File, &Dependency, sizeof(Dependency),
+                                    (DependencyIndex == 0) ? COOKED_MODEL_TABLE_ALIGNMENT : 1,
+                                    FileCursor, &Offset);
+        if (DependencyIndex == 0)
+        {
+            Header->DependenciesOffset = Offset;
+        }
+    }
+
+    return Success;
+}
+
+static bool
+COOKED_IsUpToDate(mapped_file *MappedFile, const char *SourcePath)
+{
+    // NOTE: Only the cooked files might have shipped; without the source there's nothing to check
+    if (!FileExists(SourcePath))
+    {
+        return true;
+    }
+
+    cooked_model_header *Header = (cooked_model_header *) MappedFile->Data;
+    cooked_dependency *Dependencies = (cooked_dependency *) (MappedFile->Data + Header->DependenciesOffset);
+    for (i32 DependencyIndex = 0; DependencyIndex < Header->DependencyCount; ++DependencyIndex)
+    {
+        // NOTE: The source is checked under the path it's loaded from now, which can be spelled
+        //       differently from the one it was cooked from
+        const char *Path = (DependencyIndex == 0) ? SourcePath : Dependencies[DependencyIndex].Path;
+
+        u64 Size;
+        u64 ModificationTime;
+        COOKED_GetFileStamp(Path, &Size, &ModificationTime);
+
+        // NOTE: Any difference counts, not just a newer time, so an older file copied over the
+        //       one the model was cooked from recooks it too
+        if (Size != Dependencies[DependencyIndex].Size ||
+            ModificationTime != Dependencies[DependencyIndex].ModificationTime)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void
+COOKED_GetFileStamp(const char *Path, u64 *Out_Size, u64 *Out_ModificationTime)
+{
+    if (!GetFileInfo(Path, Out_Size, Out_ModificationTime))
+    {
+        *Out_Size = 0;
+        *Out_ModificationTime = 0;
+    }
+}
+
+static void
+COOKED_AddSourceDependencies(const char *SourcePath, cook_dependencies *Dependencies)
+{
+    size_t SourceSize;
+    char *Source = ReadFile(SourcePath, &SourceSize);
+    if (!Source)
+    {
+        return;
+    }
+
+    if (HasFileExtension(SourcePath, ".gltf"))
+    {
+        COOKED_AddGLTFDependencies(SourcePath, Source, SourceSize, Dependencies);
+    }
+    else if (HasFileExtension(SourcePath, ".glb"))
+    {
+        // NOTE: GLB: 12 byte header, then the JSON chunk (u32 length, u32 type, data)
+        if (SourceSize >= 20)
+        {
+            u32 JSONSize;
+            memcpy(&JSONSize, Source + 12, sizeof(u32));
+            if ((size_t) JSONSize <= SourceSize - 20)
+            {
+                COOKED_AddGLTFDependencies(SourcePath, Source + 20, JSONSize, Dependencies);
+            }
+        }
+    }
+    else if (HasFileExtension(SourcePath, ".objm") || HasFileExtension(SourcePath, ".obj"))
+    {
+        COOKED_AddOBJDependencies(SourcePath, Source, SourceSize, Dependencies);
+    }
+
+    free(Source);
+}
+
+static void
+COOKED_AddGLTFDependencies(const char *SourcePath, const char *JSON, size_t JSONSize,
+                           cook_dependencies *Dependencies)
+{
+    // NOTE: Every external file in glTF (buffers and images) is referenced by a "uri" string;
+    //       embedded data: URIs have nothing to track
+    const char *Key = "\"uri\"";
+    size_t KeyCount = strlen(Key);
+
+    for (size_t Cursor = 0; Cursor + KeyCount < JSONSize; ++Cursor)
+    {
+        if (memcmp(JSON + Cursor, Key, KeyCount) != 0)
+        {
+            continue;
+        }
+
+        size_t ValueStart = Cursor + KeyCount;
+        while (ValueStart < JSONSize && JSON[ValueStart] != '"')
+        {
+            ++ValueStart;
+        }
+        ++ValueStart;
+
+        size_t ValueEnd = ValueStart;
+        while (ValueEnd < JSONSize && JSON[ValueEnd] != '"')
+        {
+            ++ValueEnd;
+        }
+
+        if (ValueEnd < JSONSize && strncmp(JSON + ValueStart, "data:", 5) != 0)
+        {
+            COOKED_AddRelativeDependency(SourcePath, JSON + ValueStart, (i32) (ValueEnd - ValueStart),
+                                         Dependencies);
+        }
+
+        Cursor = ValueEnd;
+    }
+}
+
+static void
+COOKED_AddOBJDependencies(const char *SourcePath, const char *Source, size_t SourceSize,
+                          cook_dependencies *Dependencies)
+{
+    const char *Key = "mtllib ";
+    size_t KeyCount = strlen(Key);
+
+    size_t LineStart = 0;
+    while (LineStart < SourceSize)
+    {
+        size_t LineEnd = LineStart;
+        while (LineEnd < SourceSize && Source[LineEnd] != '\n' && Source[LineEnd] != '\r')
+        {
+            ++LineEnd;
+        }
+
+        if (LineEnd - LineStart > KeyCount && memcmp(Source + LineStart, Key, KeyCount) == 0)
+        {
+            COOKED_AddRelativeDependency(SourcePath, Source + LineStart + KeyCount,
+                                         (i32) (LineEnd - LineStart - KeyCount), Dependencies);
+        }
+
+        LineStart = LineEnd + 1;
+    }
+}
+
+static void
+COOKED_AddRelativeDependency(const char *SourcePath, const char *RelativePath, i32 RelativePathCount,
+                             cook_dependencies *Dependencies)
+{
+    if (RelativePathCount <= 0 || RelativePathCount >= MAX_PATH_LENGTH)
+    {
+        return;
+    }
+
+    char RelativePathOnStack[MAX_PATH_LENGTH];
+    memcpy(RelativePathOnStack, RelativePath, RelativePathCount);
+    RelativePathOnStack[RelativePathCount] = '\0';
+
+    char SourcePathOnStack[MAX_PATH_LENGTH];
+    strncpy_s(SourcePathOnStack, SourcePath, MAX_PATH_LENGTH - 1);
+    char SourceDirectory[MAX_PATH_LENGTH];
+    i32 SourceDirectoryCount;
+    GetFileDirectory(SourcePathOnStack, GetNullTerminatedStringLength(SourcePathOnStack),
+                     SourceDirectory, &SourceDirectoryCount, MAX_PATH_LENGTH);
+
+    char DependencyPath[MAX_PATH_LENGTH];
+    CatStrings(SourceDirectory, SourceDirectoryCount,
+               RelativePathOnStack, RelativePathCount,
+               DependencyPath, MAX_PATH_LENGTH);
+
+    AddCookDependency(Dependencies, DependencyPath);
+}
+
+mesh_internal_data
+InitializeMeshInternalData(i32 VertexCount, i32 IndexCount, bool IncludeBones)
+{
+    mesh_internal_data Result{ };
+
+    u8 *Data = (u8 *) calloc(1, GetMeshInternalDataSize(VertexCount, IndexCount, IncludeBones));
+    if (Data)
+    {
+        LayOutMeshInternalData(Data, VertexCount, IndexCount, IncludeBones, &Result);
+    }
+    else
+    {
+        // TODO: Logging
+    }
+
+    return Result;
+}
+
+mesh_internal_data
+PushMeshInternalData(memory_arena *Arena, i32 VertexCount, i32 IndexCount, bool IncludeBones)
+{
+    mesh_internal_data Result{ };
+
+    u8 *Data = (u8 *) PushSize(Arena, GetMeshInternalDataSize(VertexCount, IndexCount, IncludeBones), 16);
+    LayOutMeshInternalData(Data, VertexCount, IndexCount, IncludeBones, &Result);
+
+    return Result;
+}
+
+void
+GetModelBounds(model *Model, glm::vec3 *Out_Min, glm::vec3 *Out_Max)
+{
+    if (!Model->IsReady)
+    {
+        GetMeshListBounds(GetPlaceholderMesh(false), 1, Out_Min, Out_Max);
+        return;
+    }
+
+    GetMeshListBounds(Model->Meshes, Model->MeshCount, Out_Min, Out_Max);
+}
+
+void
+GetSkinnedModelBounds(skinned_model *Model, glm::vec3 *Out_Min, glm::vec3 *Out_Max)
+{
+    if (!Model->IsReady)
+    {
+        GetMeshListBounds(GetPlaceholderMesh(true), 1, Out_Min, Out_Max);
+        return;
+    }
+
+    *Out_Min = Model->PoseBoundsMin;
+    *Out_Max = Model->PoseBoundsMax;
+}
+
+void
+FreeMeshInternalData(mesh_internal_data *MeshInternalData)
+{
+    free(MeshInternalData->Data);
+    memset(MeshInternalData, 0, sizeof(mesh_internal_data));
+}
+
+void
+UploadMeshInternalData(mesh_internal_data MeshInternalData, mesh *Out_Mesh)
+{
+    *Out_Mesh = { };
+    PrepareMeshRenderData(MeshInternalData, Out_Mesh);
+}
+
+static void
+PrepareMeshRenderData(mesh_internal_data MeshInternalData, mesh *Out_Mesh)
+{
+    u32 VAO;
+    glGenVertexArrays(1, &VAO);
+    u32 VBO;
+    glGenBuffers(1, &VBO);
+    u32 EBO;
+    glGenBuffers(1, &EBO);
+
+    BindVertexArray(VAO);
+    BindBuffer(GL_ARRAY_BUFFER, VBO);
+    size_t BufferSize = MeshInternalData.VertexCount * (POSITIONS_PER_VERTEX * sizeof(f32) +
+                                                        UVS_PER_VERTEX * sizeof(f32) +
+                                                        NORMALS_PER_VERTEX * sizeof(f32) +
+                                                        TANGENTS_PER_VERTEX * sizeof(f32) +
+                                                        BITANGENTS_PER_VERTEX * sizeof(f32));
+    BufferData(GL_ARRAY_BUFFER, BufferSize, MeshInternalData.Data, GL_STATIC_DRAW);
+    BindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    BufferData(GL_ELEMENT_ARRAY_BUFFER, MeshInternalData.IndexCount * sizeof(i32), MeshInternalData.Indices, GL_STATIC_DRAW);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, POSITIONS_PER_VERTEX, GL_FLOAT, GL_FALSE,
+                          POSITIONS_PER_VERTEX * sizeof(f32),
+                          (void *) ((u8 *) MeshInternalData.Positions - MeshInternalData.Data));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, UVS_PER_VERTEX, GL_FLOAT, GL_FALSE,
+                          UVS_PER_VERTEX * sizeof(f32),
+                          (void *) ((u8 *) MeshInternalData.UVs - MeshInternalData.Data));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, NORMALS_PER_VERTEX, GL_FLOAT, GL_FALSE,
+                          NORMALS_PER_VERTEX * sizeof(f32),
+                          (void *) ((u8 *) MeshInternalData.Normals - MeshInternalData.Data));
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, TANGENTS_PER_VERTEX, GL_FLOAT, GL_FALSE,
+                          TANGENTS_PER_VERTEX * sizeof(f32),
+                          (void *) ((u8 *) MeshInternalData.Tangents - MeshInternalData.Data));
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, BITANGENTS_PER_VERTEX, GL_FLOAT, GL_FALSE,
+                          BITANGENTS_PER_VERTEX * sizeof(f32),
+                          (void *) ((u8 *) MeshInternalData.Bitangents - MeshInternalData.Data));
+    SetupMeshInstanceAttributes();
+
+    BindVertexArray(0);
+
+    Out_Mesh->VAO = VAO;
+    Out_Mesh->VBO = VBO;
+    Out_Mesh->EBO = EBO;
+    Out_Mesh->IndexCount = MeshInternalData.IndexCount;
+    Out_Mesh->IndexType = GL_UNSIGNED_INT;
+
+    ComputeMeshTextureDensity(MeshInternalData.Positions, MeshInternalData.UVs, MeshInternalData.VertexCount,
+                              MeshInternalData.Indices, MeshInternalData.IndexCount, Out_Mesh);
+}
+
+static void
+PrepareSkinnedMeshRenderData(mesh_internal_data MeshInternalData, mesh *Out_Mesh)
+{
+    u32 VAO;
+    glGenVertexArrays(1, &VAO);
+    u32 VBO;
+    glGenBuffers(1, &VBO);
+    u32 EBO;
+    glGenBuffers(1, &EBO);
+
+    BindVertexArray(VAO);
+    BindBuffer(GL_ARRAY_BUFFER, VBO);
+    size_t BufferSize = MeshInternalData.VertexCount * (POSITIONS_PER_VERTEX * sizeof(f32) +
+                                                        UVS_PER_VERTEX * sizeof(f32) +
+                                                        NORMALS_PER_VERTEX * sizeof(f32) +
+                                                        TANGENTS_PER_VERTEX * sizeof(f32) +
+                                                        BITANGENTS_PER_VERTEX * sizeof(f32) +
+                                                        MAX_BONES_PER_VERTEX * sizeof(i32) +
+                                                        MAX_BONES_PER_VERTEX * sizeof(f32));
+    BufferData(GL_ARRAY_BUFFER, BufferSize, MeshInternalData.Data, GL_STATIC_DRAW);
+    BindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    BufferData(GL_ELEMENT_ARRAY_BUFFER, MeshInternalData.IndexCount * sizeof(i32), MeshInternalData.Indices, GL_STATIC_DRAW);
+    
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, POSITIONS_PER_VERTEX, GL_FLOAT, GL_FALSE,
+                          POSITIONS_PER_VERTEX * sizeof(f32),
+                          (void *) ((u8 *) MeshInternalData.Positions - MeshInternalData.Data));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, UVS_PER_VERTEX, GL_FLOAT, GL_FALSE,
+                          UVS_PER_VERTEX * sizeof(f32),
+                          (void *) ((u8 *) MeshInternalData.UVs - MeshInternalData.Data));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, NORMALS_PER_VERTEX, GL_FLOAT, GL_FALSE,
+                          NORMALS_PER_VERTEX * sizeof(f32),
+                          (void *) ((u8 *) MeshInternalData.Normals - MeshInternalData.Data));
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, TANGENTS_PER_VERTEX, GL_FLOAT, GL_FALSE,
+                          TANGENTS_PER_VERTEX * sizeof(f32),
+                          (void *) ((u8 *) MeshInternalData.Tangents - MeshInternalData.Data));
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, BITANGENTS_PER_VERTEX, GL_FLOAT, GL_FALSE,
+                          BITANGENTS_PER_VERTEX * sizeof(f32),
+                          (void *) ((u8 *) MeshInternalData.Bitangents - MeshInternalData.Data));
+    glEnableVertexAttribArray(5);
+    glVertexAttribIPointer(5, MAX_BONES_PER_VERTEX, GL_INT,
+                           MAX_BONES_PER_VERTEX * sizeof(i32),
+                           (void *) ((u8 *) MeshInternalData.BoneIDs - MeshInternalData.Data));
+    glEnableVertexAttribArray(6);
+    glVertexAttribPointer(6, MAX_BONES_PER_VERTEX, GL_FLOAT, GL_FALSE,
+                          MAX_BONES_PER_VERTEX * sizeof(f32),
+                          (void *) ((u8 *) MeshInternalData.BoneWeights - MeshInternalData.Data));
+
+    BindVertexArray(0);
+
+    Out_Mesh->VAO = VAO;
+    Out_Mesh->VBO = VBO;
+    Out_Mesh->EBO = EBO;
+    Out_Mesh->IndexCount = MeshInternalData.IndexCount;
+    Out_Mesh->IndexType = GL_UNSIGNED_INT;
+
+    ComputeMeshTextureDensity(MeshInternalData.Positions, MeshInternalData.UVs, MeshInternalData.VertexCount,
+                              MeshInternalData.Indices, MeshInternalData.IndexCount, Out_Mesh);
+}
+
+static void
+GLTF_PrepareMeshRenderData(gltf_primitive *Primitive, mesh *Out_Mesh)
+{
+    u32 VAO;
+    glGenVertexArrays(1, &VAO);
+    u32 VBO;
+    glGenBuffers(1, &VBO);
+    u32 EBO;
+    glGenBuffers(1, &EBO);
+
+    BindVertexArray(VAO);
+    BindBuffer(GL_ARRAY_BUFFER, VBO);
+
+    // NOTE: Streams are copied as they are in the file (interleaved or not), each one at a 4 byte
+    //       aligned offset, and described to GL with the file's own stride and component type
+    size_t StreamOffsets[GLTF_ATTRIBUTE_COUNT];
+    size_t BufferSize = 0;
+    for (i32 AttributeIndex = 0; AttributeIndex < GLTF_ATTRIBUTE_COUNT; ++AttributeIndex)
+    {
+        StreamOffsets[AttributeIndex] = BufferSize;
+        BufferSize += (Primitive->Attributes[AttributeIndex].Size + 3) & ~(size_t) 3;
+    }
+    BufferData(GL_ARRAY_BUFFER, BufferSize, 0, GL_STATIC_DRAW);
+
+    for (i32 AttributeIndex = 0; AttributeIndex < GLTF_ATTRIBUTE_COUNT; ++AttributeIndex)
+    {
+        gltf_vertex_stream *Stream = &Primitive->Attributes[AttributeIndex];
+        if (Stream->Data)
+        {
+            BufferSubData(GL_ARRAY_BUFFER, StreamOffsets[AttributeIndex], Stream->Size, Stream->Data);
+            glEnableVertexAttribArray(AttributeIndex);
+            glVertexAttribPointer(AttributeIndex, Stream->ComponentCount, Stream->ComponentType,
+                                  Stream->IsNormalized ? GL_TRUE : GL_FALSE, Stream->Stride,
+                                  (void *) StreamOffsets[AttributeIndex]);
+        }
+    }
+
+    // NOTE: Index data has to be tightly packed for GL, which ReadPrimitive already checked
+    BindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    BufferData(GL_ELEMENT_ARRAY_BUFFER, Primitive->Indices.Size, Primitive->Indices.Data, GL_STATIC_DRAW);
+    SetupMeshInstanceAttributes();
+
+    BindVertexArray(0);
+
+    Out_Mesh->VAO = VAO;
+    Out_Mesh->VBO = VBO;
+    Out_Mesh->EBO = EBO;
+    Out_Mesh->IndexCount = Primitive->Indices.Count;
+    Out_Mesh->IndexType = Primitive->Indices.ComponentType;
+
+    GLTF_ComputeMeshTextureDensity(Primitive, Out_Mesh);
+}
+
+// NOTE: Everything is in model space; RequestModelTextureMips applies the model transform
+static void
+ComputeMeshTextureDensity(const f32 *Positions, const f32 *UVs, i32 VertexCount,
+                          const i32 *Indices, i32 IndexCount, mesh *Out_Mesh)
+{
+    if (VertexCount == 0)
+    {
+        return;
+    }
+
+    glm::vec3 Min(Positions[0], Positions[1], Positions[2]);
+    glm::vec3 Max = Min;
+    for (i32 VertexIndex = 1; VertexIndex < VertexCount; ++VertexIndex)
+    {
+        glm::vec3 Position(Positions[VertexIndex * 3 + 0], Positions[VertexIndex * 3 + 1], Positions[VertexIndex * 3 + 2]);
+        Min = glm::min(Min, Position);
+        Max = glm::max(Max, Position);
+    }
+
+    glm::vec3 Center = (Min + Max) * 0.5f;
+    f32 RadiusSquared = 0.0f;
+    for (i32 VertexIndex = 0; VertexIndex < VertexCount; ++VertexIndex)
+    {
+        glm::vec3 Position(Positions[VertexIndex * 3 + 0], Positions[VertexIndex * 3 + 1], Positions[VertexIndex * 3 + 2]);
+        glm::vec3 Offset = Position - Center;
+        f32 DistanceSquared = glm::dot(Offset, Offset);
+        RadiusSquared = (DistanceSquared > RadiusSquared) ? DistanceSquared : RadiusSquared;
+    }
+
+    Out_Mesh->BoundsMin = Min;
+    Out_Mesh->BoundsMax = Max;
+    Out_Mesh->BoundsCenter = Center;
+    Out_Mesh->BoundsRadius = sqrtf(RadiusSquared);
+    Out_Mesh->UVDensity = 0.0f;
+    if (!UVs)
+    {
+        return;
+    }
+
+    // NOTE: Ratio of the total UV area to the total surface area, so a mesh with an atlas that's
+    //       mostly empty or with mirrored/overlapping islands still gets its average density
+    f64 SurfaceArea = 0.0;
+    f64 UVArea = 0.0;
+    for (i32 Index = 0; Index + 2 < IndexCount; Index += 3)
+    {
+        i32 A = Indices[Index + 0];
+        i32 B = Indices[Index + 1];
+        i32 C = Indices[Index + 2];
+
+        glm::vec3 PositionA(Positions[A * 3 + 0], Positions[A * 3 + 1], Positions[A * 3 + 2]);
+        glm::vec3 PositionB(Positions[B * 3 + 0], Positions[B * 3 + 1], Positions[B * 3 + 2]);
+        glm::vec3 PositionC(Positions[C * 3 + 0], Positions[C * 3 + 1], Positions[C * 3 + 2]);
+        SurfaceArea += 0.5f * glm::length(glm::cross(PositionB - PositionA, PositionC - PositionA));
+
+        glm::vec2 UVA(UVs[A * 2 + 0], UVs[A * 2 + 1]);
+        glm::vec2 UVB(UVs[B * 2 + 0], UVs[B * 2 + 1]);
+        glm::vec2 UVC(UVs[C * 2 + 0], UVs[C * 2 + 1]);
+        glm::vec2 EdgeB = UVB - UVA;
+        glm::vec2 EdgeC = UVC - UVA;
+        UVArea += 0.5f * fabsf(EdgeB.x * EdgeC.y - EdgeB.y * EdgeC.x);
+    }
+
+    Out_Mesh->UVDensity = (SurfaceArea > 0.0 && UVArea > 0.0) ? (f32) sqrt(UVArea / SurfaceArea) : 0.0f;
+}
+
+static void
+GLTF_ComputeMeshTextureDensity(gltf_primitive *Primitive, mesh *Out_Mesh)
+{
+    gltf_vertex_stream *PositionStream = &Primitive->Attributes[GLTF_ATTRIBUTE_POSITION];
+    gltf_vertex_stream *UVStream = &Primitive->Attributes[GLTF_ATTRIBUTE_UV];
+    if (!PositionStream->Data)
+    {
+        return;
+    }
+
+    // NOTE: Unpacked into the planar layout, whatever the file's component types were
+    i32 VertexCount = Primitive->VertexCount;
+    i32 IndexCount = Primitive->Indices.Count;
+    temporary_memory ScratchMemory = BeginTemporaryMemory(GetScratchArena());
+    f32 *Positions = PushArray(GetScratchArena(), (size_t) VertexCount * 3, f32);
+    f32 *UVs = UVStream->Data ? PushArray(GetScratchArena(), (size_t) VertexCount * 2, f32) : 0;
+    i32 *Indices = PushArray(GetScratchArena(), IndexCount, i32);
+
+    for (i32 VertexIndex = 0; VertexIndex < VertexCount; ++VertexIndex)
+    {
+        GLTF_ReadFloats(PositionStream, VertexIndex, &Positions[VertexIndex * 3], 3);
+        if (UVs)
+        {
+            GLTF_ReadFloats(UVStream, VertexIndex, &UVs[VertexIndex * 2], 2);
+        }
+    }
+    for (i32 Index = 0; Index < IndexCount; ++Index)
+    {
+        Indices[Index] = (i32) GLTF_ReadIndex(&Primitive->Indices, Index);
+    }
+
+    ComputeMeshTextureDensity(Positions, UVs, VertexCount, Indices, IndexCount, Out_Mesh);
+    EndTemporaryMemory(ScratchMemory);
+}
+
+// NOTE: Bind pose, from the vertex data as it's read. A skinned vertex always ends up between its
+//       bones' palette transforms of it, so the union of the bones' transformed boxes holds the
+//       mesh however far the pose is from the bind pose.
+static void
+ComputeBoneBounds(model_load_data *LoadData)
+{
+    LoadData->BoneBounds = PushArray(&LoadData->ModelArena, LoadData->BoneCount, bone_bounds);
+    for (i32 BoneIndex = 0; BoneIndex < LoadData->BoneCount; ++BoneIndex)
+    {
+        LoadData->BoneBounds[BoneIndex].Min = glm::vec3(FLT_MAX);
+        LoadData->BoneBounds[BoneIndex].Max = glm::vec3(-FLT_MAX);
+    }
+
+    for (i32 MeshIndex = 0; MeshIndex < LoadData->MeshCount; ++MeshIndex)
+    {
+        mesh_internal_data *InternalData = &LoadData->Meshes[MeshIndex].InternalData;
+        if (!InternalData->BoneIDs)
+        {
+            continue;
+        }
+
+        for (i32 VertexIndex = 0; VertexIndex < InternalData->VertexCount; ++VertexIndex)
+        {
+            f32 *Position = &InternalData->Positions[VertexIndex * POSITIONS_PER_VERTEX];
+            glm::vec3 VertexPosition(Position[0], Position[1], Position[2]);
+            for (i32 Influence = 0; Influence < MAX_BONES_PER_VERTEX; ++Influence)
+            {
+                i32 BoneID = InternalData->BoneIDs[VertexIndex * MAX_BONES_PER_VERTEX + Influence];
+                f32 Weight = InternalData->BoneWeights[VertexIndex * MAX_BONES_PER_VERTEX + Influence];
+                if (Weight > 0.0f && BoneID >= 0 && BoneID < LoadData->BoneCount)
+                {
+                    bone_bounds *Bounds = &LoadData->BoneBounds[BoneID];
+                    Bounds->Min = glm::min(Bounds->Min, VertexPosition);
+                    Bounds->Max = glm::max(Bounds->Max, VertexPosition);
+                }
+            }
+        }
+    }
+}
+
+static void
+InitializeModelLoadMeshes(model_load_data *LoadData, i32 MeshCount)
+{
+    LoadData->MeshCount = MeshCount;
+    LoadData->Meshes = PushArray(&LoadData->Arena, MeshCount, model_load_mesh);
+    LoadData->UploadedMeshes = PushArray(&LoadData->ModelArena, MeshCount, mesh);
+    if (LoadData->KeepCPUData)
+    {
+        LoadData->CPUMeshes = PushArray(&LoadData->ModelArena, MeshCount, mesh_cpu_data);
+    }
+    // NOTE: At most one distinct texture per material slot of every mesh
+    LoadData->Textures = PushArray(&LoadData->Arena, MeshCount * COOKED_MATERIAL_TEXTURE_COUNT, texture_data);
+    LoadData->TextureIDs = PushArray(&LoadData->Arena, MeshCount * COOKED_MATERIAL_TEXTURE_COUNT, u32);
+}
+
+static void
+ResetModelLoadData(model_load_data *LoadData)
+{
+    // NOTE: Whatever was handed over to a model is zeroed out by now
+    for (i32 MeshIndex = 0; MeshIndex < LoadData->MeshCount; ++MeshIndex)
+    {
+        model_load_mesh *LoadMesh = &LoadData->Meshes[MeshIndex];
+        if (LoadMesh->OwnsInternalData)
+        {
+            FreeMeshInternalData(&LoadMesh->InternalData);
+        }
+    }
+    for (i32 TextureIndex = 0; TextureIndex < LoadData->TextureCount; ++TextureIndex)
+    {
+        FreeTextureData(&LoadData->Textures[TextureIndex]);
+    }
+    // NOTE: The meshes took their own references
+    for (i32 TextureIndex = 0; TextureIndex < LoadData->UploadedTextureCount; ++TextureIndex)
+    {
+        ReleaseTexture(LoadData->TextureIDs[TextureIndex]);
+    }
+    for (i32 AnimationIndex = 0; LoadData->Animations && AnimationIndex < LoadData->AnimationCount; ++AnimationIndex)
+    {
+        free(LoadData->Animations[AnimationIndex].KeyTimes);
+        free(LoadData->Animations[AnimationIndex].Keys);
+    }
+
+    UnmapFile(&LoadData->CookedFile);
+    for (i32 SourceFileIndex = 0; SourceFileIndex < LoadData->SourceFileCount; ++SourceFileIndex)
+    {
+        UnmapFile(&LoadData->SourceFiles[SourceFileIndex]);
+    }
+    ClearArena(&LoadData->Arena);
+    ClearArena(&LoadData->ModelArena);
+
+    // NOTE: Keep what the load was requested with, so another loader can be tried
+    model_load_data Request{ };
+    strncpy_s(Request.Path, LoadData->Path, MAX_PATH_LENGTH - 1);
+    Request.IsSkinned = LoadData->IsSkinned;
+    Request.GenerateMipmap = LoadData->GenerateMipmap;
+    Request.KeepCPUData = LoadData->KeepCPUData;
+    *LoadData = Request;
+}
+
+static void
+DecodeTexturesForMesh(model_load_data *LoadData, model_load_mesh *LoadMesh, cooked_material *Material)
+{
+    char TexturePath[MAX_PATH_LENGTH];
+    for (i32 TextureType = 0; TextureType < COOKED_MATERIAL_TEXTURE_COUNT; ++TextureType)
+    {
+        LoadMesh->TextureIndices[TextureType] = -1;
+
+        if (!GetMaterialTexturePath(LoadData->Path, Material, TextureType, TexturePath, MAX_PATH_LENGTH))
+        {
+            continue;
+        }
+
+        // NOTE: Meshes of the same model often share textures; only decode each one once
+        for (i32 TextureIndex = 0; TextureIndex < LoadData->TextureCount; ++TextureIndex)
+        {
+            if (strcmp(LoadData->Textures[TextureIndex].Path, TexturePath) == 0)
+            {
+                LoadMesh->TextureIndices[TextureType] = TextureIndex;
+                break;
+            }
+        }
+
+        if (LoadMesh->TextureIndices[TextureType] < 0)
+        {
+            // NOTE: A texture that fails to decode still gets a slot; it uploads as texture 0.
+            //       With streaming on, the texture is only named here and streams in on its own.
+            i32 TextureIndex = LoadData->TextureCount++;
+            if (IsTextureStreamingActive())
+            {
+                // NOTE: Hashed here so LoadTextureAsync's lookup doesn't read the file on the GL thread
+                strncpy_s(LoadData->Textures[TextureIndex].Path, TexturePath, MAX_PATH_LENGTH - 1);
+                GetFileContentHash(TexturePath);
+            }
+            else
+            {
+                DecodeTexture(TexturePath, LoadData->GenerateMipmap, &LoadData->Textures[TextureIndex]);
+            }
+            LoadMesh->TextureIndices[TextureType] = TextureIndex;
+        }
+    }
+}
+
+static bool
+GetMaterialTexturePath(const char *ModelPath, cooked_material *Material, i32 TextureType,
+                       char *Out_TexturePath, i32 TexturePathBufferSize)
+{
+    char *TextureFilename = Material->TextureFilenames[TextureType];
+    i32 TextureFilenameCount = GetNullTerminatedStringLength(TextureFilename);
+
+    Out_TexturePath[0] = '\0';
+
+    if (TextureFilenameCount > 0)
+    {
+        char ModelPathOnStack[MAX_PATH_LENGTH];
+        strncpy_s(ModelPathOnStack, ModelPath, MAX_PATH_LENGTH - 1);
+        i32 ModelPathCount = GetNullTerminatedStringLength(ModelPathOnStack);
+        char ModelDirectory[MAX_PATH_LENGTH];
+        i32 ModelDirectoryCount;
+        GetFileDirectory(ModelPathOnStack, ModelPathCount, ModelDirectory, &ModelDirectoryCount, MAX_PATH_LENGTH);
+
+        CatStrings(ModelDirectory, ModelDirectoryCount,
+                   TextureFilename, TextureFilenameCount,
+                   Out_TexturePath, TexturePathBufferSize);
+        return true;
+    }
+
+    return false;
+}
+
+// Shared mesh and clip data
+// -------------------------
+
+static void
+GetSharedMeshLayout(model_load_data *LoadData, model_load_mesh *LoadMesh, shared_mesh_layout *Out_Layout)
+{
+    memset(Out_Layout, 0, sizeof(*Out_Layout));
+
+    if (LoadMesh->IsGLTFPrimitive)
+    {
+        // NOTE: Same buffer layout as GLTF_PrepareMeshRenderData: each stream at a 4 byte aligned
+        //       offset, indices as they are in the file
+        gltf_primitive *Primitive = &LoadMesh->GLTFPrimitive;
+        Out_Layout->Format = SHARED_MESH_GLTF;
+        Out_Layout->VertexCount = Primitive->VertexCount;
+        Out_Layout->IndexCount = Primitive->Indices.Count;
+        Out_Layout->IndexType = Primitive->Indices.ComponentType;
+        Out_Layout->IndexDataSize = Primitive->Indices.Size;
+        for (i32 AttributeIndex = 0; AttributeIndex < GLTF_ATTRIBUTE_COUNT; ++AttributeIndex)
+        {
+            gltf_vertex_stream *Stream = &Primitive->Attributes[AttributeIndex];
+            Out_Layout->VertexDataSize += (Stream->Size + 3) & ~(size_t) 3;
+
+            u32 *StreamLayout = Out_Layout->Streams[AttributeIndex];
+            StreamLayout[0] = (u32) Stream->Count;
+            StreamLayout[1] = (u32) Stream->ComponentCount;
+            StreamLayout[2] = Stream->ComponentType;
+            StreamLayout[3] = (u32) Stream->IsNormalized;
+            StreamLayout[4] = (u32) Stream->Stride;
+        }
+    }
+    else
+    {
+        mesh_internal_data *InternalData = &LoadMesh->InternalData;
+        Out_Layout->Format = LoadData->IsSkinned ? SHARED_MESH_SKINNED : SHARED_MESH_STATIC;
+        Out_Layout->VertexCount = InternalData->VertexCount;
+        Out_Layout->IndexCount = InternalData->IndexCount;
+        Out_Layout->IndexType = GL_UNSIGNED_INT;
+        Out_Layout->VertexDataSize = GetMeshInternalDataSize(InternalData->VertexCount, 0, LoadData->IsSkinned);
+        Out_Layout->IndexDataSize = (u64) InternalData->IndexCount * sizeof(i32);
+    }
+}
+
+static u64
+HashLoadMesh(shared_mesh_layout *Layout, model_load_mesh *LoadMesh)
+{
+    // NOTE: The layout goes into the hash along with the bytes, so the same bytes read as
+    //       different vertex formats never match
+    u64 Hash = HashBytes64(Layout, sizeof(*Layout), 0);
+    if (LoadMesh->IsGLTFPrimitive)
+    {
+        gltf_primitive *Primitive = &LoadMesh->GLTFPrimitive;
+        for (i32 StreamIndex = 0; StreamIndex <= GLTF_ATTRIBUTE_COUNT; ++StreamIndex)
+        {
+            gltf_vertex_stream *Stream = (StreamIndex < GLTF_ATTRIBUTE_COUNT) ?
+                                         &Primitive->Attributes[StreamIndex] : &Primitive->Indices;
+            if (Stream->Data)
+            {
+                Hash = HashBytes64(Stream->Data, Stream->Size, Hash);
+            }
+        }
+    }
+    else
+    {
+        mesh_internal_data *InternalData = &LoadMesh->InternalData;
+        Hash = HashBytes64(InternalData->Data, Layout->VertexDataSize, Hash);
+        Hash = HashBytes64(InternalData->Indices, Layout->IndexDataSize, Hash);
+    }
+
+    // NOTE: 0 marks an empty slot
+    return (Hash != 0) ? Hash : 1;
+}
+
+static bool
+AcquireSharedMesh(u64 ContentHash, shared_mesh_layout *Layout, model_load_mesh *LoadMesh, mesh *Out_Mesh)
+{
+    if (SharedModelData.MeshSlotCount == 0)
+    {
+        return false;
+    }
+
+    u32 SlotMask = SharedModelData.MeshSlotCount - 1;
+    for (u32 Slot = (u32) ContentHash & SlotMask; ; Slot = (Slot + 1) & SlotMask)
+    {
+        shared_mesh_entry *Entry = &SharedModelData.MeshSlots[Slot];
+        if (Entry->ContentHash == 0)
+        {
+            return false;
+        }
+
+        if (Entry->RefCount > 0 && Entry->ContentHash == ContentHash &&
+            memcmp(&Entry->Layout, Layout, sizeof(*Layout)) == 0 &&
+            IsSharedMeshContentEqual(Entry, LoadMesh))
+        {
+            ++Entry->RefCount;
+            *Out_Mesh = Entry->Mesh;
+            return true;
+        }
+    }
+}
+
+// NOTE: GL thread. Reads the entry's buffers back and compares them with what LoadMesh would
+//       upload. Only done on a hash match, where it costs about what the upload it saves would.
+static bool
+IsSharedMeshContentEqual(shared_mesh_entry *Entry, model_load_mesh *LoadMesh)
+{
+    shared_mesh_layout *Layout = &Entry->Layout;
+
+    temporary_memory ScratchMemory = BeginTemporaryMemory(GetScratchArena());
+    u8 *VertexData = (u8 *) PushSize(GetScratchArena(), Layout->VertexDataSize, 16);
+    u8 *IndexData = (u8 *) PushSize(GetScratchArena(), Layout->IndexDataSize, 16);
+
+    // NOTE: Not through GL_ELEMENT_ARRAY_BUFFER, that binding belongs to whatever VAO is bound
+    BindBuffer(GL_COPY_READ_BUFFER, Entry->Mesh.VBO);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, 0, Layout->VertexDataSize, VertexData);
+    BindBuffer(GL_COPY_READ_BUFFER, Entry->Mesh.EBO);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, 0, Layout->IndexDataSize, IndexData);
+    BindBuffer(GL_COPY_READ_BUFFER, 0);
+
+    bool IsEqual = true;
+    if (LoadMesh->IsGLTFPrimitive)
+    {
+        gltf_primitive *Primitive = &LoadMesh->GLTFPrimitive;
+        size_t StreamOffset = 0;
+        for (i32 AttributeIndex = 0; IsEqual && AttributeIndex < GLTF_ATTRIBUTE_COUNT; ++AttributeIndex)
+        {
+            gltf_vertex_stream *Stream = &Primitive->Attributes[AttributeIndex];
+            if (Stream->Data)
+            {
+                IsEqual = (memcmp(VertexData + StreamOffset, Stream->Data, Stream->Size) == 0);
+            }
+            StreamOffset += (Stream->Size + 3) & ~(size_t) 3;
+        }
+
+        if (IsEqual && Primitive->Indices.Data)
+        {
+            IsEqual = (memcmp(IndexData, Primitive->Indices.Data, Layout->IndexDataSize) == 0);
+        }
+    }
+    else
+    {
+        mesh_internal_data *InternalData = &LoadMesh->InternalData;
+        IsEqual = (memcmp(VertexData, InternalData->Data, Layout->VertexDataSize) == 0 &&
+                   memcmp(IndexData, InternalData->Indices, Layout->IndexDataSize) == 0);
+    }
+
+    EndTemporaryMemory(ScratchMemory);
+
+    return IsEqual;
+}
+
+static void
+AddSharedMesh(u64 ContentHash, shared_mesh_layout *Layout, mesh *Mesh)
+{
+    if ((SharedModelData.MeshUsedSlotCount + 1) * 2 > SharedModelData.MeshSlotCount)
+    {
+        RebuildSharedMeshTable();
+    }
+
+    // NOTE: The first free slot on the probe path, so lookups still reach it
+    u32 SlotMask = SharedModelData.MeshSlotCount - 1;
+    u32 Slot = (u32) ContentHash & SlotMask;
+    while (SharedModelData.MeshSlots[Slot].RefCount > 0)
+    {
+        Slot = (Slot + 1) & SlotMask;
+    }
+
+    shared_mesh_entry *Entry = &SharedModelData.MeshSlots[Slot];
+    if (Entry->ContentHash == 0)
+    {
+        ++SharedModelData.MeshUsedSlotCount;
+    }
+
+    Mesh->ContentHash = ContentHash;
+    Entry->ContentHash = ContentHash;
+    Entry->RefCount = 1;
+    Entry->Layout = *Layout;
+    Entry->Mesh = *Mesh;
+}
+
+// NOTE: Drops the entries nobody uses anymore and sizes the table for a quarter of the slots to
+//       be in use, so it isn't rebuilt again right away
+static void
+RebuildSharedMeshTable()
+{
+    u32 LiveCount = 0;
+    for (u32 Slot = 0; Slot < SharedModelData.MeshSlotCount; ++Slot)
+    {
+        if (SharedModelData.MeshSlots[Slot].RefCount > 0)
+        {
+            ++LiveCount;
+        }
+    }
+
+    u32 NewSlotCount = 64;
+    while ((LiveCount + 1) * 4 > NewSlotCount)
+    {
+        NewSlotCount *= 2;
+    }
+
+    shared_mesh_entry *NewSlots = (shared_mesh_entry *) calloc(NewSlotCount, sizeof(shared_mesh_entry));
+    Assert(NewSlots);
+    for (u32 Slot = 0; Slot < SharedModelData.MeshSlotCount; ++Slot)
+    {
+        shared_mesh_entry *Entry = &SharedModelData.MeshSlots[Slot];
+        if (Entry->RefCount > 0)
+        {
+            u32 NewSlot = (u32) Entry->ContentHash & (NewSlotCount - 1);
+            while (NewSlots[NewSlot].ContentHash != 0)
+            {
+                NewSlot = (NewSlot + 1) & (NewSlotCount - 1);
+            }
+            NewSlots[NewSlot] = *Entry;
+        }
+    }
+
+    free(SharedModelData.MeshSlots);
+    SharedModelData.MeshSlots = NewSlots;
+    SharedModelData.MeshSlotCount = NewSlotCount;
+    SharedModelData.MeshUsedSlotCount = LiveCount;
+}
+
+static void
+ReleaseMeshBuffers(mesh *Mesh)
+{
+    // NOTE: Meshes with buffers of their own (ContentHash 0) aren't in the table
+    if (Mesh->ContentHash != 0 && SharedModelData.MeshSlotCount > 0)
+    {
+        u32 SlotMask = SharedModelData.MeshSlotCount - 1;
+        for (u32 Slot = (u32) Mesh->ContentHash & SlotMask;
+             SharedModelData.MeshSlots[Slot].ContentHash != 0;
+             Slot = (Slot + 1) & SlotMask)
+        {
+            shared_mesh_entry *Entry = &SharedModelData.MeshSlots[Slot];
+            if (Entry->RefCount > 0 && Entry->Mesh.VAO == Mesh->VAO)
+            {
+                if (--Entry->RefCount > 0)
+                {
+                    return;
+                }
+                break;
+            }
+        }
+    }
+
+    DeleteVertexArray(&Mesh->VAO);
+    DeleteBuffer(&Mesh->VBO);
+    DeleteBuffer(&Mesh->EBO);
+}
+
+// NOTE: Swaps the clip's keys for an identical resident copy if there is one
+static void
+ShareAnimationClip(animation *Animation)
+{
+    size_t KeyTimesSize = (size_t) Animation->KeyCount * sizeof(f32);
+    size_t KeysSize = (size_t) Animation->KeyCount * Animation->ChannelCount * sizeof(animation_key);
+
+    i32 Layout[] = { Animation->KeyCount, Animation->ChannelCount };
+    u64 ContentHash = HashBytes64(Layout, sizeof(Layout), 0);
+    ContentHash = HashBytes64(Animation->KeyTimes, KeyTimesSize, ContentHash);
+    ContentHash = HashBytes64(Animation->Keys, KeysSize, ContentHash);
+    ContentHash = (ContentHash != 0) ? ContentHash : 1;
+
+    Animation->ContentHash = ContentHash;
+
+    if ((SharedModelData.ClipUsedSlotCount + 1) * 2 > SharedModelData.ClipSlotCount)
+    {
+        RebuildSharedClipTable();
+    }
+
+    u32 SlotMask = SharedModelData.ClipSlotCount - 1;
+    shared_clip_entry *FreeEntry = 0;
+    u32 Slot = (u32) ContentHash & SlotMask;
+    for (; SharedModelData.ClipSlots[Slot].ContentHash != 0; Slot = (Slot + 1) & SlotMask)
+    {
+        shared_clip_entry *Entry = &SharedModelData.ClipSlots[Slot];
+        if (Entry->RefCount > 0 && Entry->ContentHash == ContentHash &&
+            Entry->KeyCount == Animation->KeyCount && Entry->ChannelCount == Animation->ChannelCount &&
+            memcmp(Entry->KeyTimes, Animation->KeyTimes, KeyTimesSize) == 0 &&
+            memcmp(Entry->Keys, Animation->Keys, KeysSize) == 0)
+        {
+            free(Animation->KeyTimes);
+            free(Animation->Keys);
+            Animation->KeyTimes = Entry->KeyTimes;
+            Animation->Keys = Entry->Keys;
+            ++Entry->RefCount;
+            return;
+        }
+        if (Entry->RefCount == 0 && !FreeEntry)
+        {
+            FreeEntry = Entry;
+        }
+    }
+
+    if (!FreeEntry)
+    {
+        FreeEntry = &SharedModelData.ClipSlots[Slot];
+        ++SharedModelData.ClipUsedSlotCount;
+    }
+
+    FreeEntry->ContentHash = ContentHash;
+    FreeEntry->RefCount = 1;
+    FreeEntry->KeyCount = Animation->KeyCount;
+    FreeEntry->ChannelCount = Animation->ChannelCount;
+    FreeEntry->KeyTimes = Animation->KeyTimes;
+    FreeEntry->Keys = Animation->Keys;
+}
+
+// NOTE: Same as RebuildSharedMeshTable
+static void
+RebuildSharedClipTable()
+{
+    u32 LiveCount = 0;
+    for (u32 Slot = 0; Slot < SharedModelData.ClipSlotCount; ++Slot)
+    {
+        if (SharedModelData.ClipSlots[Slot].RefCount > 0)
+        {
+            ++LiveCount;
+        }
+    }
+
+    u32 NewSlotCount = 16;
+    while ((LiveCount + 1) * 4 > NewSlotCount)
+    {
+        NewSlotCount *= 2;
+    }
+
+    shared_clip_entry *NewSlots = (shared_clip_entry *) calloc(NewSlotCount, sizeof(shared_clip_entry));
+    Assert(NewSlots);
+    for (u32 Slot = 0; Slot < SharedModelData.ClipSlotCount; ++Slot)
+    {
+        shared_clip_entry *Entry = &SharedModelData.ClipSlots[Slot];
+        if (Entry->RefCount > 0)
+        {
+            u32 NewSlot = (u32) Entry->ContentHash & (NewSlotCount - 1);
+            while (NewSlots[NewSlot].ContentHash != 0)
+            {
+                NewSlot = (NewSlot + 1) & (NewSlotCount - 1);
+            }
+            NewSlots[NewSlot] = *Entry;
+        }
+    }
+
+    free(SharedModelData.ClipSlots);
+    SharedModelData.ClipSlots = NewSlots;
+    SharedModelData.ClipSlotCount = NewSlotCount;
+    SharedModelData.ClipUsedSlotCount = LiveCount;
+}
+
+static void
+ReleaseAnimationClip(animation *Animation)
+{
+    // NOTE: Clips with keys of their own (ContentHash 0) aren't in the table
+    if (Animation->ContentHash != 0 && SharedModelData.ClipSlotCount > 0)
+    {
+        u32 SlotMask = SharedModelData.ClipSlotCount - 1;
+        for (u32 Slot = (u32) Animation->ContentHash & SlotMask;
+             SharedModelData.ClipSlots[Slot].ContentHash != 0;
+             Slot = (Slot + 1) & SlotMask)
+        {
+            shared_clip_entry *Entry = &SharedModelData.ClipSlots[Slot];
+            if (Entry->RefCount > 0 && Entry->Keys == Animation->Keys)
+            {
+                if (--Entry->RefCount > 0)
+                {
+                    return;
+                }
+                break;
+            }
+        }
+    }
+
+    free(Animation->KeyTimes);
+    free(Animation->Keys);
+}
+
+static void
+FreeMeshList(mesh *Meshes, i32 MeshCount)
+{
+    for (i32 MeshIndex = 0; Meshes && MeshIndex < MeshCount; ++MeshIndex)
+    {
+        mesh *Mesh = &Meshes[MeshIndex];
+        for (i32 TextureType = 0; TextureType < COOKED_MATERIAL_TEXTURE_COUNT; ++TextureType)
+        {
+            ReleaseTexture(Mesh->TextureIDs[TextureType]);
+        }
+        ReleaseMeshBuffers(Mesh);
+    }
+}
+
+static void
+CopyMeshCPUData(model_load_mesh *LoadMesh, memory_arena *Arena, bool IncludeAttributes,
+                mesh_cpu_data *Out_CPUData)
+{
+    i32 VertexCount;
+    i32 IndexCount;
+    if (LoadMesh->IsGLTFPrimitive)
+    {
+        VertexCount = LoadMesh->GLTFPrimitive.VertexCount;
+        IndexCount = LoadMesh->GLTFPrimitive.Indices.Count;
+    }
+    else
+    {
+        VertexCount = LoadMesh->InternalData.VertexCount;
+        IndexCount = LoadMesh->InternalData.IndexCount;
+    }
+
+    Out_CPUData->VertexCount = VertexCount;
+    Out_CPUData->IndexCount = IndexCount;
+    Out_CPUData->Positions = PushArray(Arena, (size_t) VertexCount * POSITIONS_PER_VERTEX, f32);
+    Out_CPUData->Indices = PushArray(Arena, IndexCount, i32);
+    if (IncludeAttributes)
+    {
+        Out_CPUData->UVs = PushArray(Arena, (size_t) VertexCount * UVS_PER_VERTEX, f32);
+        Out_CPUData->Normals = PushArray(Arena, (size_t) VertexCount * NORMALS_PER_VERTEX, f32);
+        Out_CPUData->Tangents = PushArray(Arena, (size_t) VertexCount * TANGENTS_PER_VERTEX, f32);
+    }
+
+    if (LoadMesh->IsGLTFPrimitive)
+    {
+        // NOTE: Unpacked, whatever the file's component types were. Missing attributes stay zero,
+        //       and the tangent's w (the bitangent sign) is dropped, as the static mesh shader does.
+        gltf_primitive *Primitive = &LoadMesh->GLTFPrimitive;
+        for (i32 VertexIndex = 0; VertexIndex < VertexCount; ++VertexIndex)
+        {
+            GLTF_ReadFloats(&Primitive->Attributes[GLTF_ATTRIBUTE_POSITION], VertexIndex,
+                            &Out_CPUData->Positions[VertexIndex * POSITIONS_PER_VERTEX], POSITIONS_PER_VERTEX);
+        }
+        if (IncludeAttributes)
+        {
+            gltf_vertex_stream *UVs = &Primitive->Attributes[GLTF_ATTRIBUTE_UV];
+            gltf_vertex_stream *Normals = &Primitive->Attributes[GLTF_ATTRIBUTE_NORMAL];
+            gltf_vertex_stream *Tangents = &Primitive->Attributes[GLTF_ATTRIBUTE_TANGENT];
+            for (i32 VertexIndex = 0; VertexIndex < VertexCount; ++VertexIndex)
+            {
+                if (UVs->Data)
+                {
+                    GLTF_ReadFloats(UVs, VertexIndex, &Out_CPUData->UVs[VertexIndex * UVS_PER_VERTEX], UVS_PER_VERTEX);
+                }
+                if (Normals->Data)
+                {
+                    GLTF_ReadFloats(Normals, VertexIndex, &Out_CPUData->Normals[VertexIndex * NORMALS_PER_VERTEX],
+                                    NORMALS_PER_VERTEX);
+                }
+                if (Tangents->Data)
+                {
+                    GLTF_ReadFloats(Tangents, VertexIndex, &Out_CPUData->Tangents[VertexIndex * TANGENTS_PER_VERTEX],
+                                    TANGENTS_PER_VERTEX);
+                }
+            }
+        }
+        for (i32 Index = 0; Index < IndexCount; ++Index)
+        {
+            Out_CPUData->Indices[Index] = (i32) GLTF_ReadIndex(&Primitive->Indices, Index);
+        }
+    }
+    else
+    {
+        memcpy(Out_CPUData->Positions, LoadMesh->InternalData.Positions,
+               (size_t) VertexCount * POSITIONS_PER_VERTEX * sizeof(f32));
+        memcpy(Out_CPUData->Indices, LoadMesh->InternalData.Indices, (size_t) IndexCount * sizeof(i32));
+        if (IncludeAttributes)
+        {
+            memcpy(Out_CPUData->UVs, LoadMesh->InternalData.UVs, (size_t) VertexCount * UVS_PER_VERTEX * sizeof(f32));
+            memcpy(Out_CPUData->Normals, LoadMesh->InternalData.Normals,
+                   (size_t) VertexCount * NORMALS_PER_VERTEX * sizeof(f32));
+            memcpy(Out_CPUData->Tangents, LoadMesh->InternalData.Tangents,
+                   (size_t) VertexCount * TANGENTS_PER_VERTEX * sizeof(f32));
+        }
+    }
+}
+
+static size_t
+GetMeshInternalDataSize(i32 VertexCount, i32 IndexCount, bool IncludeBones)
+{
+    size_t SpaceForBones = 0;
+    if (IncludeBones)
+    {
+        SpaceForBones = MAX_BONES_PER_VERTEX * (sizeof(i32) + sizeof(f32));
+    }
+
+    return ((size_t) VertexCount * (POSITIONS_PER_VERTEX * sizeof(f32) +
+                                    UVS_PER_VERTEX * sizeof(f32) +
+                                    NORMALS_PER_VERTEX * sizeof(f32) +
+                                    TANGENTS_PER_VERTEX * sizeof(f32) +
+                                    BITANGENTS_PER_VERTEX * sizeof(f32) +
+                                    SpaceForBones) +
+            (size_t) IndexCount * sizeof(i32));
+}
+
+static void
+LayOutMeshInternalData(u8 *Data, i32 VertexCount, i32 IndexCount, bool IncludeBones,
+                       mesh_internal_data *Out_InternalData)
+{
+    Out_InternalData->Data = Data;
+    Out_InternalData->VertexCount = VertexCount;
+    Out_InternalData->IndexCount = IndexCount;
+    Out_InternalData->Positions = (f32 *) (Data);
+    Out_InternalData->UVs = (f32 *) (Out_InternalData->Positions + VertexCount * POSITIONS_PER_VERTEX);
+    Out_InternalData->Normals = (f32 *) (Out_InternalData->UVs + VertexCount * UVS_PER_VERTEX);
+    Out_InternalData->Tangents = (f32 *) (Out_InternalData->Normals + VertexCount * NORMALS_PER_VERTEX);
+    Out_InternalData->Bitangents = (f32 *) (Out_InternalData->Tangents + VertexCount * TANGENTS_PER_VERTEX);
+    if (IncludeBones)
+    {
+        Out_InternalData->BoneIDs = (i32 *) (Out_InternalData->Bitangents + VertexCount * BITANGENTS_PER_VERTEX);
+        Out_InternalData->BoneWeights = (f32 *) (Out_InternalData->BoneIDs + VertexCount * MAX_BONES_PER_VERTEX);
+        Out_InternalData->Indices = (i32 *) (Out_InternalData->BoneWeights + VertexCount * MAX_BONES_PER_VERTEX);
+    }
+    else
+    {
+        Out_InternalData->BoneIDs = 0;
+        Out_InternalData->BoneWeights = 0;
+        Out_InternalData->Indices = (i32 *) (Out_InternalData->Bitangents + VertexCount * BITANGENTS_PER_VERTEX);
+    }
+}
+
+static inline void
+RenderMeshList(mesh *Meshes, i32 MeshCount)
+{
+    for (i32 MeshIndex = 0; MeshIndex < (i32) MeshCount; ++MeshIndex)
+    {
+        RenderMesh(&Meshes[MeshIndex]);
+    }
+}
+
+static void
+GetMeshListBounds(mesh *Meshes, i32 MeshCount, glm::vec3 *Out_Min, glm::vec3 *Out_Max)
+{
+    if (MeshCount == 0)
+    {
+        *Out_Min = glm::vec3(0.0f);
+        *Out_Max = glm::vec3(0.0f);
+        return;
+    }
+
+    glm::vec3 Min = Meshes[0].BoundsMin;
+    glm::vec3 Max = Meshes[0].BoundsMax;
+    for (i32 MeshIndex = 1; MeshIndex < MeshCount; ++MeshIndex)
+    {
+        Min = glm::min(Min, Meshes[MeshIndex].BoundsMin);
+        Max = glm::max(Max, Meshes[MeshIndex].BoundsMax);
+    }
+
+    *Out_Min = Min;
+    *Out_Max = Max;
+}
+
+static void
+BindMeshTextures(mesh *Mesh)
+{
+    BindTexture2D(0, Mesh->DiffuseMapID);
+    BindTexture2D(1, Mesh->SpecularMapID);
+    BindTexture2D(2, Mesh->EmissionMapID);
+    BindTexture2D(3, Mesh->NormalMapID);
+}
+
+// NOTE: For the VAO being set up. The attributes point at the stream buffer from the start, so
+//       they're valid even before anything is uploaded.
+static void
+SetupMeshInstanceAttributes()
+{
+    for (i32 Column = 0; Column < 7; ++Column)
+    {
+        glEnableVertexAttribArray(MESH_INSTANCE_ATTRIBUTE_LOCATION + Column);
+        glVertexAttribDivisor(MESH_INSTANCE_ATTRIBUTE_LOCATION + Column, 1);
+    }
+    PointMeshInstanceAttributes(0);
+}
+
+// NOTE: For the bound VAO
+static void
+PointMeshInstanceAttributes(size_t InstanceOffset)
+{
+    BindBuffer(GL_ARRAY_BUFFER, GetStreamBuffer());
+    for (i32 Column = 0; Column < 4; ++Column)
+    {
+        glVertexAttribPointer(MESH_INSTANCE_ATTRIBUTE_LOCATION + Column, 4, GL_FLOAT, GL_FALSE,
+                              sizeof(mesh_instance),
+                              (void *) (InstanceOffset + offsetof(mesh_instance, Transform) + Column * sizeof(glm::vec4)));
+    }
+    for (i32 Column = 0; Column < 3; ++Column)
+    {
+        glVertexAttribPointer(MESH_INSTANCE_ATTRIBUTE_LOCATION + 4 + Column, 3, GL_FLOAT, GL_FALSE,
+                              sizeof(mesh_instance),
+                              (void *) (InstanceOffset + offsetof(mesh_instance, NormalMatrix) + Column * sizeof(glm::vec3)));
+    }
+}
+
+// NOTE: Uses the point of each mesh's bounding sphere closest to the camera, so a big mesh the
+//       camera is standing on or next to asks for the detail its nearest part needs. Skinned
+//       meshes use their bind pose bounds.
+static void
+RequestMeshListTextureMips(mesh *Meshes, i32 MeshCount, glm::mat4 ModelTransform,
+                           glm::vec3 CameraPosition, f32 PixelsPerUnit)
+{
+    f32 ScaleX = glm::length(glm::vec3(ModelTransform[0]));
+    f32 ScaleY = glm::length(glm::vec3(ModelTransform[1]));
+    f32 ScaleZ = glm::length(glm::vec3(ModelTransform[2]));
+    f32 Scale = glm::max(ScaleX, glm::max(ScaleY, ScaleZ));
+    if (Scale <= 0.0f || PixelsPerUnit <= 0.0f)
+    {
+        return;
+    }
+
+    for (i32 MeshIndex = 0; MeshIndex < MeshCount; ++MeshIndex)
+    {
+        mesh *Mesh = &Meshes[MeshIndex];
+        if (Mesh->UVDensity <= 0.0f)
+        {
+            continue;
+        }
+
+        glm::vec3 Center = glm::vec3(ModelTransform * glm::vec4(Mesh->BoundsCenter, 1.0f));
+        f32 Distance = glm::length(Center - CameraPosition) - Mesh->BoundsRadius * Scale;
+        // NOTE: Closer than the near plane can't be on screen
+        Distance = (Distance > 0.1f) ? Distance : 0.1f;
+
+        // NOTE: UV units per world unit over screen pixels per world unit at that distance
+        f32 UVsPerPixel = (Mesh->UVDensity / Scale) * Distance / PixelsPerUnit;
+        for (i32 TextureIndex = 0; TextureIndex < 4; ++TextureIndex)
+        {
+            RequestTextureMip(Mesh->TextureIDs[TextureIndex], UVsPerPixel);
+        }
+    }
+}
+
+
+static inline void
+UpdateAnimationState(animation *Animation, f32 DeltaTime)
+{
+    // Update current animation time to the beginning of the game loop
+    Animation->CurrentTicks += DeltaTime * Animation->TicksPerSecond;
+
+    // Loop animation around if past end
+    if (Animation->CurrentTicks >= Animation->TicksDuration)
+    {
+        Animation->CurrentTicks -= Animation->TicksDuration;
+    }
+}
+
+static inline i32
+FindNextAnimationKey(animation *Animation)
+{
+    i32 Result = -1;
+
+    for (i32 KeyIndex = 1; KeyIndex < Animation->KeyCount; KeyIndex++)
+    {
+        if (Animation->CurrentTicks <= Animation->KeyTimes[KeyIndex])
+        {
+            Result = KeyIndex;
+            break;
+        }
+    }
+    Assert(Result >= 1 && Result < Animation->KeyCount);
+
+    return Result;
+}
 
 static inline f32 
 CalculateLerpRatioBetweenTwoFrames(animation *Animation, i32 NextKey)
@@ -980,3 +3964,33 @@ GetTransformationForAnimationKey(animation_key Key)
 
     return Result;
 }
+
+// NOTE: One box transform per bone, however many vertices the model has
+static void
+UpdatePoseBounds(skinned_model *Model)
+{
+    glm::vec3 Min(FLT_MAX);
+    glm::vec3 Max(-FLT_MAX);
+    for (i32 BoneIndex = 0; BoneIndex < Model->BoneCount; ++BoneIndex)
+    {
+        bone_bounds *Bounds = &Model->BoneBounds[BoneIndex];
+        if (Bounds->Min.x > Bounds->Max.x)
+        {
+            continue;
+        }
+
+        glm::vec3 PoseMin, PoseMax;
+        TransformBounds(Bounds->Min, Bounds->Max, Model->AnimationState.BonePalette[BoneIndex], &PoseMin, &PoseMax);
+        Min = glm::min(Min, PoseMin);
+        Max = glm::max(Max, PoseMax);
+    }
+
+    // NOTE: No weighted vertices at all; fall back to the meshes' bind pose
+    if (Min.x > Max.x)
+    {
+        GetMeshListBounds(Model->Meshes, Model->MeshCount, &Min, &Max);
+    }
+
+    Model->PoseBoundsMin = Min;
+    Model->PoseBoundsMax = Max;
+}
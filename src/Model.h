@@ -5,11 +5,16 @@
 #include <glm/gtc/quaternion.hpp>
 
 #include "Common.h"
+#include "Memory.h"
 
 struct mesh
 {
     u32 VAO;
+    u32 VBO;
+    u32 EBO;
     u32 IndexCount;
+    // NOTE: GL_UNSIGNED_INT for everything but glTF meshes, which keep the file's index type
+    u32 IndexType;
     union
     {
         u32 TextureIDs[4];
@@ -21,6 +26,29 @@ struct mesh
             u32 NormalMapID;
         };
     };
+
+    // NOTE: Model space bounds, computed when the mesh is uploaded: a box for culling and a
+    //       sphere around its center for picking texture mip levels
+    glm::vec3 BoundsMin;
+    glm::vec3 BoundsMax;
+    glm::vec3 BoundsCenter;
+    f32 BoundsRadius;
+    // NOTE: Average number of UV units per model space unit over the mesh's surface (0 if it has
+    //       no UVs)
+    f32 UVDensity;
+
+    // NOTE: Key of the shared buffers it uses, 0 if the buffers are its own
+    u64 ContentHash;
+};
+
+// NOTE: Static meshes take their transform per instance from the stream buffer: the
+//       model matrix's columns at MESH_INSTANCE_ATTRIBUTE_LOCATION and the 3 locations after it,
+//       then the normal matrix's columns at the next 3. Skinned meshes use the Model uniform.
+#define MESH_INSTANCE_ATTRIBUTE_LOCATION 5
+struct mesh_instance
+{
+    glm::mat4 Transform;
+    glm::mat3 NormalMatrix;
 };
 
 #define MAX_BONE_CHILDREN 8
@@ -52,10 +80,20 @@ struct animation
     i32 ChannelCount;
     f32 *KeyTimes;
     animation_key *Keys;
+    // NOTE: Key of the shared keys it uses, 0 if the keys are its own
+    u64 ContentHash;
 
     char Name[MAX_INTERNAL_NAME_LENGTH];
 };
 
+// NOTE: Bind pose, model space box around the vertices a bone moves (any weight). Min > Max for
+//       bones that don't move any.
+struct bone_bounds
+{
+    glm::vec3 Min;
+    glm::vec3 Max;
+};
+
 struct animation_state
 {
     i32 CurrentAnimationA;
@@ -66,25 +104,65 @@ struct animation_state
     //bool IsLooped = true;
     
     glm::mat4 *TransientChannelTransformData;
+    // NOTE: Skinning matrix per bone (BoneCount of them, bone 0 is the dummy and stays identity),
+    //       uploaded to BoneTransforms in one go
+    glm::mat4 *BonePalette;
+};
+
+// NOTE: CPU copy of a mesh's positions and indices, for models loaded with KeepCPUData (picking,
+//       collision, culling). Lives in the model's arena.
+struct mesh_cpu_data
+{
+    i32 VertexCount;
+    i32 IndexCount;
+    f32 *Positions;
+    i32 *Indices;
+    // NOTE: Static models only (0 for skinned ones), so their meshes can be baked into others
+    f32 *UVs;
+    f32 *Normals;
+    f32 *Tangents;
 };
 
 struct skinned_model
 {
+    // NOTE: False while the model is still loading; a placeholder is drawn instead
+    bool IsReady;
+
     i32 MeshCount;
     mesh *Meshes;
+    // NOTE: One per mesh when loaded with KeepCPUData, 0 otherwise
+    mesh_cpu_data *CPUMeshes;
 
     i32 BoneCount;
     bone *Bones;
+    bone_bounds *BoneBounds;
 
     animation_state AnimationState;
+    // NOTE: Model space box around the current pose: each bone's box through its palette matrix.
+    //       Updated with the palette by UpdateSkinnedModelAnimation.
+    glm::vec3 PoseBoundsMin;
+    glm::vec3 PoseBoundsMax;
     i32 AnimationCount;
     animation *Animations;
+
+    // NOTE: Holds Meshes, CPUMeshes, Bones, Animations and the animation state's transforms; freed
+    //       in one go by FreeSkinnedModel. Animation keys belong to the shared clips (Model.cpp).
+    //       BoneBounds are in it too.
+    memory_arena Arena;
 };
 
 struct model
 {
+    // NOTE: False while the model is still loading; a placeholder is drawn instead
+    bool IsReady;
+
     i32 MeshCount;
     mesh *Meshes;
+    // NOTE: One per mesh when loaded with KeepCPUData, 0 otherwise
+    mesh_cpu_data *CPUMeshes;
+
+    // NOTE: Holds Meshes and CPUMeshes; freed in one go by FreeModel
+    memory_arena Arena;
 };
 
 #define POSITIONS_PER_VERTEX 3
@@ -112,6 +190,16 @@ struct mesh_internal_data
     i32 *Indices;
 };
 
+struct model_load_data;
+
+// NOTE: Other source files a cooked asset was built from (besides its own source)
+#define MAX_COOK_DEPENDENCY_COUNT 32
+struct cook_dependencies
+{
+    i32 Count;
+    char Paths[MAX_COOK_DEPENDENCY_COUNT][MAX_PATH_LENGTH];
+};
+
 // ---------------------
 // FUNCTION DECLARATIONS
 // ---------------------
@@ -123,13 +211,104 @@ model
 LoadModel(const char *Path, bool GenerateMipmap);
 skinned_model
 LoadSkinnedModel(const char *Path, bool GenerateMipmap);
+// NOTE: Deletes the GL objects and releases the mesh textures; the model has to be ready
+void
+FreeModel(model *Model);
+void
+FreeSkinnedModel(skinned_model *Model);
+
+// Staged model loading
+// --------------------
+
+// NOTE: CPU stage: file IO, parsing and texture decoding. Doesn't touch GL, so it can run on a
+//       worker thread. Returns 0 if the model couldn't be loaded. With KeepCPUData the model gets
+//       CPUMeshes; otherwise nothing but the GL buffers outlives the upload.
+model_load_data *
+PrepareModelLoadData(const char *Path, bool IsSkinned, bool GenerateMipmap, bool KeepCPUData);
+// NOTE: GL stage: uploads one texture or mesh per call, returns true once everything is uploaded
+bool
+UploadModelLoadDataStep(model_load_data *LoadData);
+// NOTE: Hand the uploaded data over to the model and free LoadData
+void
+FinishModelLoad(model_load_data *LoadData, model *Out_Model);
+void
+FinishSkinnedModelLoad(model_load_data *LoadData, skinned_model *Out_Model);
+void
+FreeModelLoadData(model_load_data *LoadData);
+
+// Mesh data
+// ---------
+
+// NOTE: One allocation holding the planar vertex attributes and the indices. The heap version is
+//       for data built on several threads at once (OBJ meshes) and has to be freed with
+//       FreeMeshInternalData; everything else pushes it to an arena.
+mesh_internal_data
+InitializeMeshInternalData(i32 VertexCount, i32 IndexCount, bool IncludeBones);
+mesh_internal_data
+PushMeshInternalData(memory_arena *Arena, i32 VertexCount, i32 IndexCount, bool IncludeBones);
+void
+FreeMeshInternalData(mesh_internal_data *MeshInternalData);
+// NOTE: GL thread. Static vertex data as a mesh of its own: not shared with other models, no
+//       textures, bounds computed as for a loaded mesh. FreeModel deletes it with the rest.
+void
+UploadMeshInternalData(mesh_internal_data MeshInternalData, mesh *Out_Mesh);
+
+// Model cooking
+// -------------
+
+void
+GetCookedModelPath(const char *SourcePath, char *Out_CookedPath, i32 CookedPathBufferSize);
+void
+AddCookDependency(cook_dependencies *Dependencies, const char *Path);
+// NOTE: Out_Dependencies (optional) gets the files the model was built from besides the source
+bool
+CookModel(const char *SourcePath, const char *CookedPath, cook_dependencies *Out_Dependencies);
 
 // Model rendering
 // ---------------
 
+// NOTE: The program has to read its transforms from the instance attributes (StaticMesh.vs)
+void
+RenderModel(model *Model, u32 Shader, glm::mat4 Transform);
+// NOTE: Every mesh is drawn for all the transforms in one instanced draw
 void
-RenderModel(model *Model, u32 Shader);
+RenderModelInstanced(model *Model, u32 Shader, glm::mat4 *Transforms, i32 InstanceCount);
+// NOTE: Advances the animation by DeltaTime (UpdateSkinnedModelAnimation) before drawing
 void
 RenderSkinnedModel(skinned_model *Model, u32 Shader, f32 DeltaTime);
+// NOTE: Advances the animation and rebuilds AnimationState.BonePalette; nothing for models that
+//       aren't ready
+void
+UpdateSkinnedModelAnimation(skinned_model *Model, f32 DeltaTime);
+// NOTE: Binds the mesh's textures and VAO and draws it with whatever program is bound. For skinned
+//       meshes; static ones go through RenderMeshInstanced.
+void
+RenderMesh(mesh *Mesh);
+mesh_instance
+MakeMeshInstance(glm::mat4 Transform);
+// NOTE: Into the stream buffer (StreamBuffer.h), for this frame only. False if it didn't fit, in
+//       which case there's nothing to draw instances from.
+bool
+UploadMeshInstances(mesh_instance *Instances, i32 InstanceCount);
+// NOTE: InstanceCount instances from FirstInstance of the last UploadMeshInstances
+void
+RenderMeshInstanced(mesh *Mesh, i32 FirstInstance, i32 InstanceCount);
+// NOTE: What's drawn for models that are still loading. The skinned one is fully weighted to bone 1.
+mesh *
+GetPlaceholderMesh(bool IsSkinned);
+// NOTE: Model space box around all the meshes (the placeholder's while the model is loading).
+//       Skinned models get the box around their current pose.
+void
+GetModelBounds(model *Model, glm::vec3 *Out_Min, glm::vec3 *Out_Max);
+void
+GetSkinnedModelBounds(skinned_model *Model, glm::vec3 *Out_Min, glm::vec3 *Out_Max);
+// NOTE: Tells the texture streamer how much detail the model's textures need this frame.
+//       PixelsPerUnit is how many pixels one world unit covers at distance 1: the projection's
+//       [1][1] times half the viewport height.
+void
+RequestModelTextureMips(model *Model, glm::mat4 ModelTransform, glm::vec3 CameraPosition, f32 PixelsPerUnit);
+void
+RequestSkinnedModelTextureMips(skinned_model *Model, glm::mat4 ModelTransform, glm::vec3 CameraPosition,
+                               f32 PixelsPerUnit);
 
 #endif
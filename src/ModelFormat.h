@@ -0,0 +1,99 @@
+#ifndef MODEL_FORMAT_H
+#define MODEL_FORMAT_H
+
+#include "Common.h"
+
+// NOTE: Cooked model file layout (all offsets are from the start of the file):
+//
+//       cooked_model_header
+//       [vertex blob, index blob] per mesh    (COOKED_MODEL_BLOB_ALIGNMENT)
+//       [key times, keys] per animation       (COOKED_MODEL_BLOB_ALIGNMENT)
+//       cooked_mesh[MeshCount]
+//       cooked_material[MaterialCount]
+//       bone[BoneCount]
+//       cooked_animation[AnimationCount]
+//       cooked_dependency[DependencyCount]    (the source first, then the files it references)
+//
+//       Vertex blobs use the same planar layout as mesh_internal_data (positions, UVs, normals,
+//       tangents, bitangents, then bone IDs and weights for skinned models), so a mapped blob
+//       can be passed to glBufferData as is.
+//
+//       Every file the model was cooked from is stamped with its size and modification time, and
+//       the cooked file is only trusted while all of them still match (see COOKED_IsUpToDate).
+
+#define COOKED_MODEL_MAGIC 0x4C444D43 // 'CMDL'
+#define COOKED_MODEL_VERSION 3
+#define COOKED_MODEL_EXTENSION ".cmdl"
+
+#define COOKED_MODEL_BLOB_ALIGNMENT 64
+#define COOKED_MODEL_TABLE_ALIGNMENT 16
+
+#define COOKED_MODEL_FLAG_SKINNED 0x1
+
+#define COOKED_MATERIAL_TEXTURE_COUNT 4
+
+struct cooked_model_header
+{
+    u32 Magic;
+    u32 Version;
+    u32 Flags;
+    i32 DependencyCount;
+
+    u64 FileSize;
+
+    i32 MeshCount;
+    i32 MaterialCount;
+    i32 BoneCount;
+    i32 AnimationCount;
+
+    u64 MeshesOffset;
+    u64 MaterialsOffset;
+    u64 BonesOffset;
+    u64 AnimationsOffset;
+    u64 DependenciesOffset;
+};
+
+struct cooked_mesh
+{
+    i32 VertexCount;
+    i32 IndexCount;
+    i32 MaterialIndex;
+    u32 Reserved;
+
+    u64 VertexDataOffset;
+    u64 VertexDataSize;
+    u64 IndexDataOffset;
+    u64 IndexDataSize;
+};
+
+struct cooked_material
+{
+    // NOTE: Same order as mesh::TextureIDs (diffuse, specular, emission, normal);
+    //       file names are relative to the model's directory, empty if there's no texture
+    char TextureFilenames[COOKED_MATERIAL_TEXTURE_COUNT][MAX_FILENAME_LENGTH];
+    // NOTE: HashFile64 of each texture at cook time, 0 if there's no texture or it couldn't be read
+    u64 TextureContentHashes[COOKED_MATERIAL_TEXTURE_COUNT];
+};
+
+struct cooked_animation
+{
+    f32 TicksDuration;
+    f32 TicksPerSecond;
+    i32 KeyCount;
+    i32 ChannelCount;
+
+    u64 KeyTimesOffset;
+    u64 KeysOffset;
+
+    char Name[MAX_INTERNAL_NAME_LENGTH];
+};
+
+struct cooked_dependency
+{
+    char Path[MAX_PATH_LENGTH];
+    // NOTE: As GetFileInfo reported them at cook time; both 0 if the file didn't exist
+    u64 Size;
+    u64 ModificationTime;
+};
+
+#endif
@@ -0,0 +1,1204 @@
+#include "Obj.h"
+
+#include <SDL2/SDL.h>
+#include <emmintrin.h>
+#include <glm/glm.hpp>
+
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "FileIO.h"
+#include "Jobs.h"
+#include "Util.h"
+
+// NOTE: Files smaller than one chunk are parsed on the calling thread; not worth waking workers
+#define OBJ_MIN_CHUNK_SIZE (1 << 20)
+#define OBJ_MAX_CHUNK_COUNT 64
+#define OBJ_MAX_MATERIAL_COUNT 256
+#define OBJ_MAX_FACE_CORNERS 64
+// NOTE: Digits a u64 mantissa can take without overflowing
+#define OBJ_MAX_MANTISSA_DIGITS 18
+
+// NOTE: Face indices as the chunk parser stores them. Positive indices in the file are absolute
+//       and final. Negative ones are relative to the vertices read so far, which a chunk only
+//       knows for itself, so they're stored relative to the chunk's own counts (biased to keep
+//       them apart from absolute ones) and resolved once every chunk has been parsed.
+#define OBJ_MISSING_INDEX INT_MIN
+#define OBJ_RELATIVE_INDEX_BIAS (1 << 30)
+
+struct obj_corner
+{
+    i32 Position;
+    i32 UV;
+    i32 Normal;
+};
+
+struct obj_material_run
+{
+    // NOTE: Into obj_chunk::Corners / 3
+    i32 FirstTriangle;
+    char Name[MAX_FILENAME_LENGTH];
+};
+
+struct obj_parse_state;
+
+struct obj_chunk
+{
+    obj_parse_state *State;
+    const char *Start;
+    const char *End;
+    bool IsValid;
+
+    i32 PositionCount;
+    i32 PositionCapacity;
+    f32 *Positions;
+    i32 UVCount;
+    i32 UVCapacity;
+    f32 *UVs;
+    i32 NormalCount;
+    i32 NormalCapacity;
+    f32 *Normals;
+
+    // NOTE: Already triangulated, 3 per triangle
+    i32 CornerCount;
+    i32 CornerCapacity;
+    obj_corner *Corners;
+
+    i32 RunCount;
+    i32 RunCapacity;
+    obj_material_run *Runs;
+
+    char MaterialLibrary[MAX_FILENAME_LENGTH];
+
+    // NOTE: Counts of all the chunks before this one
+    i32 PositionBase;
+    i32 UVBase;
+    i32 NormalBase;
+};
+
+struct obj_material
+{
+    char Name[MAX_FILENAME_LENGTH];
+    cooked_material Material;
+};
+
+// NOTE: Triangles of one chunk that use the same material
+struct obj_segment
+{
+    i32 ChunkIndex;
+    i32 FirstTriangle;
+    i32 TriangleCount;
+    // NOTE: Into obj_parse_state::Materials, MaterialCount for faces without a material
+    i32 MaterialSlot;
+};
+
+struct obj_mesh_build
+{
+    obj_parse_state *State;
+    i32 MaterialSlot;
+    obj_mesh *Mesh;
+    bool IsValid;
+};
+
+struct obj_parse_state
+{
+    const char *FileEnd;
+
+    i32 ChunkCount;
+    obj_chunk Chunks[OBJ_MAX_CHUNK_COUNT];
+
+    // NOTE: Every chunk's vertex attributes, concatenated in file order
+    i32 PositionCount;
+    i32 UVCount;
+    i32 NormalCount;
+    f32 *Positions;
+    f32 *UVs;
+    f32 *Normals;
+
+    i32 MaterialCount;
+    obj_material Materials[OBJ_MAX_MATERIAL_COUNT];
+
+    i32 SegmentCount;
+    i32 SegmentCapacity;
+    obj_segment *Segments;
+};
+
+static const f64 OBJPowersOf10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+static const u32 OBJPowersOf10U32[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+// NOTE: Loaded at (16 - N) to get a mask that keeps the first N bytes
+static const u8 OBJDigitKeepMask[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+static void
+ParseOBJChunkJob(void *Data);
+static void
+ResolveOBJChunkJob(void *Data);
+static void
+BuildOBJMeshJob(void *Data);
+static void
+RunOBJJobs(job_queue *Queue, job_callback *Callback, void *Items, size_t ItemSize, i32 ItemCount);
+
+static void
+ParseOBJFace(obj_chunk *Chunk, const char *Cursor, const char *LineEnd);
+static void
+ParseMTL(obj_parse_state *State, const char *OBJPath, const char *LibraryName);
+static i32
+FindOBJMaterial(obj_parse_state *State, const char *Name);
+static void
+AddOBJSegment(obj_parse_state *State, i32 ChunkIndex, i32 FirstTriangle, i32 TriangleCount, i32 MaterialSlot);
+static void
+FreeOBJParseState(obj_parse_state *State);
+
+static inline const char *
+FindOBJLineEnd(const char *Cursor, const char *End);
+static inline const char *
+ParseOBJDigits(const char *Cursor, const char *End, u64 *Mantissa, i32 *MantissaDigitCount,
+               i32 *Out_AppendedCount, i32 *Out_DroppedCount);
+static inline u32
+ParseEightDigits(__m128i Digits);
+static inline const char *
+ParseOBJFloat(const char *Cursor, const char *End, f32 *Out_Value);
+static inline const char *
+ParseOBJIndex(const char *Cursor, const char *End, i32 *Out_Index);
+static inline i32
+EncodeOBJIndex(i32 FileIndex, i32 LocalCount);
+static inline bool
+ResolveOBJIndex(i32 *Index, i32 Base, i32 Count);
+static inline u32
+HashOBJCorner(obj_corner Corner);
+static bool
+IsOBJKeyword(const char *Cursor, const char *LineEnd, const char *Keyword);
+static void
+CopyOBJLineArgument(const char *Cursor, const char *LineEnd, char *Out_String, i32 StringBufferSize);
+static void *
+GrowOBJArray(void *Data, i32 *Capacity, i32 Needed, size_t ElementSize);
+static inline i32
+FindLowestSetBit(u32 Value);
+
+bool
+ParseOBJ(const char *Path, obj_model *Out_Model)
+{
+    *Out_Model = { };
+
+    mapped_file File;
+    if (!MapFileReadOnly(Path, &File))
+    {
+        fprintf(stderr, "Couldn't open OBJ: %s\n", Path);
+        return false;
+    }
+
+    obj_parse_state *State = (obj_parse_state *) calloc(1, sizeof(obj_parse_state));
+    Assert(State);
+    const char *FileStart = (const char *) File.Data;
+    State->FileEnd = FileStart + File.Size;
+
+    // Line-aligned chunks
+    // -------------------
+    i32 ChunkCount = (i32) (File.Size / OBJ_MIN_CHUNK_SIZE);
+    i32 CoreCount = SDL_GetCPUCount();
+    if (ChunkCount > CoreCount) ChunkCount = CoreCount;
+    if (ChunkCount > OBJ_MAX_CHUNK_COUNT) ChunkCount = OBJ_MAX_CHUNK_COUNT;
+    if (ChunkCount < 1) ChunkCount = 1;
+
+    State->ChunkCount = ChunkCount;
+    const char *ChunkStart = FileStart;
+    for (i32 ChunkIndex = 0; ChunkIndex < ChunkCount; ++ChunkIndex)
+    {
+        obj_chunk *Chunk = &State->Chunks[ChunkIndex];
+        const char *ChunkEnd = State->FileEnd;
+        if (ChunkIndex < ChunkCount - 1)
+        {
+            ChunkEnd = FileStart + (File.Size / ChunkCount) * (ChunkIndex + 1);
+            if (ChunkEnd < ChunkStart)
+            {
+                ChunkEnd = ChunkStart;
+            }
+            ChunkEnd = FindOBJLineEnd(ChunkEnd, State->FileEnd);
+            if (ChunkEnd < State->FileEnd)
+            {
+                ++ChunkEnd;
+            }
+        }
+
+        Chunk->State = State;
+        Chunk->Start = ChunkStart;
+        Chunk->End = ChunkEnd;
+        Chunk->IsValid = true;
+        ChunkStart = ChunkEnd;
+    }
+
+    job_queue *Queue = (ChunkCount > 1) ? CreateJobQueue(ChunkCount - 1) : 0;
+
+    RunOBJJobs(Queue, ParseOBJChunkJob, State->Chunks, sizeof(obj_chunk), ChunkCount);
+
+    // Concatenate vertex attributes
+    // -----------------------------
+    bool Success = true;
+    for (i32 ChunkIndex = 0; ChunkIndex < ChunkCount; ++ChunkIndex)
+    {
+        obj_chunk *Chunk = &State->Chunks[ChunkIndex];
+        Success = Success && Chunk->IsValid;
+
+        Chunk->PositionBase = State->PositionCount;
+        Chunk->UVBase = State->UVCount;
+        Chunk->NormalBase = State->NormalCount;
+        State->PositionCount += Chunk->PositionCount;
+        State->UVCount += Chunk->UVCount;
+        State->NormalCount += Chunk->NormalCount;
+    }
+
+    if (Success)
+    {
+        State->Positions = (f32 *) malloc((State->PositionCount * 3 + 1) * sizeof(f32));
+        State->UVs = (f32 *) malloc((State->UVCount * 2 + 1) * sizeof(f32));
+        State->Normals = (f32 *) malloc((State->NormalCount * 3 + 1) * sizeof(f32));
+        Assert(State->Positions && State->UVs && State->Normals);
+
+        for (i32 ChunkIndex = 0; ChunkIndex < ChunkCount; ++ChunkIndex)
+        {
+            obj_chunk *Chunk = &State->Chunks[ChunkIndex];
+            memcpy(State->Positions + Chunk->PositionBase * 3, Chunk->Positions, Chunk->PositionCount * 3 * sizeof(f32));
+            memcpy(State->UVs + Chunk->UVBase * 2, Chunk->UVs, Chunk->UVCount * 2 * sizeof(f32));
+            memcpy(State->Normals + Chunk->NormalBase * 3, Chunk->Normals, Chunk->NormalCount * 3 * sizeof(f32));
+        }
+
+        RunOBJJobs(Queue, ResolveOBJChunkJob, State->Chunks, sizeof(obj_chunk), ChunkCount);
+
+        for (i32 ChunkIndex = 0; ChunkIndex < ChunkCount; ++ChunkIndex)
+        {
+            Success = Success && State->Chunks[ChunkIndex].IsValid;
+        }
+        if (!Success)
+        {
+            fprintf(stderr, "OBJ face references a vertex that doesn't exist: %s\n", Path);
+        }
+    }
+    else
+    {
+        fprintf(stderr, "Malformed OBJ face: %s\n", Path);
+    }
+
+    // Materials and per-material segments
+    // ------------------------------------
+    if (Success)
+    {
+        for (i32 ChunkIndex = 0; ChunkIndex < ChunkCount; ++ChunkIndex)
+        {
+            if (State->Chunks[ChunkIndex].MaterialLibrary[0])
+            {
+                ParseMTL(State, Path, State->Chunks[ChunkIndex].MaterialLibrary);
+                break;
+            }
+        }
+
+        // NOTE: A usemtl carries over into the following chunks
+        i32 MaterialSlot = State->MaterialCount;
+        for (i32 ChunkIndex = 0; ChunkIndex < ChunkCount; ++ChunkIndex)
+        {
+            obj_chunk *Chunk = &State->Chunks[ChunkIndex];
+            i32 SegmentStart = 0;
+            for (i32 RunIndex = 0; RunIndex < Chunk->RunCount; ++RunIndex)
+            {
+                obj_material_run *Run = &Chunk->Runs[RunIndex];
+                AddOBJSegment(State, ChunkIndex, SegmentStart, Run->FirstTriangle - SegmentStart, MaterialSlot);
+                MaterialSlot = FindOBJMaterial(State, Run->Name);
+                SegmentStart = Run->FirstTriangle;
+            }
+            AddOBJSegment(State, ChunkIndex, SegmentStart, Chunk->CornerCount / 3 - SegmentStart, MaterialSlot);
+        }
+    }
+
+    // Welded meshes, one per material
+    // -------------------------------
+    if (Success && State->SegmentCount > 0)
+    {
+        i32 MeshSlots[OBJ_MAX_MATERIAL_COUNT + 1];
+        i32 MeshCount = 0;
+        for (i32 SegmentIndex = 0; SegmentIndex < State->SegmentCount; ++SegmentIndex)
+        {
+            i32 Slot = State->Segments[SegmentIndex].MaterialSlot;
+            i32 MeshIndex = 0;
+            while (MeshIndex < MeshCount && MeshSlots[MeshIndex] != Slot)
+            {
+                ++MeshIndex;
+            }
+            if (MeshIndex == MeshCount)
+            {
+                MeshSlots[MeshCount++] = Slot;
+            }
+        }
+
+        Out_Model->MeshCount = MeshCount;
+        Out_Model->Meshes = (obj_mesh *) calloc(1, MeshCount * sizeof(obj_mesh));
+        obj_mesh_build *Builds = (obj_mesh_build *) calloc(1, MeshCount * sizeof(obj_mesh_build));
+        Assert(Out_Model->Meshes && Builds);
+
+        for (i32 MeshIndex = 0; MeshIndex < MeshCount; ++MeshIndex)
+        {
+            Builds[MeshIndex].State = State;
+            Builds[MeshIndex].MaterialSlot = MeshSlots[MeshIndex];
+            Builds[MeshIndex].Mesh = &Out_Model->Meshes[MeshIndex];
+        }
+
+        RunOBJJobs(Queue, BuildOBJMeshJob, Builds, sizeof(obj_mesh_build), MeshCount);
+
+        for (i32 MeshIndex = 0; MeshIndex < MeshCount; ++MeshIndex)
+        {
+            Success = Success && Builds[MeshIndex].IsValid;
+        }
+        free(Builds);
+    }
+    else
+    {
+        Success = false;
+    }
+
+    if (Queue)
+    {
+        DestroyJobQueue(Queue);
+    }
+    FreeOBJParseState(State);
+    UnmapFile(&File);
+
+    if (!Success)
+    {
+        FreeOBJ(Out_Model);
+    }
+
+    return Success;
+}
+
+void
+FreeOBJ(obj_model *Model)
+{
+    for (i32 MeshIndex = 0; MeshIndex < Model->MeshCount; ++MeshIndex)
+    {
+        if (Model->Meshes[MeshIndex].InternalData.Data)
+        {
+            FreeMeshInternalData(&Model->Meshes[MeshIndex].InternalData);
+        }
+    }
+    free(Model->Meshes);
+    *Model = { };
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+static void
+ParseOBJChunkJob(void *Data)
+{
+    obj_chunk *Chunk = (obj_chunk *) Data;
+    const char *FileEnd = Chunk->State->FileEnd;
+
+    const char *Cursor = Chunk->Start;
+    while (Cursor < Chunk->End)
+    {
+        const char *LineEnd = FindOBJLineEnd(Cursor, Chunk->End);
+        while (Cursor < LineEnd && (*Cursor == ' ' || *Cursor == '\t'))
+        {
+            ++Cursor;
+        }
+
+        // NOTE: Number parsing is bounded by FileEnd, not LineEnd, so SSE loads can run over the
+        //       end of short lines; digits never continue past a newline anyway
+        if (LineEnd - Cursor >= 2)
+        {
+            char Second = Cursor[1];
+            if (Cursor[0] == 'v' && (Second == ' ' || Second == '\t'))
+            {
+                Chunk->Positions = (f32 *) GrowOBJArray(Chunk->Positions, &Chunk->PositionCapacity,
+                                                        (Chunk->PositionCount + 1) * 3, sizeof(f32));
+                f32 *Position = &Chunk->Positions[Chunk->PositionCount++ * 3];
+                Position[0] = Position[1] = Position[2] = 0.0f;
+                Cursor = ParseOBJFloat(Cursor + 1, FileEnd, &Position[0]);
+                Cursor = ParseOBJFloat(Cursor, FileEnd, &Position[1]);
+                Cursor = ParseOBJFloat(Cursor, FileEnd, &Position[2]);
+            }
+            else if (Cursor[0] == 'v' && Second == 't')
+            {
+                Chunk->UVs = (f32 *) GrowOBJArray(Chunk->UVs, &Chunk->UVCapacity,
+                                                  (Chunk->UVCount + 1) * 2, sizeof(f32));
+                f32 *UV = &Chunk->UVs[Chunk->UVCount++ * 2];
+                UV[0] = UV[1] = 0.0f;
+                Cursor = ParseOBJFloat(Cursor + 2, FileEnd, &UV[0]);
+                // NOTE: Flipped, same as aiProcess_FlipUVs
+                Cursor = ParseOBJFloat(Cursor, FileEnd, &UV[1]);
+                UV[1] = 1.0f - UV[1];
+            }
+            else if (Cursor[0] == 'v' && Second == 'n')
+            {
+                Chunk->Normals = (f32 *) GrowOBJArray(Chunk->Normals, &Chunk->NormalCapacity,
+                                                      (Chunk->NormalCount + 1) * 3, sizeof(f32));
+                f32 *Normal = &Chunk->Normals[Chunk->NormalCount++ * 3];
+                Normal[0] = Normal[1] = Normal[2] = 0.0f;
+                Cursor = ParseOBJFloat(Cursor + 2, FileEnd, &Normal[0]);
+                Cursor = ParseOBJFloat(Cursor, FileEnd, &Normal[1]);
+                Cursor = ParseOBJFloat(Cursor, FileEnd, &Normal[2]);
+            }
+            else if (Cursor[0] == 'f' && (Second == ' ' || Second == '\t'))
+            {
+                ParseOBJFace(Chunk, Cursor + 1, LineEnd);
+            }
+            else if (IsOBJKeyword(Cursor, LineEnd, "usemtl"))
+            {
+                Chunk->Runs = (obj_material_run *) GrowOBJArray(Chunk->Runs, &Chunk->RunCapacity,
+                                                                Chunk->RunCount + 1, sizeof(obj_material_run));
+                obj_material_run *Run = &Chunk->Runs[Chunk->RunCount++];
+                Run->FirstTriangle = Chunk->CornerCount / 3;
+                CopyOBJLineArgument(Cursor + 6, LineEnd, Run->Name, MAX_FILENAME_LENGTH);
+            }
+            else if (IsOBJKeyword(Cursor, LineEnd, "mtllib") && !Chunk->MaterialLibrary[0])
+            {
+                CopyOBJLineArgument(Cursor + 6, LineEnd, Chunk->MaterialLibrary, MAX_FILENAME_LENGTH);
+            }
+        }
+
+        Cursor = LineEnd + 1;
+    }
+}
+
+static void
+ParseOBJFace(obj_chunk *Chunk, const char *Cursor, const char *LineEnd)
+{
+    const char *FileEnd = Chunk->State->FileEnd;
+
+    obj_corner FaceCorners[OBJ_MAX_FACE_CORNERS];
+    i32 FaceCornerCount = 0;
+
+    for (;;)
+    {
+        while (Cursor < LineEnd && (*Cursor == ' ' || *Cursor == '\t' || *Cursor == '\r'))
+        {
+            ++Cursor;
+        }
+        if (Cursor >= LineEnd)
+        {
+            break;
+        }
+        if (FaceCornerCount == OBJ_MAX_FACE_CORNERS)
+        {
+            Chunk->IsValid = false;
+            return;
+        }
+
+        // NOTE: v, v/vt, v//vn or v/vt/vn
+        i32 Position = 0;
+        i32 UV = 0;
+        i32 Normal = 0;
+        Cursor = ParseOBJIndex(Cursor, FileEnd, &Position);
+        if (Cursor < LineEnd && *Cursor == '/')
+        {
+            ++Cursor;
+            if (Cursor < LineEnd && *Cursor != '/')
+            {
+                Cursor = ParseOBJIndex(Cursor, FileEnd, &UV);
+            }
+            if (Cursor < LineEnd && *Cursor == '/')
+            {
+                Cursor = ParseOBJIndex(Cursor + 1, FileEnd, &Normal);
+            }
+        }
+
+        bool IsCornerEnd = (Cursor >= LineEnd || *Cursor == ' ' || *Cursor == '\t' || *Cursor == '\r');
+        if (Position == 0 || !IsCornerEnd)
+        {
+            Chunk->IsValid = false;
+            return;
+        }
+
+        obj_corner *Corner = &FaceCorners[FaceCornerCount++];
+        Corner->Position = EncodeOBJIndex(Position, Chunk->PositionCount);
+        Corner->UV = EncodeOBJIndex(UV, Chunk->UVCount);
+        Corner->Normal = EncodeOBJIndex(Normal, Chunk->NormalCount);
+    }
+
+    // NOTE: Fan triangulation, same as aiProcess_Triangulate for convex polygons
+    if (FaceCornerCount >= 3)
+    {
+        i32 NewCornerCount = (FaceCornerCount - 2) * 3;
+        Chunk->Corners = (obj_corner *) GrowOBJArray(Chunk->Corners, &Chunk->CornerCapacity,
+                                                     Chunk->CornerCount + NewCornerCount, sizeof(obj_corner));
+        obj_corner *Out = &Chunk->Corners[Chunk->CornerCount];
+        for (i32 CornerIndex = 1; CornerIndex < FaceCornerCount - 1; ++CornerIndex)
+        {
+            *Out++ = FaceCorners[0];
+            *Out++ = FaceCorners[CornerIndex];
+            *Out++ = FaceCorners[CornerIndex + 1];
+        }
+        Chunk->CornerCount += NewCornerCount;
+    }
+}
+
+static void
+ResolveOBJChunkJob(void *Data)
+{
+    obj_chunk *Chunk = (obj_chunk *) Data;
+    obj_parse_state *State = Chunk->State;
+
+    for (i32 CornerIndex = 0; CornerIndex < Chunk->CornerCount; ++CornerIndex)
+    {
+        obj_corner *Corner = &Chunk->Corners[CornerIndex];
+        if (Corner->Position == OBJ_MISSING_INDEX ||
+            !ResolveOBJIndex(&Corner->Position, Chunk->PositionBase, State->PositionCount) ||
+            !ResolveOBJIndex(&Corner->UV, Chunk->UVBase, State->UVCount) ||
+            !ResolveOBJIndex(&Corner->Normal, Chunk->NormalBase, State->NormalCount))
+        {
+            Chunk->IsValid = false;
+            return;
+        }
+    }
+}
+
+static void
+BuildOBJMeshJob(void *Data)
+{
+    obj_mesh_build *Build = (obj_mesh_build *) Data;
+    obj_parse_state *State = Build->State;
+
+    i32 IndexCount = 0;
+    for (i32 SegmentIndex = 0; SegmentIndex < State->SegmentCount; ++SegmentIndex)
+    {
+        if (State->Segments[SegmentIndex].MaterialSlot == Build->MaterialSlot)
+        {
+            IndexCount += State->Segments[SegmentIndex].TriangleCount * 3;
+        }
+    }
+
+    // Weld identical corners (same position, UV and normal) with an open-addressing table
+    // -----------------------------------------------------------------------------------
+    i32 TableCapacity = 16;
+    while (TableCapacity < IndexCount * 2)
+    {
+        TableCapacity *= 2;
+    }
+    u32 TableMask = (u32) TableCapacity - 1;
+
+    i32 *Table = (i32 *) malloc(TableCapacity * sizeof(i32));
+    obj_corner *Vertices = (obj_corner *) malloc(IndexCount * sizeof(obj_corner));
+    i32 *Indices = (i32 *) malloc(IndexCount * sizeof(i32));
+    Assert(Table && Vertices && Indices);
+    memset(Table, 0xFF, TableCapacity * sizeof(i32));
+
+    i32 VertexCount = 0;
+    i32 *IndexCursor = Indices;
+    for (i32 SegmentIndex = 0; SegmentIndex < State->SegmentCount; ++SegmentIndex)
+    {
+        obj_segment *Segment = &State->Segments[SegmentIndex];
+        if (Segment->MaterialSlot != Build->MaterialSlot)
+        {
+            continue;
+        }
+
+        obj_corner *Corners = &State->Chunks[Segment->ChunkIndex].Corners[Segment->FirstTriangle * 3];
+        for (i32 CornerIndex = 0; CornerIndex < Segment->TriangleCount * 3; ++CornerIndex)
+        {
+            obj_corner Corner = Corners[CornerIndex];
+            u32 Slot = HashOBJCorner(Corner) & TableMask;
+            for (;;)
+            {
+                i32 Vertex = Table[Slot];
+                if (Vertex < 0)
+                {
+                    Vertex = VertexCount++;
+                    Vertices[Vertex] = Corner;
+                    Table[Slot] = Vertex;
+                    *IndexCursor++ = Vertex;
+                    break;
+                }
+                if (Vertices[Vertex].Position == Corner.Position &&
+                    Vertices[Vertex].UV == Corner.UV &&
+                    Vertices[Vertex].Normal == Corner.Normal)
+                {
+                    *IndexCursor++ = Vertex;
+                    break;
+                }
+                Slot = (Slot + 1) & TableMask;
+            }
+        }
+    }
+    free(Table);
+
+    mesh_internal_data InternalData = InitializeMeshInternalData(VertexCount, IndexCount, false);
+    if (!InternalData.Data)
+    {
+        free(Vertices);
+        free(Indices);
+        return;
+    }
+    memcpy(InternalData.Indices, Indices, IndexCount * sizeof(i32));
+    free(Indices);
+
+    // Vertex attributes
+    // -----------------
+    bool HasMissingNormals = false;
+    for (i32 Vertex = 0; Vertex < VertexCount; ++Vertex)
+    {
+        obj_corner Corner = Vertices[Vertex];
+        memcpy(&InternalData.Positions[Vertex * POSITIONS_PER_VERTEX],
+               &State->Positions[Corner.Position * 3], 3 * sizeof(f32));
+        if (Corner.UV != OBJ_MISSING_INDEX)
+        {
+            memcpy(&InternalData.UVs[Vertex * UVS_PER_VERTEX], &State->UVs[Corner.UV * 2], 2 * sizeof(f32));
+        }
+        if (Corner.Normal != OBJ_MISSING_INDEX)
+        {
+            memcpy(&InternalData.Normals[Vertex * NORMALS_PER_VERTEX],
+                   &State->Normals[Corner.Normal * 3], 3 * sizeof(f32));
+        }
+        else
+        {
+            HasMissingNormals = true;
+        }
+    }
+
+    // Per-triangle normals (only where the file has none) and tangents, summed per vertex
+    // -----------------------------------------------------------------------------------
+    glm::vec3 *Positions = (glm::vec3 *) InternalData.Positions;
+    glm::vec2 *UVs = (glm::vec2 *) InternalData.UVs;
+    glm::vec3 *Normals = (glm::vec3 *) InternalData.Normals;
+    glm::vec3 *Tangents = (glm::vec3 *) InternalData.Tangents;
+    glm::vec3 *Bitangents = (glm::vec3 *) InternalData.Bitangents;
+
+    for (i32 Index = 0; Index < IndexCount; Index += 3)
+    {
+        i32 V0 = InternalData.Indices[Index + 0];
+        i32 V1 = InternalData.Indices[Index + 1];
+        i32 V2 = InternalData.Indices[Index + 2];
+
+        glm::vec3 Edge1 = Positions[V1] - Positions[V0];
+        glm::vec3 Edge2 = Positions[V2] - Positions[V0];
+
+        if (HasMissingNormals)
+        {
+            // NOTE: Unnormalized, so bigger triangles weigh more
+            glm::vec3 FaceNormal = glm::cross(Edge1, Edge2);
+            i32 TriangleVertices[3] = { V0, V1, V2 };
+            for (i32 Corner = 0; Corner < 3; ++Corner)
+            {
+                if (Vertices[TriangleVertices[Corner]].Normal == OBJ_MISSING_INDEX)
+                {
+                    Normals[TriangleVertices[Corner]] += FaceNormal;
+                }
+            }
+        }
+
+        glm::vec2 DeltaUV1 = UVs[V1] - UVs[V0];
+        glm::vec2 DeltaUV2 = UVs[V2] - UVs[V0];
+        f32 Determinant = DeltaUV1.x * DeltaUV2.y - DeltaUV2.x * DeltaUV1.y;
+        if (fabsf(Determinant) < 1e-12f)
+        {
+            continue;
+        }
+
+        f32 InverseDeterminant = 1.0f / Determinant;
+        glm::vec3 Tangent = (Edge1 * DeltaUV2.y - Edge2 * DeltaUV1.y) * InverseDeterminant;
+        glm::vec3 Bitangent = (Edge2 * DeltaUV1.x - Edge1 * DeltaUV2.x) * InverseDeterminant;
+        Tangents[V0] += Tangent;
+        Tangents[V1] += Tangent;
+        Tangents[V2] += Tangent;
+        Bitangents[V0] += Bitangent;
+        Bitangents[V1] += Bitangent;
+        Bitangents[V2] += Bitangent;
+    }
+
+    for (i32 Vertex = 0; Vertex < VertexCount; ++Vertex)
+    {
+        glm::vec3 Normal = Normals[Vertex];
+        if (Vertices[Vertex].Normal == OBJ_MISSING_INDEX)
+        {
+            f32 Length = glm::length(Normal);
+            Normal = (Length > 0.0f) ? Normal / Length : glm::vec3(0.0f, 1.0f, 0.0f);
+            Normals[Vertex] = Normal;
+        }
+
+        // NOTE: Orthogonalized against the normal, as aiProcess_CalcTangentSpace does
+        glm::vec3 Tangent = Tangents[Vertex] - Normal * glm::dot(Normal, Tangents[Vertex]);
+        glm::vec3 Bitangent = Bitangents[Vertex] - Normal * glm::dot(Normal, Bitangents[Vertex]);
+        if (glm::dot(Tangent, Tangent) < 1e-12f)
+        {
+            // NOTE: No UVs or degenerate UVs; any direction perpendicular to the normal will do
+            glm::vec3 Axis = (fabsf(Normal.x) > 0.9f) ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+            Tangent = glm::cross(Normal, Axis);
+        }
+        Tangent = glm::normalize(Tangent);
+        if (glm::dot(Bitangent, Bitangent) < 1e-12f)
+        {
+            Bitangent = glm::cross(Normal, Tangent);
+        }
+        Tangents[Vertex] = Tangent;
+        Bitangents[Vertex] = glm::normalize(Bitangent);
+    }
+
+    free(Vertices);
+
+    Build->Mesh->InternalData = InternalData;
+    if (Build->MaterialSlot < State->MaterialCount)
+    {
+        Build->Mesh->Material = State->Materials[Build->MaterialSlot].Material;
+    }
+    Build->IsValid = true;
+}
+
+static void
+RunOBJJobs(job_queue *Queue, job_callback *Callback, void *Items, size_t ItemSize, i32 ItemCount)
+{
+    for (i32 ItemIndex = 0; ItemIndex < ItemCount; ++ItemIndex)
+    {
+        void *Item = (u8 *) Items + ItemIndex * ItemSize;
+        if (Queue)
+        {
+            AddJob(Queue, Callback, Item);
+        }
+        else
+        {
+            Callback(Item);
+        }
+    }
+
+    if (Queue)
+    {
+        CompleteAllJobs(Queue);
+    }
+}
+
+static void
+ParseMTL(obj_parse_state *State, const char *OBJPath, const char *LibraryName)
+{
+    char OBJPathOnStack[MAX_PATH_LENGTH];
+    strncpy_s(OBJPathOnStack, OBJPath, MAX_PATH_LENGTH - 1);
+    char Directory[MAX_PATH_LENGTH];
+    i32 DirectoryCount;
+    GetFileDirectory(OBJPathOnStack, GetNullTerminatedStringLength(OBJPathOnStack),
+                     Directory, &DirectoryCount, MAX_PATH_LENGTH);
+
+    char LibraryNameOnStack[MAX_FILENAME_LENGTH];
+    strncpy_s(LibraryNameOnStack, LibraryName, MAX_FILENAME_LENGTH - 1);
+    char LibraryPath[MAX_PATH_LENGTH];
+    CatStrings(Directory, DirectoryCount, LibraryNameOnStack, GetNullTerminatedStringLength(LibraryNameOnStack),
+               LibraryPath, MAX_PATH_LENGTH);
+
+    mapped_file File;
+    if (!MapFileReadOnly(LibraryPath, &File))
+    {
+        // NOTE: Assimp carries on without materials too
+        fprintf(stderr, "Couldn't open MTL: %s\n", LibraryPath);
+        return;
+    }
+
+    // NOTE: Same slots assimp fills in (diffuse, specular, emission, height)
+    const char *TextureKeys[COOKED_MATERIAL_TEXTURE_COUNT] = { "map_Kd", "map_Ks", "map_Ke", "map_Bump" };
+
+    obj_material *Material = 0;
+    const char *Cursor = (const char *) File.Data;
+    const char *End = Cursor + File.Size;
+    while (Cursor < End)
+    {
+        const char *LineEnd = FindOBJLineEnd(Cursor, End);
+        while (Cursor < LineEnd && (*Cursor == ' ' || *Cursor == '\t'))
+        {
+            ++Cursor;
+        }
+        if (IsOBJKeyword(Cursor, LineEnd, "newmtl"))
+        {
+            Material = 0;
+            if (State->MaterialCount < OBJ_MAX_MATERIAL_COUNT)
+            {
+                Material = &State->Materials[State->MaterialCount++];
+                CopyOBJLineArgument(Cursor + 6, LineEnd, Material->Name, MAX_FILENAME_LENGTH);
+            }
+        }
+        else if (Material)
+        {
+            for (i32 TextureType = 0; TextureType < COOKED_MATERIAL_TEXTURE_COUNT; ++TextureType)
+            {
+                // NOTE: "bump" is the other spelling of map_Bump
+                if (IsOBJKeyword(Cursor, LineEnd, TextureKeys[TextureType]) ||
+                    (TextureType == 3 && IsOBJKeyword(Cursor, LineEnd, "bump")))
+                {
+                    // NOTE: The file name is the last argument; options like -bm 1.0 come before it
+                    const char *NameEnd = LineEnd;
+                    while (NameEnd > Cursor && (NameEnd[-1] == ' ' || NameEnd[-1] == '\t' || NameEnd[-1] == '\r'))
+                    {
+                        --NameEnd;
+                    }
+                    const char *NameStart = NameEnd;
+                    while (NameStart > Cursor && NameStart[-1] != ' ' && NameStart[-1] != '\t')
+                    {
+                        --NameStart;
+                    }
+                    CopyOBJLineArgument(NameStart, NameEnd, Material->Material.TextureFilenames[TextureType],
+                                        MAX_FILENAME_LENGTH);
+                    break;
+                }
+            }
+        }
+
+        Cursor = LineEnd + 1;
+    }
+
+    UnmapFile(&File);
+}
+
+static i32
+FindOBJMaterial(obj_parse_state *State, const char *Name)
+{
+    for (i32 MaterialIndex = 0; MaterialIndex < State->MaterialCount; ++MaterialIndex)
+    {
+        if (strcmp(State->Materials[MaterialIndex].Name, Name) == 0)
+        {
+            return MaterialIndex;
+        }
+    }
+
+    return State->MaterialCount;
+}
+
+static void
+AddOBJSegment(obj_parse_state *State, i32 ChunkIndex, i32 FirstTriangle, i32 TriangleCount, i32 MaterialSlot)
+{
+    if (TriangleCount <= 0)
+    {
+        return;
+    }
+
+    State->Segments = (obj_segment *) GrowOBJArray(State->Segments, &State->SegmentCapacity,
+                                                   State->SegmentCount + 1, sizeof(obj_segment));
+    obj_segment *Segment = &State->Segments[State->SegmentCount++];
+    Segment->ChunkIndex = ChunkIndex;
+    Segment->FirstTriangle = FirstTriangle;
+    Segment->TriangleCount = TriangleCount;
+    Segment->MaterialSlot = MaterialSlot;
+}
+
+static void
+FreeOBJParseState(obj_parse_state *State)
+{
+    for (i32 ChunkIndex = 0; ChunkIndex < State->ChunkCount; ++ChunkIndex)
+    {
+        obj_chunk *Chunk = &State->Chunks[ChunkIndex];
+        free(Chunk->Positions);
+        free(Chunk->UVs);
+        free(Chunk->Normals);
+        free(Chunk->Corners);
+        free(Chunk->Runs);
+    }
+    free(State->Positions);
+    free(State->UVs);
+    free(State->Normals);
+    free(State->Segments);
+    free(State);
+}
+
+static inline const char *
+FindOBJLineEnd(const char *Cursor, const char *End)
+{
+    // NOTE: 16 bytes at a time
+    __m128i Newlines = _mm_set1_epi8('\n');
+    while (End - Cursor >= 16)
+    {
+        __m128i Bytes = _mm_loadu_si128((const __m128i *) Cursor);
+        u32 NewlineMask = (u32) _mm_movemask_epi8(_mm_cmpeq_epi8(Bytes, Newlines));
+        if (NewlineMask)
+        {
+            return Cursor + FindLowestSetBit(NewlineMask);
+        }
+        Cursor += 16;
+    }
+
+    while (Cursor < End && *Cursor != '\n')
+    {
+        ++Cursor;
+    }
+
+    return Cursor;
+}
+
+static inline const char *
+ParseOBJDigits(const char *Cursor, const char *End, u64 *Mantissa, i32 *MantissaDigitCount,
+               i32 *Out_AppendedCount, i32 *Out_DroppedCount)
+{
+    i32 AppendedCount = 0;
+    i32 DroppedCount = 0;
+
+    // NOTE: Up to 8 digits per step: find the run of digits with one compare, convert it with
+    //       two multiply-adds
+    while (End - Cursor >= 16 && *MantissaDigitCount + 8 <= OBJ_MAX_MANTISSA_DIGITS)
+    {
+        __m128i Digits = _mm_sub_epi8(_mm_loadu_si128((const __m128i *) Cursor), _mm_set1_epi8('0'));
+        __m128i IsDigit = _mm_cmpeq_epi8(_mm_min_epu8(Digits, _mm_set1_epi8(9)), Digits);
+        u32 NonDigitMask = ~(u32) _mm_movemask_epi8(IsDigit);
+        i32 DigitCount = FindLowestSetBit(NonDigitMask);
+        if (DigitCount > 8)
+        {
+            DigitCount = 8;
+        }
+        if (DigitCount == 0)
+        {
+            break;
+        }
+
+        __m128i KeepMask = _mm_loadu_si128((const __m128i *) (OBJDigitKeepMask + 16 - DigitCount));
+        u32 Value = ParseEightDigits(_mm_and_si128(Digits, KeepMask)) / OBJPowersOf10U32[8 - DigitCount];
+
+        *Mantissa = *Mantissa * OBJPowersOf10U32[DigitCount] + Value;
+        *MantissaDigitCount += DigitCount;
+        AppendedCount += DigitCount;
+        Cursor += DigitCount;
+
+        if (DigitCount < 8)
+        {
+            break;
+        }
+    }
+
+    while (Cursor < End && (u8) (*Cursor - '0') <= 9)
+    {
+        if (*MantissaDigitCount < OBJ_MAX_MANTISSA_DIGITS)
+        {
+            *Mantissa = *Mantissa * 10 + (*Cursor - '0');
+            ++*MantissaDigitCount;
+            ++AppendedCount;
+        }
+        else
+        {
+            ++DroppedCount;
+        }
+        ++Cursor;
+    }
+
+    *Out_AppendedCount = AppendedCount;
+    *Out_DroppedCount = DroppedCount;
+
+    return Cursor;
+}
+
+static inline u32
+ParseEightDigits(__m128i Digits)
+{
+    // NOTE: Digits holds 8 values 0-9 in its low bytes, most significant first
+    __m128i Wide = _mm_unpacklo_epi8(Digits, _mm_setzero_si128());
+    __m128i Pairs = _mm_madd_epi16(Wide, _mm_set_epi16(1, 10, 1, 10, 1, 10, 1, 10));
+    __m128i Quads = _mm_madd_epi16(_mm_packs_epi32(Pairs, Pairs), _mm_set_epi16(1, 100, 1, 100, 1, 100, 1, 100));
+
+    u32 High = (u32) _mm_cvtsi128_si32(Quads);
+    u32 Low = (u32) _mm_cvtsi128_si32(_mm_srli_si128(Quads, 4));
+
+    return High * 10000 + Low;
+}
+
+static inline const char *
+ParseOBJFloat(const char *Cursor, const char *End, f32 *Out_Value)
+{
+    while (Cursor < End && (*Cursor == ' ' || *Cursor == '\t'))
+    {
+        ++Cursor;
+    }
+
+    bool IsNegative = false;
+    if (Cursor < End && (*Cursor == '-' || *Cursor == '+'))
+    {
+        IsNegative = (*Cursor == '-');
+        ++Cursor;
+    }
+
+    const char *NumberStart = Cursor;
+    u64 Mantissa = 0;
+    i32 MantissaDigitCount = 0;
+    i32 AppendedCount;
+    i32 DroppedCount;
+    Cursor = ParseOBJDigits(Cursor, End, &Mantissa, &MantissaDigitCount, &AppendedCount, &DroppedCount);
+    i32 Exponent = DroppedCount;
+
+    if (Cursor < End && *Cursor == '.')
+    {
+        Cursor = ParseOBJDigits(Cursor + 1, End, &Mantissa, &MantissaDigitCount, &AppendedCount, &DroppedCount);
+        Exponent -= AppendedCount;
+    }
+
+    if (Cursor == NumberStart)
+    {
+        // NOTE: Not a number; leave the value alone
+        return Cursor;
+    }
+
+    if (Cursor < End && (*Cursor == 'e' || *Cursor == 'E'))
+    {
+        ++Cursor;
+        bool IsExponentNegative = false;
+        if (Cursor < End && (*Cursor == '-' || *Cursor == '+'))
+        {
+            IsExponentNegative = (*Cursor == '-');
+            ++Cursor;
+        }
+        i32 ExplicitExponent = 0;
+        while (Cursor < End && (u8) (*Cursor - '0') <= 9)
+        {
+            if (ExplicitExponent < 10000)
+            {
+                ExplicitExponent = ExplicitExponent * 10 + (*Cursor - '0');
+            }
+            ++Cursor;
+        }
+        Exponent += IsExponentNegative ? -ExplicitExponent : ExplicitExponent;
+    }
+
+    f64 Value = (f64) Mantissa;
+    if (Exponent < 0)
+    {
+        Value = (Exponent >= -22) ? Value / OBJPowersOf10[-Exponent] : Value * pow(10.0, Exponent);
+    }
+    else if (Exponent > 0)
+    {
+        Value = (Exponent <= 22) ? Value * OBJPowersOf10[Exponent] : Value * pow(10.0, Exponent);
+    }
+
+    *Out_Value = (f32) (IsNegative ? -Value : Value);
+
+    return Cursor;
+}
+
+static inline const char *
+ParseOBJIndex(const char *Cursor, const char *End, i32 *Out_Index)
+{
+    bool IsNegative = false;
+    if (Cursor < End && *Cursor == '-')
+    {
+        IsNegative = true;
+        ++Cursor;
+    }
+
+    u64 Value = 0;
+    i32 DigitCount = 0;
+    i32 AppendedCount;
+    i32 DroppedCount;
+    Cursor = ParseOBJDigits(Cursor, End, &Value, &DigitCount, &AppendedCount, &DroppedCount);
+
+    // NOTE: 0 means missing (or too big to be real)
+    *Out_Index = 0;
+    if (DroppedCount == 0 && Value < OBJ_RELATIVE_INDEX_BIAS)
+    {
+        *Out_Index = IsNegative ? -(i32) Value : (i32) Value;
+    }
+
+    return Cursor;
+}
+
+static inline i32
+EncodeOBJIndex(i32 FileIndex, i32 LocalCount)
+{
+    if (FileIndex > 0)
+    {
+        return FileIndex - 1;
+    }
+    if (FileIndex < 0)
+    {
+        return (LocalCount + FileIndex) - OBJ_RELATIVE_INDEX_BIAS;
+    }
+    return OBJ_MISSING_INDEX;
+}
+
+static inline bool
+ResolveOBJIndex(i32 *Index, i32 Base, i32 Count)
+{
+    if (*Index == OBJ_MISSING_INDEX)
+    {
+        return true;
+    }
+    if (*Index < 0)
+    {
+        *Index = Base + (*Index + OBJ_RELATIVE_INDEX_BIAS);
+    }
+
+    return (*Index >= 0 && *Index < Count);
+}
+
+static inline u32
+HashOBJCorner(obj_corner Corner)
+{
+    u32 Hash = ((u32) Corner.Position * 0x9E3779B1u) ^ ((u32) Corner.UV * 0x85EBCA77u) ^ ((u32) Corner.Normal * 0xC2B2AE3Du);
+    Hash ^= Hash >> 15;
+    Hash *= 0x2C1B3C6Du;
+    Hash ^= Hash >> 12;
+
+    return Hash;
+}
+
+static bool
+IsOBJKeyword(const char *Cursor, const char *LineEnd, const char *Keyword)
+{
+    // NOTE: Case-insensitive (map_Bump is often map_bump), and followed by an argument
+    for (; *Keyword; ++Keyword, ++Cursor)
+    {
+        if (Cursor >= LineEnd || tolower((u8) *Cursor) != tolower((u8) *Keyword))
+        {
+            return false;
+        }
+    }
+
+    return (Cursor < LineEnd && (*Cursor == ' ' || *Cursor == '\t'));
+}
+
+static void
+CopyOBJLineArgument(const char *Cursor, const char *LineEnd, char *Out_String, i32 StringBufferSize)
+{
+    while (Cursor < LineEnd && (*Cursor == ' ' || *Cursor == '\t'))
+    {
+        ++Cursor;
+    }
+    while (LineEnd > Cursor && (LineEnd[-1] == ' ' || LineEnd[-1] == '\t' || LineEnd[-1] == '\r'))
+    {
+        --LineEnd;
+    }
+
+    i32 Count = (i32) (LineEnd - Cursor);
+    if (Count > StringBufferSize - 1)
+    {
+        Count = StringBufferSize - 1;
+    }
+    memcpy(Out_String, Cursor, Count);
+    Out_String[Count] = '\0';
+}
+
+static void *
+GrowOBJArray(void *Data, i32 *Capacity, i32 Needed, size_t ElementSize)
+{
+    if (Needed > *Capacity)
+    {
+        i32 NewCapacity = (*Capacity > 0) ? *Capacity * 2 : 1024;
+        while (NewCapacity < Needed)
+        {
+            NewCapacity *= 2;
+        }
+
+        Data = realloc(Data, NewCapacity * ElementSize);
+        Assert(Data);
+        *Capacity = NewCapacity;
+    }
+
+    return Data;
+}
+
+static inline i32
+FindLowestSetBit(u32 Value)
+{
+    Assert(Value);
+#ifdef _MSC_VER
+    unsigned long Index;
+    _BitScanForward(&Index, Value);
+    return (i32) Index;
+#else
+    return __builtin_ctz(Value);
+#endif
+}
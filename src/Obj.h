@@ -0,0 +1,32 @@
+#ifndef OBJ_H
+#define OBJ_H
+
+#include "Common.h"
+#include "Model.h"
+#include "ModelFormat.h"
+
+// NOTE: Native Wavefront OBJ/MTL reader. Produces the same data the assimp import does
+//       (triangulated, identical vertices welded, UVs flipped, tangents calculated), but files
+//       over OBJ_MIN_CHUNK_SIZE are split into line-aligned chunks that are parsed in parallel.
+//       Doesn't touch GL, so it's fine to call from a worker thread.
+
+// NOTE: One mesh per material, in the order the materials are first used in the file
+struct obj_mesh
+{
+    mesh_internal_data InternalData;
+    cooked_material Material;
+};
+
+struct obj_model
+{
+    i32 MeshCount;
+    obj_mesh *Meshes;
+};
+
+bool
+ParseOBJ(const char *Path, obj_model *Out_Model);
+// NOTE: Frees the InternalData of every mesh that wasn't taken over (zeroed out) by the caller
+void
+FreeOBJ(obj_model *Model);
+
+#endif
@@ -0,0 +1,431 @@
+#include "Occlusion.h"
+
+#include <emmintrin.h>
+
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+
+#include "Jobs.h"
+
+// NOTE: Past this many texels the box is big enough on screen that it's cheaper to draw it
+#define OCCLUSION_MAX_TEST_TEXELS 64
+
+static i32
+OCCLUSION_ClipToNearPlane(glm::vec4 *Triangle, glm::vec4 *Out_Polygon);
+static void
+OCCLUSION_SetUpTriangle(occlusion_buffer *Buffer, glm::vec4 A, glm::vec4 B, glm::vec4 C);
+static void
+OCCLUSION_RasterizeBand(void *Data);
+static void
+OCCLUSION_BuildPyramid(occlusion_buffer *Buffer);
+
+// -----------------------------
+// EXTERNAL FUNCTION DEFINITIONS
+// -----------------------------
+
+void
+InitializeOcclusionBuffer(occlusion_buffer *Buffer, i32 Width, i32 Height, i32 ThreadCount)
+{
+    Assert(Width > 0 && Height > 0 && (Width % 4) == 0);
+
+    *Buffer = { };
+    Buffer->Width = Width;
+    Buffer->Height = Height;
+
+    f32 *Raster = (f32 *) calloc((size_t) Width * Height, sizeof(f32));
+    Assert(Raster);
+    Buffer->LevelWidths[0] = Width;
+    Buffer->LevelHeights[0] = Height;
+    Buffer->FarthestLevels[0] = Raster;
+    Buffer->NearestLevels[0] = Raster;
+    Buffer->LevelCount = 1;
+    while ((Buffer->LevelWidths[Buffer->LevelCount - 1] > 1 || Buffer->LevelHeights[Buffer->LevelCount - 1] > 1) &&
+           Buffer->LevelCount < MAX_OCCLUSION_LEVELS)
+    {
+        i32 Level = Buffer->LevelCount++;
+        i32 LevelWidth = (Buffer->LevelWidths[Level - 1] + 1) / 2;
+        i32 LevelHeight = (Buffer->LevelHeights[Level - 1] + 1) / 2;
+        Buffer->LevelWidths[Level] = LevelWidth;
+        Buffer->LevelHeights[Level] = LevelHeight;
+        Buffer->FarthestLevels[Level] = (f32 *) calloc((size_t) LevelWidth * LevelHeight, sizeof(f32));
+        Buffer->NearestLevels[Level] = (f32 *) calloc((size_t) LevelWidth * LevelHeight, sizeof(f32));
+        Assert(Buffer->FarthestLevels[Level] && Buffer->NearestLevels[Level]);
+    }
+
+    // NOTE: The bands point back at the buffer, so it can't move after this
+    Buffer->BandCount = (Height + OCCLUSION_BAND_HEIGHT - 1) / OCCLUSION_BAND_HEIGHT;
+    Assert(Buffer->BandCount <= MAX_OCCLUSION_BANDS);
+    for (i32 BandIndex = 0; BandIndex < Buffer->BandCount; ++BandIndex)
+    {
+        occlusion_band *Band = &Buffer->Bands[BandIndex];
+        Band->Buffer = Buffer;
+        Band->FirstRow = BandIndex * OCCLUSION_BAND_HEIGHT;
+        Band->RowCount = glm::min(OCCLUSION_BAND_HEIGHT, Height - Band->FirstRow);
+    }
+
+    Buffer->TriangleCapacity = 256;
+    Buffer->Triangles = (occlusion_triangle *) malloc(Buffer->TriangleCapacity * sizeof(occlusion_triangle));
+    Assert(Buffer->Triangles);
+
+    Buffer->Queue = CreateJobQueue(ThreadCount);
+}
+
+void
+FreeOcclusionBuffer(occlusion_buffer *Buffer)
+{
+    DestroyJobQueue(Buffer->Queue);
+    free(Buffer->Triangles);
+    free(Buffer->FarthestLevels[0]);
+    for (i32 Level = 1; Level < Buffer->LevelCount; ++Level)
+    {
+        free(Buffer->FarthestLevels[Level]);
+        free(Buffer->NearestLevels[Level]);
+    }
+    *Buffer = { };
+}
+
+void
+BeginOcclusionFrame(occlusion_buffer *Buffer, glm::mat4 ViewProjection)
+{
+    Buffer->ViewProjection = ViewProjection;
+    Buffer->TriangleCount = 0;
+    Buffer->Stats = { };
+}
+
+void
+AddOccluderMesh(occlusion_buffer *Buffer, const f32 *Positions, const i32 *Indices, i32 IndexCount,
+                glm::mat4 Transform)
+{
+    glm::mat4 ClipTransform = Buffer->ViewProjection * Transform;
+
+    for (i32 Index = 0; Index + 2 < IndexCount; Index += 3)
+    {
+        glm::vec4 Triangle[3];
+        for (i32 Corner = 0; Corner < 3; ++Corner)
+        {
+            const f32 *Position = &Positions[Indices[Index + Corner] * POSITIONS_PER_VERTEX];
+            Triangle[Corner] = ClipTransform * glm::vec4(Position[0], Position[1], Position[2], 1.0f);
+        }
+
+        glm::vec4 Polygon[4];
+        i32 PolygonVertexCount = OCCLUSION_ClipToNearPlane(Triangle, Polygon);
+        for (i32 FanIndex = 1; FanIndex + 1 < PolygonVertexCount; ++FanIndex)
+        {
+            OCCLUSION_SetUpTriangle(Buffer, Polygon[0], Polygon[FanIndex], Polygon[FanIndex + 1]);
+        }
+    }
+}
+
+void
+AddOccluderModel(occlusion_buffer *Buffer, model *Model, glm::mat4 Transform)
+{
+    if (!Model->IsReady || !Model->CPUMeshes)
+    {
+        return;
+    }
+
+    for (i32 MeshIndex = 0; MeshIndex < Model->MeshCount; ++MeshIndex)
+    {
+        mesh_cpu_data *CPUMesh = &Model->CPUMeshes[MeshIndex];
+        AddOccluderMesh(Buffer, CPUMesh->Positions, CPUMesh->Indices, CPUMesh->IndexCount, Transform);
+    }
+}
+
+void
+RasterizeOccluders(occlusion_buffer *Buffer)
+{
+    for (i32 BandIndex = 0; BandIndex < Buffer->BandCount; ++BandIndex)
+    {
+        AddJob(Buffer->Queue, OCCLUSION_RasterizeBand, &Buffer->Bands[BandIndex]);
+    }
+    CompleteAllJobs(Buffer->Queue);
+
+    OCCLUSION_BuildPyramid(Buffer);
+}
+
+// NOTE: Starts at the finest level where the box's rectangle covers at most 2x2 texels. A box
+//       that's behind the farthest occluder there is hidden; one whose nearest corner is in front
+//       of the nearest occluder there is seen (that corner is). Otherwise the finer level, with
+//       fewer texels outside the rectangle, gets to decide.
+bool
+IsBoxUnoccluded(occlusion_buffer *Buffer, glm::vec3 Min, glm::vec3 Max)
+{
+    ++Buffer->Stats.Tested;
+
+    f32 MinX = FLT_MAX;
+    f32 MinY = FLT_MAX;
+    f32 MaxX = -FLT_MAX;
+    f32 MaxY = -FLT_MAX;
+    f32 NearestDepth = 0.0f;
+    for (i32 Corner = 0; Corner < 8; ++Corner)
+    {
+        glm::vec4 Position((Corner & 1) ? Max.x : Min.x,
+                           (Corner & 2) ? Max.y : Min.y,
+                           (Corner & 4) ? Max.z : Min.z, 1.0f);
+        glm::vec4 Clip = Buffer->ViewProjection * Position;
+        // NOTE: Reaches past the near plane, so it's as close as anything can be
+        if (Clip.z < -Clip.w || Clip.w <= 0.0f)
+        {
+            return true;
+        }
+
+        f32 InverseW = 1.0f / Clip.w;
+        f32 ScreenX = (Clip.x * InverseW * 0.5f + 0.5f) * (f32) Buffer->Width;
+        f32 ScreenY = (Clip.y * InverseW * 0.5f + 0.5f) * (f32) Buffer->Height;
+        MinX = glm::min(MinX, ScreenX);
+        MinY = glm::min(MinY, ScreenY);
+        MaxX = glm::max(MaxX, ScreenX);
+        MaxY = glm::max(MaxY, ScreenY);
+        NearestDepth = glm::max(NearestDepth, InverseW);
+    }
+
+    // NOTE: Off screen it's the frustum's business, not the occluders'
+    i32 X0 = glm::max((i32) floorf(MinX), 0);
+    i32 Y0 = glm::max((i32) floorf(MinY), 0);
+    i32 X1 = glm::min((i32) floorf(MaxX), Buffer->Width - 1);
+    i32 Y1 = glm::min((i32) floorf(MaxY), Buffer->Height - 1);
+    if (X0 > X1 || Y0 > Y1)
+    {
+        return true;
+    }
+
+    i32 Level = 0;
+    while (Level + 1 < Buffer->LevelCount &&
+           ((X1 >> Level) - (X0 >> Level) > 1 || (Y1 >> Level) - (Y0 >> Level) > 1))
+    {
+        ++Level;
+    }
+
+    for (; Level >= 0; --Level)
+    {
+        i32 LevelX0 = X0 >> Level;
+        i32 LevelY0 = Y0 >> Level;
+        i32 LevelX1 = X1 >> Level;
+        i32 LevelY1 = Y1 >> Level;
+        if ((LevelX1 - LevelX0 + 1) * (LevelY1 - LevelY0 + 1) > OCCLUSION_MAX_TEST_TEXELS)
+        {
+            break;
+        }
+
+        i32 LevelWidth = Buffer->LevelWidths[Level];
+        f32 *Farthest = Buffer->FarthestLevels[Level];
+        f32 *Nearest = Buffer->NearestLevels[Level];
+        f32 FarthestOccluder = FLT_MAX;
+        f32 NearestOccluder = 0.0f;
+        for (i32 Y = LevelY0; Y <= LevelY1; ++Y)
+        {
+            for (i32 X = LevelX0; X <= LevelX1; ++X)
+            {
+                FarthestOccluder = glm::min(FarthestOccluder, Farthest[Y * LevelWidth + X]);
+                NearestOccluder = glm::max(NearestOccluder, Nearest[Y * LevelWidth + X]);
+            }
+        }
+
+        if (NearestDepth < FarthestOccluder)
+        {
+            ++Buffer->Stats.Occluded;
+            return false;
+        }
+        if (NearestDepth >= NearestOccluder)
+        {
+            return true;
+        }
+    }
+
+    return true;
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+// NOTE: Against z >= -w (GL clip space); returns the vertex count, 0 to 4
+static i32
+OCCLUSION_ClipToNearPlane(glm::vec4 *Triangle, glm::vec4 *Out_Polygon)
+{
+    i32 Result = 0;
+    for (i32 Corner = 0; Corner < 3; ++Corner)
+    {
+        glm::vec4 Current = Triangle[Corner];
+        glm::vec4 Next = Triangle[(Corner + 1) % 3];
+        f32 CurrentDistance = Current.z + Current.w;
+        f32 NextDistance = Next.z + Next.w;
+
+        if (CurrentDistance >= 0.0f)
+        {
+            Out_Polygon[Result++] = Current;
+        }
+        if ((CurrentDistance >= 0.0f) != (NextDistance >= 0.0f))
+        {
+            f32 T = CurrentDistance / (CurrentDistance - NextDistance);
+            Out_Polygon[Result++] = Current + (Next - Current) * T;
+        }
+    }
+
+    return Result;
+}
+
+static void
+OCCLUSION_SetUpTriangle(occlusion_buffer *Buffer, glm::vec4 A, glm::vec4 B, glm::vec4 C)
+{
+    glm::vec4 Clip[3] = { A, B, C };
+    f32 X[3], Y[3], Depth[3];
+    for (i32 Corner = 0; Corner < 3; ++Corner)
+    {
+        if (Clip[Corner].w <= 0.0f)
+        {
+            return;
+        }
+        Depth[Corner] = 1.0f / Clip[Corner].w;
+        X[Corner] = (Clip[Corner].x * Depth[Corner] * 0.5f + 0.5f) * (f32) Buffer->Width;
+        Y[Corner] = (Clip[Corner].y * Depth[Corner] * 0.5f + 0.5f) * (f32) Buffer->Height;
+    }
+
+    // NOTE: Counter-clockwise is positive; back faces and slivers don't occlude anything
+    f32 Area = (X[1] - X[0]) * (Y[2] - Y[0]) - (X[2] - X[0]) * (Y[1] - Y[0]);
+    if (Area <= 0.0f)
+    {
+        return;
+    }
+
+    occlusion_triangle Triangle;
+    Triangle.MinX = glm::max((i32) floorf(glm::min(X[0], glm::min(X[1], X[2]))), 0);
+    Triangle.MinY = glm::max((i32) floorf(glm::min(Y[0], glm::min(Y[1], Y[2]))), 0);
+    Triangle.MaxX = glm::min((i32) ceilf(glm::max(X[0], glm::max(X[1], X[2]))), Buffer->Width - 1);
+    Triangle.MaxY = glm::min((i32) ceilf(glm::max(Y[0], glm::max(Y[1], Y[2]))), Buffer->Height - 1);
+    if (Triangle.MinX > Triangle.MaxX || Triangle.MinY > Triangle.MaxY)
+    {
+        return;
+    }
+
+    for (i32 Edge = 0; Edge < 3; ++Edge)
+    {
+        i32 Next = (Edge + 1) % 3;
+        Triangle.EdgeA[Edge] = Y[Edge] - Y[Next];
+        Triangle.EdgeB[Edge] = X[Next] - X[Edge];
+        Triangle.EdgeC[Edge] = -(Triangle.EdgeA[Edge] * X[Edge] + Triangle.EdgeB[Edge] * Y[Edge]);
+    }
+
+    Triangle.DepthA = ((Depth[1] - Depth[0]) * (Y[2] - Y[0]) - (Depth[2] - Depth[0]) * (Y[1] - Y[0])) / Area;
+    Triangle.DepthB = ((Depth[2] - Depth[0]) * (X[1] - X[0]) - (Depth[1] - Depth[0]) * (X[2] - X[0])) / Area;
+    Triangle.DepthC = Depth[0] - Triangle.DepthA * X[0] - Triangle.DepthB * Y[0];
+
+    if (Buffer->TriangleCount == Buffer->TriangleCapacity)
+    {
+        i32 NewCapacity = Buffer->TriangleCapacity * 2;
+        occlusion_triangle *NewTriangles = (occlusion_triangle *) realloc(Buffer->Triangles,
+                                                                          NewCapacity * sizeof(occlusion_triangle));
+        Assert(NewTriangles);
+        Buffer->Triangles = NewTriangles;
+        Buffer->TriangleCapacity = NewCapacity;
+    }
+    Buffer->Triangles[Buffer->TriangleCount++] = Triangle;
+    ++Buffer->Stats.OccluderTriangles;
+}
+
+// NOTE: Job: clears the band's rows and draws every triangle that overlaps them, 4 pixel centers
+//       at a time. Nothing else writes to these rows, so the bands need no locking.
+static void
+OCCLUSION_RasterizeBand(void *Data)
+{
+    occlusion_band *Band = (occlusion_band *) Data;
+    occlusion_buffer *Buffer = Band->Buffer;
+    i32 Width = Buffer->Width;
+    f32 *Raster = Buffer->FarthestLevels[0];
+    i32 FirstRow = Band->FirstRow;
+    i32 LastRow = Band->FirstRow + Band->RowCount - 1;
+
+    __m128 Zero = _mm_setzero_ps();
+    for (i32 Index = FirstRow * Width; Index < (LastRow + 1) * Width; Index += 4)
+    {
+        _mm_storeu_ps(&Raster[Index], Zero);
+    }
+
+    __m128 PixelOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    for (i32 TriangleIndex = 0; TriangleIndex < Buffer->TriangleCount; ++TriangleIndex)
+    {
+        occlusion_triangle *Triangle = &Buffer->Triangles[TriangleIndex];
+        if (Triangle->MaxY < FirstRow || Triangle->MinY > LastRow)
+        {
+            continue;
+        }
+
+        i32 Y0 = glm::max(Triangle->MinY, FirstRow);
+        i32 Y1 = glm::min(Triangle->MaxY, LastRow);
+        // NOTE: Width is a multiple of 4, so a group that starts in the row ends in it
+        i32 X0 = Triangle->MinX & ~3;
+        i32 X1 = Triangle->MaxX;
+
+        __m128 EdgeA0 = _mm_set1_ps(Triangle->EdgeA[0]);
+        __m128 EdgeA1 = _mm_set1_ps(Triangle->EdgeA[1]);
+        __m128 EdgeA2 = _mm_set1_ps(Triangle->EdgeA[2]);
+        __m128 DepthA = _mm_set1_ps(Triangle->DepthA);
+
+        for (i32 Y = Y0; Y <= Y1; ++Y)
+        {
+            f32 CenterY = (f32) Y + 0.5f;
+            __m128 RowEdge0 = _mm_set1_ps(Triangle->EdgeB[0] * CenterY + Triangle->EdgeC[0]);
+            __m128 RowEdge1 = _mm_set1_ps(Triangle->EdgeB[1] * CenterY + Triangle->EdgeC[1]);
+            __m128 RowEdge2 = _mm_set1_ps(Triangle->EdgeB[2] * CenterY + Triangle->EdgeC[2]);
+            __m128 RowDepth = _mm_set1_ps(Triangle->DepthB * CenterY + Triangle->DepthC);
+            f32 *Row = &Raster[Y * Width];
+
+            for (i32 X = X0; X <= X1; X += 4)
+            {
+                __m128 CenterX = _mm_add_ps(_mm_set1_ps((f32) X), PixelOffsets);
+                __m128 Edge0 = _mm_add_ps(_mm_mul_ps(EdgeA0, CenterX), RowEdge0);
+                __m128 Edge1 = _mm_add_ps(_mm_mul_ps(EdgeA1, CenterX), RowEdge1);
+                __m128 Edge2 = _mm_add_ps(_mm_mul_ps(EdgeA2, CenterX), RowEdge2);
+                __m128 Inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(Edge0, Zero), _mm_cmpge_ps(Edge1, Zero)),
+                                           _mm_cmpge_ps(Edge2, Zero));
+                if (_mm_movemask_ps(Inside) == 0)
+                {
+                    continue;
+                }
+
+                __m128 Depth = _mm_add_ps(_mm_mul_ps(DepthA, CenterX), RowDepth);
+                __m128 Old = _mm_loadu_ps(&Row[X]);
+                __m128 New = _mm_max_ps(Old, Depth);
+                _mm_storeu_ps(&Row[X], _mm_or_ps(_mm_and_ps(Inside, New), _mm_andnot_ps(Inside, Old)));
+            }
+        }
+    }
+}
+
+// NOTE: Each texel takes the farthest and the nearest of the (up to) 4 below it
+static void
+OCCLUSION_BuildPyramid(occlusion_buffer *Buffer)
+{
+    for (i32 Level = 1; Level < Buffer->LevelCount; ++Level)
+    {
+        i32 SourceWidth = Buffer->LevelWidths[Level - 1];
+        i32 SourceHeight = Buffer->LevelHeights[Level - 1];
+        f32 *SourceFarthest = Buffer->FarthestLevels[Level - 1];
+        f32 *SourceNearest = Buffer->NearestLevels[Level - 1];
+        i32 LevelWidth = Buffer->LevelWidths[Level];
+        i32 LevelHeight = Buffer->LevelHeights[Level];
+        f32 *Farthest = Buffer->FarthestLevels[Level];
+        f32 *Nearest = Buffer->NearestLevels[Level];
+
+        for (i32 Y = 0; Y < LevelHeight; ++Y)
+        {
+            i32 SourceY0 = Y * 2;
+            i32 SourceY1 = glm::min(SourceY0 + 1, SourceHeight - 1);
+            for (i32 X = 0; X < LevelWidth; ++X)
+            {
+                i32 SourceX0 = X * 2;
+                i32 SourceX1 = glm::min(SourceX0 + 1, SourceWidth - 1);
+
+                i32 Index00 = SourceY0 * SourceWidth + SourceX0;
+                i32 Index01 = SourceY0 * SourceWidth + SourceX1;
+                i32 Index10 = SourceY1 * SourceWidth + SourceX0;
+                i32 Index11 = SourceY1 * SourceWidth + SourceX1;
+                Farthest[Y * LevelWidth + X] = glm::min(glm::min(SourceFarthest[Index00], SourceFarthest[Index01]),
+                                                        glm::min(SourceFarthest[Index10], SourceFarthest[Index11]));
+                Nearest[Y * LevelWidth + X] = glm::max(glm::max(SourceNearest[Index00], SourceNearest[Index01]),
+                                                       glm::max(SourceNearest[Index10], SourceNearest[Index11]));
+            }
+        }
+    }
+}
@@ -0,0 +1,118 @@
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+#include <glm/glm.hpp>
+
+#include "Common.h"
+#include "Model.h"
+
+// NOTE: Software occlusion culling, all on the CPU. Occluder triangles (walls, big props) are set
+//       up on the calling thread and rasterized at low resolution into a depth buffer of 1/w (so
+//       bigger is nearer, and 0 is nothing) by worker threads, one band of rows each, 4 pixels at a
+//       time (SSE2). A pyramid of the farthest and nearest depth in each texel is built over it,
+//       and boxes are tested against the pyramid instead of the pixels: the farthest depth of a
+//       few coarse texels around the box says whether it's hidden, the nearest whether it's in
+//       front of everything there, and only in between does the test go to finer levels.
+//       Only front faces (counter-clockwise, as GL draws them) occlude. Pixels count as covered
+//       when their center is, so an object seen through a gap narrower than a pixel can be culled.
+//       Needs no GL, so it can be run and timed on its own.
+#define DEFAULT_OCCLUSION_BUFFER_WIDTH 256
+#define DEFAULT_OCCLUSION_BUFFER_HEIGHT 128
+#define DEFAULT_OCCLUSION_THREAD_COUNT 3
+#define OCCLUSION_BAND_HEIGHT 16
+#define MAX_OCCLUSION_LEVELS 12
+#define MAX_OCCLUSION_BANDS 64
+
+struct job_queue;
+struct occlusion_buffer;
+
+// NOTE: Set up once per triangle, in pixels: inside where all three edge functions are >= 0
+struct occlusion_triangle
+{
+    f32 EdgeA[3];
+    f32 EdgeB[3];
+    f32 EdgeC[3];
+    // NOTE: 1/w = DepthA * X + DepthB * Y + DepthC
+    f32 DepthA;
+    f32 DepthB;
+    f32 DepthC;
+    i32 MinX;
+    i32 MinY;
+    i32 MaxX;
+    i32 MaxY;
+};
+
+struct occlusion_band
+{
+    occlusion_buffer *Buffer;
+    i32 FirstRow;
+    i32 RowCount;
+};
+
+struct occlusion_stats
+{
+    i32 OccluderTriangles;
+    i32 Tested;
+    i32 Occluded;
+};
+
+struct occlusion_buffer
+{
+    i32 Width;
+    i32 Height;
+
+    // NOTE: Level 0 is the rasterized buffer itself (both arrays point at it); each level after it
+    //       is half the size, rounded up
+    i32 LevelCount;
+    i32 LevelWidths[MAX_OCCLUSION_LEVELS];
+    i32 LevelHeights[MAX_OCCLUSION_LEVELS];
+    f32 *FarthestLevels[MAX_OCCLUSION_LEVELS];
+    f32 *NearestLevels[MAX_OCCLUSION_LEVELS];
+
+    glm::mat4 ViewProjection;
+
+    i32 TriangleCount;
+    i32 TriangleCapacity;
+    occlusion_triangle *Triangles;
+
+    i32 BandCount;
+    occlusion_band Bands[MAX_OCCLUSION_BANDS];
+    job_queue *Queue;
+
+    // NOTE: Since the last BeginOcclusionFrame
+    occlusion_stats Stats;
+};
+
+// ---------------------
+// FUNCTION DECLARATIONS
+// ---------------------
+
+// NOTE: Width has to be a multiple of 4. The buffer gets its own workers (ThreadCount <= 0 is one
+//       per core): CompleteAllJobs on a shared queue would wait for its other work too.
+void
+InitializeOcclusionBuffer(occlusion_buffer *Buffer, i32 Width = DEFAULT_OCCLUSION_BUFFER_WIDTH,
+                          i32 Height = DEFAULT_OCCLUSION_BUFFER_HEIGHT,
+                          i32 ThreadCount = DEFAULT_OCCLUSION_THREAD_COUNT);
+void
+FreeOcclusionBuffer(occlusion_buffer *Buffer);
+
+// NOTE: Clears the occluders; everything after it is in this view
+void
+BeginOcclusionFrame(occlusion_buffer *Buffer, glm::mat4 ViewProjection);
+// NOTE: Triangle list, model space positions (POSITIONS_PER_VERTEX floats each)
+void
+AddOccluderMesh(occlusion_buffer *Buffer, const f32 *Positions, const i32 *Indices, i32 IndexCount,
+                glm::mat4 Transform);
+// NOTE: Needs the model's CPUMeshes (RESOURCE_KEEP_CPU_DATA); does nothing without them
+void
+AddOccluderModel(occlusion_buffer *Buffer, model *Model, glm::mat4 Transform);
+// NOTE: Rasterizes everything added since BeginOcclusionFrame and builds the pyramid. Returns once
+//       the workers are done.
+void
+RasterizeOccluders(occlusion_buffer *Buffer);
+
+// NOTE: World space box, after RasterizeOccluders. False only if the occluders hide all of it.
+bool
+IsBoxUnoccluded(occlusion_buffer *Buffer, glm::vec3 Min, glm::vec3 Max);
+
+#endif
@@ -0,0 +1,698 @@
+#include "Pack.h"
+
+#include <SDL2/SDL.h>
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+#include "FileIO.h"
+#include "Hash.h"
+#include "Jobs.h"
+#include "LZ4.h"
+#include "PackFormat.h"
+#include "Util.h"
+
+// NOTE: Reads of fewer chunks than this per thread aren't worth handing to the workers
+#define PACK_MIN_CHUNKS_PER_JOB 4
+
+struct pack
+{
+    mapped_file File;
+    job_queue *Queue;
+
+    const pack_header *Header;
+    const pack_entry *Entries;
+    const pack_chunk *Chunks;
+    const u32 *Slots;
+    const char *Paths;
+};
+
+static pack Pack;
+
+// NOTE: One read split across threads. Chunks are handed out through NextChunk; the reading
+//       thread waits on Done once they're all taken. Helper jobs can start long after the read is
+//       over (the queue may be busy), so the last one out frees it, not the reader.
+struct pack_read
+{
+    SDL_atomic_t RefCount;
+    SDL_atomic_t NextChunk;
+    SDL_atomic_t FinishedCount;
+    SDL_atomic_t FailedCount;
+    SDL_sem *Done;
+
+    const pack_entry *Entry;
+    u32 FirstChunk;
+    u32 ChunkCount;
+    u64 Offset;
+    size_t Size;
+    u8 *Out_Data;
+};
+
+struct pack_write_entry
+{
+    pack_input *Input;
+    char Path[MAX_PATH_LENGTH];
+    bool Failed;
+    bool IsDuplicate;
+
+    u64 Size;
+    u64 ModificationTime;
+    mapped_file File;
+
+    // NOTE: Compressed entries only; chunks back to back, File is already unmapped
+    bool IsCompressed;
+    u32 ChunkCount;
+    u32 *ChunkSizes;
+    u8 *CompressedData;
+};
+
+static bool
+PACK_IsRangeValid(u64 Offset, u64 Size, u64 FileSize);
+static bool
+PACK_Validate(const mapped_file *File);
+
+static bool
+PACK_ReadChunk(const pack_entry *Entry, u32 ChunkIndex, u64 Offset, size_t Size, u8 *Out_Data, u8 **Scratch);
+static void
+PACK_ReadChunks(pack_read *Read);
+static void
+PACK_ReadChunksJob(void *Data);
+static void
+PACK_ReleaseRead(pack_read *Read);
+
+static void
+PACK_CompressEntryJob(void *Data);
+static bool
+PACK_WriteBlock(FILE *File, const void *Data, size_t Size, size_t Alignment, u64 *FileCursor, u64 *Out_Offset);
+
+// ------------------------
+// MOUNTING ---------------
+// ------------------------
+
+bool
+MountPack(const char *Path, job_queue *Queue)
+{
+    Assert(!IsPackMounted());
+
+    // NOTE: No pack just means running from loose files
+    mapped_file File;
+    if (!MapFileReadOnly(Path, &File))
+    {
+        return false;
+    }
+
+    if (!PACK_Validate(&File))
+    {
+        fprintf(stderr, "Invalid resource pack: %s\n", Path);
+        UnmapFile(&File);
+        return false;
+    }
+
+    const pack_header *Header = (const pack_header *) File.Data;
+    Pack.File = File;
+    Pack.Queue = Queue;
+    Pack.Header = Header;
+    Pack.Entries = (const pack_entry *) (File.Data + Header->EntriesOffset);
+    Pack.Chunks = (const pack_chunk *) (File.Data + Header->ChunksOffset);
+    Pack.Slots = (const u32 *) (File.Data + Header->SlotsOffset);
+    Pack.Paths = (const char *) (File.Data + Header->PathsOffset);
+
+    printf("Mounted resource pack %s (%u file(s), %.2f MB)\n",
+           Path, Header->EntryCount, (f64) File.Size / (1024.0 * 1024.0));
+    return true;
+}
+
+void
+UnmountPack()
+{
+    UnmapFile(&Pack.File);
+    Pack = { };
+}
+
+bool
+IsPackMounted()
+{
+    return (Pack.Header != 0);
+}
+
+// ------------------------
+// PACKED FILES -----------
+// ------------------------
+
+bool
+FindPackedFile(const char *Path, packed_file *Out_File)
+{
+    if (!Pack.Header)
+    {
+        return false;
+    }
+
+    char NormalizedPath[MAX_PATH_LENGTH];
+    if (!NormalizePath(Path, NormalizedPath, MAX_PATH_LENGTH))
+    {
+        return false;
+    }
+
+    u64 PathHash = HashBytes64(NormalizedPath, strlen(NormalizedPath), 0);
+    u32 SlotMask = Pack.Header->SlotCount - 1;
+    for (u32 Probe = 0; Probe < Pack.Header->SlotCount; ++Probe)
+    {
+        u32 Slot = Pack.Slots[(PathHash + Probe) & SlotMask];
+        if (Slot == 0)
+        {
+            break;
+        }
+
+        const pack_entry *Entry = &Pack.Entries[Slot - 1];
+        if (Entry->PathHash == PathHash && strcmp(Pack.Paths + Entry->PathOffset, NormalizedPath) == 0)
+        {
+            Out_File->EntryIndex = Slot - 1;
+            Out_File->Size = Entry->Size;
+            Out_File->ModificationTime = Entry->ModificationTime;
+            Out_File->Data = (Entry->Flags & PACK_ENTRY_FLAG_COMPRESSED) ? 0 : Pack.File.Data + Entry->DataOffset;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool
+ReadPackedFile(packed_file *File, u64 Offset, size_t Size, u8 *Out_Data)
+{
+    Assert(Pack.Header);
+
+    if (Offset > File->Size || Size > File->Size - Offset)
+    {
+        return false;
+    }
+    if (Size == 0)
+    {
+        return true;
+    }
+    if (File->Data)
+    {
+        memcpy(Out_Data, File->Data + Offset, Size);
+        return true;
+    }
+
+    const pack_entry *Entry = &Pack.Entries[File->EntryIndex];
+    u32 FirstChunk = (u32) (Offset / PACK_CHUNK_SIZE);
+    u32 ChunkCount = (u32) ((Offset + Size - 1) / PACK_CHUNK_SIZE) - FirstChunk + 1;
+
+    i32 HelperCount = 0;
+    if (Pack.Queue)
+    {
+        HelperCount = (i32) (ChunkCount / PACK_MIN_CHUNKS_PER_JOB) - 1;
+        i32 ThreadCount = GetJobQueueThreadCount(Pack.Queue);
+        HelperCount = (HelperCount < ThreadCount) ? HelperCount : ThreadCount;
+    }
+
+    if (HelperCount <= 0)
+    {
+        u8 *Scratch = 0;
+        bool Succeeded = true;
+        for (u32 ChunkIndex = FirstChunk; Succeeded && ChunkIndex < FirstChunk + ChunkCount; ++ChunkIndex)
+        {
+            Succeeded = PACK_ReadChunk(Entry, ChunkIndex, Offset, Size, Out_Data, &Scratch);
+        }
+        free(Scratch);
+        return Succeeded;
+    }
+
+    pack_read *Read = (pack_read *) calloc(1, sizeof(pack_read));
+    Assert(Read);
+    Read->Done = SDL_CreateSemaphore(0);
+    Assert(Read->Done);
+    Read->Entry = Entry;
+    Read->FirstChunk = FirstChunk;
+    Read->ChunkCount = ChunkCount;
+    Read->Offset = Offset;
+    Read->Size = Size;
+    Read->Out_Data = Out_Data;
+    SDL_AtomicSet(&Read->RefCount, HelperCount + 1);
+
+    for (i32 HelperIndex = 0; HelperIndex < HelperCount; ++HelperIndex)
+    {
+        AddJob(Pack.Queue, PACK_ReadChunksJob, Read);
+    }
+
+    // NOTE: Once this returns every chunk has been taken, so the wait is only for chunks a worker
+    //       is already decompressing, never for a job that's still queued
+    PACK_ReadChunks(Read);
+    SDL_SemWait(Read->Done);
+
+    bool Succeeded = (SDL_AtomicGet(&Read->FailedCount) == 0);
+    PACK_ReleaseRead(Read);
+    return Succeeded;
+}
+
+// ------------------------
+// WRITING ----------------
+// ------------------------
+
+bool
+WritePack(const char *PackPath, pack_input *Inputs, i32 InputCount, job_queue *Queue)
+{
+    pack_write_entry *WriteEntries = (pack_write_entry *) calloc((InputCount > 0) ? InputCount : 1,
+                                                                 sizeof(pack_write_entry));
+    Assert(WriteEntries);
+
+    for (i32 InputIndex = 0; InputIndex < InputCount; ++InputIndex)
+    {
+        WriteEntries[InputIndex].Input = &Inputs[InputIndex];
+        AddJob(Queue, PACK_CompressEntryJob, &WriteEntries[InputIndex]);
+    }
+    CompleteAllJobs(Queue);
+
+    // Path index
+    // ----------
+    pack_header Header = { };
+    Header.Magic = PACK_MAGIC;
+    Header.Version = PACK_VERSION;
+
+    u32 SlotCount = 16;
+    while (SlotCount < (u32) InputCount * 2)
+    {
+        SlotCount *= 2;
+    }
+    Header.SlotCount = SlotCount;
+
+    u32 *Slots = (u32 *) calloc(SlotCount, sizeof(u32));
+    pack_entry *Entries = (pack_entry *) calloc((InputCount > 0) ? InputCount : 1, sizeof(pack_entry));
+    Assert(Slots && Entries);
+
+    bool Success = true;
+    u64 PathsSize = 0;
+    for (i32 InputIndex = 0; InputIndex < InputCount; ++InputIndex)
+    {
+        pack_write_entry *WriteEntry = &WriteEntries[InputIndex];
+        if (WriteEntry->Failed)
+        {
+            Success = false;
+            continue;
+        }
+
+        u64 PathHash = HashBytes64(WriteEntry->Path, strlen(WriteEntry->Path), 0);
+        u32 SlotIndex = (u32) (PathHash & (SlotCount - 1));
+        while (Slots[SlotIndex] != 0)
+        {
+            pack_write_entry *Other = &WriteEntries[Entries[Slots[SlotIndex] - 1].PathOffset];
+            if (strcmp(Other->Path, WriteEntry->Path) == 0)
+            {
+                WriteEntry->IsDuplicate = true;
+                break;
+            }
+            SlotIndex = (SlotIndex + 1) & (SlotCount - 1);
+        }
+        if (WriteEntry->IsDuplicate)
+        {
+            continue;
+        }
+
+        // NOTE: PathOffset holds the write entry's index until the paths are laid out below
+        pack_entry *Entry = &Entries[Header.EntryCount];
+        Entry->PathHash = PathHash;
+        Entry->PathOffset = (u32) InputIndex;
+        Entry->Size = WriteEntry->Size;
+        Entry->ModificationTime = WriteEntry->ModificationTime;
+        Entry->Flags = WriteEntry->IsCompressed ? PACK_ENTRY_FLAG_COMPRESSED : 0;
+        Entry->FirstChunk = Header.ChunkCount;
+        Entry->ChunkCount = WriteEntry->ChunkCount;
+
+        Header.ChunkCount += WriteEntry->ChunkCount;
+        PathsSize += strlen(WriteEntry->Path) + 1;
+        Slots[SlotIndex] = ++Header.EntryCount;
+    }
+
+    FILE *File = 0;
+    if (Success)
+    {
+        fopen_s(&File, PackPath, "wb");
+        if (!File)
+        {
+            fprintf(stderr, "Couldn't open resource pack for writing: %s\n", PackPath);
+            Success = false;
+        }
+    }
+
+    // File data
+    // ---------
+    pack_chunk *Chunks = (pack_chunk *) calloc((Header.ChunkCount > 0) ? Header.ChunkCount : 1, sizeof(pack_chunk));
+    char *Paths = (char *) calloc((size_t) PathsSize + 1, 1);
+    Assert(Chunks && Paths);
+
+    u64 FileCursor = 0;
+    u64 IgnoredOffset;
+    u64 CompressedEntrySize = 0;
+    u64 TotalSize = 0;
+    Success = Success && PACK_WriteBlock(File, &Header, sizeof(Header), 1, &FileCursor, &IgnoredOffset);
+
+    u64 PathCursor = 0;
+    for (u32 EntryIndex = 0; Success && EntryIndex < Header.EntryCount; ++EntryIndex)
+    {
+        pack_entry *Entry = &Entries[EntryIndex];
+        pack_write_entry *WriteEntry = &WriteEntries[Entry->PathOffset];
+
+        size_t PathSize = strlen(WriteEntry->Path) + 1;
+        memcpy(Paths + PathCursor, WriteEntry->Path, PathSize);
+        Entry->PathOffset = (u32) PathCursor;
+        PathCursor += PathSize;
+
+        TotalSize += Entry->Size;
+        if (WriteEntry->IsCompressed)
+        {
+            u64 ChunkOffset = 0;
+            for (u32 ChunkIndex = 0; Success && ChunkIndex < WriteEntry->ChunkCount; ++ChunkIndex)
+            {
+                pack_chunk *Chunk = &Chunks[Entry->FirstChunk + ChunkIndex];
+                Chunk->CompressedSize = WriteEntry->ChunkSizes[ChunkIndex];
+                Success = PACK_WriteBlock(File, WriteEntry->CompressedData + ChunkOffset, Chunk->CompressedSize,
+                                          (ChunkIndex == 0) ? PACK_CHUNK_ALIGNMENT : 1, &FileCursor, &Chunk->Offset);
+                ChunkOffset += Chunk->CompressedSize;
+            }
+            CompressedEntrySize += ChunkOffset;
+        }
+        else
+        {
+            Success = PACK_WriteBlock(File, WriteEntry->File.Data, (size_t) Entry->Size,
+                                      (Entry->Size > 0) ? PACK_DATA_ALIGNMENT : 1, &FileCursor, &Entry->DataOffset);
+            CompressedEntrySize += Entry->Size;
+        }
+    }
+
+    // Tables
+    // ------
+    Header.PathsSize = PathsSize;
+    Success = (Success &&
+               PACK_WriteBlock(File, Entries, Header.EntryCount * sizeof(pack_entry),
+                               PACK_TABLE_ALIGNMENT, &FileCursor, &Header.EntriesOffset) &&
+               PACK_WriteBlock(File, Chunks, Header.ChunkCount * sizeof(pack_chunk),
+                               PACK_TABLE_ALIGNMENT, &FileCursor, &Header.ChunksOffset) &&
+               PACK_WriteBlock(File, Slots, SlotCount * sizeof(u32),
+                               PACK_TABLE_ALIGNMENT, &FileCursor, &Header.SlotsOffset) &&
+               PACK_WriteBlock(File, Paths, (size_t) PathsSize,
+                               PACK_TABLE_ALIGNMENT, &FileCursor, &Header.PathsOffset));
+
+    // Final header
+    // ------------
+    Header.FileSize = FileCursor;
+    Success = (Success &&
+               fseek(File, 0, SEEK_SET) == 0 &&
+               fwrite(&Header, sizeof(Header), 1, File) == 1);
+
+    if (File)
+    {
+        fclose(File);
+        if (!Success)
+        {
+            fprintf(stderr, "Failed to write resource pack: %s\n", PackPath);
+            remove(PackPath);
+        }
+    }
+
+    if (Success)
+    {
+        printf("Packed %u file(s) into %s: %.2f MB of data stored as %.2f MB\n",
+               Header.EntryCount, PackPath,
+               (f64) TotalSize / (1024.0 * 1024.0), (f64) CompressedEntrySize / (1024.0 * 1024.0));
+    }
+
+    for (i32 InputIndex = 0; InputIndex < InputCount; ++InputIndex)
+    {
+        UnmapFile(&WriteEntries[InputIndex].File);
+        free(WriteEntries[InputIndex].ChunkSizes);
+        free(WriteEntries[InputIndex].CompressedData);
+    }
+    free(Paths);
+    free(Chunks);
+    free(Entries);
+    free(Slots);
+    free(WriteEntries);
+
+    return Success;
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+// Validation
+// ----------
+
+static bool
+PACK_IsRangeValid(u64 Offset, u64 Size, u64 FileSize)
+{
+    return (Offset <= FileSize && Size <= FileSize - Offset);
+}
+
+static bool
+PACK_Validate(const mapped_file *File)
+{
+    // NOTE: Everything a lookup or read follows is checked here once, so those don't have to
+    if (File->Size < sizeof(pack_header))
+    {
+        return false;
+    }
+
+    const pack_header *Header = (const pack_header *) File->Data;
+    if (Header->Magic != PACK_MAGIC || Header->Version != PACK_VERSION || Header->FileSize != File->Size ||
+        Header->SlotCount == 0 || (Header->SlotCount & (Header->SlotCount - 1)) != 0 ||
+        Header->PathsSize == 0 ||
+        !PACK_IsRangeValid(Header->EntriesOffset, (u64) Header->EntryCount * sizeof(pack_entry), File->Size) ||
+        !PACK_IsRangeValid(Header->ChunksOffset, (u64) Header->ChunkCount * sizeof(pack_chunk), File->Size) ||
+        !PACK_IsRangeValid(Header->SlotsOffset, (u64) Header->SlotCount * sizeof(u32), File->Size) ||
+        !PACK_IsRangeValid(Header->PathsOffset, Header->PathsSize, File->Size) ||
+        File->Data[Header->PathsOffset + Header->PathsSize - 1] != '\0')
+    {
+        return false;
+    }
+
+    const pack_entry *Entries = (const pack_entry *) (File->Data + Header->EntriesOffset);
+    const pack_chunk *Chunks = (const pack_chunk *) (File->Data + Header->ChunksOffset);
+    const u32 *Slots = (const u32 *) (File->Data + Header->SlotsOffset);
+
+    for (u32 EntryIndex = 0; EntryIndex < Header->EntryCount; ++EntryIndex)
+    {
+        const pack_entry *Entry = &Entries[EntryIndex];
+        if (Entry->PathOffset >= Header->PathsSize)
+        {
+            return false;
+        }
+
+        if (Entry->Flags & PACK_ENTRY_FLAG_COMPRESSED)
+        {
+            u64 ChunkCount = (Entry->Size + PACK_CHUNK_SIZE - 1) / PACK_CHUNK_SIZE;
+            if (Entry->ChunkCount != ChunkCount || !PACK_IsRangeValid(Entry->FirstChunk, ChunkCount, Header->ChunkCount))
+            {
+                return false;
+            }
+        }
+        else if (!PACK_IsRangeValid(Entry->DataOffset, Entry->Size, File->Size))
+        {
+            return false;
+        }
+    }
+
+    for (u32 ChunkIndex = 0; ChunkIndex < Header->ChunkCount; ++ChunkIndex)
+    {
+        if (Chunks[ChunkIndex].CompressedSize > PACK_CHUNK_SIZE ||
+            !PACK_IsRangeValid(Chunks[ChunkIndex].Offset, Chunks[ChunkIndex].CompressedSize, File->Size))
+        {
+            return false;
+        }
+    }
+
+    for (u32 SlotIndex = 0; SlotIndex < Header->SlotCount; ++SlotIndex)
+    {
+        if (Slots[SlotIndex] > Header->EntryCount)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Reading
+// -------
+
+static bool
+PACK_ReadChunk(const pack_entry *Entry, u32 ChunkIndex, u64 Offset, size_t Size, u8 *Out_Data, u8 **Scratch)
+{
+    const pack_chunk *Chunk = &Pack.Chunks[Entry->FirstChunk + ChunkIndex];
+    const u8 *Source = Pack.File.Data + Chunk->Offset;
+
+    u64 ChunkStart = (u64) ChunkIndex * PACK_CHUNK_SIZE;
+    size_t ChunkSize = (Entry->Size - ChunkStart < PACK_CHUNK_SIZE) ? (size_t) (Entry->Size - ChunkStart) : PACK_CHUNK_SIZE;
+
+    // NOTE: The part of the chunk that's in the range
+    u64 CopyStart = (Offset > ChunkStart) ? Offset : ChunkStart;
+    u64 CopyEnd = (Offset + Size < ChunkStart + ChunkSize) ? Offset + Size : ChunkStart + ChunkSize;
+    u8 *Dest = Out_Data + (CopyStart - Offset);
+
+    if (Chunk->CompressedSize == ChunkSize)
+    {
+        memcpy(Dest, Source + (CopyStart - ChunkStart), (size_t) (CopyEnd - CopyStart));
+        return true;
+    }
+
+    if (CopyStart == ChunkStart && CopyEnd == ChunkStart + ChunkSize)
+    {
+        return DecompressLZ4(Source, Chunk->CompressedSize, Dest, ChunkSize);
+    }
+
+    // NOTE: Chunks cut by the ends of the range go through a scratch buffer first
+    if (!*Scratch)
+    {
+        *Scratch = (u8 *) malloc(PACK_CHUNK_SIZE);
+        Assert(*Scratch);
+    }
+    if (!DecompressLZ4(Source, Chunk->CompressedSize, *Scratch, ChunkSize))
+    {
+        return false;
+    }
+    memcpy(Dest, *Scratch + (CopyStart - ChunkStart), (size_t) (CopyEnd - CopyStart));
+    return true;
+}
+
+static void
+PACK_ReadChunks(pack_read *Read)
+{
+    u8 *Scratch = 0;
+    for (;;)
+    {
+        u32 Claimed = (u32) SDL_AtomicAdd(&Read->NextChunk, 1);
+        if (Claimed >= Read->ChunkCount)
+        {
+            break;
+        }
+
+        if (!PACK_ReadChunk(Read->Entry, Read->FirstChunk + Claimed, Read->Offset, Read->Size, Read->Out_Data, &Scratch))
+        {
+            SDL_AtomicAdd(&Read->FailedCount, 1);
+        }
+        if ((u32) SDL_AtomicAdd(&Read->FinishedCount, 1) + 1 == Read->ChunkCount)
+        {
+            SDL_SemPost(Read->Done);
+        }
+    }
+    free(Scratch);
+}
+
+static void
+PACK_ReadChunksJob(void *Data)
+{
+    pack_read *Read = (pack_read *) Data;
+    PACK_ReadChunks(Read);
+    PACK_ReleaseRead(Read);
+}
+
+static void
+PACK_ReleaseRead(pack_read *Read)
+{
+    if (SDL_AtomicDecRef(&Read->RefCount))
+    {
+        SDL_DestroySemaphore(Read->Done);
+        free(Read);
+    }
+}
+
+// Writing
+// -------
+
+static void
+PACK_CompressEntryJob(void *Data)
+{
+    pack_write_entry *Entry = (pack_write_entry *) Data;
+    const char *SourcePath = Entry->Input->Path;
+
+    u64 Size;
+    if (!NormalizePath(SourcePath, Entry->Path, MAX_PATH_LENGTH) ||
+        !GetFileInfo(SourcePath, &Size, &Entry->ModificationTime))
+    {
+        fprintf(stderr, "Couldn't pack %s\n", SourcePath);
+        Entry->Failed = true;
+        return;
+    }
+
+    // NOTE: Empty files can't be mapped; they're stored with no data
+    if (Size == 0)
+    {
+        return;
+    }
+    if (!MapFileReadOnly(SourcePath, &Entry->File))
+    {
+        fprintf(stderr, "Couldn't pack %s\n", SourcePath);
+        Entry->Failed = true;
+        return;
+    }
+    Entry->Size = Entry->File.Size;
+
+    if (Entry->Input->KeepUncompressed)
+    {
+        return;
+    }
+
+    // NOTE: A chunk is only kept compressed if it got smaller, so every chunk (and the whole file)
+    //       fits in Size bytes
+    u32 ChunkCount = (u32) ((Entry->Size + PACK_CHUNK_SIZE - 1) / PACK_CHUNK_SIZE);
+    u32 *ChunkSizes = (u32 *) malloc(ChunkCount * sizeof(u32));
+    u8 *CompressedData = (u8 *) malloc((size_t) Entry->Size);
+    Assert(ChunkSizes && CompressedData);
+
+    u64 CompressedSize = 0;
+    for (u32 ChunkIndex = 0; ChunkIndex < ChunkCount; ++ChunkIndex)
+    {
+        u64 ChunkStart = (u64) ChunkIndex * PACK_CHUNK_SIZE;
+        size_t ChunkSize = (Entry->Size - ChunkStart < PACK_CHUNK_SIZE) ? (size_t) (Entry->Size - ChunkStart) : PACK_CHUNK_SIZE;
+
+        size_t ChunkCompressedSize = CompressLZ4(Entry->File.Data + ChunkStart, ChunkSize,
+                                                 CompressedData + CompressedSize, ChunkSize - 1);
+        if (ChunkCompressedSize == 0)
+        {
+            memcpy(CompressedData + CompressedSize, Entry->File.Data + ChunkStart, ChunkSize);
+            ChunkCompressedSize = ChunkSize;
+        }
+
+        ChunkSizes[ChunkIndex] = (u32) ChunkCompressedSize;
+        CompressedSize += ChunkCompressedSize;
+    }
+
+    if (CompressedSize > Entry->Size - Entry->Size / 8)
+    {
+        free(ChunkSizes);
+        free(CompressedData);
+        return;
+    }
+
+    Entry->IsCompressed = true;
+    Entry->ChunkCount = ChunkCount;
+    Entry->ChunkSizes = ChunkSizes;
+    Entry->CompressedData = CompressedData;
+    UnmapFile(&Entry->File);
+}
+
+static bool
+PACK_WriteBlock(FILE *File, const void *Data, size_t Size, size_t Alignment, u64 *FileCursor, u64 *Out_Offset)
+{
+    static const u8 Padding[PACK_DATA_ALIGNMENT] = { };
+    Assert(Alignment <= PACK_DATA_ALIGNMENT);
+
+    size_t PaddingSize = (size_t) ((Alignment - (*FileCursor % Alignment)) % Alignment);
+    if (PaddingSize > 0 && fwrite(Padding, PaddingSize, 1, File) != 1)
+    {
+        return false;
+    }
+    *FileCursor += PaddingSize;
+
+    *Out_Offset = *FileCursor;
+    if (Size > 0 && fwrite(Data, Size, 1, File) != 1)
+    {
+        return false;
+    }
+    *FileCursor += Size;
+
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef PACK_H
+#define PACK_H
+
+#include "Common.h"
+
+// NOTE: One resource pack (see PackFormat.h) can be mounted at a time. While it is, FileIO looks
+//       every path up in it before going to disk, so ReadFile, MapFileReadOnly, ReadFilesAsync,
+//       FileExists and GetFileInfo (and everything built on them) read packed files
+//       transparently; anything that isn't in the pack still comes from loose files. The pack is
+//       mapped once, so a packed file costs no open/read/close of its own. Mount before loading
+//       starts and unmount after it's done; lookups aren't synchronized against either.
+
+struct job_queue;
+
+// Pack mounting
+// -------------
+
+// NOTE: Queue is optional; with one, big compressed reads are decompressed on its workers too
+bool
+MountPack(const char *Path, job_queue *Queue);
+void
+UnmountPack();
+bool
+IsPackMounted();
+
+// Packed files
+// ------------
+
+struct packed_file
+{
+    u32 EntryIndex;
+    u64 Size;
+    u64 ModificationTime;
+    // NOTE: Straight into the mapped pack for stored entries, 0 for compressed ones
+    const u8 *Data;
+};
+
+bool
+FindPackedFile(const char *Path, packed_file *Out_File);
+// NOTE: Only decompresses the chunks that overlap the range. Reads of many chunks are split
+//       across the mount queue's workers; the calling thread decompresses chunks as well and only
+//       waits for ones a worker has already started, so this is safe to call from a job.
+bool
+ReadPackedFile(packed_file *File, u64 Offset, size_t Size, u8 *Out_Data);
+
+// Pack writing
+// ------------
+
+struct pack_input
+{
+    char Path[MAX_PATH_LENGTH];
+    // NOTE: For files that are read in place a range at a time (cooked textures stream their mips
+    //       out of the mapping), so they stay mappable
+    bool KeepUncompressed;
+};
+
+// NOTE: Files are compressed on Queue's workers; ones that don't get at least 1/8 smaller are
+//       stored instead
+bool
+WritePack(const char *PackPath, pack_input *Inputs, i32 InputCount, job_queue *Queue);
+
+#endif
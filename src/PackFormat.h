@@ -0,0 +1,80 @@
+#ifndef PACK_FORMAT_H
+#define PACK_FORMAT_H
+
+#include "Common.h"
+
+// NOTE: Resource pack layout (all offsets are from the start of the file):
+//
+//       pack_header
+//       [file data] per entry             (PACK_DATA_ALIGNMENT for stored entries,
+//                                          PACK_CHUNK_ALIGNMENT for compressed ones)
+//       pack_entry[EntryCount]
+//       pack_chunk[ChunkCount]
+//       u32 Slots[SlotCount]              (hashed path index, see below)
+//       char Paths[PathsSize]             (null terminated)
+//
+//       Entries are either stored as is, so a mapped pack can hand out pointers straight into
+//       itself, or split into PACK_CHUNK_SIZE chunks that are LZ4 compressed on their own, so a
+//       range of a file can be read without decompressing all of it. A chunk whose CompressedSize
+//       equals its uncompressed size didn't compress and is stored as is.
+//
+//       Paths are normalized (see NormalizePath) and relative to the directory the game runs in,
+//       e.g. "resources/textures/grass.jpg". Slots is an open addressing table on PathHash
+//       (HashBytes64 of the path, linear probing, SlotCount a power of 2) holding entry index + 1,
+//       0 for empty slots.
+
+#define PACK_MAGIC 0x4B434150 // 'PACK'
+#define PACK_VERSION 1
+#define PACK_EXTENSION ".pack"
+
+#define PACK_CHUNK_SIZE (64 * 1024)
+#define PACK_DATA_ALIGNMENT 4096
+#define PACK_CHUNK_ALIGNMENT 16
+#define PACK_TABLE_ALIGNMENT 16
+
+#define PACK_ENTRY_FLAG_COMPRESSED 0x1
+
+struct pack_header
+{
+    u32 Magic;
+    u32 Version;
+    u32 EntryCount;
+    u32 ChunkCount;
+
+    u64 FileSize;
+
+    u32 SlotCount;
+    u32 Reserved;
+
+    u64 EntriesOffset;
+    u64 ChunksOffset;
+    u64 SlotsOffset;
+    u64 PathsOffset;
+    u64 PathsSize;
+};
+
+struct pack_entry
+{
+    u64 PathHash;
+    u32 PathOffset;
+    u32 Flags;
+
+    u64 Size;
+    u64 ModificationTime;
+
+    // NOTE: Stored entries only
+    u64 DataOffset;
+
+    // NOTE: Compressed entries only; Size rounded up to PACK_CHUNK_SIZE
+    u32 FirstChunk;
+    u32 ChunkCount;
+};
+
+struct pack_chunk
+{
+    u64 Offset;
+    u32 CompressedSize;
+    u32 Reserved;
+};
+
+#endif
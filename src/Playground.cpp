@@ -3,23 +3,45 @@
 #include <sdl2/SDL_ttf.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/string_cast.hpp>
 #include <glm/gtc/quaternion.hpp>
 
 #include <cstdlib>
 #include <cstdio>
 
+#include "AssetLoader.h"
 #include "Common.h"
 #include "DebugUI.h"
+#include "GLState.h"
+#include "Memory.h"
 #include "Model.h"
+#include "Occlusion.h"
+#include "Pack.h"
+#include "RenderQueue.h"
+#include "Resource.h"
+#include "Scene.h"
 #include "Shader.h"
+#include "StaticBatch.h"
+#include "StreamBuffer.h"
 #include "Text.h"
+#include "Texture.h"
 #include "Util.h"
 
 #define SCREEN_WIDTH 1920
 #define SCREEN_HEIGHT 1080
 
+// NOTE: Written by sdlogl-cook -pack; without it everything is read from the loose files
+#define RESOURCE_PACK_PATH "resources.pack"
+
+// NOTE: Stress case for the static batch: lines the floor's edge with a wall of unit quads, 100
+//       more meshes for it to bake. Off by default.
+#ifndef PLAYGROUND_STATIC_BATCH_STRESS
+#define PLAYGROUND_STATIC_BATCH_STRESS 0
+#endif
+
+// NOTE: Unit quads along each edge of the floor (25 units across)
+#define FLOOR_BORDER_SEGMENTS 25
+
 glm::vec3 CameraPosition = glm::vec3(0.0f, 1.7f, 0.0f);
 glm::vec3 CameraFront = glm::vec3(0.0f, 0.0f, 1.0f);
 glm::vec3 CameraRight = glm::vec3(1.0f, 0.0f, 0.0f);
@@ -42,6 +64,7 @@ f32 AdamYaw = 0.0f;
 i32 AdamMovementState = 0;
 
 #define DEBUG_TIMING_AVG_SAMPLES 10
+#define ASSET_UPLOAD_BUDGET_MS 2.0
 
 int
 main(int Argc, char *Argv[])
@@ -82,22 +105,32 @@ main(int Argc, char *Argv[])
                 printf("Version: %s\n", glGetString(GL_VERSION));
 
                 // GL Global Settings
-                glEnable(GL_DEPTH_TEST);
-                glEnable(GL_CULL_FACE);
-                glEnable(GL_BLEND);
-                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);  
+                InitializeGLState();
+                InitializeStreamBuffer(DEFAULT_STREAM_BUFFER_FRAME_SIZE);
+                SetDepthTest(true);
+                SetFaceCulling(true);
+                SetBlending(true);
+                SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);  
 
                 int WindowWidth;
                 int WindowHeight;
                 SDL_GetWindowSize(Window, &WindowWidth, &WindowHeight);
                 glViewport(0, 0, WindowWidth, WindowHeight);
 
+                // Resources
+                // ---------
+                // NOTE: Up before anything is read, so the pack serves every file and its big
+                //       reads decompress on the loader's workers
+                InitializeAssetLoader(0);
+                MountPack(RESOURCE_PACK_PATH, GetAssetLoaderQueue());
+
                 // Load fonts
                 // ----------
                 Assert(TTF_Init() != -1);
 
-                font_info *FontContrailOne24 =
-                    RasterizeAndProcessFont("resources/fonts/ContrailOne-Regular.ttf", 24);
+                font_handle FontContrailOne24Handle =
+                    LoadFontResource("resources/fonts/ContrailOne-Regular.ttf", 24, 0);
+                font_info *FontContrailOne24 = GetFont(FontContrailOne24Handle);
 
                 // Load shaders
                 // ------------
@@ -112,39 +145,108 @@ main(int Argc, char *Argv[])
                     BuildShaderProgram("resources/shaders/BasicText.vs",
                                        "resources/shaders/BasicText.fs");
 
+
                 // Load models
                 // -----------
-                model SnowmanModel = LoadModel("resources/models/snowman/snowman.objm", true);
-                model ContainerModel = LoadModel("resources/models/container/container.objm", true);
-                model FloorModel = LoadModel("resources/models/primitives/floor.gltf", true);
-                FloorModel.Meshes[0].DiffuseMapID = LoadTexture("resources/textures/grass.jpg", true);
-                model WallModel = LoadModel("resources/models/primitives/quad.gltf", true);
-                WallModel.Meshes[0].DiffuseMapID = LoadTexture("resources/textures/brickwall.jpg", true);
-                WallModel.Meshes[0].NormalMapID = LoadTexture("resources/textures/brickwall_normal.jpg", true);
-                skinned_model AdamModel = LoadSkinnedModel("resources/models/adam/adam.gltf", false);
-                AdamModel.AnimationState.CurrentAnimationA = 0;
-                AdamModel.AnimationState.CurrentAnimationB = 2;
-                AdamModel.AnimationState.BlendingFactor = 0.0f;
+                // NOTE: Primitives whose textures get swapped right away are loaded synchronously,
+                //       everything else streams in while the first frames are drawn
+                // NOTE: Pointers from the pools stay valid until their handles are released
+                model_handle SnowmanModelHandle =
+                    LoadModelResource("resources/models/snowman/snowman.objm", RESOURCE_GENERATE_MIPMAP);
+                // NOTE: One of the containers is baked into the static scenery, so it's loaded now and
+                //       its vertices are kept on the CPU
+                model_handle ContainerModelHandle =
+                    LoadModelResource("resources/models/container/container.objm",
+                                      RESOURCE_GENERATE_MIPMAP | RESOURCE_LOAD_NOW | RESOURCE_KEEP_CPU_DATA);
+                skinned_model_handle AdamModelHandle = LoadSkinnedModelResource("resources/models/adam/adam.gltf", 0);
+                model_handle FloorModelHandle =
+                    LoadModelResource("resources/models/primitives/floor.gltf",
+                                      RESOURCE_GENERATE_MIPMAP | RESOURCE_LOAD_NOW | RESOURCE_KEEP_CPU_DATA);
+                // NOTE: The walls occlude (and make up the stress case's border), so their vertices are
+                //       kept on the CPU
+                model_handle WallModelHandle =
+                    LoadModelResource("resources/models/primitives/quad.gltf",
+                                      RESOURCE_GENERATE_MIPMAP | RESOURCE_LOAD_NOW | RESOURCE_KEEP_CPU_DATA);
+
+                model *SnowmanModel = GetModel(SnowmanModelHandle);
+                model *ContainerModel = GetModel(ContainerModelHandle);
+                skinned_model *AdamModel = GetSkinnedModel(AdamModelHandle);
+                AdamModel->AnimationState.CurrentAnimationA = 0;
+                AdamModel->AnimationState.CurrentAnimationB = 2;
+                AdamModel->AnimationState.BlendingFactor = 0.0f;
+                model *FloorModel = GetModel(FloorModelHandle);
+                FloorModel->Meshes[0].DiffuseMapID = LoadTexture("resources/textures/grass.jpg", true);
+                model *WallModel = GetModel(WallModelHandle);
+                WallModel->Meshes[0].DiffuseMapID = LoadTexture("resources/textures/brickwall.jpg", true);
+                WallModel->Meshes[0].NormalMapID = LoadTexture("resources/textures/brickwall_normal.jpg", true);
 
                 // Shader global uniforms
                 // ----------------------
-                SetUniformInt(StaticMeshShader, "DiffuseMap", true, 0);
-                SetUniformInt(StaticMeshShader, "SpecularMap", false, 1);
-                SetUniformInt(StaticMeshShader, "EmissionMap", false, 2);
-                SetUniformInt(StaticMeshShader, "NormalMap", false, 3);
-
-                SetUniformInt(SkinnedMeshShader, "DiffuseMap", true, 0);
-                SetUniformInt(SkinnedMeshShader, "SpecularMap", false, 1);
-                SetUniformInt(SkinnedMeshShader, "EmissionMap", false, 2);
-                SetUniformInt(SkinnedMeshShader, "NormalMap", false, 3);
+                SetUniformInt(StaticMeshShader, "DiffuseMap", 0);
+                SetUniformInt(StaticMeshShader, "SpecularMap", 1);
+                SetUniformInt(StaticMeshShader, "EmissionMap", 2);
+                SetUniformInt(StaticMeshShader, "NormalMap", 3);
+
+                SetUniformInt(SkinnedMeshShader, "DiffuseMap", 0);
+                SetUniformInt(SkinnedMeshShader, "SpecularMap", 1);
+                SetUniformInt(SkinnedMeshShader, "EmissionMap", 2);
+                SetUniformInt(SkinnedMeshShader, "NormalMap", 3);
                 
-                SetUniformInt(BasicTextShader, "FontAtlas", true, 0);
+                SetUniformInt(BasicTextShader, "FontAtlas", 0);
+
+                // Static scenery
+                // --------------
+                // NOTE: The floor and the second container never move, so they're baked into a few world
+                //       space chunks instead of being drawn one by one
+                glm::mat4 Container2Transform = glm::mat4(1.0f);
+                Container2Transform = glm::translate(Container2Transform, glm::vec3(-1.5f, 2.0f, -2.0f));
+                Container2Transform = glm::scale(Container2Transform, glm::vec3(0.70f));
+                static_batch_source StaticSources[2 + 4 * FLOOR_BORDER_SEGMENTS];
+                i32 StaticSourceCount = 0;
+                StaticSources[StaticSourceCount++] = { FloorModel, glm::mat4(1.0f) };
+                StaticSources[StaticSourceCount++] = { ContainerModel, Container2Transform };
+#if PLAYGROUND_STATIC_BATCH_STRESS
+                for (i32 Side = 0; Side < 4; ++Side)
+                {
+                    for (i32 Segment = 0; Segment < FLOOR_BORDER_SEGMENTS; ++Segment)
+                    {
+                        // NOTE: Along the far edge facing in, turned a quarter for each side
+                        glm::mat4 Transform = glm::rotate(glm::mat4(1.0f), glm::radians(90.0f * (f32) Side),
+                                                          glm::vec3(0.0f, 1.0f, 0.0f));
+                        f32 HalfEdge = 0.5f * (f32) FLOOR_BORDER_SEGMENTS;
+                        Transform = glm::translate(Transform, glm::vec3(-HalfEdge + 0.5f + (f32) Segment, 0.0f, -HalfEdge));
+                        StaticSources[StaticSourceCount++] = { WallModel, Transform };
+                    }
+                }
+#endif
+                static_batch StaticBatch;
+                BakeStaticBatch(StaticSources, StaticSourceCount, &StaticBatch);
+
+                // Scene
+                // -----
+                // NOTE: Instances that move get their transforms set every frame in the game loop
+                scene Scene;
+                InitializeScene(&Scene);
+                for (i32 ChunkIndex = 0; ChunkIndex < StaticBatch.ChunkCount; ++ChunkIndex)
+                {
+                    AddSceneModel(&Scene, &StaticBatch.Chunks[ChunkIndex], StaticMeshShader, glm::mat4(1.0f));
+                }
+                i32 ContainerInstance = AddSceneModel(&Scene, ContainerModel, StaticMeshShader, glm::mat4(1.0f));
+                i32 WallInstance = AddSceneModel(&Scene, WallModel, StaticMeshShader, glm::mat4(1.0f));
+                i32 WallBackInstance = AddSceneModel(&Scene, WallModel, StaticMeshShader, glm::mat4(1.0f));
+                i32 SnowmanInstance = AddSceneModel(&Scene, SnowmanModel, StaticMeshShader, glm::mat4(1.0f));
+                i32 AdamInstance = AddSceneSkinnedModel(&Scene, AdamModel, SkinnedMeshShader, glm::mat4(1.0f));
+                // NOTE: Not the floor: everything stands on it, and a box that dips into it would be tested
+                //       against the floor's own depth
+                SetSceneInstanceOccluder(&Scene, WallInstance, true);
+                SetSceneInstanceOccluder(&Scene, WallBackInstance, true);
+                occlusion_buffer Occlusion;
+                InitializeOcclusionBuffer(&Occlusion);
 
                 // Light configuration
                 // -------------------
+                // NOTE: Goes to the shaders with the rest of the frame globals
                 glm::vec3 LightDir = glm::normalize(glm::vec3(-1.0f, -1.0f, -0.33f));
-                SetUniformVec3F(StaticMeshShader, "LightDirection", true, &LightDir[0]);
-                SetUniformVec3F(SkinnedMeshShader, "LightDirection", true, &LightDir[0]);
 
                 // Debug UI setup
                 // --------------
@@ -205,8 +307,16 @@ main(int Argc, char *Argv[])
 
                 SDL_Event SdlEvent;
                 bool ShouldQuit = false;
+                frame_memory_stats LastFrameMemoryStats = { };
+                gl_state_stats LastFrameGLStats = { };
+                stream_buffer_stats LastFrameStreamStats = { };
+                cull_stats LastFrameCullStats = { };
                 while (!ShouldQuit)
                 {
+                    BeginFrameMemory();
+                    BeginGLStateFrame();
+                    BeginStreamBufferFrame();
+
                     // Poll SDL events
                     // ---------------
                     while (SDL_PollEvent(&SdlEvent))
@@ -258,15 +368,15 @@ main(int Argc, char *Argv[])
                         }
                         if (AdamMovementState == 0)
                         {
-                            AdamModel.AnimationState.CurrentAnimationA = 0;
+                            AdamModel->AnimationState.CurrentAnimationA = 0;
                         }
                         if (AdamMovementState == 1)
                         {
-                            AdamModel.AnimationState.CurrentAnimationA = 3;
+                            AdamModel->AnimationState.CurrentAnimationA = 3;
                         }
                         if (AdamMovementState == 2)
                         {
-                            AdamModel.AnimationState.CurrentAnimationA = 2;
+                            AdamModel->AnimationState.CurrentAnimationA = 2;
                         }
                         AdamMovementStateButtonPressed = true;
                     }
@@ -335,6 +445,10 @@ main(int Argc, char *Argv[])
                         CameraPosition += PositionDelta;
                     }
 
+                    // Finish loaded assets
+                    // --------------------
+                    ProcessAssetUploads(ASSET_UPLOAD_BUDGET_MS);
+
                     // Render
                     // ------
                     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
@@ -346,51 +460,40 @@ main(int Argc, char *Argv[])
                     // Common transform matrices
                     glm::mat4 ProjectionTransform = glm::perspective(glm::radians(CameraFov / 2.0f), (f32)SCREEN_WIDTH / (f32)SCREEN_HEIGHT, 0.1f, 1000.0f);
                     glm::mat4 ViewTransform = glm::lookAt(CameraPosition, CameraPosition + CameraFront, CameraUp);
+                    // NOTE: Pixels one world unit covers at distance 1, for texture mip streaming
+                    f32 PixelsPerUnit = ProjectionTransform[1][1] * 0.5f * (f32) SCREEN_HEIGHT;
+
+                    frame_globals FrameGlobals = { };
+                    FrameGlobals.Projection = ProjectionTransform;
+                    FrameGlobals.View = ViewTransform;
+                    FrameGlobals.ViewPosition = CameraPosition;
+                    FrameGlobals.Time = (f32) ElapsedTime;
+                    FrameGlobals.LightDirection = LightDir;
+                    UploadFrameGlobals(&FrameGlobals);
+
+                    // Queue models
+                    // ------------
+                    render_queue RenderQueue;
+                    BeginRenderQueue(&RenderQueue, DEFAULT_RENDER_QUEUE_CAPACITY, CameraPosition, CameraFront, 1000.0f);
 
-                    SetUniformMat4F(StaticMeshShader, "Projection", true, glm::value_ptr(ProjectionTransform));
-                    SetUniformMat4F(StaticMeshShader, "View", false, glm::value_ptr(ViewTransform));
-                    SetUniformVec3F(StaticMeshShader, "ViewPosition", false, &CameraPosition[0]);
-
-                    SetUniformMat4F(SkinnedMeshShader, "Projection", true, glm::value_ptr(ProjectionTransform));
-                    SetUniformMat4F(SkinnedMeshShader, "View", false, glm::value_ptr(ViewTransform));
-                    SetUniformVec3F(SkinnedMeshShader, "ViewPosition", false, &CameraPosition[0]);
-
-                    // Render models
-                    // -------------
-
-                    // floor
-                    glm::mat4 ModelTransform = glm::mat4(1.0f);
-                    SetUniformMat4F(StaticMeshShader, "Model", true, glm::value_ptr(ModelTransform));
-                    //glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(ModelTransform)));
-                    RenderModel(&FloorModel, StaticMeshShader);
                     // container 1
-                    ModelTransform = glm::mat4(1.0f);
+                    glm::mat4 ModelTransform = glm::mat4(1.0f);
                     ModelTransform = glm::rotate(ModelTransform, (f32) ElapsedTime, glm::vec3(0.0f, 1.0f, 0.0f));
                     ModelTransform = glm::scale(ModelTransform, glm::vec3(1.0f));
-                    SetUniformMat4F(StaticMeshShader, "Model", false, glm::value_ptr(ModelTransform));
-                    RenderModel(&ContainerModel, StaticMeshShader);
-                    // container 2
-                    ModelTransform = glm::mat4(1.0f);
-                    ModelTransform = glm::translate(ModelTransform, glm::vec3(-1.5f, 2.0f, -2.0f));
-                    ModelTransform = glm::scale(ModelTransform, glm::vec3(0.70f));
-                    SetUniformMat4F(StaticMeshShader, "Model", false, glm::value_ptr(ModelTransform));
-                    RenderModel(&ContainerModel, StaticMeshShader);
+                    SetSceneInstanceTransform(&Scene, ContainerInstance, ModelTransform);
                     // quad wall
                     ModelTransform = glm::mat4(1.0f);
                     ModelTransform = glm::translate(ModelTransform, glm::vec3(-10.0f, 0.0f, 0.0f));
                     ModelTransform = glm::rotate(ModelTransform, (f32) ElapsedTime, glm::vec3(0.0f, 1.0f, 0.0f));
-                    SetUniformMat4F(StaticMeshShader, "Model", false, glm::value_ptr(ModelTransform));
-                    RenderModel(&WallModel, StaticMeshShader);
+                    SetSceneInstanceTransform(&Scene, WallInstance, ModelTransform);
                     // other side of wall (no z-fighting because faces are culled)
                     ModelTransform = glm::rotate(ModelTransform, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-                    SetUniformMat4F(StaticMeshShader, "Model", false, glm::value_ptr(ModelTransform));
-                    RenderModel(&WallModel, StaticMeshShader);
+                    SetSceneInstanceTransform(&Scene, WallBackInstance, ModelTransform);
                     // snowman
                     ModelTransform = glm::mat4(1.0f);
                     ModelTransform = glm::translate(ModelTransform, glm::vec3(0.0f, 0.0f, -5.0f));
                     ModelTransform = glm::rotate(ModelTransform, (f32) ElapsedTime * 2.0f, glm::vec3(0.0f, 1.0f, 0.0f));
-                    SetUniformMat4F(StaticMeshShader, "Model", false, glm::value_ptr(ModelTransform));
-                    RenderModel(&SnowmanModel, StaticMeshShader);
+                    SetSceneInstanceTransform(&Scene, SnowmanInstance, ModelTransform);
                     // adam
                     ModelTransform = glm::mat4(1.0f);
                     glm::vec3 AdamPositionDelta(0.0f);
@@ -414,8 +517,16 @@ main(int Argc, char *Argv[])
                     ModelTransform = glm::translate(ModelTransform, AdamPosition);
                     ModelTransform = glm::rotate(ModelTransform, glm::radians(AdamYaw), glm::vec3(0.0f, 1.0f, 0.0f));
                     //ModelTransform = glm::scale(ModelTransform, glm::vec3(0.5f));
-                    SetUniformMat4F(SkinnedMeshShader, "Model", true, glm::value_ptr(ModelTransform));
-                    RenderSkinnedModel(&AdamModel, SkinnedMeshShader, (f32) PrevFrameDeltaTimeSec);
+                    UpdateSkinnedModelAnimation(AdamModel, (f32) PrevFrameDeltaTimeSec);
+                    SetSceneInstanceTransform(&Scene, AdamInstance, ModelTransform);
+
+                    // NOTE: The static chunks never move, so they're never touched after setup
+                    LastFrameCullStats = QueueVisibleScene(&Scene, &RenderQueue, ProjectionTransform * ViewTransform,
+                                                           CameraPosition, PixelsPerUnit, &Occlusion);
+
+                    // Render models
+                    // -------------
+                    FlushRenderQueue(&RenderQueue);
 
                     // Render Debug UI
                     // ---------------
@@ -437,16 +548,46 @@ main(int Argc, char *Argv[])
                             DeltaTimeAverage = DeltaTimeAverage / (f64) DEBUG_TIMING_AVG_SAMPLES;
 
                             sprintf_s(DebugUI_FPSCounterNumberBuffer, "%.2f", FPSAverage);
-                            UpdateUIString(DebugUI_FPSCounterNumber, DebugUI_FPSCounterNumberBuffer);
+                            UpdateUIString(&DebugUI_FPSCounterNumber, DebugUI_FPSCounterNumberBuffer);
                             sprintf_s(DebugUI_DeltaTimeNumberBuffer, "%.2f", DeltaTimeAverage * 1000.0);
-                            UpdateUIString(DebugUI_DeltaTimeNumber, DebugUI_DeltaTimeNumberBuffer);
+                            UpdateUIString(&DebugUI_DeltaTimeNumber, DebugUI_DeltaTimeNumberBuffer);
                         }
 
-                        RenderUIString(DebugUI_GLInfo);
-                        RenderUIString(DebugUI_FPSCounterText);
-                        RenderUIString(DebugUI_FPSCounterNumber);
-                        RenderUIString(DebugUI_DeltaTimeText);
-                        RenderUIString(DebugUI_DeltaTimeNumber);
+                        RenderUIString(&DebugUI_GLInfo);
+                        RenderUIString(&DebugUI_FPSCounterText);
+                        RenderUIString(&DebugUI_FPSCounterNumber);
+                        RenderUIString(&DebugUI_DeltaTimeText);
+                        RenderUIString(&DebugUI_DeltaTimeNumber);
+
+                        // NOTE: Last frame's, since this one isn't over yet
+                        char DebugUI_FrameMemoryBuffer[128];
+                        sprintf_s(DebugUI_FrameMemoryBuffer, "Frame heap allocs: %d (%llu B)%s, frame arena: %llu B",
+                                  LastFrameMemoryStats.HeapAllocationCount,
+                                  (unsigned long long) LastFrameMemoryStats.HeapAllocatedBytes,
+                                  LastFrameMemoryStats.CountsEveryAllocation ? "" : " [arenas/pools only]",
+                                  (unsigned long long) LastFrameMemoryStats.FrameArenaBytes);
+                        DEBUG_AddDebugString(DebugUI_FrameMemoryBuffer);
+
+                        char DebugUI_GLStatsBuffer[128];
+                        sprintf_s(DebugUI_GLStatsBuffer, "Draws: %d (%d inst, %llu tris), binds: %d, state changes: %d, skipped: %d",
+                                  LastFrameGLStats.DrawCalls, LastFrameGLStats.InstancesDrawn,
+                                  (unsigned long long) LastFrameGLStats.TrianglesDrawn,
+                                  LastFrameGLStats.ProgramBinds + LastFrameGLStats.VertexArrayBinds +
+                                  LastFrameGLStats.BufferBinds + LastFrameGLStats.TextureBinds,
+                                  LastFrameGLStats.StateChanges, LastFrameGLStats.RedundantCallsSkipped);
+                        DEBUG_AddDebugString(DebugUI_GLStatsBuffer);
+                        char DebugUI_GLUploadBuffer[128];
+                        sprintf_s(DebugUI_GLUploadBuffer, "GL uploads: %.1f KB, streamed: %.1f KB in %d (%d failed, %d orphans)",
+                                  (f64) LastFrameGLStats.UploadedBytes / 1024.0,
+                                  (f64) LastFrameStreamStats.BytesWritten / 1024.0, LastFrameStreamStats.Allocations,
+                                  LastFrameStreamStats.FailedAllocations, LastFrameStreamStats.Orphans);
+                        DEBUG_AddDebugString(DebugUI_GLUploadBuffer);
+                        char DebugUI_CullStatsBuffer[128];
+                        sprintf_s(DebugUI_CullStatsBuffer,
+                                  "Instances: %d visible, %d culled, %d occluded (%d BVH nodes, %d occluder tris)",
+                                  LastFrameCullStats.Visible, LastFrameCullStats.Culled, LastFrameCullStats.Occluded,
+                                  LastFrameCullStats.NodesTested, Occlusion.Stats.OccluderTriangles);
+                        DEBUG_AddDebugString(DebugUI_CullStatsBuffer);
                         
                         DEBUG_RenderAllDebugStrings();
                     
@@ -459,6 +600,13 @@ main(int Argc, char *Argv[])
                     // -----------
                     SDL_GL_SwapWindow(Window);
 
+                    // NOTE: Everything that could still draw what was released has been submitted
+                    ProcessResourceDestruction();
+
+                    LastFrameMemoryStats = EndFrameMemory();
+                    LastFrameStreamStats = EndStreamBufferFrame();
+                    LastFrameGLStats = EndGLStateFrame();
+
                     // Timing
                     // ------
                     u64 CurrentCounter = SDL_GetPerformanceCounter();
@@ -475,6 +623,23 @@ main(int Argc, char *Argv[])
                     }
                     ElapsedTime += PrevFrameDeltaTimeSec;
                 }
+
+                printf("%d frame(s) allocated from the heap\n", LastFrameMemoryStats.AllocatingFrameCount);
+
+                FreeOcclusionBuffer(&Occlusion);
+                FreeScene(&Scene);
+                FreeStaticBatch(&StaticBatch);
+
+                ReleaseModel(SnowmanModelHandle);
+                ReleaseModel(ContainerModelHandle);
+                ReleaseSkinnedModel(AdamModelHandle);
+                ReleaseModel(FloorModelHandle);
+                ReleaseModel(WallModelHandle);
+                ReleaseFont(FontContrailOne24Handle);
+
+                ShutdownAssetLoader();
+                ShutdownResources();
+                UnmountPack();
             }
             else
             {
@@ -0,0 +1,305 @@
+#include "RenderQueue.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstring>
+
+#include "GLState.h"
+#include "Hash.h"
+#include "Memory.h"
+#include "Shader.h"
+
+// NOTE: Sort key layout, most significant bits first. Only the layer has to be exact; the rest
+//       are truncated IDs and hashes, so two different states can share a value and just won't
+//       be grouped as tightly.
+//         Opaque:      layer (2) | shader (6) | material (16) | VAO (16) | depth (24)
+//         Transparent: layer (2) | inverted depth (24) | shader (6) | material (16) | VAO (16)
+#define RENDER_KEY_LAYER_SHIFT 62
+#define RENDER_KEY_DEPTH_MAX 0xFFFFFF
+#define RENDER_KEY_SHADER_MASK 0x3F
+#define RENDER_KEY_MATERIAL_MASK 0xFFFF
+#define RENDER_KEY_VAO_MASK 0xFFFF
+
+static u64
+RENDER_PackSortKey(render_queue *Queue, render_item *Item, render_layer Layer);
+static void
+RENDER_RadixSort(u64 *Keys, u32 *Indices, i32 Count, u64 *TempKeys, u32 *TempIndices);
+static inline bool
+RENDER_CanInstanceTogether(mesh *A, mesh *B);
+
+// -----------------------------
+// EXTERNAL FUNCTION DEFINITIONS
+// -----------------------------
+
+void
+BeginRenderQueue(render_queue *Queue, i32 Capacity, glm::vec3 CameraPosition, glm::vec3 CameraForward,
+                 f32 MaxDepth)
+{
+    Assert(Capacity > 0 && MaxDepth > 0.0f);
+
+    *Queue = { };
+    Queue->Capacity = Capacity;
+    Queue->Items = PushArray(GetFrameArena(), Capacity, render_item);
+    Queue->SortKeys = PushArray(GetFrameArena(), Capacity, u64);
+    Queue->CameraPosition = CameraPosition;
+    Queue->CameraForward = glm::normalize(CameraForward);
+    Queue->MaxDepth = MaxDepth;
+}
+
+void
+QueueMesh(render_queue *Queue, mesh *Mesh, u32 Shader, glm::mat4 Transform, render_layer Layer,
+          glm::mat4 *BonePalette, i32 BoneCount)
+{
+    Assert(Layer >= 0 && Layer < RENDER_LAYER_COUNT);
+
+    if (Queue->ItemCount == Queue->Capacity)
+    {
+        ++Queue->OverflowCount;
+        return;
+    }
+
+    i32 ItemIndex = Queue->ItemCount++;
+    render_item *Item = &Queue->Items[ItemIndex];
+    Item->Mesh = Mesh;
+    Item->Shader = Shader;
+    Item->Transform = Transform;
+    Item->BonePalette = BonePalette;
+    Item->BoneCount = BoneCount;
+
+    Queue->SortKeys[ItemIndex] = RENDER_PackSortKey(Queue, Item, Layer);
+}
+
+void
+QueueModel(render_queue *Queue, model *Model, u32 Shader, glm::mat4 Transform, render_layer Layer)
+{
+    if (!Model->IsReady)
+    {
+        QueueMesh(Queue, GetPlaceholderMesh(false), Shader, Transform, Layer);
+        return;
+    }
+
+    for (i32 MeshIndex = 0; MeshIndex < Model->MeshCount; ++MeshIndex)
+    {
+        QueueMesh(Queue, &Model->Meshes[MeshIndex], Shader, Transform, Layer);
+    }
+}
+
+void
+QueueSkinnedModel(render_queue *Queue, skinned_model *Model, u32 Shader, glm::mat4 Transform, render_layer Layer)
+{
+    if (!Model->IsReady)
+    {
+        static glm::mat4 PlaceholderPalette[2] = { glm::mat4(1.0f), glm::mat4(1.0f) };
+        QueueMesh(Queue, GetPlaceholderMesh(true), Shader, Transform, Layer, PlaceholderPalette, 2);
+        return;
+    }
+
+    for (i32 MeshIndex = 0; MeshIndex < Model->MeshCount; ++MeshIndex)
+    {
+        QueueMesh(Queue, &Model->Meshes[MeshIndex], Shader, Transform, Layer,
+                  Model->AnimationState.BonePalette, Model->BoneCount);
+    }
+}
+
+void
+FlushRenderQueue(render_queue *Queue)
+{
+    i32 ItemCount = Queue->ItemCount;
+    if (ItemCount == 0)
+    {
+        return;
+    }
+
+    memory_arena *Arena = GetFrameArena();
+    temporary_memory SortMemory = BeginTemporaryMemory(Arena);
+
+    u32 *Order = PushArray(Arena, ItemCount, u32);
+    u32 *TempOrder = PushArray(Arena, ItemCount, u32);
+    u64 *TempKeys = PushArray(Arena, ItemCount, u64);
+    for (i32 ItemIndex = 0; ItemIndex < ItemCount; ++ItemIndex)
+    {
+        Order[ItemIndex] = (u32) ItemIndex;
+    }
+    RENDER_RadixSort(Queue->SortKeys, Order, ItemCount, TempKeys, TempOrder);
+
+    // NOTE: Static items' transforms go up in one upload, in draw order, so each run of items
+    //       sharing a mesh is a contiguous range of instances
+    mesh_instance *Instances = PushArray(Arena, ItemCount, mesh_instance);
+    i32 InstanceCount = 0;
+    for (i32 SortedIndex = 0; SortedIndex < ItemCount; ++SortedIndex)
+    {
+        render_item *Item = &Queue->Items[Order[SortedIndex]];
+        if (!Item->BonePalette)
+        {
+            Instances[InstanceCount++] = MakeMeshInstance(Item->Transform);
+        }
+    }
+    // NOTE: Static items are skipped for the frame if the stream buffer is full
+    bool AreInstancesUploaded = (InstanceCount > 0 && UploadMeshInstances(Instances, InstanceCount));
+
+    // NOTE: Handles are looked up again only when the program changes, and the palette is only
+    //       uploaded again for a different model (a skinned model's meshes all share one)
+    u32 CurrentShader = 0;
+    bool HasShader = false;
+    uniform_handle ModelUniform = { };
+    uniform_handle BoneTransformsUniform = { };
+    glm::mat4 *CurrentBonePalette = 0;
+    i32 FirstInstance = 0;
+
+    for (i32 SortedIndex = 0; SortedIndex < ItemCount; )
+    {
+        render_item *Item = &Queue->Items[Order[SortedIndex]];
+
+        if (!HasShader || Item->Shader != CurrentShader)
+        {
+            UseShader(Item->Shader);
+            ModelUniform = GetUniformHandle(Item->Shader, "Model");
+            BoneTransformsUniform = GetUniformHandle(Item->Shader, "BoneTransforms");
+            CurrentShader = Item->Shader;
+            HasShader = true;
+            CurrentBonePalette = 0;
+        }
+
+        if (Item->BonePalette)
+        {
+            SetUniformMat4F(ModelUniform, glm::value_ptr(Item->Transform));
+            if (Item->BonePalette != CurrentBonePalette)
+            {
+                SetUniformMat4F(BoneTransformsUniform, glm::value_ptr(Item->BonePalette[0]), Item->BoneCount);
+                CurrentBonePalette = Item->BonePalette;
+            }
+
+            RenderMesh(Item->Mesh);
+            ++SortedIndex;
+            continue;
+        }
+
+        i32 RunLength = 1;
+        while (SortedIndex + RunLength < ItemCount)
+        {
+            render_item *NextItem = &Queue->Items[Order[SortedIndex + RunLength]];
+            if (NextItem->BonePalette || NextItem->Shader != Item->Shader ||
+                !RENDER_CanInstanceTogether(Item->Mesh, NextItem->Mesh))
+            {
+                break;
+            }
+            ++RunLength;
+        }
+
+        if (AreInstancesUploaded)
+        {
+            RenderMeshInstanced(Item->Mesh, FirstInstance, RunLength);
+        }
+        FirstInstance += RunLength;
+        SortedIndex += RunLength;
+    }
+
+    EndTemporaryMemory(SortMemory);
+    Queue->ItemCount = 0;
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+static u64
+RENDER_PackSortKey(render_queue *Queue, render_item *Item, render_layer Layer)
+{
+    mesh *Mesh = Item->Mesh;
+
+    glm::vec3 Center = glm::vec3(Item->Transform * glm::vec4(Mesh->BoundsCenter, 1.0f));
+    f32 Depth = glm::dot(Center - Queue->CameraPosition, Queue->CameraForward) / Queue->MaxDepth;
+    Depth = glm::clamp(Depth, 0.0f, 1.0f);
+    u64 DepthBits = (u64) (Depth * (f32) RENDER_KEY_DEPTH_MAX);
+
+    u64 LayerBits = (u64) Layer;
+    u64 ShaderBits = Item->Shader & RENDER_KEY_SHADER_MASK;
+    u64 MaterialBits = HashBytes64(Mesh->TextureIDs, sizeof(Mesh->TextureIDs), 0) & RENDER_KEY_MATERIAL_MASK;
+    u64 VAOBits = Mesh->VAO & RENDER_KEY_VAO_MASK;
+
+    u64 Result;
+    if (Layer == RENDER_LAYER_TRANSPARENT)
+    {
+        Result = ((LayerBits << RENDER_KEY_LAYER_SHIFT) |
+                  ((RENDER_KEY_DEPTH_MAX - DepthBits) << 38) |
+                  (ShaderBits << 32) |
+                  (MaterialBits << 16) |
+                  VAOBits);
+    }
+    else
+    {
+        Result = ((LayerBits << RENDER_KEY_LAYER_SHIFT) |
+                  (ShaderBits << 56) |
+                  (MaterialBits << 40) |
+                  (VAOBits << 24) |
+                  DepthBits);
+    }
+
+    return Result;
+}
+
+// NOTE: LSD radix sort on 8 bit digits, moving Indices along with Keys. Stable, so items with
+//       equal keys stay in the order they were queued. Passes where every key has the same digit
+//       are skipped, which with few distinct states is most of them.
+static void
+RENDER_RadixSort(u64 *Keys, u32 *Indices, i32 Count, u64 *TempKeys, u32 *TempIndices)
+{
+    u64 *SourceKeys = Keys;
+    u32 *SourceIndices = Indices;
+    u64 *DestKeys = TempKeys;
+    u32 *DestIndices = TempIndices;
+
+    for (i32 Shift = 0; Shift < 64; Shift += 8)
+    {
+        u32 Offsets[256] = { };
+        for (i32 Index = 0; Index < Count; ++Index)
+        {
+            ++Offsets[(SourceKeys[Index] >> Shift) & 0xFF];
+        }
+        if (Offsets[(SourceKeys[0] >> Shift) & 0xFF] == (u32) Count)
+        {
+            continue;
+        }
+
+        u32 Total = 0;
+        for (i32 Digit = 0; Digit < 256; ++Digit)
+        {
+            u32 DigitCount = Offsets[Digit];
+            Offsets[Digit] = Total;
+            Total += DigitCount;
+        }
+
+        for (i32 Index = 0; Index < Count; ++Index)
+        {
+            u32 Destination = Offsets[(SourceKeys[Index] >> Shift) & 0xFF]++;
+            DestKeys[Destination] = SourceKeys[Index];
+            DestIndices[Destination] = SourceIndices[Index];
+        }
+
+        u64 *SwapKeys = SourceKeys;
+        SourceKeys = DestKeys;
+        DestKeys = SwapKeys;
+        u32 *SwapIndices = SourceIndices;
+        SourceIndices = DestIndices;
+        DestIndices = SwapIndices;
+    }
+
+    if (SourceKeys != Keys)
+    {
+        memcpy(Keys, SourceKeys, Count * sizeof(u64));
+        memcpy(Indices, SourceIndices, Count * sizeof(u32));
+    }
+}
+
+// NOTE: Different mesh structs can share GL buffers (shared meshes), so it's what's drawn that's
+//       compared, not the pointers
+static inline bool
+RENDER_CanInstanceTogether(mesh *A, mesh *B)
+{
+    bool Result = (A == B ||
+                   (A->VAO == B->VAO &&
+                    A->IndexCount == B->IndexCount &&
+                    A->IndexType == B->IndexType &&
+                    memcmp(A->TextureIDs, B->TextureIDs, sizeof(A->TextureIDs)) == 0));
+    return Result;
+}
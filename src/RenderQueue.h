@@ -0,0 +1,77 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glm/glm.hpp>
+
+#include "Common.h"
+#include "Model.h"
+
+// NOTE: Draws are queued during the frame and submitted all at once by FlushRenderQueue, sorted
+//       by a 64 bit key so that items sharing a program, textures and VAO end up next to each other
+//       (and GLState drops the binds between them). Opaque items are sorted by state first and
+//       then front to back; transparent ones back to front first, so they blend correctly. The
+//       queue's arrays come from the frame arena, so a queue lives for one frame at most.
+//       Consecutive static items with the same mesh and program are drawn as one instanced draw.
+#define DEFAULT_RENDER_QUEUE_CAPACITY 4096
+
+enum render_layer
+{
+    RENDER_LAYER_OPAQUE,
+    RENDER_LAYER_TRANSPARENT,
+
+    RENDER_LAYER_COUNT
+};
+
+struct render_item
+{
+    mesh *Mesh;
+    u32 Shader;
+    glm::mat4 Transform;
+
+    // NOTE: Skinned meshes only: uploaded to the program's BoneTransforms
+    glm::mat4 *BonePalette;
+    i32 BoneCount;
+};
+
+struct render_queue
+{
+    i32 Capacity;
+    i32 ItemCount;
+    render_item *Items;
+    u64 *SortKeys;
+
+    glm::vec3 CameraPosition;
+    glm::vec3 CameraForward;
+    // NOTE: Depth range the sort keys resolve; anything further sorts as if it were this far
+    f32 MaxDepth;
+
+    // NOTE: Items dropped because the queue was full, since the last BeginRenderQueue
+    i32 OverflowCount;
+};
+
+// ---------------------
+// FUNCTION DECLARATIONS
+// ---------------------
+
+void
+BeginRenderQueue(render_queue *Queue, i32 Capacity, glm::vec3 CameraPosition, glm::vec3 CameraForward,
+                 f32 MaxDepth);
+
+// NOTE: Static meshes (no bone palette) are drawn instanced, so their program has to read the
+//       transform from the instance attributes (StaticMesh.vs). Skinned ones set the program's
+//       mat4 Model and BoneTransforms uniforms.
+void
+QueueMesh(render_queue *Queue, mesh *Mesh, u32 Shader, glm::mat4 Transform, render_layer Layer,
+          glm::mat4 *BonePalette = 0, i32 BoneCount = 0);
+// NOTE: Queues the placeholder for models that are still loading
+void
+QueueModel(render_queue *Queue, model *Model, u32 Shader, glm::mat4 Transform, render_layer Layer);
+// NOTE: Uses the bone palette as it is; UpdateSkinnedModelAnimation first
+void
+QueueSkinnedModel(render_queue *Queue, skinned_model *Model, u32 Shader, glm::mat4 Transform, render_layer Layer);
+
+// NOTE: Sorts and draws everything queued, then empties the queue
+void
+FlushRenderQueue(render_queue *Queue);
+
+#endif
@@ -0,0 +1,607 @@
+#include "Resource.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "AssetLoader.h"
+#include "Texture.h"
+
+enum resource_type
+{
+    RESOURCE_TYPE_MODEL,
+    RESOURCE_TYPE_SKINNED_MODEL,
+    RESOURCE_TYPE_TEXTURE,
+    RESOURCE_TYPE_FONT,
+    RESOURCE_TYPE_COUNT,
+};
+
+struct resource_slot
+{
+    char Path[MAX_PATH_LENGTH];
+    u32 Flags;
+    // NOTE: Fonts only; part of what identifies a font next to its path
+    i32 Points;
+
+    u16 Generation;
+    bool IsLive;
+    bool IsQueuedForDestruction;
+    i32 RefCount;
+
+    // NOTE: Free list through dead slots, -1 at the end
+    i32 NextFreeSlot;
+};
+
+struct resource_pool
+{
+    i32 Capacity;
+    resource_slot *Slots;
+    i32 FirstFreeSlot;
+    // NOTE: Slots at and above this one have never been used
+    i32 UsedSlotCount;
+};
+
+#define RESOURCE_HANDLE_INDEX_BITS 16
+#define RESOURCE_HANDLE_INDEX_MASK ((1u << RESOURCE_HANDLE_INDEX_BITS) - 1)
+#define MAX_QUEUED_RESOURCE_DESTRUCTIONS (MAX_MODEL_RESOURCES + MAX_SKINNED_MODEL_RESOURCES + \
+                                          MAX_TEXTURE_RESOURCES + MAX_FONT_RESOURCES)
+
+struct resource_destruction
+{
+    resource_type Type;
+    i32 SlotIndex;
+};
+
+struct resource_manager
+{
+    bool IsInitialized;
+    resource_pool Pools[RESOURCE_TYPE_COUNT];
+
+    resource_slot ModelSlots[MAX_MODEL_RESOURCES];
+    resource_slot SkinnedModelSlots[MAX_SKINNED_MODEL_RESOURCES];
+    resource_slot TextureSlots[MAX_TEXTURE_RESOURCES];
+    resource_slot FontSlots[MAX_FONT_RESOURCES];
+
+    // NOTE: The resources themselves, by slot index
+    model Models[MAX_MODEL_RESOURCES];
+    skinned_model SkinnedModels[MAX_SKINNED_MODEL_RESOURCES];
+    u32 TextureIDs[MAX_TEXTURE_RESOURCES];
+    // NOTE: Allocated by RasterizeAndProcessFont
+    font_info *Fonts[MAX_FONT_RESOURCES];
+
+    // NOTE: A slot is in here at most once (IsQueuedForDestruction)
+    i32 QueuedDestructionCount;
+    resource_destruction QueuedDestructions[MAX_QUEUED_RESOURCE_DESTRUCTIONS];
+    i32 DestroyedCount;
+};
+
+static resource_manager ResourceManager;
+
+static resource_pool *
+RESOURCE_GetPool(resource_type Type);
+static i32
+RESOURCE_AcquireSlot(resource_type Type, const char *Path, u32 Flags, i32 Points, bool *Out_IsNew);
+static u32
+RESOURCE_MakeHandle(resource_type Type, i32 SlotIndex);
+static resource_slot *
+RESOURCE_ResolveHandle(resource_type Type, u32 HandleValue, i32 *Out_SlotIndex);
+static void
+RESOURCE_Retain(resource_type Type, u32 HandleValue);
+static void
+RESOURCE_Release(resource_type Type, u32 HandleValue);
+static void
+RESOURCE_QueueDestruction(resource_type Type, i32 SlotIndex);
+static bool
+RESOURCE_Destroy(resource_type Type, i32 SlotIndex);
+static void
+RESOURCE_LoadModelNow(const char *Path, bool IsSkinned, u32 Flags, model *Out_Model, skinned_model *Out_SkinnedModel);
+
+// -----------------------------
+// EXTERNAL FUNCTION DEFINITIONS
+// -----------------------------
+
+// Loading
+// -------
+
+model_handle
+LoadModelResource(const char *Path, u32 Flags)
+{
+    bool IsNew;
+    i32 SlotIndex = RESOURCE_AcquireSlot(RESOURCE_TYPE_MODEL, Path, Flags, 0, &IsNew);
+    if (IsNew)
+    {
+        model *Model = &ResourceManager.Models[SlotIndex];
+        if (Flags & RESOURCE_LOAD_NOW)
+        {
+            RESOURCE_LoadModelNow(Path, false, Flags, Model, 0);
+        }
+        else
+        {
+            LoadModelAsync(Path, (Flags & RESOURCE_GENERATE_MIPMAP) != 0, (Flags & RESOURCE_KEEP_CPU_DATA) != 0,
+                           Model);
+        }
+    }
+
+    model_handle Result = { RESOURCE_MakeHandle(RESOURCE_TYPE_MODEL, SlotIndex) };
+    return Result;
+}
+
+skinned_model_handle
+LoadSkinnedModelResource(const char *Path, u32 Flags)
+{
+    bool IsNew;
+    i32 SlotIndex = RESOURCE_AcquireSlot(RESOURCE_TYPE_SKINNED_MODEL, Path, Flags, 0, &IsNew);
+    Assert(IsNew);
+
+    skinned_model *Model = &ResourceManager.SkinnedModels[SlotIndex];
+    if (Flags & RESOURCE_LOAD_NOW)
+    {
+        RESOURCE_LoadModelNow(Path, true, Flags, 0, Model);
+    }
+    else
+    {
+        LoadSkinnedModelAsync(Path, (Flags & RESOURCE_GENERATE_MIPMAP) != 0, (Flags & RESOURCE_KEEP_CPU_DATA) != 0,
+                              Model);
+    }
+
+    skinned_model_handle Result = { RESOURCE_MakeHandle(RESOURCE_TYPE_SKINNED_MODEL, SlotIndex) };
+    return Result;
+}
+
+texture_handle
+LoadTextureResource(const char *Path, u32 Flags)
+{
+    bool IsNew;
+    i32 SlotIndex = RESOURCE_AcquireSlot(RESOURCE_TYPE_TEXTURE, Path, Flags, 0, &IsNew);
+    if (IsNew)
+    {
+        bool GenerateMipmap = (Flags & RESOURCE_GENERATE_MIPMAP) != 0;
+        bool IsAsync = IsTextureStreamingActive() && !(Flags & RESOURCE_LOAD_NOW);
+        ResourceManager.TextureIDs[SlotIndex] = IsAsync ? LoadTextureAsync(Path, GenerateMipmap)
+                                                        : LoadTexture(Path, GenerateMipmap);
+    }
+
+    texture_handle Result = { RESOURCE_MakeHandle(RESOURCE_TYPE_TEXTURE, SlotIndex) };
+    return Result;
+}
+
+font_handle
+LoadFontResource(const char *Path, i32 Points, u32 Flags)
+{
+    bool IsNew;
+    i32 SlotIndex = RESOURCE_AcquireSlot(RESOURCE_TYPE_FONT, Path, Flags, Points, &IsNew);
+    if (IsNew)
+    {
+        ResourceManager.Fonts[SlotIndex] = RasterizeAndProcessFont(Path, Points);
+    }
+
+    font_handle Result = { RESOURCE_MakeHandle(RESOURCE_TYPE_FONT, SlotIndex) };
+    return Result;
+}
+
+// Access
+// ------
+
+model *
+GetModel(model_handle Handle)
+{
+    i32 SlotIndex;
+    if (!RESOURCE_ResolveHandle(RESOURCE_TYPE_MODEL, Handle.Value, &SlotIndex))
+    {
+        return 0;
+    }
+    return &ResourceManager.Models[SlotIndex];
+}
+
+skinned_model *
+GetSkinnedModel(skinned_model_handle Handle)
+{
+    i32 SlotIndex;
+    if (!RESOURCE_ResolveHandle(RESOURCE_TYPE_SKINNED_MODEL, Handle.Value, &SlotIndex))
+    {
+        return 0;
+    }
+    return &ResourceManager.SkinnedModels[SlotIndex];
+}
+
+u32
+GetTextureID(texture_handle Handle)
+{
+    i32 SlotIndex;
+    if (!RESOURCE_ResolveHandle(RESOURCE_TYPE_TEXTURE, Handle.Value, &SlotIndex))
+    {
+        return 0;
+    }
+    return ResourceManager.TextureIDs[SlotIndex];
+}
+
+font_info *
+GetFont(font_handle Handle)
+{
+    i32 SlotIndex;
+    if (!RESOURCE_ResolveHandle(RESOURCE_TYPE_FONT, Handle.Value, &SlotIndex))
+    {
+        return 0;
+    }
+    return ResourceManager.Fonts[SlotIndex];
+}
+
+// Reference counting
+// ------------------
+
+void
+RetainModel(model_handle Handle)
+{
+    RESOURCE_Retain(RESOURCE_TYPE_MODEL, Handle.Value);
+}
+
+void
+ReleaseModel(model_handle Handle)
+{
+    RESOURCE_Release(RESOURCE_TYPE_MODEL, Handle.Value);
+}
+
+void
+RetainSkinnedModel(skinned_model_handle Handle)
+{
+    RESOURCE_Retain(RESOURCE_TYPE_SKINNED_MODEL, Handle.Value);
+}
+
+void
+ReleaseSkinnedModel(skinned_model_handle Handle)
+{
+    RESOURCE_Release(RESOURCE_TYPE_SKINNED_MODEL, Handle.Value);
+}
+
+void
+RetainTextureResource(texture_handle Handle)
+{
+    RESOURCE_Retain(RESOURCE_TYPE_TEXTURE, Handle.Value);
+}
+
+void
+ReleaseTextureResource(texture_handle Handle)
+{
+    RESOURCE_Release(RESOURCE_TYPE_TEXTURE, Handle.Value);
+}
+
+void
+RetainFont(font_handle Handle)
+{
+    RESOURCE_Retain(RESOURCE_TYPE_FONT, Handle.Value);
+}
+
+void
+ReleaseFont(font_handle Handle)
+{
+    RESOURCE_Release(RESOURCE_TYPE_FONT, Handle.Value);
+}
+
+// Destruction
+// -----------
+
+void
+ProcessResourceDestruction()
+{
+    i32 RemainingCount = 0;
+    for (i32 QueueIndex = 0; QueueIndex < ResourceManager.QueuedDestructionCount; ++QueueIndex)
+    {
+        resource_destruction Destruction = ResourceManager.QueuedDestructions[QueueIndex];
+        resource_slot *Slot = &RESOURCE_GetPool(Destruction.Type)->Slots[Destruction.SlotIndex];
+
+        bool IsDone = true;
+        if (Slot->RefCount > 0)
+        {
+            // NOTE: Loaded again before it was destroyed
+            Slot->IsQueuedForDestruction = false;
+        }
+        else
+        {
+            IsDone = RESOURCE_Destroy(Destruction.Type, Destruction.SlotIndex);
+        }
+
+        if (!IsDone)
+        {
+            ResourceManager.QueuedDestructions[RemainingCount++] = Destruction;
+        }
+    }
+    ResourceManager.QueuedDestructionCount = RemainingCount;
+}
+
+void
+UnloadUnusedResources()
+{
+    for (i32 Type = 0; Type < RESOURCE_TYPE_COUNT; ++Type)
+    {
+        resource_pool *Pool = RESOURCE_GetPool((resource_type) Type);
+        for (i32 SlotIndex = 0; SlotIndex < Pool->UsedSlotCount; ++SlotIndex)
+        {
+            resource_slot *Slot = &Pool->Slots[SlotIndex];
+            if (Slot->IsLive && Slot->RefCount == 0)
+            {
+                RESOURCE_QueueDestruction((resource_type) Type, SlotIndex);
+            }
+        }
+    }
+}
+
+void
+ShutdownResources()
+{
+    for (i32 Type = 0; Type < RESOURCE_TYPE_COUNT; ++Type)
+    {
+        resource_pool *Pool = RESOURCE_GetPool((resource_type) Type);
+        for (i32 SlotIndex = 0; SlotIndex < Pool->UsedSlotCount; ++SlotIndex)
+        {
+            if (Pool->Slots[SlotIndex].IsLive)
+            {
+                bool IsDestroyed = RESOURCE_Destroy((resource_type) Type, SlotIndex);
+                Assert(IsDestroyed);
+            }
+        }
+    }
+    ResourceManager.QueuedDestructionCount = 0;
+}
+
+resource_stats
+GetResourceStats()
+{
+    resource_stats Result = { };
+    i32 *LiveCounts[RESOURCE_TYPE_COUNT] = {
+        &Result.LiveModelCount, &Result.LiveSkinnedModelCount, &Result.LiveTextureCount, &Result.LiveFontCount
+    };
+
+    for (i32 Type = 0; Type < RESOURCE_TYPE_COUNT; ++Type)
+    {
+        resource_pool *Pool = RESOURCE_GetPool((resource_type) Type);
+        for (i32 SlotIndex = 0; SlotIndex < Pool->UsedSlotCount; ++SlotIndex)
+        {
+            if (Pool->Slots[SlotIndex].IsLive)
+            {
+                ++*LiveCounts[Type];
+            }
+        }
+    }
+    Result.QueuedForDestructionCount = ResourceManager.QueuedDestructionCount;
+    Result.DestroyedCount = ResourceManager.DestroyedCount;
+
+    return Result;
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+static resource_pool *
+RESOURCE_GetPool(resource_type Type)
+{
+    if (!ResourceManager.IsInitialized)
+    {
+        resource_slot *Slots[RESOURCE_TYPE_COUNT] = {
+            ResourceManager.ModelSlots, ResourceManager.SkinnedModelSlots,
+            ResourceManager.TextureSlots, ResourceManager.FontSlots
+        };
+        i32 Capacities[RESOURCE_TYPE_COUNT] = {
+            MAX_MODEL_RESOURCES, MAX_SKINNED_MODEL_RESOURCES, MAX_TEXTURE_RESOURCES, MAX_FONT_RESOURCES
+        };
+        for (i32 PoolType = 0; PoolType < RESOURCE_TYPE_COUNT; ++PoolType)
+        {
+            Assert(Capacities[PoolType] <= (i32) RESOURCE_HANDLE_INDEX_MASK);
+            ResourceManager.Pools[PoolType].Capacity = Capacities[PoolType];
+            ResourceManager.Pools[PoolType].Slots = Slots[PoolType];
+            ResourceManager.Pools[PoolType].FirstFreeSlot = -1;
+        }
+        ResourceManager.IsInitialized = true;
+    }
+
+    return &ResourceManager.Pools[Type];
+}
+
+static i32
+RESOURCE_AcquireSlot(resource_type Type, const char *Path, u32 Flags, i32 Points, bool *Out_IsNew)
+{
+    resource_pool *Pool = RESOURCE_GetPool(Type);
+
+    // NOTE: Only the flags that change what gets loaded tell two loads apart
+    u32 IdentityFlags = Flags & ~RESOURCE_KEEP_LOADED;
+
+    if (Type != RESOURCE_TYPE_SKINNED_MODEL)
+    {
+        for (i32 SlotIndex = 0; SlotIndex < Pool->UsedSlotCount; ++SlotIndex)
+        {
+            resource_slot *Slot = &Pool->Slots[SlotIndex];
+            if (Slot->IsLive &&
+                (Slot->Flags & ~RESOURCE_KEEP_LOADED) == IdentityFlags &&
+                Slot->Points == Points &&
+                strcmp(Slot->Path, Path) == 0)
+            {
+                ++Slot->RefCount;
+                Slot->Flags |= (Flags & RESOURCE_KEEP_LOADED);
+                *Out_IsNew = false;
+                return SlotIndex;
+            }
+        }
+    }
+
+    i32 SlotIndex;
+    if (Pool->FirstFreeSlot >= 0)
+    {
+        SlotIndex = Pool->FirstFreeSlot;
+        Pool->FirstFreeSlot = Pool->Slots[SlotIndex].NextFreeSlot;
+    }
+    else
+    {
+        Assert(Pool->UsedSlotCount < Pool->Capacity);
+        SlotIndex = Pool->UsedSlotCount++;
+    }
+
+    resource_slot *Slot = &Pool->Slots[SlotIndex];
+    strncpy_s(Slot->Path, Path, MAX_PATH_LENGTH - 1);
+    Slot->Flags = Flags;
+    Slot->Points = Points;
+    Slot->IsLive = true;
+    Slot->IsQueuedForDestruction = false;
+    Slot->RefCount = 1;
+    Slot->NextFreeSlot = -1;
+
+    *Out_IsNew = true;
+    return SlotIndex;
+}
+
+static u32
+RESOURCE_MakeHandle(resource_type Type, i32 SlotIndex)
+{
+    // NOTE: Index + 1, so no live handle is ever 0
+    resource_slot *Slot = &RESOURCE_GetPool(Type)->Slots[SlotIndex];
+    return ((u32) Slot->Generation << RESOURCE_HANDLE_INDEX_BITS) | (u32) (SlotIndex + 1);
+}
+
+static resource_slot *
+RESOURCE_ResolveHandle(resource_type Type, u32 HandleValue, i32 *Out_SlotIndex)
+{
+    resource_pool *Pool = RESOURCE_GetPool(Type);
+
+    i32 SlotIndex = (i32) (HandleValue & RESOURCE_HANDLE_INDEX_MASK) - 1;
+    u16 Generation = (u16) (HandleValue >> RESOURCE_HANDLE_INDEX_BITS);
+    if (SlotIndex < 0 || SlotIndex >= Pool->UsedSlotCount)
+    {
+        return 0;
+    }
+
+    resource_slot *Slot = &Pool->Slots[SlotIndex];
+    if (!Slot->IsLive || Slot->Generation != Generation)
+    {
+        return 0;
+    }
+
+    *Out_SlotIndex = SlotIndex;
+    return Slot;
+}
+
+static void
+RESOURCE_Retain(resource_type Type, u32 HandleValue)
+{
+    i32 SlotIndex;
+    resource_slot *Slot = RESOURCE_ResolveHandle(Type, HandleValue, &SlotIndex);
+    if (Slot)
+    {
+        ++Slot->RefCount;
+    }
+}
+
+static void
+RESOURCE_Release(resource_type Type, u32 HandleValue)
+{
+    i32 SlotIndex;
+    resource_slot *Slot = RESOURCE_ResolveHandle(Type, HandleValue, &SlotIndex);
+    if (!Slot)
+    {
+        return;
+    }
+
+    Assert(Slot->RefCount > 0);
+    --Slot->RefCount;
+    if (Slot->RefCount == 0 && !(Slot->Flags & RESOURCE_KEEP_LOADED))
+    {
+        RESOURCE_QueueDestruction(Type, SlotIndex);
+    }
+}
+
+static void
+RESOURCE_QueueDestruction(resource_type Type, i32 SlotIndex)
+{
+    resource_slot *Slot = &RESOURCE_GetPool(Type)->Slots[SlotIndex];
+    if (!Slot->IsQueuedForDestruction)
+    {
+        Assert(ResourceManager.QueuedDestructionCount < MAX_QUEUED_RESOURCE_DESTRUCTIONS);
+        Slot->IsQueuedForDestruction = true;
+        resource_destruction *Destruction = &ResourceManager.QueuedDestructions[ResourceManager.QueuedDestructionCount++];
+        Destruction->Type = Type;
+        Destruction->SlotIndex = SlotIndex;
+    }
+}
+
+static bool
+RESOURCE_Destroy(resource_type Type, i32 SlotIndex)
+{
+    switch (Type)
+    {
+        case RESOURCE_TYPE_MODEL:
+        {
+            model *Model = &ResourceManager.Models[SlotIndex];
+            // NOTE: The loader still writes into the model until the load is done
+            if (IsModelLoadPending(Model))
+            {
+                return false;
+            }
+            FreeModel(Model);
+        } break;
+
+        case RESOURCE_TYPE_SKINNED_MODEL:
+        {
+            skinned_model *Model = &ResourceManager.SkinnedModels[SlotIndex];
+            if (IsSkinnedModelLoadPending(Model))
+            {
+                return false;
+            }
+            FreeSkinnedModel(Model);
+        } break;
+
+        case RESOURCE_TYPE_TEXTURE:
+        {
+            ReleaseTexture(ResourceManager.TextureIDs[SlotIndex]);
+            ResourceManager.TextureIDs[SlotIndex] = 0;
+        } break;
+
+        case RESOURCE_TYPE_FONT:
+        {
+            FreeFontInfoAndUnloadFromGPU(ResourceManager.Fonts[SlotIndex]);
+            ResourceManager.Fonts[SlotIndex] = 0;
+        } break;
+
+        default:
+        {
+            Assert(0);
+        } break;
+    }
+
+    // NOTE: Handles to the old occupant stop resolving from here on
+    resource_pool *Pool = RESOURCE_GetPool(Type);
+    resource_slot *Slot = &Pool->Slots[SlotIndex];
+    Slot->IsLive = false;
+    Slot->IsQueuedForDestruction = false;
+    Slot->RefCount = 0;
+    Slot->Path[0] = 0;
+    ++Slot->Generation;
+    Slot->NextFreeSlot = Pool->FirstFreeSlot;
+    Pool->FirstFreeSlot = SlotIndex;
+
+    ++ResourceManager.DestroyedCount;
+    return true;
+}
+
+static void
+RESOURCE_LoadModelNow(const char *Path, bool IsSkinned, u32 Flags, model *Out_Model, skinned_model *Out_SkinnedModel)
+{
+    printf("Loading %smodel at: %s\n", IsSkinned ? "skinned " : "", Path);
+
+    model_load_data *LoadData = PrepareModelLoadData(Path, IsSkinned, (Flags & RESOURCE_GENERATE_MIPMAP) != 0,
+                                                     (Flags & RESOURCE_KEEP_CPU_DATA) != 0);
+    if (!LoadData)
+    {
+        fprintf(stderr, "Couldn't load %s, keeping the placeholder\n", Path);
+        return;
+    }
+
+    while (!UploadModelLoadDataStep(LoadData))
+    {
+    }
+
+    if (IsSkinned)
+    {
+        FinishSkinnedModelLoad(LoadData, Out_SkinnedModel);
+    }
+    else
+    {
+        FinishModelLoad(LoadData, Out_Model);
+    }
+}
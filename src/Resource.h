@@ -0,0 +1,133 @@
+#ifndef RESOURCE_H
+#define RESOURCE_H
+
+#include "Common.h"
+#include "Model.h"
+#include "Text.h"
+
+// NOTE: Owner of everything loaded from disk. Each type lives in its own fixed pool, so a Get*
+//       pointer stays valid for as long as its resource does. Handles are a slot index plus the
+//       slot's generation: once a resource is destroyed and its slot reused, old handles resolve to
+//       0 instead of the new occupant. The null handle (Value 0) never resolves.
+//
+//       Every Load* and Retain* holds a reference that has to be given back with Release*. Loading a
+//       path that's already loaded (with the same flags) returns the same handle. Releasing the last
+//       reference only queues the resource; ProcessResourceDestruction deletes the queued ones at the
+//       end of the frame, after everything that could still draw them has been submitted, and a load
+//       of the same path before then revives it. Everything here has to run on the GL thread.
+
+struct model_handle
+{
+    u32 Value;
+};
+
+// NOTE: Skinned models carry their own animation state, so every load is a separate instance (the
+//       mesh buffers and clips underneath are still shared, see Model.cpp)
+struct skinned_model_handle
+{
+    u32 Value;
+};
+
+struct texture_handle
+{
+    u32 Value;
+};
+
+struct font_handle
+{
+    u32 Value;
+};
+
+// NOTE: Load flags
+#define RESOURCE_GENERATE_MIPMAP 0x1
+// NOTE: Models only: keep every mesh's positions and indices in CPUMeshes after the upload
+#define RESOURCE_KEEP_CPU_DATA 0x2
+// NOTE: Load before returning instead of streaming in; for models that are edited right away
+#define RESOURCE_LOAD_NOW 0x4
+// NOTE: Stays loaded with no references left, until UnloadUnusedResources
+#define RESOURCE_KEEP_LOADED 0x8
+
+#define MAX_MODEL_RESOURCES 256
+#define MAX_SKINNED_MODEL_RESOURCES 64
+#define MAX_TEXTURE_RESOURCES 1024
+#define MAX_FONT_RESOURCES 16
+
+struct resource_stats
+{
+    i32 LiveModelCount;
+    i32 LiveSkinnedModelCount;
+    i32 LiveTextureCount;
+    i32 LiveFontCount;
+    // NOTE: Released, waiting for ProcessResourceDestruction
+    i32 QueuedForDestructionCount;
+    i32 DestroyedCount;
+};
+
+// ---------------------
+// FUNCTION DECLARATIONS
+// ---------------------
+
+// Loading
+// -------
+
+// NOTE: Models stream in through AssetLoader.h (draw as placeholders until IsReady) unless
+//       RESOURCE_LOAD_NOW is set. Fonts are rasterized right away.
+model_handle
+LoadModelResource(const char *Path, u32 Flags);
+skinned_model_handle
+LoadSkinnedModelResource(const char *Path, u32 Flags);
+texture_handle
+LoadTextureResource(const char *Path, u32 Flags);
+font_handle
+LoadFontResource(const char *Path, i32 Points, u32 Flags);
+
+// Access
+// ------
+
+// NOTE: 0 for stale and null handles
+model *
+GetModel(model_handle Handle);
+skinned_model *
+GetSkinnedModel(skinned_model_handle Handle);
+u32
+GetTextureID(texture_handle Handle);
+font_info *
+GetFont(font_handle Handle);
+
+// Reference counting
+// ------------------
+
+void
+RetainModel(model_handle Handle);
+void
+ReleaseModel(model_handle Handle);
+void
+RetainSkinnedModel(skinned_model_handle Handle);
+void
+ReleaseSkinnedModel(skinned_model_handle Handle);
+void
+RetainTextureResource(texture_handle Handle);
+void
+ReleaseTextureResource(texture_handle Handle);
+void
+RetainFont(font_handle Handle);
+void
+ReleaseFont(font_handle Handle);
+
+// Destruction
+// -----------
+
+// NOTE: Call once a frame on the GL thread, after the frame's draws. Models whose load is still
+//       in flight stay queued until it's done.
+void
+ProcessResourceDestruction();
+// NOTE: Queues every RESOURCE_KEEP_LOADED resource nobody references anymore (level transitions)
+void
+UnloadUnusedResources();
+// NOTE: Destroys everything, referenced or not. The asset loader has to be shut down first.
+void
+ShutdownResources();
+resource_stats
+GetResourceStats();
+
+#endif
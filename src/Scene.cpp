@@ -0,0 +1,259 @@
+#include "Scene.h"
+
+#include <cstdlib>
+
+static scene_instance *
+SCENE_GetInstance(scene *Scene, i32 InstanceIndex);
+static i32
+SCENE_AddInstance(scene *Scene, model *Model, skinned_model *SkinnedModel, u32 Shader, glm::mat4 Transform,
+                  render_layer Layer);
+static bool
+SCENE_GetWorldBounds(scene_instance *Instance, glm::vec3 *Out_Min, glm::vec3 *Out_Max);
+static bool
+SCENE_RefitInstance(scene *Scene, scene_instance *Instance);
+static void
+SCENE_RemoveIndex(i32 *Indices, i32 *Count, i32 InstanceIndex);
+
+// -----------------------------
+// EXTERNAL FUNCTION DEFINITIONS
+// -----------------------------
+
+void
+InitializeScene(scene *Scene, i32 Capacity)
+{
+    Assert(Capacity > 0);
+
+    *Scene = { };
+    InitializePool(&Scene->InstancePool, sizeof(scene_instance), Capacity);
+    Scene->PendingBoundsInstances = (i32 *) malloc(Capacity * sizeof(i32));
+    Scene->SkinnedInstances = (i32 *) malloc(Capacity * sizeof(i32));
+    Assert(Scene->PendingBoundsInstances && Scene->SkinnedInstances);
+
+    // NOTE: Each instance is a leaf, and there's one internal node per leaf (minus one), so the
+    //       BVH never has to grow
+    InitializeSceneBVH(&Scene->BVH, Capacity * 2);
+}
+
+void
+FreeScene(scene *Scene)
+{
+    FreeSceneBVH(&Scene->BVH);
+    free(Scene->SkinnedInstances);
+    free(Scene->PendingBoundsInstances);
+    FreePool(&Scene->InstancePool);
+    *Scene = { };
+}
+
+i32
+AddSceneModel(scene *Scene, model *Model, u32 Shader, glm::mat4 Transform, render_layer Layer)
+{
+    i32 Result = SCENE_AddInstance(Scene, Model, 0, Shader, Transform, Layer);
+    return Result;
+}
+
+i32
+AddSceneSkinnedModel(scene *Scene, skinned_model *Model, u32 Shader, glm::mat4 Transform, render_layer Layer)
+{
+    i32 Result = SCENE_AddInstance(Scene, 0, Model, Shader, Transform, Layer);
+    return Result;
+}
+
+void
+RemoveSceneInstance(scene *Scene, i32 InstanceIndex)
+{
+    scene_instance *Instance = SCENE_GetInstance(Scene, InstanceIndex);
+
+    RemoveBVHProxy(&Scene->BVH, Instance->Proxy);
+    if (!Instance->HasModelBounds)
+    {
+        SCENE_RemoveIndex(Scene->PendingBoundsInstances, &Scene->PendingBoundsCount, InstanceIndex);
+    }
+    if (Instance->SkinnedModel)
+    {
+        SCENE_RemoveIndex(Scene->SkinnedInstances, &Scene->SkinnedInstanceCount, InstanceIndex);
+    }
+
+    Instance->IsInUse = false;
+    FreeToPool(&Scene->InstancePool, Instance);
+    --Scene->InstanceCount;
+}
+
+void
+SetSceneInstanceTransform(scene *Scene, i32 InstanceIndex, glm::mat4 Transform)
+{
+    scene_instance *Instance = SCENE_GetInstance(Scene, InstanceIndex);
+    Instance->Transform = Transform;
+
+    SCENE_GetWorldBounds(Instance, &Instance->BoundsMin, &Instance->BoundsMax);
+    MoveBVHProxy(&Scene->BVH, Instance->Proxy, Instance->BoundsMin, Instance->BoundsMax);
+}
+
+void
+SetSceneInstanceOccluder(scene *Scene, i32 InstanceIndex, bool IsOccluder)
+{
+    SCENE_GetInstance(Scene, InstanceIndex)->IsOccluder = IsOccluder;
+}
+
+cull_stats
+QueueVisibleScene(scene *Scene, render_queue *Queue, glm::mat4 ViewProjection, glm::vec3 CameraPosition,
+                  f32 PixelsPerUnit, occlusion_buffer *Occlusion)
+{
+    // NOTE: Skinned instances take the bounds of the pose they're about to be drawn in, and models
+    //       that finished loading since last frame swap the placeholder's bounds for theirs
+    for (i32 SkinnedIndex = 0; SkinnedIndex < Scene->SkinnedInstanceCount; ++SkinnedIndex)
+    {
+        SCENE_RefitInstance(Scene, SCENE_GetInstance(Scene, Scene->SkinnedInstances[SkinnedIndex]));
+    }
+    for (i32 PendingIndex = Scene->PendingBoundsCount - 1; PendingIndex >= 0; --PendingIndex)
+    {
+        scene_instance *Instance = SCENE_GetInstance(Scene, Scene->PendingBoundsInstances[PendingIndex]);
+        // NOTE: Skinned ones were just refit
+        if (Instance->HasModelBounds || SCENE_RefitInstance(Scene, Instance))
+        {
+            Scene->PendingBoundsInstances[PendingIndex] = Scene->PendingBoundsInstances[--Scene->PendingBoundsCount];
+        }
+    }
+
+    frustum Frustum = MakeFrustum(ViewProjection);
+    cull_stats Stats;
+    i32 VisibleCount;
+    i32 *Visible = CullSceneBVH(&Scene->BVH, &Frustum, &VisibleCount, &Stats);
+
+    if (Occlusion)
+    {
+        BeginOcclusionFrame(Occlusion, ViewProjection);
+        for (i32 VisibleIndex = 0; VisibleIndex < VisibleCount; ++VisibleIndex)
+        {
+            scene_instance *Instance = SCENE_GetInstance(Scene, Visible[VisibleIndex]);
+            if (Instance->IsOccluder && Instance->Model)
+            {
+                AddOccluderModel(Occlusion, Instance->Model, Instance->Transform);
+            }
+        }
+        RasterizeOccluders(Occlusion);
+    }
+
+    for (i32 VisibleIndex = 0; VisibleIndex < VisibleCount; ++VisibleIndex)
+    {
+        scene_instance *Instance = SCENE_GetInstance(Scene, Visible[VisibleIndex]);
+        if (Occlusion && !Instance->IsOccluder &&
+            !IsBoxUnoccluded(Occlusion, Instance->BoundsMin, Instance->BoundsMax))
+        {
+            ++Stats.Occluded;
+            continue;
+        }
+
+        if (Instance->SkinnedModel)
+        {
+            QueueSkinnedModel(Queue, Instance->SkinnedModel, Instance->Shader, Instance->Transform, Instance->Layer);
+            RequestSkinnedModelTextureMips(Instance->SkinnedModel, Instance->Transform, CameraPosition, PixelsPerUnit);
+        }
+        else
+        {
+            QueueModel(Queue, Instance->Model, Instance->Shader, Instance->Transform, Instance->Layer);
+            RequestModelTextureMips(Instance->Model, Instance->Transform, CameraPosition, PixelsPerUnit);
+        }
+    }
+    Stats.Visible -= Stats.Occluded;
+
+    return Stats;
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+static i32
+SCENE_AddInstance(scene *Scene, model *Model, skinned_model *SkinnedModel, u32 Shader, glm::mat4 Transform,
+                  render_layer Layer)
+{
+    Assert((Model != 0) != (SkinnedModel != 0));
+
+    // NOTE: Zeroed by the pool
+    scene_instance *Instance = (scene_instance *) AllocateFromPool(&Scene->InstancePool);
+    Assert(Instance);
+    i32 Result = (i32) (((u8 *) Instance - Scene->InstancePool.Memory) / Scene->InstancePool.ElementSize);
+    ++Scene->InstanceCount;
+
+    Instance->IsInUse = true;
+    Instance->Model = Model;
+    Instance->SkinnedModel = SkinnedModel;
+    Instance->Shader = Shader;
+    Instance->Layer = Layer;
+    Instance->Transform = Transform;
+
+    Instance->HasModelBounds = SCENE_GetWorldBounds(Instance, &Instance->BoundsMin, &Instance->BoundsMax);
+    if (!Instance->HasModelBounds)
+    {
+        Scene->PendingBoundsInstances[Scene->PendingBoundsCount++] = Result;
+    }
+    if (SkinnedModel)
+    {
+        Scene->SkinnedInstances[Scene->SkinnedInstanceCount++] = Result;
+    }
+    Instance->Proxy = InsertBVHProxy(&Scene->BVH, Instance->BoundsMin, Instance->BoundsMax, Result);
+
+    return Result;
+}
+
+static scene_instance *
+SCENE_GetInstance(scene *Scene, i32 InstanceIndex)
+{
+    Assert(InstanceIndex >= 0 && InstanceIndex < Scene->InstancePool.Capacity);
+
+    scene_instance *Result = (scene_instance *) (Scene->InstancePool.Memory +
+                                                 InstanceIndex * Scene->InstancePool.ElementSize);
+    Assert(Result->IsInUse);
+    return Result;
+}
+
+// NOTE: Moves the proxy to the model's bounds if they're ready; returns whether they were
+static bool
+SCENE_RefitInstance(scene *Scene, scene_instance *Instance)
+{
+    if (!SCENE_GetWorldBounds(Instance, &Instance->BoundsMin, &Instance->BoundsMax))
+    {
+        return false;
+    }
+
+    MoveBVHProxy(&Scene->BVH, Instance->Proxy, Instance->BoundsMin, Instance->BoundsMax);
+    Instance->HasModelBounds = true;
+    return true;
+}
+
+// NOTE: Swaps the last index into its place; the lists aren't ordered
+static void
+SCENE_RemoveIndex(i32 *Indices, i32 *Count, i32 InstanceIndex)
+{
+    for (i32 Index = 0; Index < *Count; ++Index)
+    {
+        if (Indices[Index] == InstanceIndex)
+        {
+            Indices[Index] = Indices[--*Count];
+            return;
+        }
+    }
+
+    Assert(!"Instance isn't in the list");
+}
+
+// NOTE: Returns whether the bounds are the model's own rather than the placeholder's
+static bool
+SCENE_GetWorldBounds(scene_instance *Instance, glm::vec3 *Out_Min, glm::vec3 *Out_Max)
+{
+    glm::vec3 Min, Max;
+    bool IsReady;
+    if (Instance->SkinnedModel)
+    {
+        GetSkinnedModelBounds(Instance->SkinnedModel, &Min, &Max);
+        IsReady = Instance->SkinnedModel->IsReady;
+    }
+    else
+    {
+        GetModelBounds(Instance->Model, &Min, &Max);
+        IsReady = Instance->Model->IsReady;
+    }
+
+    TransformBounds(Min, Max, Instance->Transform, Out_Min, Out_Max);
+    return IsReady;
+}
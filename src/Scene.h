@@ -0,0 +1,93 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <glm/glm.hpp>
+
+#include "Common.h"
+#include "Culling.h"
+#include "Memory.h"
+#include "Model.h"
+#include "Occlusion.h"
+#include "RenderQueue.h"
+
+// NOTE: What's drawn in the world, kept in a BVH by world space bounds so each frame only the
+//       instances the camera can see are queued (and have their texture mips requested). Models
+//       still loading are placed with the placeholder's bounds until they're ready, and skinned
+//       ones are refit to their current pose every frame. Instances marked as occluders can also
+//       hide the rest from an occlusion_buffer. Instances live in a memory_pool, so the capacity
+//       is fixed when the scene is initialized and removed instances' slots are reused.
+#define DEFAULT_SCENE_CAPACITY 64
+
+struct scene_instance
+{
+    // NOTE: One or the other
+    model *Model;
+    skinned_model *SkinnedModel;
+
+    u32 Shader;
+    render_layer Layer;
+    glm::mat4 Transform;
+    // NOTE: World space, as last given to the BVH
+    glm::vec3 BoundsMin;
+    glm::vec3 BoundsMax;
+
+    i32 Proxy;
+    // NOTE: False while the bounds are the placeholder's
+    bool HasModelBounds;
+    bool IsOccluder;
+    // NOTE: Not the first field: a free slot's first bytes are the pool's free list link
+    bool IsInUse;
+};
+
+struct scene
+{
+    // NOTE: Instance indices are slot indices in the pool
+    memory_pool InstancePool;
+    i32 InstanceCount;
+    // NOTE: Indices of the instances whose bounds are looked at every frame, so the rest aren't:
+    //       the ones without their model's bounds yet, and the skinned ones. Both hold up to the
+    //       pool's capacity.
+    i32 PendingBoundsCount;
+    i32 *PendingBoundsInstances;
+    i32 SkinnedInstanceCount;
+    i32 *SkinnedInstances;
+
+    scene_bvh BVH;
+};
+
+// ---------------------
+// FUNCTION DECLARATIONS
+// ---------------------
+
+void
+InitializeScene(scene *Scene, i32 Capacity = DEFAULT_SCENE_CAPACITY);
+void
+FreeScene(scene *Scene);
+
+// NOTE: Return the instance's index, for SetSceneInstanceTransform and RemoveSceneInstance
+i32
+AddSceneModel(scene *Scene, model *Model, u32 Shader, glm::mat4 Transform,
+              render_layer Layer = RENDER_LAYER_OPAQUE);
+// NOTE: Culled by the bounds of its pose as of the last UpdateSkinnedModelAnimation, which has to
+//       run every frame whether the instance is visible or not
+i32
+AddSceneSkinnedModel(scene *Scene, skinned_model *Model, u32 Shader, glm::mat4 Transform,
+                     render_layer Layer = RENDER_LAYER_OPAQUE);
+// NOTE: The index can be handed out again by the next AddSceneModel/AddSceneSkinnedModel
+void
+RemoveSceneInstance(scene *Scene, i32 InstanceIndex);
+void
+SetSceneInstanceTransform(scene *Scene, i32 InstanceIndex, glm::mat4 Transform);
+// NOTE: Occluders are drawn into the occlusion buffer and never tested against it. Only static
+//       models with their CPU data kept (RESOURCE_KEEP_CPU_DATA) contribute anything.
+void
+SetSceneInstanceOccluder(scene *Scene, i32 InstanceIndex, bool IsOccluder);
+
+// NOTE: Queues the instances that touch the view's frustum and requests their texture mips. With an
+//       occlusion buffer, the visible occluders are rasterized first and whatever they hide is
+//       left out too.
+cull_stats
+QueueVisibleScene(scene *Scene, render_queue *Queue, glm::mat4 ViewProjection, glm::vec3 CameraPosition,
+                  f32 PixelsPerUnit, occlusion_buffer *Occlusion = 0);
+
+#endif
@@ -4,13 +4,91 @@
 
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
 
-#include "Util.h"
+#include "FileIO.h"
+#include "GLState.h"
+#include "Hash.h"
+#include "StreamBuffer.h"
+
+struct shader_uniform
+{
+    char Name[MAX_INTERNAL_NAME_LENGTH];
+    u64 NameHash;
+    i32 Location;
+    u32 Type;
+    i32 ArraySize;
+
+    // NOTE: Last value uploaded, ArraySize elements at ValueCache + CacheOffset
+    size_t CacheOffset;
+    // NOTE: How many elements from the start of the cache hold uploaded values; nothing is
+    //       skipped until the first upload
+    i32 CachedCount;
+};
+
+struct shader_uniform_block
+{
+    char Name[MAX_INTERNAL_NAME_LENGTH];
+    u64 NameHash;
+    i32 Index;
+    i32 DataSize;
+};
+
+struct shader_program
+{
+    u32 ID;
+
+    i32 UniformCount;
+    shader_uniform Uniforms[MAX_SHADER_UNIFORMS];
+    i32 UniformBlockCount;
+    shader_uniform_block UniformBlocks[MAX_SHADER_UNIFORM_BLOCKS];
+
+    u8 *ValueCache;
+};
+
+// NOTE: Source handed to GL in pieces: the text between includes, each included file, and a
+//       #line after it so the shader's own lines keep their numbers in compile errors
+#define MAX_SHADER_SOURCE_PIECES (3 * MAX_SHADER_INCLUDES + 1)
+struct shader_source
+{
+    char *Source;
+
+    i32 PieceCount;
+    const char *Pieces[MAX_SHADER_SOURCE_PIECES];
+    i32 PieceLengths[MAX_SHADER_SOURCE_PIECES];
+
+    i32 IncludeCount;
+    char *Includes[MAX_SHADER_INCLUDES];
+    char LineDirectives[MAX_SHADER_INCLUDES][32];
+};
+
+static shader_program ShaderPrograms[MAX_SHADER_PROGRAMS];
+static i32 ShaderProgramCount;
 
 static u32
 CompileShaderAndCheckErrors(const char *Path, GLenum GLShaderType);
+static bool
+SHADER_ReadSource(const char *Path, shader_source *Out_Source);
+static void
+SHADER_FreeSource(shader_source *Source);
 static u32
 LinkShaderProgramAndCleanShaders(u32 *Shaders, i32 ShaderCount);
+static void
+SHADER_ReflectProgram(u32 Shader);
+static shader_program *
+SHADER_FindProgram(u32 Shader);
+static u64
+SHADER_HashName(const char *Name, size_t Length);
+static size_t
+SHADER_GetUniformTypeSize(u32 Type);
+static shader_uniform *
+SHADER_GetUniformForSet(uniform_handle Handle, u32 Type, const void *Value, i32 Count, shader_program **Out_Program);
+static void
+SHADER_CacheUniformValue(shader_program *Program, shader_uniform *Uniform, const void *Value, i32 Count);
+
+// -----------------------------
+// EXTERNAL FUNCTION DEFINITIONS
+// -----------------------------
 
 u32
 BuildShaderProgram(const char *VertexPath, const char *FragmentPath)
@@ -26,74 +104,192 @@ BuildShaderProgram(const char *VertexPath, const char *FragmentPath)
     i32 ShaderCount = 2;
     u32 ShaderProgram = LinkShaderProgramAndCleanShaders(Shaders, ShaderCount);
 
+    SHADER_ReflectProgram(ShaderProgram);
+
     return ShaderProgram;
 }
 
-void
-SetUniformInt(u32 Shader, const char *UniformName, bool UseProgram, i32 Value)
+// Reflection
+// ----------
+
+uniform_handle
+GetUniformHandle(u32 Shader, const char *UniformName)
 {
-    if (UseProgram)
+    uniform_handle Result = { -1, -1 };
+
+    shader_program *Program = SHADER_FindProgram(Shader);
+    Assert(Program);
+    Result.ProgramIndex = (i16) (Program - ShaderPrograms);
+
+    u64 NameHash = SHADER_HashName(UniformName, strlen(UniformName));
+    for (i32 UniformIndex = 0; UniformIndex < Program->UniformCount; ++UniformIndex)
     {
-        glUseProgram(Shader);
+        shader_uniform *Uniform = &Program->Uniforms[UniformIndex];
+        if (Uniform->NameHash == NameHash && strcmp(Uniform->Name, UniformName) == 0)
+        {
+            Result.UniformIndex = (i16) UniformIndex;
+            break;
+        }
     }
 
-    i32 UniformLocation = glGetUniformLocation(Shader, UniformName);
-    Assert(UniformLocation != -1);
+    return Result;
+}
 
-    glUniform1i(UniformLocation, Value);
+bool
+IsUniformHandleValid(uniform_handle Handle)
+{
+    return (Handle.ProgramIndex >= 0 && Handle.UniformIndex >= 0);
 }
 
-void
-SetUniformVec3F(u32 Shader, const char *UniformName, bool UseProgram, f32 *Value)
+i32
+GetUniformBlockIndex(u32 Shader, const char *BlockName)
 {
-    if (UseProgram)
+    shader_program *Program = SHADER_FindProgram(Shader);
+    Assert(Program);
+
+    u64 NameHash = SHADER_HashName(BlockName, strlen(BlockName));
+    for (i32 BlockIndex = 0; BlockIndex < Program->UniformBlockCount; ++BlockIndex)
     {
-        glUseProgram(Shader);
+        shader_uniform_block *Block = &Program->UniformBlocks[BlockIndex];
+        if (Block->NameHash == NameHash && strcmp(Block->Name, BlockName) == 0)
+        {
+            return Block->Index;
+        }
     }
 
-    i32 UniformLocation = glGetUniformLocation(Shader, UniformName);
-    Assert(UniformLocation != -1);
+    return -1;
+}
+
+i32
+GetUniformBlockSize(u32 Shader, const char *BlockName)
+{
+    shader_program *Program = SHADER_FindProgram(Shader);
+    Assert(Program);
 
-    glUniform3fv(UniformLocation, 1, Value);
+    i32 BlockIndex = GetUniformBlockIndex(Shader, BlockName);
+    return (BlockIndex != -1) ? Program->UniformBlocks[BlockIndex].DataSize : 0;
 }
 
+// Setting uniforms
+// ----------------
+
 void
-SetUniformMat3F(u32 Shader, const char *UniformName, bool UseProgram, f32 *Value)
+SetUniformInt(uniform_handle Handle, i32 Value)
 {
-    if (UseProgram)
+    shader_program *Program;
+    shader_uniform *Uniform = SHADER_GetUniformForSet(Handle, GL_INT, &Value, 1, &Program);
+    if (Uniform)
     {
-        glUseProgram(Shader);
+        UseShader(Program->ID);
+        glUniform1i(Uniform->Location, Value);
+        SHADER_CacheUniformValue(Program, Uniform, &Value, 1);
     }
+}
 
-    i32 UniformLocation = glGetUniformLocation(Shader, UniformName);
-    Assert(UniformLocation != -1);
+void
+SetUniformVec3F(uniform_handle Handle, f32 *Value)
+{
+    shader_program *Program;
+    shader_uniform *Uniform = SHADER_GetUniformForSet(Handle, GL_FLOAT_VEC3, Value, 1, &Program);
+    if (Uniform)
+    {
+        UseShader(Program->ID);
+        glUniform3fv(Uniform->Location, 1, Value);
+        SHADER_CacheUniformValue(Program, Uniform, Value, 1);
+    }
+}
 
-    glUniformMatrix3fv(UniformLocation, 1, GL_FALSE, Value);
+void
+SetUniformMat3F(uniform_handle Handle, f32 *Value)
+{
+    shader_program *Program;
+    shader_uniform *Uniform = SHADER_GetUniformForSet(Handle, GL_FLOAT_MAT3, Value, 1, &Program);
+    if (Uniform)
+    {
+        UseShader(Program->ID);
+        glUniformMatrix3fv(Uniform->Location, 1, GL_FALSE, Value);
+        SHADER_CacheUniformValue(Program, Uniform, Value, 1);
+    }
 }
 
 void
-SetUniformMat4F(u32 Shader, const char *UniformName, bool UseProgram, f32 *Value)
+SetUniformMat4F(uniform_handle Handle, f32 *Value, i32 Count)
 {
-    if (UseProgram)
+    shader_program *Program;
+    shader_uniform *Uniform = SHADER_GetUniformForSet(Handle, GL_FLOAT_MAT4, Value, Count, &Program);
+    if (Uniform)
     {
-        glUseProgram(Shader);
+        UseShader(Program->ID);
+        glUniformMatrix4fv(Uniform->Location, Count, GL_FALSE, Value);
+        SHADER_CacheUniformValue(Program, Uniform, Value, Count);
     }
+}
+
+void
+SetUniformInt(u32 Shader, const char *UniformName, i32 Value)
+{
+    uniform_handle Handle = GetUniformHandle(Shader, UniformName);
+    Assert(IsUniformHandleValid(Handle));
+    SetUniformInt(Handle, Value);
+}
+
+void
+SetUniformVec3F(u32 Shader, const char *UniformName, f32 *Value)
+{
+    uniform_handle Handle = GetUniformHandle(Shader, UniformName);
+    Assert(IsUniformHandleValid(Handle));
+    SetUniformVec3F(Handle, Value);
+}
+
+void
+SetUniformMat3F(u32 Shader, const char *UniformName, f32 *Value)
+{
+    uniform_handle Handle = GetUniformHandle(Shader, UniformName);
+    Assert(IsUniformHandleValid(Handle));
+    SetUniformMat3F(Handle, Value);
+}
+
+void
+SetUniformMat4F(u32 Shader, const char *UniformName, f32 *Value)
+{
+    uniform_handle Handle = GetUniformHandle(Shader, UniformName);
+    Assert(IsUniformHandleValid(Handle));
+    SetUniformMat4F(Handle, Value);
+}
 
-    i32 UniformLocation = glGetUniformLocation(Shader, UniformName);
-    Assert(UniformLocation != -1);
+// Frame globals
+// -------------
 
-    glUniformMatrix4fv(UniformLocation, 1, GL_FALSE, Value);
+void
+UploadFrameGlobals(frame_globals *Globals)
+{
+    stream_allocation Allocation = StreamUpload(Globals, sizeof(frame_globals), STREAM_USAGE_UNIFORM);
+    if (Allocation.Buffer)
+    {
+        BindBufferRange(GL_UNIFORM_BUFFER, FRAME_GLOBALS_BINDING, Allocation.Buffer, Allocation.Offset, Allocation.Size);
+    }
+}
+
+void
+UseShader(u32 Shader)
+{
+    BindProgram(Shader);
 }
 
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
 static u32
 CompileShaderAndCheckErrors(const char *Path, GLenum GLShaderType)
 {
     u32 Shader;
 
     Shader = glCreateShader(GLShaderType);
-    size_t SourceSize = 0;
-    char *Source = ReadFile(Path, &SourceSize);
-    glShaderSource(Shader, 1, &Source, 0);
+    shader_source Source;
+    bool ReadSuccess = SHADER_ReadSource(Path, &Source);
+    Assert(ReadSuccess);
+    glShaderSource(Shader, Source.PieceCount, Source.Pieces, Source.PieceLengths);
     glCompileShader(Shader);
     i32 Success;
     char InfoLog[512];
@@ -105,11 +301,132 @@ CompileShaderAndCheckErrors(const char *Path, GLenum GLShaderType)
     }
     Assert(Success);
 
-    free(Source);
+    SHADER_FreeSource(&Source);
 
     return Shader;
 }
 
+static bool
+SHADER_ReadSource(const char *Path, shader_source *Out_Source)
+{
+    *Out_Source = { };
+
+    size_t SourceSize = 0;
+    char *Source = ReadFile(Path, &SourceSize);
+    if (!Source)
+    {
+        fprintf(stderr, "Couldn't read shader %s\n", Path);
+        return false;
+    }
+    Out_Source->Source = Source;
+
+    // NOTE: Includes are relative to the including shader's directory
+    i32 DirectoryLength = 0;
+    for (i32 CharIndex = 0; Path[CharIndex]; ++CharIndex)
+    {
+        if (Path[CharIndex] == '/' || Path[CharIndex] == '\\')
+        {
+            DirectoryLength = CharIndex + 1;
+        }
+    }
+
+    char *PieceStart = Source;
+    char *LineStart = Source;
+    i32 LineNumber = 1;
+    while (*LineStart)
+    {
+        char *LineEnd = LineStart;
+        while (*LineEnd && *LineEnd != '\n')
+        {
+            ++LineEnd;
+        }
+        char *NextLine = *LineEnd ? LineEnd + 1 : LineEnd;
+
+        char *At = LineStart;
+        while (*At == ' ' || *At == '\t')
+        {
+            ++At;
+        }
+        if (strncmp(At, "#include", 8) == 0)
+        {
+            char *NameStart = At + 8;
+            while (NameStart < LineEnd && *NameStart != '"')
+            {
+                ++NameStart;
+            }
+            char *NameEnd = (NameStart < LineEnd) ? NameStart + 1 : LineEnd;
+            while (NameEnd < LineEnd && *NameEnd != '"')
+            {
+                ++NameEnd;
+            }
+            i32 NameLength = (i32) (NameEnd - NameStart) - 1;
+            if (NameEnd == LineEnd || NameLength <= 0 ||
+                DirectoryLength + NameLength >= MAX_PATH_LENGTH)
+            {
+                fprintf(stderr, "%s(%d): Malformed #include\n", Path, LineNumber);
+                SHADER_FreeSource(Out_Source);
+                return false;
+            }
+            if (Out_Source->IncludeCount == MAX_SHADER_INCLUDES)
+            {
+                fprintf(stderr, "%s(%d): More than %d includes\n", Path, LineNumber, MAX_SHADER_INCLUDES);
+                SHADER_FreeSource(Out_Source);
+                return false;
+            }
+
+            char IncludePath[MAX_PATH_LENGTH];
+            memcpy(IncludePath, Path, DirectoryLength);
+            memcpy(IncludePath + DirectoryLength, NameStart + 1, NameLength);
+            IncludePath[DirectoryLength + NameLength] = '\0';
+
+            size_t IncludeSize = 0;
+            char *Include = ReadFile(IncludePath, &IncludeSize);
+            if (!Include)
+            {
+                fprintf(stderr, "%s(%d): Couldn't read included %s\n", Path, LineNumber, IncludePath);
+                SHADER_FreeSource(Out_Source);
+                return false;
+            }
+
+            i32 IncludeIndex = Out_Source->IncludeCount++;
+            Out_Source->Includes[IncludeIndex] = Include;
+            char *LineDirective = Out_Source->LineDirectives[IncludeIndex];
+            // NOTE: From GLSL 3.30 on, the line after "#line N" is line N (before it, N + 1), so this
+            //       is the number of the line after the #include
+            sprintf_s(LineDirective, sizeof(Out_Source->LineDirectives[IncludeIndex]), "\n#line %d\n",
+                      LineNumber + 1);
+
+            Out_Source->Pieces[Out_Source->PieceCount] = PieceStart;
+            Out_Source->PieceLengths[Out_Source->PieceCount++] = (i32) (LineStart - PieceStart);
+            Out_Source->Pieces[Out_Source->PieceCount] = Include;
+            Out_Source->PieceLengths[Out_Source->PieceCount++] = (i32) IncludeSize;
+            Out_Source->Pieces[Out_Source->PieceCount] = LineDirective;
+            Out_Source->PieceLengths[Out_Source->PieceCount++] = (i32) strlen(LineDirective);
+
+            PieceStart = NextLine;
+        }
+
+        LineStart = NextLine;
+        ++LineNumber;
+    }
+
+    Out_Source->Pieces[Out_Source->PieceCount] = PieceStart;
+    Out_Source->PieceLengths[Out_Source->PieceCount++] = (i32) (LineStart - PieceStart);
+
+    return true;
+}
+
+static void
+SHADER_FreeSource(shader_source *Source)
+{
+    for (i32 IncludeIndex = 0; IncludeIndex < Source->IncludeCount; ++IncludeIndex)
+    {
+        free(Source->Includes[IncludeIndex]);
+    }
+    free(Source->Source);
+    *Source = { };
+}
+
 static u32
 LinkShaderProgramAndCleanShaders(u32 *Shaders, i32 ShaderCount)
 {
@@ -133,14 +450,178 @@ LinkShaderProgramAndCleanShaders(u32 *Shaders, i32 ShaderCount)
 
     for (i32 ShaderIndex = 0; ShaderIndex < ShaderCount; ++ShaderIndex)
     {
-        glDeleteShader(Shaders[ShaderCount]);
+        glDeleteShader(Shaders[ShaderIndex]);
     }
 
     return ShaderProgram;
 }
 
-void
-UseShader(u32 Shader)
+static void
+SHADER_ReflectProgram(u32 Shader)
+{
+    Assert(ShaderProgramCount < MAX_SHADER_PROGRAMS);
+    shader_program *Program = &ShaderPrograms[ShaderProgramCount++];
+    *Program = { };
+    Program->ID = Shader;
+
+    // Uniforms
+    // --------
+    i32 ActiveUniformCount = 0;
+    glGetProgramiv(Shader, GL_ACTIVE_UNIFORMS, &ActiveUniformCount);
+
+    size_t ValueCacheSize = 0;
+    for (i32 ActiveIndex = 0; ActiveIndex < ActiveUniformCount; ++ActiveIndex)
+    {
+        // NOTE: Members of uniform blocks have no location; they're set through the block's buffer
+        u32 UniformIndex = (u32) ActiveIndex;
+        i32 BlockIndex = -1;
+        glGetActiveUniformsiv(Shader, 1, &UniformIndex, GL_UNIFORM_BLOCK_INDEX, &BlockIndex);
+        if (BlockIndex != -1)
+        {
+            continue;
+        }
+
+        char Name[MAX_INTERNAL_NAME_LENGTH];
+        i32 NameLength = 0;
+        i32 ArraySize = 0;
+        GLenum Type = 0;
+        glGetActiveUniform(Shader, UniformIndex, MAX_INTERNAL_NAME_LENGTH, &NameLength, &ArraySize, &Type, Name);
+
+        // NOTE: Arrays are reported as their first element
+        if (NameLength > 3 && strcmp(Name + NameLength - 3, "[0]") == 0)
+        {
+            NameLength -= 3;
+            Name[NameLength] = '\0';
+        }
+
+        if (Program->UniformCount == MAX_SHADER_UNIFORMS)
+        {
+            fprintf(stderr, "Shader program %u has more than %d uniforms, %s is ignored\n",
+                    Shader, MAX_SHADER_UNIFORMS, Name);
+            continue;
+        }
+
+        shader_uniform *Uniform = &Program->Uniforms[Program->UniformCount++];
+        memcpy(Uniform->Name, Name, NameLength + 1);
+        Uniform->NameHash = SHADER_HashName(Name, NameLength);
+        Uniform->Location = glGetUniformLocation(Shader, Name);
+        Uniform->Type = Type;
+        Uniform->ArraySize = ArraySize;
+        Uniform->CacheOffset = ValueCacheSize;
+        ValueCacheSize += SHADER_GetUniformTypeSize(Type) * ArraySize;
+    }
+
+    if (ValueCacheSize > 0)
+    {
+        Program->ValueCache = (u8 *) malloc(ValueCacheSize);
+        Assert(Program->ValueCache);
+    }
+
+    // Uniform blocks
+    // --------------
+    i32 ActiveBlockCount = 0;
+    glGetProgramiv(Shader, GL_ACTIVE_UNIFORM_BLOCKS, &ActiveBlockCount);
+    Assert(ActiveBlockCount <= MAX_SHADER_UNIFORM_BLOCKS);
+
+    for (i32 BlockIndex = 0; BlockIndex < ActiveBlockCount; ++BlockIndex)
+    {
+        shader_uniform_block *Block = &Program->UniformBlocks[Program->UniformBlockCount++];
+
+        i32 NameLength = 0;
+        glGetActiveUniformBlockName(Shader, (u32) BlockIndex, MAX_INTERNAL_NAME_LENGTH, &NameLength, Block->Name);
+        Block->NameHash = SHADER_HashName(Block->Name, NameLength);
+        Block->Index = BlockIndex;
+        glGetActiveUniformBlockiv(Shader, (u32) BlockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &Block->DataSize);
+
+        if (strcmp(Block->Name, "FrameGlobals") == 0)
+        {
+            Assert(Block->DataSize == sizeof(frame_globals));
+            glUniformBlockBinding(Shader, (u32) BlockIndex, FRAME_GLOBALS_BINDING);
+        }
+    }
+}
+
+static shader_program *
+SHADER_FindProgram(u32 Shader)
+{
+    for (i32 ProgramIndex = 0; ProgramIndex < ShaderProgramCount; ++ProgramIndex)
+    {
+        if (ShaderPrograms[ProgramIndex].ID == Shader)
+        {
+            return &ShaderPrograms[ProgramIndex];
+        }
+    }
+
+    return 0;
+}
+
+static u64
+SHADER_HashName(const char *Name, size_t Length)
+{
+    return HashBytes64(Name, Length, 0);
+}
+
+static size_t
+SHADER_GetUniformTypeSize(u32 Type)
 {
-    glUseProgram(Shader);
+    switch (Type)
+    {
+        case GL_INT:
+        case GL_BOOL:
+        case GL_SAMPLER_2D:
+        case GL_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_CUBE:
+        case GL_FLOAT: return 4;
+        case GL_FLOAT_VEC2: return 8;
+        case GL_FLOAT_VEC3: return 12;
+        case GL_FLOAT_VEC4: return 16;
+        case GL_FLOAT_MAT3: return 36;
+        case GL_FLOAT_MAT4: return 64;
+        default: return 0;
+    }
+}
+
+// NOTE: 0 when there's nothing to upload: the handle doesn't resolve, or every value is already
+//       what the uniform holds
+static shader_uniform *
+SHADER_GetUniformForSet(uniform_handle Handle, u32 Type, const void *Value, i32 Count, shader_program **Out_Program)
+{
+    if (!IsUniformHandleValid(Handle))
+    {
+        return 0;
+    }
+
+    Assert(Handle.ProgramIndex < ShaderProgramCount);
+    shader_program *Program = &ShaderPrograms[Handle.ProgramIndex];
+    Assert(Handle.UniformIndex < Program->UniformCount);
+    shader_uniform *Uniform = &Program->Uniforms[Handle.UniformIndex];
+
+    // NOTE: Samplers are set as ints
+    bool IsIntLike = (Uniform->Type == GL_INT || Uniform->Type == GL_BOOL ||
+                      Uniform->Type == GL_SAMPLER_2D || Uniform->Type == GL_SAMPLER_2D_ARRAY ||
+                      Uniform->Type == GL_SAMPLER_CUBE);
+    Assert(Uniform->Type == Type || (Type == GL_INT && IsIntLike));
+    Assert(Count > 0 && Count <= Uniform->ArraySize);
+
+    size_t Size = SHADER_GetUniformTypeSize(Uniform->Type) * Count;
+    if (Count <= Uniform->CachedCount &&
+        memcmp(Program->ValueCache + Uniform->CacheOffset, Value, Size) == 0)
+    {
+        return 0;
+    }
+
+    *Out_Program = Program;
+    return Uniform;
+}
+
+static void
+SHADER_CacheUniformValue(shader_program *Program, shader_uniform *Uniform, const void *Value, i32 Count)
+{
+    size_t Size = SHADER_GetUniformTypeSize(Uniform->Type) * Count;
+    memcpy(Program->ValueCache + Uniform->CacheOffset, Value, Size);
+    CountUploadedBytes(Size);
+    if (Count > Uniform->CachedCount)
+    {
+        Uniform->CachedCount = Count;
+    }
 }
@@ -1,21 +1,95 @@
 #ifndef SHADER_H
 #define SHADER_H
 
+#include <glm/glm.hpp>
+
 #include "Common.h"
 
+// NOTE: Every program's active uniforms and uniform blocks are read back once when it's linked.
+//       Uniforms are then set through handles into that table: no glGetUniformLocation per call,
+//       the program is only bound when it isn't already, and a value that's the same as the last
+//       one uploaded to that uniform isn't uploaded again.
+#define MAX_SHADER_PROGRAMS 32
+#define MAX_SHADER_UNIFORMS 32
+#define MAX_SHADER_UNIFORM_BLOCKS 8
+
+// NOTE: Shaders can #include "File" (relative to the shader, one level deep); GLSL itself can't
+#define MAX_SHADER_INCLUDES 4
+
+// NOTE: Uniform buffer binding point of the FrameGlobals block (resources/shaders/FrameGlobals.glsl).
+//       Every program that has the block gets it bound here when it's built.
+#define FRAME_GLOBALS_BINDING 0
+
+// NOTE: Same layout as the std140 FrameGlobals block
+struct frame_globals
+{
+    glm::mat4 Projection;
+    glm::mat4 View;
+    glm::vec3 ViewPosition;
+    f32 Time;
+    glm::vec3 LightDirection;
+    f32 Padding;
+};
+
+// NOTE: Resolves to nothing (sets are ignored) when the uniform isn't active in the program, the
+//       same as location -1 in GL
+struct uniform_handle
+{
+    i16 ProgramIndex;
+    i16 UniformIndex;
+};
+
 u32
 BuildShaderProgram(const char *VertexPath, const char *FragmentPath);
 
+// Reflection
+// ----------
+
+// NOTE: Arrays are looked up by their bare name ("BoneTransforms", not "BoneTransforms[0]").
+//       Asserts that the uniform's GL type matches the one it's set with later.
+uniform_handle
+GetUniformHandle(u32 Shader, const char *UniformName);
+bool
+IsUniformHandleValid(uniform_handle Handle);
+// NOTE: -1 when the program has no such active block
+i32
+GetUniformBlockIndex(u32 Shader, const char *BlockName);
+i32
+GetUniformBlockSize(u32 Shader, const char *BlockName);
+
+// Setting uniforms
+// ----------------
+
 void
-SetUniformInt(u32 Shader, const char *UniformName, bool UseProgram, i32 Value);
+SetUniformInt(uniform_handle Handle, i32 Value);
 void
-SetUniformVec3F(u32 Shader, const char *UniformName, bool UseProgram, f32 *Value);
+SetUniformVec3F(uniform_handle Handle, f32 *Value);
 void
-SetUniformMat3F(u32 Shader, const char *UniformName, bool UseProgram, f32 *Value);
+SetUniformMat3F(uniform_handle Handle, f32 *Value);
+// NOTE: Count consecutive elements from the start of an array uniform
+void
+SetUniformMat4F(uniform_handle Handle, f32 *Value, i32 Count = 1);
+
+// NOTE: By name, for setup code; asserts that the uniform is active
+void
+SetUniformInt(u32 Shader, const char *UniformName, i32 Value);
+void
+SetUniformVec3F(u32 Shader, const char *UniformName, f32 *Value);
+void
+SetUniformMat3F(u32 Shader, const char *UniformName, f32 *Value);
+void
+SetUniformMat4F(u32 Shader, const char *UniformName, f32 *Value);
+
+// Frame globals
+// -------------
+
+// NOTE: Once per frame, or once per view before that view's draws. One upload (to the stream
+//       buffer) however many programs there are; draws already issued keep the previous one.
 void
-SetUniformMat4F(u32 Shader, const char *UniformName, bool UseProgram, f32 *Value);
+UploadFrameGlobals(frame_globals *Globals);
 
+// NOTE: BindProgram (GLState.h)
 void
 UseShader(u32 Shader);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,324 @@
+#include "StaticBatch.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "ModelFormat.h"
+#include "Texture.h"
+
+struct static_batch_triangle
+{
+    i32 SourceIndex;
+    i32 MeshIndex;
+    i32 FirstIndex;
+};
+
+// NOTE: One per chunk: a material in a grid cell
+struct static_batch_group
+{
+    u32 TextureIDs[COOKED_MATERIAL_TEXTURE_COUNT];
+    i32 CellX;
+    i32 CellY;
+    i32 CellZ;
+
+    i32 TriangleCount;
+    // NOTE: Into the triangles sorted by group
+    i32 FirstTriangle;
+};
+
+static bool
+STATICBATCH_IsSourceUsable(static_batch_source *Source);
+static i32
+STATICBATCH_FindGroup(static_batch_group *Groups, i32 *GroupCount, i32 LastGroup, const u32 *TextureIDs,
+                      i32 CellX, i32 CellY, i32 CellZ);
+static void
+STATICBATCH_BuildChunk(static_batch_source *Sources, static_batch_triangle *Triangles, i32 *SortedTriangles,
+                       static_batch_group *Group, i32 *VertexStamps, i32 *VertexRemap, i32 *Stamp,
+                       mesh *Out_Mesh);
+
+// -----------------------------
+// EXTERNAL FUNCTION DEFINITIONS
+// -----------------------------
+
+void
+BakeStaticBatch(static_batch_source *Sources, i32 SourceCount, static_batch *Out_Batch, f32 ChunkSize)
+{
+    Assert(ChunkSize > 0.0f);
+
+    *Out_Batch = { };
+
+    memory_arena *Scratch = GetScratchArena();
+    temporary_memory ScratchMemory = BeginTemporaryMemory(Scratch);
+
+    // Count what's to be baked
+    // ------------------------
+    i32 TriangleCount = 0;
+    i32 MaxVertexCount = 0;
+    for (i32 SourceIndex = 0; SourceIndex < SourceCount; ++SourceIndex)
+    {
+        static_batch_source *Source = &Sources[SourceIndex];
+        if (!STATICBATCH_IsSourceUsable(Source))
+        {
+            fprintf(stderr, "Static batch source %d isn't ready or has no CPU vertex data; left out\n", SourceIndex);
+            continue;
+        }
+
+        for (i32 MeshIndex = 0; MeshIndex < Source->Model->MeshCount; ++MeshIndex)
+        {
+            mesh_cpu_data *CPUMesh = &Source->Model->CPUMeshes[MeshIndex];
+            TriangleCount += CPUMesh->IndexCount / 3;
+            MaxVertexCount = (CPUMesh->VertexCount > MaxVertexCount) ? CPUMesh->VertexCount : MaxVertexCount;
+            ++Out_Batch->SourceMeshCount;
+        }
+    }
+    Out_Batch->TriangleCount = TriangleCount;
+
+    // Triangles into groups by material and by the cell their center is in
+    // ---------------------------------------------------------------------
+    static_batch_triangle *Triangles = PushArray(Scratch, TriangleCount, static_batch_triangle);
+    i32 *TriangleGroups = PushArray(Scratch, TriangleCount, i32);
+    // NOTE: At worst every triangle is a group of its own
+    static_batch_group *Groups = PushArray(Scratch, TriangleCount, static_batch_group);
+    i32 GroupCount = 0;
+
+    i32 TriangleIndex = 0;
+    i32 LastGroup = -1;
+    f32 InverseChunkSize = 1.0f / ChunkSize;
+    for (i32 SourceIndex = 0; SourceIndex < SourceCount; ++SourceIndex)
+    {
+        static_batch_source *Source = &Sources[SourceIndex];
+        if (!STATICBATCH_IsSourceUsable(Source))
+        {
+            continue;
+        }
+
+        for (i32 MeshIndex = 0; MeshIndex < Source->Model->MeshCount; ++MeshIndex)
+        {
+            mesh *Mesh = &Source->Model->Meshes[MeshIndex];
+            mesh_cpu_data *CPUMesh = &Source->Model->CPUMeshes[MeshIndex];
+            for (i32 FirstIndex = 0; FirstIndex + 2 < CPUMesh->IndexCount; FirstIndex += 3)
+            {
+                glm::vec3 Center(0.0f);
+                for (i32 Corner = 0; Corner < 3; ++Corner)
+                {
+                    const f32 *Position = &CPUMesh->Positions[CPUMesh->Indices[FirstIndex + Corner] * POSITIONS_PER_VERTEX];
+                    Center += glm::vec3(Source->Transform * glm::vec4(Position[0], Position[1], Position[2], 1.0f));
+                }
+                Center = Center * (1.0f / 3.0f);
+
+                LastGroup = STATICBATCH_FindGroup(Groups, &GroupCount, LastGroup, Mesh->TextureIDs,
+                                                  (i32) floorf(Center.x * InverseChunkSize),
+                                                  (i32) floorf(Center.y * InverseChunkSize),
+                                                  (i32) floorf(Center.z * InverseChunkSize));
+                ++Groups[LastGroup].TriangleCount;
+
+                Triangles[TriangleIndex].SourceIndex = SourceIndex;
+                Triangles[TriangleIndex].MeshIndex = MeshIndex;
+                Triangles[TriangleIndex].FirstIndex = FirstIndex;
+                TriangleGroups[TriangleIndex] = LastGroup;
+                ++TriangleIndex;
+            }
+        }
+    }
+    TriangleCount = TriangleIndex;
+
+    // NOTE: Counting sort; triangles of one mesh stay together and in order within their group
+    i32 *SortedTriangles = PushArray(Scratch, TriangleCount, i32);
+    i32 *GroupCursors = PushArray(Scratch, GroupCount, i32);
+    i32 FirstTriangle = 0;
+    for (i32 GroupIndex = 0; GroupIndex < GroupCount; ++GroupIndex)
+    {
+        Groups[GroupIndex].FirstTriangle = FirstTriangle;
+        GroupCursors[GroupIndex] = FirstTriangle;
+        FirstTriangle += Groups[GroupIndex].TriangleCount;
+    }
+    for (TriangleIndex = 0; TriangleIndex < TriangleCount; ++TriangleIndex)
+    {
+        SortedTriangles[GroupCursors[TriangleGroups[TriangleIndex]]++] = TriangleIndex;
+    }
+
+    // Groups into chunks
+    // ------------------
+    // NOTE: A source vertex's index in the chunk being built is valid while its stamp is current;
+    //       bumping the stamp forgets them all at once
+    i32 *VertexStamps = PushArray(Scratch, MaxVertexCount, i32);
+    i32 *VertexRemap = PushArray(Scratch, MaxVertexCount, i32);
+    i32 Stamp = 0;
+
+    Out_Batch->ChunkCount = GroupCount;
+    Out_Batch->Chunks = PushArray(&Out_Batch->Arena, GroupCount, model);
+    for (i32 GroupIndex = 0; GroupIndex < GroupCount; ++GroupIndex)
+    {
+        model *Chunk = &Out_Batch->Chunks[GroupIndex];
+        Chunk->MeshCount = 1;
+        Chunk->Meshes = PushStruct(&Out_Batch->Arena, mesh);
+        STATICBATCH_BuildChunk(Sources, Triangles, SortedTriangles, &Groups[GroupIndex], VertexStamps, VertexRemap,
+                               &Stamp, Chunk->Meshes);
+        Chunk->IsReady = true;
+    }
+
+    EndTemporaryMemory(ScratchMemory);
+
+    printf("Baked %d static meshes (%d triangles) into %d chunks\n", Out_Batch->SourceMeshCount,
+           Out_Batch->TriangleCount, Out_Batch->ChunkCount);
+}
+
+void
+FreeStaticBatch(static_batch *Batch)
+{
+    for (i32 ChunkIndex = 0; ChunkIndex < Batch->ChunkCount; ++ChunkIndex)
+    {
+        FreeModel(&Batch->Chunks[ChunkIndex]);
+    }
+    ClearArena(&Batch->Arena);
+    *Batch = { };
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+static bool
+STATICBATCH_IsSourceUsable(static_batch_source *Source)
+{
+    model *Model = Source->Model;
+    bool Result = (Model && Model->IsReady && Model->CPUMeshes &&
+                   (Model->MeshCount == 0 || Model->CPUMeshes[0].Normals));
+    return Result;
+}
+
+// NOTE: Searched linearly, but the last hit is tried first: neighbouring triangles of a mesh are
+//       almost always in the same group
+static i32
+STATICBATCH_FindGroup(static_batch_group *Groups, i32 *GroupCount, i32 LastGroup, const u32 *TextureIDs,
+                      i32 CellX, i32 CellY, i32 CellZ)
+{
+    for (i32 Attempt = -1; Attempt < *GroupCount; ++Attempt)
+    {
+        i32 GroupIndex = (Attempt < 0) ? LastGroup : Attempt;
+        if (GroupIndex < 0 || (Attempt >= 0 && GroupIndex == LastGroup))
+        {
+            continue;
+        }
+
+        static_batch_group *Group = &Groups[GroupIndex];
+        if (Group->CellX == CellX && Group->CellY == CellY && Group->CellZ == CellZ &&
+            memcmp(Group->TextureIDs, TextureIDs, sizeof(Group->TextureIDs)) == 0)
+        {
+            return GroupIndex;
+        }
+    }
+
+    i32 Result = (*GroupCount)++;
+    static_batch_group *Group = &Groups[Result];
+    memcpy(Group->TextureIDs, TextureIDs, sizeof(Group->TextureIDs));
+    Group->CellX = CellX;
+    Group->CellY = CellY;
+    Group->CellZ = CellZ;
+    Group->TriangleCount = 0;
+    return Result;
+}
+
+// NOTE: Vertices are shared within each source mesh's run of triangles, as they were in the mesh.
+//       Mirroring transforms get their triangles' winding flipped so they still face out.
+static void
+STATICBATCH_BuildChunk(static_batch_source *Sources, static_batch_triangle *Triangles, i32 *SortedTriangles,
+                       static_batch_group *Group, i32 *VertexStamps, i32 *VertexRemap, i32 *Stamp,
+                       mesh *Out_Mesh)
+{
+    i32 *GroupTriangles = &SortedTriangles[Group->FirstTriangle];
+
+    // NOTE: Counted first, since the planar layout needs the exact vertex count
+    i32 VertexCount = 0;
+    for (i32 Index = 0; Index < Group->TriangleCount; ++Index)
+    {
+        static_batch_triangle *Triangle = &Triangles[GroupTriangles[Index]];
+        if (Index == 0 || Triangle->SourceIndex != Triangles[GroupTriangles[Index - 1]].SourceIndex ||
+            Triangle->MeshIndex != Triangles[GroupTriangles[Index - 1]].MeshIndex)
+        {
+            ++*Stamp;
+        }
+
+        mesh_cpu_data *CPUMesh = &Sources[Triangle->SourceIndex].Model->CPUMeshes[Triangle->MeshIndex];
+        for (i32 Corner = 0; Corner < 3; ++Corner)
+        {
+            i32 SourceVertex = CPUMesh->Indices[Triangle->FirstIndex + Corner];
+            if (VertexStamps[SourceVertex] != *Stamp)
+            {
+                VertexStamps[SourceVertex] = *Stamp;
+                ++VertexCount;
+            }
+        }
+    }
+
+    temporary_memory ScratchMemory = BeginTemporaryMemory(GetScratchArena());
+    mesh_internal_data Data = PushMeshInternalData(GetScratchArena(), VertexCount, Group->TriangleCount * 3, false);
+
+    i32 OutVertex = 0;
+    glm::mat4 Transform(1.0f);
+    glm::mat3 NormalMatrix(1.0f);
+    glm::mat3 TangentMatrix(1.0f);
+    bool IsMirrored = false;
+    for (i32 Index = 0; Index < Group->TriangleCount; ++Index)
+    {
+        static_batch_triangle *Triangle = &Triangles[GroupTriangles[Index]];
+        static_batch_source *Source = &Sources[Triangle->SourceIndex];
+        if (Index == 0 || Triangle->SourceIndex != Triangles[GroupTriangles[Index - 1]].SourceIndex ||
+            Triangle->MeshIndex != Triangles[GroupTriangles[Index - 1]].MeshIndex)
+        {
+            ++*Stamp;
+            Transform = Source->Transform;
+            NormalMatrix = MakeMeshInstance(Transform).NormalMatrix;
+            TangentMatrix = glm::mat3(Transform);
+            IsMirrored = (glm::determinant(TangentMatrix) < 0.0f);
+        }
+
+        mesh_cpu_data *CPUMesh = &Source->Model->CPUMeshes[Triangle->MeshIndex];
+        for (i32 Corner = 0; Corner < 3; ++Corner)
+        {
+            i32 SourceVertex = CPUMesh->Indices[Triangle->FirstIndex + Corner];
+            if (VertexStamps[SourceVertex] != *Stamp)
+            {
+                VertexStamps[SourceVertex] = *Stamp;
+                VertexRemap[SourceVertex] = OutVertex;
+
+                const f32 *P = &CPUMesh->Positions[SourceVertex * POSITIONS_PER_VERTEX];
+                const f32 *UV = &CPUMesh->UVs[SourceVertex * UVS_PER_VERTEX];
+                const f32 *N = &CPUMesh->Normals[SourceVertex * NORMALS_PER_VERTEX];
+                const f32 *T = &CPUMesh->Tangents[SourceVertex * TANGENTS_PER_VERTEX];
+                glm::vec3 Position = glm::vec3(Transform * glm::vec4(P[0], P[1], P[2], 1.0f));
+                glm::vec3 Normal = NormalMatrix * glm::vec3(N[0], N[1], N[2]);
+                glm::vec3 Tangent = TangentMatrix * glm::vec3(T[0], T[1], T[2]);
+                // NOTE: Missing attributes stay zero rather than turning into NaNs
+                f32 NormalLength = glm::length(Normal);
+                f32 TangentLength = glm::length(Tangent);
+                Normal = (NormalLength > 0.0f) ? Normal * (1.0f / NormalLength) : Normal;
+                Tangent = (TangentLength > 0.0f) ? Tangent * (1.0f / TangentLength) : Tangent;
+                glm::vec3 Bitangent = glm::cross(Normal, Tangent);
+
+                memcpy(&Data.Positions[OutVertex * POSITIONS_PER_VERTEX], &Position[0], sizeof(Position));
+                memcpy(&Data.UVs[OutVertex * UVS_PER_VERTEX], UV, UVS_PER_VERTEX * sizeof(f32));
+                memcpy(&Data.Normals[OutVertex * NORMALS_PER_VERTEX], &Normal[0], sizeof(Normal));
+                memcpy(&Data.Tangents[OutVertex * TANGENTS_PER_VERTEX], &Tangent[0], sizeof(Tangent));
+                memcpy(&Data.Bitangents[OutVertex * BITANGENTS_PER_VERTEX], &Bitangent[0], sizeof(Bitangent));
+                ++OutVertex;
+            }
+        }
+
+        i32 *OutIndices = &Data.Indices[Index * 3];
+        OutIndices[0] = VertexRemap[CPUMesh->Indices[Triangle->FirstIndex + 0]];
+        OutIndices[1] = VertexRemap[CPUMesh->Indices[Triangle->FirstIndex + (IsMirrored ? 2 : 1)]];
+        OutIndices[2] = VertexRemap[CPUMesh->Indices[Triangle->FirstIndex + (IsMirrored ? 1 : 2)]];
+    }
+    Assert(OutVertex == VertexCount);
+
+    UploadMeshInternalData(Data, Out_Mesh);
+    EndTemporaryMemory(ScratchMemory);
+
+    memcpy(Out_Mesh->TextureIDs, Group->TextureIDs, sizeof(Out_Mesh->TextureIDs));
+    for (i32 TextureType = 0; TextureType < COOKED_MATERIAL_TEXTURE_COUNT; ++TextureType)
+    {
+        RetainTexture(Out_Mesh->TextureIDs[TextureType]);
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef STATIC_BATCH_H
+#define STATIC_BATCH_H
+
+#include <glm/glm.hpp>
+
+#include "Common.h"
+#include "Memory.h"
+#include "Model.h"
+
+// NOTE: Static scenery baked into a few big meshes. Every triangle of the source instances is moved
+//       to world space and goes into the chunk for its material (the mesh's texture set) and the
+//       grid cell its center falls in, so each chunk is one draw and has tight bounds of its own.
+//       Chunks are models of one mesh with world space vertices, culled and queued like any other
+//       with an identity transform (AddSceneModel). The sources aren't referenced once the batch
+//       is baked and can be released; the chunks hold on to the textures.
+#define DEFAULT_STATIC_BATCH_CHUNK_SIZE 16.0f
+
+struct static_batch_source
+{
+    // NOTE: Has to be ready and loaded with its CPU data (RESOURCE_KEEP_CPU_DATA)
+    model *Model;
+    glm::mat4 Transform;
+};
+
+struct static_batch
+{
+    i32 ChunkCount;
+    // NOTE: Ready, with one mesh each
+    model *Chunks;
+
+    // NOTE: Meshes (draws, without the batch) and triangles that went into the chunks
+    i32 SourceMeshCount;
+    i32 TriangleCount;
+
+    // NOTE: Holds Chunks and their meshes
+    memory_arena Arena;
+};
+
+// ---------------------
+// FUNCTION DECLARATIONS
+// ---------------------
+
+// NOTE: GL thread. Sources that can't be baked are reported and left out. ChunkSize is the edge
+//       of the grid cells, in world units.
+void
+BakeStaticBatch(static_batch_source *Sources, i32 SourceCount, static_batch *Out_Batch,
+                f32 ChunkSize = DEFAULT_STATIC_BATCH_CHUNK_SIZE);
+// NOTE: Deletes the chunks' GL objects and releases their textures
+void
+FreeStaticBatch(static_batch *Batch);
+
+#endif
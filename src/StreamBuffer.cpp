@@ -0,0 +1,206 @@
+#include "StreamBuffer.h"
+
+#include <glad/glad.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include "GLState.h"
+
+struct stream_buffer
+{
+    u32 Buffer;
+    size_t FrameSize;
+    size_t UniformAlignment;
+
+    // NOTE: 0 once the frame that last used the region has finished on the GPU
+    GLsync Fences[STREAM_BUFFER_FRAME_COUNT];
+
+    u64 FrameIndex;
+    bool IsInFrame;
+    i32 Region;
+    // NOTE: Bytes used of the current region
+    size_t Used;
+
+    stream_buffer_stats Stats;
+};
+
+static stream_buffer StreamBuffer;
+
+static size_t
+STREAMBUFFER_GetAlignment(stream_usage Usage);
+static void
+STREAMBUFFER_Orphan();
+
+// -----------------------------
+// EXTERNAL FUNCTION DEFINITIONS
+// -----------------------------
+
+void
+InitializeStreamBuffer(size_t FrameSize)
+{
+    Assert(!StreamBuffer.Buffer && FrameSize > 0);
+
+    i32 UniformAlignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &UniformAlignment);
+    StreamBuffer.UniformAlignment = (UniformAlignment > 0) ? (size_t) UniformAlignment : 256;
+    StreamBuffer.FrameSize = FrameSize;
+
+    glGenBuffers(1, &StreamBuffer.Buffer);
+    STREAMBUFFER_Orphan();
+}
+
+u32
+GetStreamBuffer()
+{
+    Assert(StreamBuffer.Buffer);
+    return StreamBuffer.Buffer;
+}
+
+void
+BeginStreamBufferFrame()
+{
+    Assert(StreamBuffer.Buffer && !StreamBuffer.IsInFrame);
+
+    StreamBuffer.IsInFrame = true;
+    ++StreamBuffer.FrameIndex;
+    StreamBuffer.Region = (i32) (StreamBuffer.FrameIndex % STREAM_BUFFER_FRAME_COUNT);
+    StreamBuffer.Used = 0;
+    StreamBuffer.Stats = { };
+
+    GLsync *Fence = &StreamBuffer.Fences[StreamBuffer.Region];
+    if (*Fence)
+    {
+        GLenum WaitResult = glClientWaitSync(*Fence, 0, 0);
+        if (WaitResult == GL_ALREADY_SIGNALED || WaitResult == GL_CONDITION_SATISFIED)
+        {
+            glDeleteSync(*Fence);
+            *Fence = 0;
+        }
+        else
+        {
+            // NOTE: Fresh storage is free everywhere, so the fences on the old one don't matter
+            STREAMBUFFER_Orphan();
+            ++StreamBuffer.Stats.Orphans;
+        }
+    }
+}
+
+stream_buffer_stats
+EndStreamBufferFrame()
+{
+    Assert(StreamBuffer.IsInFrame);
+
+    StreamBuffer.Fences[StreamBuffer.Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    StreamBuffer.IsInFrame = false;
+
+    return StreamBuffer.Stats;
+}
+
+stream_allocation
+BeginStreamWrite(size_t Size, stream_usage Usage)
+{
+    Assert(StreamBuffer.IsInFrame && Size > 0);
+
+    stream_allocation Result = { };
+
+    size_t Alignment = STREAMBUFFER_GetAlignment(Usage);
+    size_t Offset = (StreamBuffer.Used + Alignment - 1) / Alignment * Alignment;
+    if (Offset + Size > StreamBuffer.FrameSize)
+    {
+        ++StreamBuffer.Stats.FailedAllocations;
+        if (StreamBuffer.Stats.FailedAllocations == 1)
+        {
+            fprintf(stderr, "Stream buffer frame region (%llu bytes) is full\n",
+                    (unsigned long long) StreamBuffer.FrameSize);
+        }
+        return Result;
+    }
+
+    size_t BufferOffset = StreamBuffer.Region * StreamBuffer.FrameSize + Offset;
+    BindBuffer(GL_COPY_WRITE_BUFFER, StreamBuffer.Buffer);
+    u8 *Data = (u8 *) glMapBufferRange(GL_COPY_WRITE_BUFFER, BufferOffset, Size,
+                                       GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+                                       GL_MAP_UNSYNCHRONIZED_BIT);
+    if (!Data)
+    {
+        ++StreamBuffer.Stats.FailedAllocations;
+        return Result;
+    }
+
+    StreamBuffer.Used = Offset + Size;
+    ++StreamBuffer.Stats.Allocations;
+
+    Result.Buffer = StreamBuffer.Buffer;
+    Result.Offset = BufferOffset;
+    Result.Size = Size;
+    Result.Data = Data;
+    return Result;
+}
+
+void
+EndStreamWrite(stream_allocation *Allocation)
+{
+    if (!Allocation->Data)
+    {
+        return;
+    }
+
+    BindBuffer(GL_COPY_WRITE_BUFFER, StreamBuffer.Buffer);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    Allocation->Data = 0;
+
+    StreamBuffer.Stats.BytesWritten += Allocation->Size;
+    CountUploadedBytes(Allocation->Size);
+}
+
+stream_allocation
+StreamUpload(const void *Data, size_t Size, stream_usage Usage)
+{
+    stream_allocation Result = BeginStreamWrite(Size, Usage);
+    if (Result.Data)
+    {
+        memcpy(Result.Data, Data, Size);
+        EndStreamWrite(&Result);
+    }
+
+    return Result;
+}
+
+u64
+GetStreamBufferFrameIndex()
+{
+    return StreamBuffer.FrameIndex;
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+static size_t
+STREAMBUFFER_GetAlignment(stream_usage Usage)
+{
+    switch (Usage)
+    {
+        case STREAM_USAGE_VERTEX: return 16;
+        case STREAM_USAGE_INDEX: return 4;
+        case STREAM_USAGE_UNIFORM: return StreamBuffer.UniformAlignment;
+        default: return 16;
+    }
+}
+
+static void
+STREAMBUFFER_Orphan()
+{
+    BindBuffer(GL_COPY_WRITE_BUFFER, StreamBuffer.Buffer);
+    BufferData(GL_COPY_WRITE_BUFFER, STREAM_BUFFER_FRAME_COUNT * StreamBuffer.FrameSize, 0, GL_STREAM_DRAW);
+
+    for (i32 Region = 0; Region < STREAM_BUFFER_FRAME_COUNT; ++Region)
+    {
+        if (StreamBuffer.Fences[Region])
+        {
+            glDeleteSync(StreamBuffer.Fences[Region]);
+            StreamBuffer.Fences[Region] = 0;
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <cstddef>
+
+#include "Common.h"
+
+// NOTE: One GL buffer for everything that's rewritten every frame (instance transforms, frame
+//       globals, dynamic text). It's split into STREAM_BUFFER_FRAME_COUNT regions used in turn, one
+//       per frame, each fenced when its frame ends. A region is only written again once its fence
+//       has passed, so writes map it unsynchronized and never wait on the GPU or make the driver
+//       copy. If the GPU is still behind when a region comes round again, the whole buffer is
+//       orphaned instead of waited on.
+//       Persistent mapping would save the map per write, but needs GL 4.4 and the context is 3.3.
+//       GL thread only.
+#define STREAM_BUFFER_FRAME_COUNT 3
+#define DEFAULT_STREAM_BUFFER_FRAME_SIZE (4 * 1024 * 1024)
+
+// NOTE: Decides the allocation's alignment; the buffer can be bound to any of these targets
+enum stream_usage
+{
+    STREAM_USAGE_VERTEX,
+    STREAM_USAGE_INDEX,
+    STREAM_USAGE_UNIFORM,
+};
+
+struct stream_allocation
+{
+    // NOTE: 0 when the frame's region is full; there's nothing to draw from then
+    u32 Buffer;
+    size_t Offset;
+    size_t Size;
+
+    // NOTE: Write-only, and only until EndStreamWrite
+    u8 *Data;
+};
+
+struct stream_buffer_stats
+{
+    u64 BytesWritten;
+    i32 Allocations;
+    // NOTE: Allocations that didn't fit in the frame's region
+    i32 FailedAllocations;
+    // NOTE: Times the GPU was still using a region that came round again
+    i32 Orphans;
+};
+
+// ---------------------
+// FUNCTION DECLARATIONS
+// ---------------------
+
+// NOTE: After InitializeGLState, before anything that points a VAO at the buffer (static meshes)
+void
+InitializeStreamBuffer(size_t FrameSize);
+// NOTE: The buffer's name doesn't change, even when it's orphaned
+u32
+GetStreamBuffer();
+
+// NOTE: Bracket everything that's drawn in the frame
+void
+BeginStreamBufferFrame();
+stream_buffer_stats
+EndStreamBufferFrame();
+
+// NOTE: Valid for the current frame only. The pair maps the range for writing in place;
+//       StreamUpload copies Data into a fresh allocation.
+stream_allocation
+BeginStreamWrite(size_t Size, stream_usage Usage);
+void
+EndStreamWrite(stream_allocation *Allocation);
+stream_allocation
+StreamUpload(const void *Data, size_t Size, stream_usage Usage);
+// NOTE: For telling whether something streamed earlier is still in this frame's region
+u64
+GetStreamBufferFrameIndex();
+
+#endif
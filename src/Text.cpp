@@ -8,7 +8,11 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
+#include "FileIO.h"
+#include "GLState.h"
+#include "StreamBuffer.h"
 #include "Util.h"
 
 font_info *
@@ -16,8 +20,12 @@ RasterizeAndProcessFont(const char *FontPath, i32 FontSizePoints)
 {
     font_info *Result = (font_info *) malloc(sizeof(font_info));
 
-    TTF_Font *Font = NULL;
-    Font = TTF_OpenFont(FontPath, FontSizePoints);
+    // NOTE: Through a mapped view, so fonts can come out of a mounted pack; SDL_ttf reads from it
+    //       until the font is closed
+    mapped_file FontFile;
+    bool FontMapped = MapFileReadOnly(FontPath, &FontFile);
+    Assert(FontMapped);
+    TTF_Font *Font = TTF_OpenFontRW(SDL_RWFromConstMem(FontFile.Data, (int) FontFile.Size), 1, FontSizePoints);
     Result->Height = TTF_FontHeight(Font);
     Result->Points = FontSizePoints;
 
@@ -112,7 +120,7 @@ RasterizeAndProcessFont(const char *FontPath, i32 FontSizePoints)
     }
 
     glGenTextures(1, &Result->AtlasGLID);
-    glBindTexture(GL_TEXTURE_2D, Result->AtlasGLID);
+    BindTexture2D(0, Result->AtlasGLID);
     // TODO: Don't really need all 4 channels, just need alpha, and can color in the shader with custom color
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8,
                  AtlasWidth, AtlasHeight,
@@ -122,9 +130,9 @@ RasterizeAndProcessFont(const char *FontPath, i32 FontSizePoints)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glBindTexture(GL_TEXTURE_2D, 0);
 
     TTF_CloseFont(Font);
+    UnmapFile(&FontFile);
     //SDL_SaveBMP(FontAtlas, "font_atlas_test.bmp");
     SDL_FreeSurface(FontAtlas);
 
@@ -142,6 +150,8 @@ PrepareUIString(const char *Text, font_info *FontInfo,
     Result.ScreenWidth = ScreenWidth;
     Result.ScreenHeight = ScreenHeight;
     Result.FontInfo = FontInfo;
+    Result.IsDynamic = false;
+    Result.StreamedFrame = 0;
 
 
 
@@ -158,50 +168,84 @@ PrepareUIString(const char *Text, font_info *FontInfo,
 
     glGenVertexArrays(1, &Result.VAO);
     glGenBuffers(1, &Result.VBO);
-    glBindVertexArray(Result.VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, Result.VBO);
-    glBufferData(GL_ARRAY_BUFFER, Result.PositionsBufferSize + Result.UVsBufferSize, 0, GL_STATIC_DRAW); // TODO: Dynamic?
-    glBufferSubData(GL_ARRAY_BUFFER, 0, Result.PositionsBufferSize, Result.Positions);
-    glBufferSubData(GL_ARRAY_BUFFER, Result.PositionsBufferSize, Result.UVsBufferSize, Result.UVs);
+    BindVertexArray(Result.VAO);
+    BindBuffer(GL_ARRAY_BUFFER, Result.VBO);
+    BufferData(GL_ARRAY_BUFFER, Result.PositionsBufferSize + Result.UVsBufferSize, 0, GL_STATIC_DRAW);
+    BufferSubData(GL_ARRAY_BUFFER, 0, Result.PositionsBufferSize, Result.Positions);
+    BufferSubData(GL_ARRAY_BUFFER, Result.PositionsBufferSize, Result.UVsBufferSize, Result.UVs);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(f32), (void *) 0);
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(f32), (void *) Result.PositionsBufferSize);
 
-    glBindVertexArray(0);
+    BindVertexArray(0);
 
     return Result;
 }
 
 void
-RenderUIString(ui_string UIString)
+RenderUIString(ui_string *UIString)
 {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, UIString.FontInfo->AtlasGLID);
+    BindVertexArray(UIString->VAO);
 
-    glBindVertexArray(UIString.VAO);
-    glDrawArrays(GL_TRIANGLES, 0, UIString.StringLength * 6);
-    glBindVertexArray(0);
+    if (UIString->IsDynamic && UIString->StreamedFrame != GetStreamBufferFrameIndex())
+    {
+        stream_allocation Allocation = BeginStreamWrite(UIString->PositionsBufferSize + UIString->UVsBufferSize,
+                                                        STREAM_USAGE_VERTEX);
+        if (!Allocation.Data)
+        {
+            return;
+        }
+        memcpy(Allocation.Data, UIString->Positions, UIString->PositionsBufferSize);
+        memcpy(Allocation.Data + UIString->PositionsBufferSize, UIString->UVs, UIString->UVsBufferSize);
+        EndStreamWrite(&Allocation);
+
+        BindBuffer(GL_ARRAY_BUFFER, Allocation.Buffer);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(f32), (void *) Allocation.Offset);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(f32),
+                              (void *) (Allocation.Offset + UIString->PositionsBufferSize));
+        UIString->StreamedFrame = GetStreamBufferFrameIndex();
+    }
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    BindTexture2D(0, UIString->FontInfo->AtlasGLID);
+    DrawArrays(GL_TRIANGLES, 0, UIString->StringLength * 6);
 }
 
 void
-UpdateUIString(ui_string UIString, const char *NewText)
+UpdateUIString(ui_string *UIString, const char *NewText)
 {
     i32 NewTextLength = GetNullTerminatedStringLength(NewText);
-    Assert(NewTextLength <= UIString.StringLength);
+    Assert(NewTextLength <= UIString->StringLength);
 
     // NOTE: Do not want to update text length in UIString, because the buffer is capable of holding
     //       the same length of strings throughout its lifetime.
-    PrepareRenderDataForString(NewText, NewTextLength, UIString.StringLength, UIString.FontInfo,
-                               UIString.XPos, UIString.YPos, UIString.ScreenWidth, UIString.ScreenHeight, 0,
-                               UIString.Positions, UIString.UVs);
-
-    glBindBuffer(GL_ARRAY_BUFFER, UIString.VBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, UIString.PositionsBufferSize, UIString.Positions);
-    glBufferSubData(GL_ARRAY_BUFFER, UIString.PositionsBufferSize, UIString.UVsBufferSize, UIString.UVs);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    PrepareRenderDataForString(NewText, NewTextLength, UIString->StringLength, UIString->FontInfo,
+                               UIString->XPos, UIString->YPos, UIString->ScreenWidth, UIString->ScreenHeight, 0,
+                               UIString->Positions, UIString->UVs);
+
+    // NOTE: Rewriting VBO could stall on draws still reading it; RenderUIString streams the new
+    //       vertices instead
+    UIString->IsDynamic = true;
+    UIString->StreamedFrame = 0;
+}
+
+void
+FreeFontInfoAndUnloadFromGPU(font_info *FontInfo)
+{
+    if (FontInfo)
+    {
+        DeleteTexture(&FontInfo->AtlasGLID);
+        free(FontInfo);
+    }
+}
+
+void
+UnloadUIStringFromGPU(ui_string UIString)
+{
+    DeleteBuffer(&UIString.VBO);
+    DeleteVertexArray(&UIString.VAO);
+    free(UIString.Positions);
+    free(UIString.UVs);
 }
 
 void
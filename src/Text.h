@@ -42,6 +42,10 @@ struct ui_string
 
     u32 VAO;
     u32 VBO;
+    // NOTE: Set by the first UpdateUIString. From then on the string is streamed from Positions
+    //       and UVs in each frame it's rendered, instead of drawn from VBO.
+    bool IsDynamic;
+    u64 StreamedFrame;
 
     size_t PositionsBufferSize;
     f32 *Positions;
@@ -62,18 +66,17 @@ PrepareRenderDataForString(const char *String, i32 StringLength, i32 OldStringLe
                            f32 *Out_Positions, f32 *Out_UVs);
 
 void
-RenderUIString(ui_string UIString);
+RenderUIString(ui_string *UIString);
 
 void
-UpdateUIString(ui_string UIString, const char *NewText);
+UpdateUIString(ui_string *UIString, const char *NewText);
 
-// TODO:
-//void
-//FreeFontInfoAndUnloadFromGPU(font_info *FontInfo);
+// NOTE: Strings prepared with the font can't be rendered after this
+void
+FreeFontInfoAndUnloadFromGPU(font_info *FontInfo);
 
-// TODO:
-//void
-//UnloadUIStringFromGPU(ui_string UIString);
+void
+UnloadUIStringFromGPU(ui_string UIString);
 
 void
 CalculateUIStringOffsetPosition(i32 XPos, i32 YPos, const char *OffsetColsByString, i32 OffsetRows,
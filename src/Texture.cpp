@@ -0,0 +1,2006 @@
+#include "Texture.h"
+
+#include <glad/glad.h>
+#include <SDL2/SDL.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+#include "BlockCompression.h"
+#include "GLState.h"
+#include "Hash.h"
+#include "ImageProcessing.h"
+#include "Jobs.h"
+
+// NOTE: Cook textures that have no up-to-date cooked file when they're decoded. Same as with
+//       models; builds that only ship cooked data can turn it off.
+#ifndef TEXTURE_COOK_ON_LOAD
+#define TEXTURE_COOK_ON_LOAD 1
+#endif
+
+// NOTE: S3TC isn't core in 3.3, but every desktop driver exposes EXT_texture_compression_s3tc
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+struct texture_stream_request;
+
+// NOTE: Keyed by the content hash of the source file, so the same image under different paths is
+//       one texture; Path is the first one it was loaded from. Entries are never removed. An
+//       evicted texture keeps its entry and interned path with TextureID 0, so the registry only
+//       grows with the number of distinct images ever loaded.
+struct texture_entry
+{
+    const char *Path;
+    u64 ContentHash;
+    u32 TextureID;
+    i32 RefCount;
+    u64 ResidentBytes;
+
+    // NOTE: Set while the texture is being streamed, so RequestTextureMip can find its stream
+    texture_stream_request *Stream;
+
+    // NOTE: Links in the eviction list, -1 at the ends or when not in it
+    i32 LRUPrev;
+    i32 LRUNext;
+};
+
+#define TEXTURE_PATH_BLOCK_SIZE (64 * 1024)
+struct texture_path_block
+{
+    texture_path_block *Next;
+    i32 Used;
+    char Chars[TEXTURE_PATH_BLOCK_SIZE];
+};
+
+struct texture_registry
+{
+    i32 EntryCount;
+    i32 EntryCapacity;
+    texture_entry *Entries;
+
+    // NOTE: Open addressing with linear probing; a slot holds an entry index + 1, 0 is empty.
+    //       SlotCount is a power of two and kept over twice the entry count.
+    u32 SlotCount;
+    i32 *ContentSlots;
+    i32 *IDSlots;
+
+    // NOTE: Resident textures without references, least recently released at the head
+    i32 LRUHead = -1;
+    i32 LRUTail = -1;
+
+    texture_path_block *PathBlocks;
+
+    i32 ResidentTextureCount;
+    u64 ResidentBytes;
+    u64 BudgetBytes = DEFAULT_TEXTURE_MEMORY_BUDGET;
+
+    i32 SharedLoadCount;
+};
+
+static texture_registry TextureRegistry;
+
+// NOTE: GL 3.3 has no persistent mapping and a buffer can't be a copy source while it's mapped, so
+//       the staging ring is a ring of PBOs: a slot stays mapped while a worker copies one mip
+//       level into it, is unmapped for the upload and then fenced. Allocation wraps around and
+//       waits (returns nothing this frame) for the fence of the slot it lands on.
+#define TEXTURE_STREAM_SLOT_COUNT 8
+#define TEXTURE_STREAM_SLOT_SIZE (4 * 1024 * 1024)
+// NOTE: Streams of cooked textures stay around for as long as the texture is referenced, so this
+//       also caps how many textures can have their mips streamed on demand. Past it LoadTextureAsync
+//       falls back to LoadTexture.
+#define MAX_TEXTURE_STREAM_REQUESTS 1024
+
+// NOTE: Cooked textures are made resident down to the first level that's at most this big and
+//       never dropped below it; finer levels are only streamed when RequestTextureMip asks for them
+#define TEXTURE_STREAM_RESIDENT_SIZE 128
+// NOTE: Frames without a RequestTextureMip before a texture goes back to its resident levels
+#define TEXTURE_STREAM_IDLE_FRAMES 120
+
+enum texture_stream_state
+{
+    TEXTURE_STREAM_DECODING,
+    // NOTE: Nothing in flight. Raw images never come back here; cooked textures wait here for
+    //       their target level to change.
+    TEXTURE_STREAM_IDLE,
+    // NOTE: Level is waiting for a free staging slot
+    TEXTURE_STREAM_WAITING,
+    TEXTURE_STREAM_COPYING,
+    TEXTURE_STREAM_COPIED,
+    TEXTURE_STREAM_FAILED,
+};
+
+struct texture_stream_slot
+{
+    u32 PBO;
+    u32 Size;
+    bool IsMapped;
+    // NOTE: 0 once the last upload from this slot has finished
+    GLsync Fence;
+};
+
+struct texture_stream_request
+{
+    char Path[MAX_PATH_LENGTH];
+    u32 TextureID;
+    bool GenerateMipmap;
+
+    // NOTE: Written by a worker before State changes
+    texture_data Data;
+    // NOTE: Next level to upload; cooked textures count down from their coarsest level
+    i32 Level;
+
+    // NOTE: Finest level in GL (MAX_TEXTURE_MIP_COUNT while only the placeholder is) and the
+    //       coarsest one that's always kept there. FloorLevel is set by the decode job.
+    i32 ResidentLevel;
+    i32 FloorLevel;
+
+    // NOTE: Cooked textures only, GL thread only. Finest footprint asked for since the last
+    //       ProcessTextureStreaming (0 if none), the level that turned into and the level the
+    //       stream is headed for once the budget is applied.
+    f32 RequestedUVsPerPixel;
+    u32 LastRequestFrame;
+    i32 WantedLevel;
+    i32 TargetLevel;
+
+    i32 SlotIndex;
+    u8 *Staging;
+    SDL_atomic_t State;
+};
+
+struct texture_streamer
+{
+    job_queue *Queue;
+
+    texture_stream_slot Slots[TEXTURE_STREAM_SLOT_COUNT];
+    i32 NextSlot;
+
+    // NOTE: In request order; only touched on the GL thread
+    i32 RequestCount;
+    texture_stream_request *Requests[MAX_TEXTURE_STREAM_REQUESTS];
+
+    u32 FrameIndex;
+    i32 MipBias;
+    u64 StreamedBytes;
+    u64 BudgetBytes = DEFAULT_TEXTURE_STREAMING_BUDGET;
+};
+
+static texture_streamer TextureStreamer;
+
+static u32
+AcquireResidentTexture(const char *Path);
+static void
+RegisterTexture(const char *Path, u32 TextureID, u64 ResidentBytes);
+static u64
+GetTextureContentHash(const char *Path);
+static i32
+FindTextureEntryByContent(u64 ContentHash);
+static i32
+FindTextureEntryByID(u32 TextureID);
+static i32
+AddTextureEntry(const char *Path, u64 ContentHash);
+static void
+GrowTextureSlots();
+static void
+InsertTextureIDSlot(i32 EntryIndex);
+static void
+RemoveTextureIDSlot(u32 TextureID);
+static u32
+HashTextureID(u32 TextureID);
+static const char *
+InternTexturePath(const char *Path, i32 PathCount);
+static void
+LinkTextureLRU(i32 EntryIndex);
+static void
+UnlinkTextureLRU(i32 EntryIndex);
+static void
+EvictTexturesOverBudget();
+static u64
+EstimateTextureBytes(i32 Width, i32 Height, i32 ComponentCount, bool GenerateMipmap);
+static void
+UpdateTextureResidentBytes(u32 TextureID, u64 ResidentBytes);
+
+static texture_stream_request *
+STREAM_AddRequest(const char *Path, u32 TextureID, bool GenerateMipmap, i32 ResidentLevel);
+static void
+STREAM_FinishRequest(texture_stream_request *Request);
+static void
+STREAM_UpdateTargetLevels();
+static u64
+STREAM_GetChainBytes(texture_stream_request *Request, i32 FirstLevel);
+static void
+STREAM_UpdateResidentBytes(texture_stream_request *Request);
+static i32
+STREAM_AcquireSlot(u32 Size);
+static u32
+STREAM_GetLevelSize(texture_stream_request *Request);
+static bool
+STREAM_UploadLevel(texture_stream_request *Request);
+static void
+STREAM_DropLevels(texture_stream_request *Request, i32 FirstKeptLevel);
+static void
+STREAM_DecodeJob(void *Data);
+static void
+STREAM_CopyLevelJob(void *Data);
+
+static bool
+DDS_MapCookedTexture(const char *SourcePath, texture_data *Out_TextureData);
+static bool
+DDS_MapTexture(const char *CookedPath, const char *SourcePath, texture_data *Out_TextureData);
+static bool
+DDS_WriteTexture(const char *CookedPath, u64 SourceSize, u64 SourceModificationTime,
+                 u32 FourCC, i32 Width, i32 Height, i32 MipCount, const u8 *Blocks, size_t BlocksSize);
+static void
+DDS_GetSourceStamp(const char *SourcePath, u64 *Out_Size, u64 *Out_ModificationTime);
+static u8 *
+LoadImageFile(const char *Path, int *Out_Width, int *Out_Height, int *Out_ComponentCount, int DesiredComponentCount);
+static bool
+IsNormalMapImage(const char *Path, const u8 *Pixels, i32 Width, i32 Height);
+static void
+BuildRawMipChain(texture_data *TextureData, bool GenerateMipmap);
+
+// ------------------------
+// TEXTURE LOADING --------
+// ------------------------
+
+// TODO: STBI is too slow; switch back to SDL image
+u32
+LoadTexture(const char *Path, bool GenerateMipmap)
+{
+    u32 TextureID = AcquireResidentTexture(Path);
+    if (TextureID > 0)
+    {
+        return TextureID;
+    }
+
+    texture_data TextureData;
+    if (DecodeTexture(Path, GenerateMipmap, &TextureData))
+    {
+        TextureID = UploadTexture(&TextureData, GenerateMipmap);
+    }
+
+    return TextureID;
+}
+
+bool
+DecodeTexture(const char *Path, bool GenerateMipmap, texture_data *Out_TextureData)
+{
+    *Out_TextureData = { };
+    strncpy_s(Out_TextureData->Path, Path, MAX_PATH_LENGTH - 1);
+
+    // NOTE: Only so the content hash is cached by the time UploadTexture looks the texture up on
+    //       the GL thread
+    GetFileContentHash(Path);
+
+    if (DDS_MapCookedTexture(Path, Out_TextureData))
+    {
+        return true;
+    }
+
+    int Width, Height, ComponentCount;
+    u8 *Pixels = LoadImageFile(Path, &Width, &Height, &ComponentCount, 0);
+    if (!Pixels)
+    {
+        fprintf(stderr, "Texture failed to load at path: %s\n", Path);
+        return false;
+    }
+
+    if (ComponentCount != 1 && ComponentCount != 3 && ComponentCount != 4)
+    {
+        fprintf(stderr, "Unknown texture format at path: %s\n", Path);
+        stbi_image_free(Pixels);
+        return false;
+    }
+
+    Out_TextureData->Width = Width;
+    Out_TextureData->Height = Height;
+    Out_TextureData->ComponentCount = ComponentCount;
+    Out_TextureData->Pixels = Pixels;
+    Out_TextureData->MipCount = 1;
+    Out_TextureData->MipData[0] = Pixels;
+    Out_TextureData->MipSizes[0] = (u32) ((size_t) Width * Height * ComponentCount);
+
+    // NOTE: Single channel images keep the driver's mips; the CPU filters only work on RGBA
+    if (ComponentCount == 3 || (GenerateMipmap && ComponentCount == 4))
+    {
+        BuildRawMipChain(Out_TextureData, GenerateMipmap);
+    }
+
+    return true;
+}
+
+u32
+UploadTexture(texture_data *TextureData, bool GenerateMipmap)
+{
+    // NOTE: Something else might have loaded the same texture since this one was decoded
+    u32 TextureID = AcquireResidentTexture(TextureData->Path);
+    if (TextureID > 0 || (!TextureData->Pixels && !TextureData->CompressedFormat))
+    {
+        FreeTextureData(TextureData);
+        return TextureID;
+    }
+
+    glGenTextures(1, &TextureID);
+    BindTexture2D(0, TextureID);
+
+    u64 ResidentBytes = 0;
+    bool HasMipmaps;
+    if (TextureData->CompressedFormat)
+    {
+        // NOTE: Cooked textures bring their own mip chain, GenerateMipmap doesn't matter
+        i32 MipWidth = TextureData->Width;
+        i32 MipHeight = TextureData->Height;
+        for (i32 MipIndex = 0; MipIndex < TextureData->MipCount; ++MipIndex)
+        {
+            glCompressedTexImage2D(GL_TEXTURE_2D, MipIndex, TextureData->CompressedFormat,
+                                   MipWidth, MipHeight, 0,
+                                   TextureData->MipSizes[MipIndex], TextureData->MipData[MipIndex]);
+            ResidentBytes += TextureData->MipSizes[MipIndex];
+            MipWidth = (MipWidth > 1) ? MipWidth / 2 : 1;
+            MipHeight = (MipHeight > 1) ? MipHeight / 2 : 1;
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, TextureData->MipCount - 1);
+        HasMipmaps = (TextureData->MipCount > 1);
+    }
+    else
+    {
+        GLenum Format;
+        if (TextureData->ComponentCount == 1)
+        {
+            Format = GL_RED;
+        }
+        else if (TextureData->ComponentCount == 3)
+        {
+            Format = GL_RGB;
+        }
+        else
+        {
+            Format = GL_RGBA;
+        }
+
+        // NOTE: Single channel rows (and the mips of any image) aren't always 4 byte aligned
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        if (TextureData->MipCount > 1)
+        {
+            i32 MipWidth = TextureData->Width;
+            i32 MipHeight = TextureData->Height;
+            for (i32 MipIndex = 0; MipIndex < TextureData->MipCount; ++MipIndex)
+            {
+                glTexImage2D(GL_TEXTURE_2D, MipIndex, Format, MipWidth, MipHeight, 0,
+                             Format, GL_UNSIGNED_BYTE, TextureData->MipData[MipIndex]);
+                MipWidth = (MipWidth > 1) ? MipWidth / 2 : 1;
+                MipHeight = (MipHeight > 1) ? MipHeight / 2 : 1;
+            }
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, TextureData->MipCount - 1);
+            HasMipmaps = true;
+        }
+        else
+        {
+            glTexImage2D(GL_TEXTURE_2D, 0, Format, TextureData->Width, TextureData->Height, 0,
+                         Format, GL_UNSIGNED_BYTE, TextureData->Pixels);
+            if (GenerateMipmap)
+            {
+                glGenerateMipmap(GL_TEXTURE_2D);
+            }
+            HasMipmaps = GenerateMipmap;
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        ResidentBytes = EstimateTextureBytes(TextureData->Width, TextureData->Height,
+                                             TextureData->ComponentCount, HasMipmaps);
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    if (HasMipmaps)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    }
+    else
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    CountUploadedBytes(ResidentBytes);
+
+    RegisterTexture(TextureData->Path, TextureID, ResidentBytes);
+
+    FreeTextureData(TextureData);
+    return TextureID;
+}
+
+void
+FreeTextureData(texture_data *TextureData)
+{
+    if (TextureData->Pixels)
+    {
+        stbi_image_free(TextureData->Pixels);
+        TextureData->Pixels = 0;
+    }
+    UnmapFile(&TextureData->CookedFile);
+    TextureData->CompressedFormat = 0;
+    TextureData->MipCount = 0;
+}
+
+// ------------------------
+// TEXTURE STREAMING ------
+// ------------------------
+
+void
+InitializeTextureStreaming(job_queue *Queue)
+{
+    Assert(!TextureStreamer.Queue && Queue);
+    TextureStreamer.Queue = Queue;
+
+    for (i32 SlotIndex = 0; SlotIndex < TEXTURE_STREAM_SLOT_COUNT; ++SlotIndex)
+    {
+        texture_stream_slot *Slot = &TextureStreamer.Slots[SlotIndex];
+        glGenBuffers(1, &Slot->PBO);
+        BindBuffer(GL_PIXEL_UNPACK_BUFFER, Slot->PBO);
+        BufferData(GL_PIXEL_UNPACK_BUFFER, TEXTURE_STREAM_SLOT_SIZE, 0, GL_STREAM_DRAW);
+        Slot->Size = TEXTURE_STREAM_SLOT_SIZE;
+    }
+    BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void
+ShutdownTextureStreaming()
+{
+    if (!TextureStreamer.Queue)
+    {
+        return;
+    }
+
+    for (i32 RequestIndex = 0; RequestIndex < TextureStreamer.RequestCount; ++RequestIndex)
+    {
+        STREAM_FinishRequest(TextureStreamer.Requests[RequestIndex]);
+    }
+    TextureStreamer.RequestCount = 0;
+
+    for (i32 SlotIndex = 0; SlotIndex < TEXTURE_STREAM_SLOT_COUNT; ++SlotIndex)
+    {
+        texture_stream_slot *Slot = &TextureStreamer.Slots[SlotIndex];
+        if (Slot->IsMapped)
+        {
+            BindBuffer(GL_PIXEL_UNPACK_BUFFER, Slot->PBO);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        if (Slot->Fence)
+        {
+            glDeleteSync(Slot->Fence);
+        }
+        DeleteBuffer(&Slot->PBO);
+    }
+
+    u64 BudgetBytes = TextureStreamer.BudgetBytes;
+    TextureStreamer = { };
+    TextureStreamer.BudgetBytes = BudgetBytes;
+}
+
+bool
+IsTextureStreamingActive()
+{
+    return (TextureStreamer.Queue != 0);
+}
+
+u32
+LoadTextureAsync(const char *Path, bool GenerateMipmap)
+{
+    if (!TextureStreamer.Queue || TextureStreamer.RequestCount >= MAX_TEXTURE_STREAM_REQUESTS)
+    {
+        return LoadTexture(Path, GenerateMipmap);
+    }
+
+    u32 TextureID = AcquireResidentTexture(Path);
+    if (TextureID > 0)
+    {
+        // NOTE: A cooked texture whose stream was finished while it wasn't referenced keeps the
+        //       levels it had then; stream the rest again from there
+        i32 EntryIndex = FindTextureEntryByID(TextureID);
+        if (!TextureRegistry.Entries[EntryIndex].Stream)
+        {
+            GLint BaseLevel = 0;
+            BindTexture2D(0, TextureID);
+            glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, &BaseLevel);
+            if (BaseLevel > 0)
+            {
+                STREAM_AddRequest(Path, TextureID, GenerateMipmap, BaseLevel);
+            }
+        }
+        return TextureID;
+    }
+
+    // NOTE: Same grey as the placeholder mesh; MAX_LEVEL 0 keeps it complete with any filter
+    u8 GreyPixel[] = { 128, 128, 128, 255 };
+    glGenTextures(1, &TextureID);
+    BindTexture2D(0, TextureID);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, GreyPixel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+    RegisterTexture(Path, TextureID, sizeof(GreyPixel));
+    STREAM_AddRequest(Path, TextureID, GenerateMipmap, MAX_TEXTURE_MIP_COUNT);
+
+    return TextureID;
+}
+
+void
+RequestTextureMip(u32 TextureID, f32 UVsPerPixel)
+{
+    i32 EntryIndex = FindTextureEntryByID(TextureID);
+    if (EntryIndex < 0 || UVsPerPixel <= 0.0f)
+    {
+        return;
+    }
+
+    texture_stream_request *Request = TextureRegistry.Entries[EntryIndex].Stream;
+    if (Request && (Request->RequestedUVsPerPixel == 0.0f || UVsPerPixel < Request->RequestedUVsPerPixel))
+    {
+        Request->RequestedUVsPerPixel = UVsPerPixel;
+    }
+}
+
+void
+SetTextureStreamingBudget(u64 BudgetBytes)
+{
+    TextureStreamer.BudgetBytes = BudgetBytes;
+}
+
+void
+ProcessTextureStreaming()
+{
+    if (!TextureStreamer.Queue)
+    {
+        return;
+    }
+
+    for (i32 SlotIndex = 0; SlotIndex < TEXTURE_STREAM_SLOT_COUNT; ++SlotIndex)
+    {
+        texture_stream_slot *Slot = &TextureStreamer.Slots[SlotIndex];
+        if (Slot->Fence)
+        {
+            GLenum WaitResult = glClientWaitSync(Slot->Fence, 0, 0);
+            if (WaitResult == GL_ALREADY_SIGNALED || WaitResult == GL_CONDITION_SATISFIED)
+            {
+                glDeleteSync(Slot->Fence);
+                Slot->Fence = 0;
+            }
+        }
+    }
+
+    STREAM_UpdateTargetLevels();
+
+    i32 RemainingCount = 0;
+    for (i32 RequestIndex = 0; RequestIndex < TextureStreamer.RequestCount; ++RequestIndex)
+    {
+        texture_stream_request *Request = TextureStreamer.Requests[RequestIndex];
+        bool IsCooked = (Request->Data.CompressedFormat != 0);
+        bool IsDone = false;
+
+        i32 State = SDL_AtomicGet(&Request->State);
+        if (State == TEXTURE_STREAM_FAILED)
+        {
+            fprintf(stderr, "Couldn't stream %s, keeping the placeholder\n", Request->Path);
+            IsDone = true;
+        }
+        else if (State == TEXTURE_STREAM_COPIED)
+        {
+            if (STREAM_UploadLevel(Request))
+            {
+                Request->ResidentLevel = Request->Level;
+                STREAM_UpdateResidentBytes(Request);
+
+                if (!IsCooked)
+                {
+                    IsDone = true;
+                }
+                else if (Request->Level > Request->TargetLevel)
+                {
+                    --Request->Level;
+                    State = TEXTURE_STREAM_WAITING;
+                }
+                else
+                {
+                    State = TEXTURE_STREAM_IDLE;
+                }
+            }
+            else
+            {
+                State = TEXTURE_STREAM_WAITING;
+            }
+            SDL_AtomicSet(&Request->State, State);
+        }
+        else if (State == TEXTURE_STREAM_IDLE)
+        {
+            i32 EntryIndex = FindTextureEntryByID(Request->TextureID);
+            if (!IsCooked)
+            {
+                // NOTE: Raw images go up in one piece
+                Request->Level = 0;
+                State = TEXTURE_STREAM_WAITING;
+            }
+            else if (TextureRegistry.Entries[EntryIndex].RefCount <= 1 &&
+                     Request->ResidentLevel <= Request->FloorLevel)
+            {
+                // NOTE: Only the stream's own reference is left. The texture keeps the levels it has
+                //       and waits to be evicted or loaded again like any other.
+                IsDone = true;
+            }
+            else if (Request->TargetLevel < Request->ResidentLevel)
+            {
+                Request->Level = Request->ResidentLevel - 1;
+                State = TEXTURE_STREAM_WAITING;
+            }
+            else if (Request->TargetLevel > Request->ResidentLevel)
+            {
+                // NOTE: A texture still in use keeps one level over its target while there's room in
+                //       the budget, so one that sits at a level boundary doesn't keep reloading it
+                bool IsInUse = (TextureStreamer.FrameIndex - Request->LastRequestFrame <= TEXTURE_STREAM_IDLE_FRAMES);
+                i32 FirstKeptLevel = Request->TargetLevel;
+                if (IsInUse && TextureStreamer.MipBias == 0)
+                {
+                    --FirstKeptLevel;
+                }
+                if (FirstKeptLevel > Request->ResidentLevel)
+                {
+                    STREAM_DropLevels(Request, FirstKeptLevel);
+                }
+            }
+            SDL_AtomicSet(&Request->State, State);
+        }
+
+        if (State == TEXTURE_STREAM_WAITING)
+        {
+            u32 LevelSize = STREAM_GetLevelSize(Request);
+            i32 SlotIndex = STREAM_AcquireSlot(LevelSize);
+            if (SlotIndex >= 0)
+            {
+                BindBuffer(GL_PIXEL_UNPACK_BUFFER, TextureStreamer.Slots[SlotIndex].PBO);
+                Request->Staging = (u8 *) glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, LevelSize,
+                                                           GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT |
+                                                           GL_MAP_UNSYNCHRONIZED_BIT);
+                BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+                if (Request->Staging)
+                {
+                    TextureStreamer.Slots[SlotIndex].IsMapped = true;
+                    Request->SlotIndex = SlotIndex;
+                    SDL_AtomicSet(&Request->State, TEXTURE_STREAM_COPYING);
+                    AddJob(TextureStreamer.Queue, STREAM_CopyLevelJob, Request);
+                }
+            }
+        }
+
+        if (IsDone)
+        {
+            STREAM_FinishRequest(Request);
+        }
+        else
+        {
+            TextureStreamer.Requests[RemainingCount++] = Request;
+        }
+    }
+
+    TextureStreamer.RequestCount = RemainingCount;
+}
+
+i32
+GetPendingTextureStreamCount()
+{
+    i32 PendingCount = 0;
+    for (i32 RequestIndex = 0; RequestIndex < TextureStreamer.RequestCount; ++RequestIndex)
+    {
+        // NOTE: Idle requests that were just decoded still have their first levels to load
+        texture_stream_request *Request = TextureStreamer.Requests[RequestIndex];
+        if (SDL_AtomicGet(&Request->State) != TEXTURE_STREAM_IDLE ||
+            !Request->Data.CompressedFormat || Request->TargetLevel < Request->ResidentLevel)
+        {
+            ++PendingCount;
+        }
+    }
+
+    return PendingCount;
+}
+
+// ------------------------
+// TEXTURE COOKING --------
+// ------------------------
+
+void
+GetCookedTexturePath(const char *SourcePath, char *Out_CookedPath, i32 CookedPathBufferSize)
+{
+    char SourcePathOnStack[MAX_PATH_LENGTH];
+    strncpy_s(SourcePathOnStack, SourcePath, MAX_PATH_LENGTH - 1);
+    char Extension[] = COOKED_TEXTURE_EXTENSION;
+    CatStrings(SourcePathOnStack, GetNullTerminatedStringLength(SourcePathOnStack),
+               Extension, GetNullTerminatedStringLength(Extension),
+               Out_CookedPath, CookedPathBufferSize);
+}
+
+bool
+CookTexture(const char *SourcePath, const char *CookedPath)
+{
+    printf("Cooking texture: %s -> %s\n", SourcePath, CookedPath);
+
+    // NOTE: Stamped before the read, so a source that changes while it's cooked is cooked again
+    u64 SourceSize;
+    u64 SourceModificationTime;
+    DDS_GetSourceStamp(SourcePath, &SourceSize, &SourceModificationTime);
+
+    // NOTE: Always expanded to RGBA; ComponentCount is still what the file has
+    int Width, Height, ComponentCount;
+    u8 *Pixels = LoadImageFile(SourcePath, &Width, &Height, &ComponentCount, 4);
+    if (!Pixels)
+    {
+        fprintf(stderr, "Texture failed to load at path: %s\n", SourcePath);
+        return false;
+    }
+
+    // Pick the block format
+    // ---------------------
+    bool HasAlpha = false;
+    if (ComponentCount == 2 || ComponentCount == 4)
+    {
+        for (size_t PixelIndex = 0; PixelIndex < (size_t) Width * Height; ++PixelIndex)
+        {
+            if (Pixels[PixelIndex * 4 + 3] < 255)
+            {
+                HasAlpha = true;
+                break;
+            }
+        }
+    }
+
+    bool IsNormalMap = (ComponentCount >= 3 && !HasAlpha &&
+                        IsNormalMapImage(SourcePath, Pixels, Width, Height));
+
+    block_compression_format Format;
+    u32 FourCC;
+    if (IsNormalMap)
+    {
+        Format = BLOCK_COMPRESSION_BC5;
+        FourCC = DDS_FOURCC_ATI2;
+    }
+    else if (HasAlpha)
+    {
+        Format = BLOCK_COMPRESSION_BC3;
+        FourCC = DDS_FOURCC_DXT5;
+    }
+    else if (ComponentCount == 1)
+    {
+        Format = BLOCK_COMPRESSION_BC4;
+        FourCC = DDS_FOURCC_ATI1;
+    }
+    else
+    {
+        Format = BLOCK_COMPRESSION_BC1;
+        FourCC = DDS_FOURCC_DXT1;
+    }
+
+    // NOTE: Color is filtered in linear light; single channel images are usually data (roughness,
+    //       height, ...) so they're filtered as is
+    u32 Flags = 0;
+    if (IsNormalMap)
+    {
+        Flags = IMAGE_NORMAL_MAP;
+        RenormalizeNormalMap(Pixels, (size_t) Width * Height);
+    }
+    else if (ComponentCount >= 3)
+    {
+        Flags = IMAGE_SRGB;
+    }
+    if (HasAlpha)
+    {
+        Flags |= IMAGE_ALPHA_WEIGHTED;
+    }
+
+    // Compress the mip chain
+    // ----------------------
+    i32 MipCount = 1;
+    size_t BlocksSize = GetCompressedImageSize(Format, Width, Height);
+    for (i32 MipWidth = Width, MipHeight = Height;
+         (MipWidth > 1 || MipHeight > 1) && MipCount < MAX_TEXTURE_MIP_COUNT;
+         ++MipCount)
+    {
+        MipWidth = (MipWidth > 1) ? MipWidth / 2 : 1;
+        MipHeight = (MipHeight > 1) ? MipHeight / 2 : 1;
+        BlocksSize += GetCompressedImageSize(Format, MipWidth, MipHeight);
+    }
+
+    u8 *Blocks = (u8 *) malloc(BlocksSize);
+    Assert(Blocks);
+
+    u8 *MipPixels = Pixels;
+    i32 MipWidth = Width;
+    i32 MipHeight = Height;
+    size_t BlocksOffset = 0;
+    for (i32 MipIndex = 0; MipIndex < MipCount; ++MipIndex)
+    {
+        CompressImage(Format, MipPixels, MipWidth, MipHeight, Blocks + BlocksOffset);
+        BlocksOffset += GetCompressedImageSize(Format, MipWidth, MipHeight);
+
+        if (MipIndex + 1 < MipCount)
+        {
+            i32 NextWidth = (MipWidth > 1) ? MipWidth / 2 : 1;
+            i32 NextHeight = (MipHeight > 1) ? MipHeight / 2 : 1;
+            u8 *NextPixels = (u8 *) malloc((size_t) NextWidth * NextHeight * 4);
+            Assert(NextPixels);
+            DownsampleImage(MipPixels, MipWidth, MipHeight, IMAGE_FILTER_KAISER, Flags, NextPixels);
+
+            if (MipPixels != Pixels)
+            {
+                free(MipPixels);
+            }
+            MipPixels = NextPixels;
+            MipWidth = NextWidth;
+            MipHeight = NextHeight;
+        }
+    }
+    if (MipPixels != Pixels)
+    {
+        free(MipPixels);
+    }
+    stbi_image_free(Pixels);
+
+    bool Success = DDS_WriteTexture(CookedPath, SourceSize, SourceModificationTime,
+                                    FourCC, Width, Height, MipCount, Blocks, BlocksSize);
+    free(Blocks);
+
+    return Success;
+}
+
+// ------------------------
+// TEXTURE REGISTRY -------
+// ------------------------
+
+void
+RetainTexture(u32 TextureID)
+{
+    i32 EntryIndex = FindTextureEntryByID(TextureID);
+    if (EntryIndex < 0)
+    {
+        return;
+    }
+
+    texture_entry *Entry = &TextureRegistry.Entries[EntryIndex];
+    if (Entry->RefCount == 0)
+    {
+        UnlinkTextureLRU(EntryIndex);
+    }
+    ++Entry->RefCount;
+}
+
+void
+ReleaseTexture(u32 TextureID)
+{
+    i32 EntryIndex = FindTextureEntryByID(TextureID);
+    if (EntryIndex < 0)
+    {
+        return;
+    }
+
+    texture_entry *Entry = &TextureRegistry.Entries[EntryIndex];
+    Assert(Entry->RefCount > 0);
+    if (--Entry->RefCount == 0)
+    {
+        LinkTextureLRU(EntryIndex);
+        EvictTexturesOverBudget();
+    }
+}
+
+void
+SetTextureMemoryBudget(u64 BudgetBytes)
+{
+    TextureRegistry.BudgetBytes = BudgetBytes;
+    EvictTexturesOverBudget();
+}
+
+u64
+GetTextureResidentBytes(u32 TextureID)
+{
+    i32 EntryIndex = FindTextureEntryByID(TextureID);
+    return (EntryIndex >= 0) ? TextureRegistry.Entries[EntryIndex].ResidentBytes : 0;
+}
+
+texture_memory_stats
+GetTextureMemoryStats()
+{
+    texture_memory_stats Stats{ };
+    Stats.ResidentTextureCount = TextureRegistry.ResidentTextureCount;
+    Stats.ResidentBytes = TextureRegistry.ResidentBytes;
+    Stats.BudgetBytes = TextureRegistry.BudgetBytes;
+    Stats.StreamedBytes = TextureStreamer.StreamedBytes;
+    Stats.StreamingBudgetBytes = TextureStreamer.BudgetBytes;
+    Stats.StreamingMipBias = TextureStreamer.MipBias;
+    Stats.SharedLoadCount = TextureRegistry.SharedLoadCount;
+    for (i32 EntryIndex = 0; EntryIndex < TextureRegistry.EntryCount; ++EntryIndex)
+    {
+        if (TextureRegistry.Entries[EntryIndex].RefCount > 0)
+        {
+            ++Stats.ReferencedTextureCount;
+        }
+        if (TextureRegistry.Entries[EntryIndex].Stream)
+        {
+            ++Stats.StreamedTextureCount;
+        }
+    }
+
+    return Stats;
+}
+
+void
+PrintTextureMemoryReport()
+{
+    texture_memory_stats Stats = GetTextureMemoryStats();
+    printf("Textures: %d resident (%d referenced), %.2f / %.2f MB, %d load(s) shared by content\n",
+           Stats.ResidentTextureCount, Stats.ReferencedTextureCount,
+           (f64) Stats.ResidentBytes / (1024.0 * 1024.0), (f64) Stats.BudgetBytes / (1024.0 * 1024.0),
+           Stats.SharedLoadCount);
+    printf("Streamed: %d textures, %.2f / %.2f MB, mip bias %d\n",
+           Stats.StreamedTextureCount, (f64) Stats.StreamedBytes / (1024.0 * 1024.0),
+           (f64) Stats.StreamingBudgetBytes / (1024.0 * 1024.0), Stats.StreamingMipBias);
+
+    for (i32 EntryIndex = 0; EntryIndex < TextureRegistry.EntryCount; ++EntryIndex)
+    {
+        texture_entry *Entry = &TextureRegistry.Entries[EntryIndex];
+        if (Entry->TextureID > 0)
+        {
+            printf("  %4u %9.2f KB  refs %3d  %s\n", Entry->TextureID,
+                   (f64) Entry->ResidentBytes / 1024.0, Entry->RefCount, Entry->Path);
+        }
+    }
+}
+
+// ----------------------------
+// INTERNAL HELPERS -----------
+// ----------------------------
+
+// Texture registry
+// ----------------
+
+// NOTE: Takes a reference if the texture at Path, or one with the same contents, is resident;
+//       returns 0 otherwise
+static u32
+AcquireResidentTexture(const char *Path)
+{
+    i32 EntryIndex = FindTextureEntryByContent(GetTextureContentHash(Path));
+    if (EntryIndex < 0 || TextureRegistry.Entries[EntryIndex].TextureID == 0)
+    {
+        return 0;
+    }
+
+    texture_entry *Entry = &TextureRegistry.Entries[EntryIndex];
+    if (Entry->RefCount == 0)
+    {
+        UnlinkTextureLRU(EntryIndex);
+    }
+    ++Entry->RefCount;
+    if (strncmp(Entry->Path, Path, MAX_PATH_LENGTH - 1) != 0)
+    {
+        ++TextureRegistry.SharedLoadCount;
+    }
+
+    return Entry->TextureID;
+}
+
+static void
+RegisterTexture(const char *Path, u32 TextureID, u64 ResidentBytes)
+{
+    u64 ContentHash = GetTextureContentHash(Path);
+    i32 EntryIndex = FindTextureEntryByContent(ContentHash);
+    if (EntryIndex < 0)
+    {
+        EntryIndex = AddTextureEntry(Path, ContentHash);
+    }
+
+    texture_entry *Entry = &TextureRegistry.Entries[EntryIndex];
+    Assert(Entry->TextureID == 0 && Entry->RefCount == 0);
+    Entry->TextureID = TextureID;
+    Entry->RefCount = 1;
+    Entry->ResidentBytes = ResidentBytes;
+    InsertTextureIDSlot(EntryIndex);
+
+    ++TextureRegistry.ResidentTextureCount;
+    TextureRegistry.ResidentBytes += ResidentBytes;
+
+    EvictTexturesOverBudget();
+}
+
+// NOTE: The source image's bytes. Builds that only ship cooked textures have no source, so the
+//       cooked file stands in (the cooker is deterministic, so equal sources give equal DDS files);
+//       a path with neither only matches itself.
+static u64
+GetTextureContentHash(const char *Path)
+{
+    u64 ContentHash = GetFileContentHash(Path);
+    if (ContentHash == 0)
+    {
+        char CookedPath[MAX_PATH_LENGTH];
+        GetCookedTexturePath(Path, CookedPath, MAX_PATH_LENGTH);
+        ContentHash = GetFileContentHash(CookedPath);
+    }
+    if (ContentHash == 0)
+    {
+        ContentHash = HashBytes64(Path, strnlen(Path, MAX_PATH_LENGTH - 1), 0);
+    }
+
+    return ContentHash;
+}
+
+static i32
+FindTextureEntryByContent(u64 ContentHash)
+{
+    if (TextureRegistry.SlotCount == 0)
+    {
+        return -1;
+    }
+
+    u32 SlotMask = TextureRegistry.SlotCount - 1;
+    for (u32 Slot = (u32) ContentHash & SlotMask; TextureRegistry.ContentSlots[Slot] != 0; Slot = (Slot + 1) & SlotMask)
+    {
+        i32 EntryIndex = TextureRegistry.ContentSlots[Slot] - 1;
+        if (TextureRegistry.Entries[EntryIndex].ContentHash == ContentHash)
+        {
+            return EntryIndex;
+        }
+    }
+
+    return -1;
+}
+
+static i32
+FindTextureEntryByID(u32 TextureID)
+{
+    if (TextureID == 0 || TextureRegistry.SlotCount == 0)
+    {
+        return -1;
+    }
+
+    u32 SlotMask = TextureRegistry.SlotCount - 1;
+    for (u32 Slot = HashTextureID(TextureID) & SlotMask; TextureRegistry.IDSlots[Slot] != 0; Slot = (Slot + 1) & SlotMask)
+    {
+        i32 EntryIndex = TextureRegistry.IDSlots[Slot] - 1;
+        if (TextureRegistry.Entries[EntryIndex].TextureID == TextureID)
+        {
+            return EntryIndex;
+        }
+    }
+
+    return -1;
+}
+
+static i32
+AddTextureEntry(const char *Path, u64 ContentHash)
+{
+    if (TextureRegistry.EntryCount == TextureRegistry.EntryCapacity)
+    {
+        i32 NewCapacity = (TextureRegistry.EntryCapacity > 0) ? TextureRegistry.EntryCapacity * 2 : 64;
+        texture_entry *NewEntries = (texture_entry *) realloc(TextureRegistry.Entries,
+                                                              NewCapacity * sizeof(texture_entry));
+        Assert(NewEntries);
+        TextureRegistry.Entries = NewEntries;
+        TextureRegistry.EntryCapacity = NewCapacity;
+    }
+    if ((u32) (TextureRegistry.EntryCount + 1) * 2 > TextureRegistry.SlotCount)
+    {
+        GrowTextureSlots();
+    }
+
+    i32 EntryIndex = TextureRegistry.EntryCount++;
+    texture_entry *Entry = &TextureRegistry.Entries[EntryIndex];
+    *Entry = { };
+    Entry->Path = InternTexturePath(Path, (i32) strnlen(Path, MAX_PATH_LENGTH - 1));
+    Entry->ContentHash = ContentHash;
+    Entry->LRUPrev = -1;
+    Entry->LRUNext = -1;
+
+    u32 SlotMask = TextureRegistry.SlotCount - 1;
+    u32 Slot = (u32) ContentHash & SlotMask;
+    while (TextureRegistry.ContentSlots[Slot] != 0)
+    {
+        Slot = (Slot + 1) & SlotMask;
+    }
+    TextureRegistry.ContentSlots[Slot] = EntryIndex + 1;
+
+    return EntryIndex;
+}
+
+static void
+GrowTextureSlots()
+{
+    u32 NewSlotCount = (TextureRegistry.SlotCount > 0) ? TextureRegistry.SlotCount * 2 : 128;
+    free(TextureRegistry.ContentSlots);
+    free(TextureRegistry.IDSlots);
+    TextureRegistry.ContentSlots = (i32 *) calloc(NewSlotCount, sizeof(i32));
+    TextureRegistry.IDSlots = (i32 *) calloc(NewSlotCount, sizeof(i32));
+    Assert(TextureRegistry.ContentSlots && TextureRegistry.IDSlots);
+    TextureRegistry.SlotCount = NewSlotCount;
+
+    u32 SlotMask = NewSlotCount - 1;
+    for (i32 EntryIndex = 0; EntryIndex < TextureRegistry.EntryCount; ++EntryIndex)
+    {
+        texture_entry *Entry = &TextureRegistry.Entries[EntryIndex];
+        u32 Slot = (u32) Entry->ContentHash & SlotMask;
+        while (TextureRegistry.ContentSlots[Slot] != 0)
+        {
+            Slot = (Slot + 1) & SlotMask;
+        }
+        TextureRegistry.ContentSlots[Slot] = EntryIndex + 1;
+
+        if (Entry->TextureID > 0)
+        {
+            InsertTextureIDSlot(EntryIndex);
+        }
+    }
+}
+
+static void
+InsertTextureIDSlot(i32 EntryIndex)
+{
+    u32 SlotMask = TextureRegistry.SlotCount - 1;
+    u32 Slot = HashTextureID(TextureRegistry.Entries[EntryIndex].TextureID) & SlotMask;
+    while (TextureRegistry.IDSlots[Slot] != 0)
+    {
+        Slot = (Slot + 1) & SlotMask;
+    }
+    TextureRegistry.IDSlots[Slot] = EntryIndex + 1;
+}
+
+static void
+RemoveTextureIDSlot(u32 TextureID)
+{
+    u32 SlotMask = TextureRegistry.SlotCount - 1;
+    u32 Hole = HashTextureID(TextureID) & SlotMask;
+    while (TextureRegistry.IDSlots[Hole] != 0 &&
+           TextureRegistry.Entries[TextureRegistry.IDSlots[Hole] - 1].TextureID != TextureID)
+    {
+        Hole = (Hole + 1) & SlotMask;
+    }
+    if (TextureRegistry.IDSlots[Hole] == 0)
+    {
+        return;
+    }
+
+    // NOTE: Backward shift instead of tombstones, so probe chains never get longer than needed.
+    //       A following slot moves into the hole unless its home slot lies after the hole.
+    for (u32 Slot = (Hole + 1) & SlotMask; TextureRegistry.IDSlots[Slot] != 0; Slot = (Slot + 1) & SlotMask)
+    {
+        u32 HomeSlot = HashTextureID(TextureRegistry.Entries[TextureRegistry.IDSlots[Slot] - 1].TextureID) & SlotMask;
+        if (((Slot - HomeSlot) & SlotMask) >= ((Slot - Hole) & SlotMask))
+        {
+            TextureRegistry.IDSlots[Hole] = TextureRegistry.IDSlots[Slot];
+            Hole = Slot;
+        }
+    }
+    TextureRegistry.IDSlots[Hole] = 0;
+}
+
+static u32
+HashTextureID(u32 TextureID)
+{
+    // NOTE: GL names are small sequential integers, spread them over the table
+    return (u32) (((u64) TextureID * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+static const char *
+InternTexturePath(const char *Path, i32 PathCount)
+{
+    texture_path_block *Block = TextureRegistry.PathBlocks;
+    if (!Block || Block->Used + PathCount + 1 > TEXTURE_PATH_BLOCK_SIZE)
+    {
+        Block = (texture_path_block *) malloc(sizeof(texture_path_block));
+        Assert(Block);
+        Block->Next = TextureRegistry.PathBlocks;
+        Block->Used = 0;
+        TextureRegistry.PathBlocks = Block;
+    }
+
+    char *Result = Block->Chars + Block->Used;
+    memcpy(Result, Path, PathCount);
+    Result[PathCount] = '\0';
+    Block->Used += PathCount + 1;
+
+    return Result;
+}
+
+static void
+LinkTextureLRU(i32 EntryIndex)
+{
+    texture_entry *Entry = &TextureRegistry.Entries[EntryIndex];
+    Entry->LRUPrev = TextureRegistry.LRUTail;
+    Entry->LRUNext = -1;
+    if (TextureRegistry.LRUTail >= 0)
+    {
+        TextureRegistry.Entries[TextureRegistry.LRUTail].LRUNext = EntryIndex;
+    }
+    else
+    {
+        TextureRegistry.LRUHead = EntryIndex;
+    }
+    TextureRegistry.LRUTail = EntryIndex;
+}
+
+static void
+UnlinkTextureLRU(i32 EntryIndex)
+{
+    texture_entry *Entry = &TextureRegistry.Entries[EntryIndex];
+    if (Entry->LRUPrev >= 0)
+    {
+        TextureRegistry.Entries[Entry->LRUPrev].LRUNext = Entry->LRUNext;
+    }
+    else
+    {
+        TextureRegistry.LRUHead = Entry->LRUNext;
+    }
+    if (Entry->LRUNext >= 0)
+    {
+        TextureRegistry.Entries[Entry->LRUNext].LRUPrev = Entry->LRUPrev;
+    }
+    else
+    {
+        TextureRegistry.LRUTail = Entry->LRUPrev;
+    }
+    Entry->LRUPrev = -1;
+    Entry->LRUNext = -1;
+}
+
+static void
+EvictTexturesOverBudget()
+{
+    while (TextureRegistry.ResidentBytes > TextureRegistry.BudgetBytes && TextureRegistry.LRUHead >= 0)
+    {
+        i32 EntryIndex = TextureRegistry.LRUHead;
+        texture_entry *Entry = &TextureRegistry.Entries[EntryIndex];
+        UnlinkTextureLRU(EntryIndex);
+
+        RemoveTextureIDSlot(Entry->TextureID);
+        DeleteTexture(&Entry->TextureID);
+
+        --TextureRegistry.ResidentTextureCount;
+        TextureRegistry.ResidentBytes -= Entry->ResidentBytes;
+        Entry->TextureID = 0;
+        Entry->ResidentBytes = 0;
+    }
+}
+
+static u64
+EstimateTextureBytes(i32 Width, i32 Height, i32 ComponentCount, bool GenerateMipmap)
+{
+    // NOTE: Drivers pad RGB8 out to four bytes per texel
+    u64 BytesPerTexel = (ComponentCount == 3) ? 4 : (u64) ComponentCount;
+
+    u64 Result = (u64) Width * (u64) Height * BytesPerTexel;
+    while (GenerateMipmap && (Width > 1 || Height > 1))
+    {
+        Width = (Width > 1) ? Width / 2 : 1;
+        Height = (Height > 1) ? Height / 2 : 1;
+        Result += (u64) Width * (u64) Height * BytesPerTexel;
+    }
+
+    return Result;
+}
+
+static void
+UpdateTextureResidentBytes(u32 TextureID, u64 ResidentBytes)
+{
+    i32 EntryIndex = FindTextureEntryByID(TextureID);
+    if (EntryIndex < 0)
+    {
+        return;
+    }
+
+    texture_entry *Entry = &TextureRegistry.Entries[EntryIndex];
+    TextureRegistry.ResidentBytes -= Entry->ResidentBytes;
+    TextureRegistry.ResidentBytes += ResidentBytes;
+    Entry->ResidentBytes = ResidentBytes;
+
+    EvictTexturesOverBudget();
+}
+
+// Texture streaming
+// -----------------
+
+// NOTE: Takes the stream's own reference, which keeps the texture from being evicted mid-stream
+static texture_stream_request *
+STREAM_AddRequest(const char *Path, u32 TextureID, bool GenerateMipmap, i32 ResidentLevel)
+{
+    RetainTexture(TextureID);
+
+    texture_stream_request *Request = (texture_stream_request *) calloc(1, sizeof(texture_stream_request));
+    Assert(Request);
+    strncpy_s(Request->Path, Path, MAX_PATH_LENGTH - 1);
+    Request->TextureID = TextureID;
+    Request->GenerateMipmap = GenerateMipmap;
+    Request->ResidentLevel = ResidentLevel;
+    Request->LastRequestFrame = TextureStreamer.FrameIndex;
+    Request->SlotIndex = -1;
+    SDL_AtomicSet(&Request->State, TEXTURE_STREAM_DECODING);
+
+    i32 EntryIndex = FindTextureEntryByID(TextureID);
+    TextureRegistry.Entries[EntryIndex].Stream = Request;
+
+    TextureStreamer.Requests[TextureStreamer.RequestCount++] = Request;
+    AddJob(TextureStreamer.Queue, STREAM_DecodeJob, Request);
+
+    return Request;
+}
+
+static void
+STREAM_FinishRequest(texture_stream_request *Request)
+{
+    i32 EntryIndex = FindTextureEntryByID(Request->TextureID);
+    if (EntryIndex >= 0)
+    {
+        TextureRegistry.Entries[EntryIndex].Stream = 0;
+    }
+
+    FreeTextureData(&Request->Data);
+    ReleaseTexture(Request->TextureID);
+    free(Request);
+}
+
+// NOTE: Turns this frame's requests into the level each cooked texture should have. If all of
+//       them don't fit in the budget, every texture is biased the same number of levels coarser
+//       (down to its floor), so the loss of detail is spread evenly.
+static void
+STREAM_UpdateTargetLevels()
+{
+    ++TextureStreamer.FrameIndex;
+
+    u64 StreamedBytes = 0;
+    for (i32 RequestIndex = 0; RequestIndex < TextureStreamer.RequestCount; ++RequestIndex)
+    {
+        texture_stream_request *Request = TextureStreamer.Requests[RequestIndex];
+        i32 State = SDL_AtomicGet(&Request->State);
+        if (State == TEXTURE_STREAM_DECODING || State == TEXTURE_STREAM_FAILED || !Request->Data.CompressedFormat)
+        {
+            continue;
+        }
+
+        if (Request->RequestedUVsPerPixel > 0.0f)
+        {
+            // NOTE: Same as the GPU's LOD: the sampler reads the level under log2(texels per pixel)
+            //       and the one above it
+            i32 Size = (Request->Data.Width > Request->Data.Height) ? Request->Data.Width : Request->Data.Height;
+            f32 TexelsPerPixel = Request->RequestedUVsPerPixel * (f32) Size;
+            i32 Level = (TexelsPerPixel > 1.0f) ? (i32) floorf(log2f(TexelsPerPixel)) : 0;
+            Request->WantedLevel = (Level < Request->FloorLevel) ? Level : Request->FloorLevel;
+            Request->LastRequestFrame = TextureStreamer.FrameIndex;
+            Request->RequestedUVsPerPixel = 0.0f;
+        }
+        else if (TextureStreamer.FrameIndex - Request->LastRequestFrame > TEXTURE_STREAM_IDLE_FRAMES)
+        {
+            Request->WantedLevel = Request->FloorLevel;
+        }
+
+        if (Request->ResidentLevel < Request->Data.MipCount)
+        {
+            StreamedBytes += STREAM_GetChainBytes(Request, Request->ResidentLevel);
+        }
+    }
+
+    i32 MipBias = 0;
+    for (; MipBias < MAX_TEXTURE_MIP_COUNT; ++MipBias)
+    {
+        u64 TargetBytes = 0;
+        for (i32 RequestIndex = 0; RequestIndex < TextureStreamer.RequestCount; ++RequestIndex)
+        {
+            texture_stream_request *Request = TextureStreamer.Requests[RequestIndex];
+            i32 State = SDL_AtomicGet(&Request->State);
+            if (State != TEXTURE_STREAM_DECODING && State != TEXTURE_STREAM_FAILED && Request->Data.CompressedFormat)
+            {
+                i32 Level = Request->WantedLevel + MipBias;
+                TargetBytes += STREAM_GetChainBytes(Request, (Level < Request->FloorLevel) ? Level : Request->FloorLevel);
+            }
+        }
+
+        if (TargetBytes <= TextureStreamer.BudgetBytes)
+        {
+            break;
+        }
+    }
+
+    for (i32 RequestIndex = 0; RequestIndex < TextureStreamer.RequestCount; ++RequestIndex)
+    {
+        texture_stream_request *Request = TextureStreamer.Requests[RequestIndex];
+        i32 State = SDL_AtomicGet(&Request->State);
+        if (State != TEXTURE_STREAM_DECODING && State != TEXTURE_STREAM_FAILED && Request->Data.CompressedFormat)
+        {
+            i32 Level = Request->WantedLevel + MipBias;
+            Request->TargetLevel = (Level < Request->FloorLevel) ? Level : Request->FloorLevel;
+        }
+    }
+
+    TextureStreamer.MipBias = MipBias;
+    TextureStreamer.StreamedBytes = StreamedBytes;
+}
+
+static u64
+STREAM_GetChainBytes(texture_stream_request *Request, i32 FirstLevel)
+{
+    u64 Bytes = 0;
+    for (i32 MipIndex = FirstLevel; MipIndex < Request->Data.MipCount; ++MipIndex)
+    {
+        Bytes += Request->Data.MipSizes[MipIndex];
+    }
+
+    return Bytes;
+}
+
+static void
+STREAM_UpdateResidentBytes(texture_stream_request *Request)
+{
+    u64 ResidentBytes;
+    if (Request->Data.CompressedFormat)
+    {
+        ResidentBytes = STREAM_GetChainBytes(Request, Request->ResidentLevel);
+    }
+    else
+    {
+        ResidentBytes = EstimateTextureBytes(Request->Data.Width, Request->Data.Height,
+                                             Request->Data.ComponentCount, Request->GenerateMipmap);
+    }
+    UpdateTextureResidentBytes(Request->TextureID, ResidentBytes);
+}
+
+static i32
+STREAM_AcquireSlot(u32 Size)
+{
+    i32 SlotIndex = TextureStreamer.NextSlot;
+    texture_stream_slot *Slot = &TextureStreamer.Slots[SlotIndex];
+    if (Slot->IsMapped || Slot->Fence)
+    {
+        return -1;
+    }
+
+    // NOTE: Levels that don't fit grow the slot; it's free, so nothing references the old storage
+    if (Size > Slot->Size)
+    {
+        BindBuffer(GL_PIXEL_UNPACK_BUFFER, Slot->PBO);
+        BufferData(GL_PIXEL_UNPACK_BUFFER, Size, 0, GL_STREAM_DRAW);
+        BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        Slot->Size = Size;
+    }
+
+    TextureStreamer.NextSlot = (SlotIndex + 1) % TEXTURE_STREAM_SLOT_COUNT;
+    return SlotIndex;
+}
+
+static u32
+STREAM_GetLevelSize(texture_stream_request *Request)
+{
+    texture_data *Data = &Request->Data;
+    if (Data->CompressedFormat)
+    {
+        return Data->MipSizes[Request->Level];
+    }
+
+    // NOTE: Raw images go up in one piece, with whatever mips were built on the CPU; the chain is
+    //       one block starting at Pixels
+    u32 Size = 0;
+    for (i32 MipIndex = 0; MipIndex < Data->MipCount; ++MipIndex)
+    {
+        Size += Data->MipSizes[MipIndex];
+    }
+
+    return Size;
+}
+
+// NOTE: Returns false if the staging data was lost while mapped; the level is copied again then
+static bool
+STREAM_UploadLevel(texture_stream_request *Request)
+{
+    texture_stream_slot *Slot = &TextureStreamer.Slots[Request->SlotIndex];
+    texture_data *Data = &Request->Data;
+
+    BindBuffer(GL_PIXEL_UNPACK_BUFFER, Slot->PBO);
+    bool IsIntact = (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE);
+    Slot->IsMapped = false;
+    Request->Staging = 0;
+    Request->SlotIndex = -1;
+    if (!IsIntact)
+    {
+        BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    // NOTE: The pixel pointers below are offsets into the bound PBO
+    BindTexture2D(0, Request->TextureID);
+    if (Data->CompressedFormat)
+    {
+        i32 Level = Request->Level;
+        i32 LevelWidth = (Data->Width >> Level) > 0 ? (Data->Width >> Level) : 1;
+        i32 LevelHeight = (Data->Height >> Level) > 0 ? (Data->Height >> Level) : 1;
+
+        // NOTE: The first level streamed in also turns the grey placeholder (RGBA) into an empty
+        //       level 0 in the compressed format, so the texture never mixes internal formats
+        if (Request->ResidentLevel >= Data->MipCount && Level > 0)
+        {
+            glCompressedTexImage2D(GL_TEXTURE_2D, 0, Data->CompressedFormat, 0, 0, 0, 0, 0);
+        }
+
+        glCompressedTexImage2D(GL_TEXTURE_2D, Level, Data->CompressedFormat, LevelWidth, LevelHeight, 0,
+                               Data->MipSizes[Level], 0);
+        CountUploadedBytes(Data->MipSizes[Level]);
+
+        // NOTE: Only the levels streamed so far are in [BASE_LEVEL, MAX_LEVEL], so the texture is
+        //       complete the whole time; the placeholder in level 0 is outside until it's replaced
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, Level);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, Data->MipCount - 1);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                        (Data->MipCount > 1) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    }
+    else
+    {
+        GLenum Format = (Data->ComponentCount == 1) ? GL_RED : (Data->ComponentCount == 3) ? GL_RGB : GL_RGBA;
+
+        // NOTE: Rows were copied tightly packed. BASE_LEVEL only matters if a cooked texture
+        //       that was partly streamed came back as a raw image.
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        size_t Offset = 0;
+        for (i32 MipIndex = 0; MipIndex < Data->MipCount; ++MipIndex)
+        {
+            i32 MipWidth = (Data->Width >> MipIndex) > 0 ? (Data->Width >> MipIndex) : 1;
+            i32 MipHeight = (Data->Height >> MipIndex) > 0 ? (Data->Height >> MipIndex) : 1;
+            glTexImage2D(GL_TEXTURE_2D, MipIndex, Format, MipWidth, MipHeight, 0, Format, GL_UNSIGNED_BYTE,
+                         (void *) Offset);
+            Offset += Data->MipSizes[MipIndex];
+        }
+        CountUploadedBytes(Offset);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        if (Data->MipCount > 1)
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, Data->MipCount - 1);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        }
+        else if (Request->GenerateMipmap)
+        {
+            glGenerateMipmap(GL_TEXTURE_2D);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        }
+    }
+    BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    Slot->Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    return true;
+}
+
+// NOTE: Drops the levels finer than FirstKeptLevel. Zero sized images are the only way to give a
+//       level's storage back without recreating the texture (and changing its ID); they're in the
+//       texture's own compressed format, so its levels never mix internal formats.
+static void
+STREAM_DropLevels(texture_stream_request *Request, i32 FirstKeptLevel)
+{
+    Assert(Request->Data.CompressedFormat);
+
+    BindTexture2D(0, Request->TextureID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, FirstKeptLevel);
+    for (i32 Level = Request->ResidentLevel; Level < FirstKeptLevel; ++Level)
+    {
+        glCompressedTexImage2D(GL_TEXTURE_2D, Level, Request->Data.CompressedFormat, 0, 0, 0, 0, 0);
+    }
+
+    Request->ResidentLevel = FirstKeptLevel;
+    STREAM_UpdateResidentBytes(Request);
+}
+
+static void
+STREAM_DecodeJob(void *Data)
+{
+    texture_stream_request *Request = (texture_stream_request *) Data;
+    texture_data *TextureData = &Request->Data;
+
+    bool Success = DecodeTexture(Request->Path, Request->GenerateMipmap, TextureData);
+    if (Success && TextureData->CompressedFormat)
+    {
+        i32 FloorLevel = 0;
+        while (FloorLevel < TextureData->MipCount - 1 &&
+               ((TextureData->Width >> FloorLevel) > TEXTURE_STREAM_RESIDENT_SIZE ||
+                (TextureData->Height >> FloorLevel) > TEXTURE_STREAM_RESIDENT_SIZE))
+        {
+            ++FloorLevel;
+        }
+
+        Request->FloorLevel = FloorLevel;
+        Request->WantedLevel = FloorLevel;
+        Request->TargetLevel = FloorLevel;
+        if (Request->ResidentLevel > TextureData->MipCount)
+        {
+            Request->ResidentLevel = TextureData->MipCount;
+        }
+    }
+
+    // NOTE: SDL_AtomicSet is a full barrier, so Data is visible before the state changes
+    SDL_AtomicSet(&Request->State, Success ? TEXTURE_STREAM_IDLE : TEXTURE_STREAM_FAILED);
+}
+
+static void
+STREAM_CopyLevelJob(void *Data)
+{
+    texture_stream_request *Request = (texture_stream_request *) Data;
+    texture_data *TextureData = &Request->Data;
+
+    // NOTE: For cooked textures this is where the mapped file is actually read
+    if (TextureData->CompressedFormat)
+    {
+        memcpy(Request->Staging, TextureData->MipData[Request->Level], TextureData->MipSizes[Request->Level]);
+    }
+    else
+    {
+        memcpy(Request->Staging, TextureData->Pixels, STREAM_GetLevelSize(Request));
+    }
+
+    SDL_AtomicSet(&Request->State, TEXTURE_STREAM_COPIED);
+}
+
+// Texture cooking
+// ---------------
+
+static bool
+DDS_MapCookedTexture(const char *SourcePath, texture_data *Out_TextureData)
+{
+    char CookedPath[MAX_PATH_LENGTH];
+    GetCookedTexturePath(SourcePath, CookedPath, MAX_PATH_LENGTH);
+
+    if (DDS_MapTexture(CookedPath, SourcePath, Out_TextureData))
+    {
+        return true;
+    }
+
+#if TEXTURE_COOK_ON_LOAD
+    // NOTE: Another worker may be cooking the same texture; once it's done the cooked file is
+    //       looked at again instead of being cooked twice. Just cooked, it isn't checked against
+    //       the source again.
+    LockFilePath(CookedPath);
+    bool Success = (DDS_MapTexture(CookedPath, SourcePath, Out_TextureData) ||
+                    (CookTexture(SourcePath, CookedPath) && DDS_MapTexture(CookedPath, 0, Out_TextureData)));
+    UnlockFilePath(CookedPath);
+
+    if (Success)
+    {
+        return true;
+    }
+#endif
+
+    return false;
+}
+
+static bool
+DDS_MapTexture(const char *CookedPath, const char *SourcePath, texture_data *Out_TextureData)
+{
+    mapped_file *CookedFile = &Out_TextureData->CookedFile;
+    if (!MapFileReadOnly(CookedPath, CookedFile))
+    {
+        return false;
+    }
+
+    dds_header Header;
+    u32 Magic;
+    bool IsValid = (CookedFile->Size >= sizeof(u32) + sizeof(dds_header));
+    if (IsValid)
+    {
+        memcpy(&Magic, CookedFile->Data, sizeof(u32));
+        memcpy(&Header, CookedFile->Data + sizeof(u32), sizeof(dds_header));
+        IsValid = (Magic == DDS_MAGIC &&
+                   Header.Size == sizeof(dds_header) &&
+                   Header.Reserved1[0] == COOKED_TEXTURE_MAGIC &&
+                   Header.Reserved1[1] == COOKED_TEXTURE_VERSION &&
+                   (Header.PixelFormat.Flags & DDPF_FOURCC) &&
+                   Header.Width > 0 && Header.Height > 0 &&
+                   Header.MipMapCount > 0 && Header.MipMapCount <= MAX_TEXTURE_MIP_COUNT);
+    }
+
+    // NOTE: Only trusted while the source is still the file it was cooked from; any difference
+    //       counts, not just a newer time. Without the source (only the cooked files shipped)
+    //       there's nothing to check.
+    if (IsValid && SourcePath && FileExists(SourcePath))
+    {
+        u64 SourceSize;
+        u64 SourceModificationTime;
+        DDS_GetSourceStamp(SourcePath, &SourceSize, &SourceModificationTime);
+
+        u64 CookedSourceSize;
+        u64 CookedSourceModificationTime;
+        memcpy(&CookedSourceSize, &Header.Reserved1[2], sizeof(u64));
+        memcpy(&CookedSourceModificationTime, &Header.Reserved1[4], sizeof(u64));
+        IsValid = (SourceSize == CookedSourceSize && SourceModificationTime == CookedSourceModificationTime);
+    }
+
+    block_compression_format Format = BLOCK_COMPRESSION_BC1;
+    if (IsValid)
+    {
+        switch (Header.PixelFormat.FourCC)
+        {
+            case DDS_FOURCC_DXT1:
+            {
+                Format = BLOCK_COMPRESSION_BC1;
+                Out_TextureData->CompressedFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+                Out_TextureData->ComponentCount = 3;
+            } break;
+
+            case DDS_FOURCC_DXT5:
+            {
+                Format = BLOCK_COMPRESSION_BC3;
+                Out_TextureData->CompressedFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                Out_TextureData->ComponentCount = 4;
+            } break;
+
+            case DDS_FOURCC_ATI1:
+            {
+                Format = BLOCK_COMPRESSION_BC4;
+                Out_TextureData->CompressedFormat = GL_COMPRESSED_RED_RGTC1;
+                Out_TextureData->ComponentCount = 1;
+            } break;
+
+            case DDS_FOURCC_ATI2:
+            {
+                Format = BLOCK_COMPRESSION_BC5;
+                Out_TextureData->CompressedFormat = GL_COMPRESSED_RG_RGTC2;
+                Out_TextureData->ComponentCount = 2;
+            } break;
+
+            default:
+            {
+                IsValid = false;
+            } break;
+        }
+    }
+
+    if (IsValid)
+    {
+        size_t Offset = sizeof(u32) + sizeof(dds_header);
+        i32 MipWidth = (i32) Header.Width;
+        i32 MipHeight = (i32) Header.Height;
+        for (i32 MipIndex = 0; MipIndex < (i32) Header.MipMapCount; ++MipIndex)
+        {
+            size_t MipSize = GetCompressedImageSize(Format, MipWidth, MipHeight);
+            if (MipSize > CookedFile->Size - Offset)
+            {
+                IsValid = false;
+                break;
+            }
+
+            Out_TextureData->MipData[MipIndex] = CookedFile->Data + Offset;
+            Out_TextureData->MipSizes[MipIndex] = (u32) MipSize;
+            Offset += MipSize;
+            MipWidth = (MipWidth > 1) ? MipWidth / 2 : 1;
+            MipHeight = (MipHeight > 1) ? MipHeight / 2 : 1;
+        }
+    }
+
+    if (!IsValid)
+    {
+        UnmapFile(CookedFile);
+        Out_TextureData->CompressedFormat = 0;
+        Out_TextureData->ComponentCount = 0;
+        return false;
+    }
+
+    Out_TextureData->Width = (i32) Header.Width;
+    Out_TextureData->Height = (i32) Header.Height;
+    Out_TextureData->MipCount = (i32) Header.MipMapCount;
+
+    return true;
+}
+
+static bool
+DDS_WriteTexture(const char *CookedPath, u64 SourceSize, u64 SourceModificationTime,
+                 u32 FourCC, i32 Width, i32 Height, i32 MipCount, const u8 *Blocks, size_t BlocksSize)
+{
+    FILE *File = OpenReplacingFile(CookedPath);
+    if (!File)
+    {
+        fprintf(stderr, "Couldn't open cooked texture for writing: %s\n", CookedPath);
+        return false;
+    }
+
+    dds_header Header{ };
+    Header.Size = sizeof(dds_header);
+    Header.Flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+    Header.Height = (u32) Height;
+    Header.Width = (u32) Width;
+    Header.PitchOrLinearSize = (u32) (FourCC == DDS_FOURCC_DXT1 || FourCC == DDS_FOURCC_ATI1 ?
+                                      ((Width + 3) / 4) * ((Height + 3) / 4) * 8 :
+                                      ((Width + 3) / 4) * ((Height + 3) / 4) * 16);
+    Header.MipMapCount = (u32) MipCount;
+    Header.Reserved1[0] = COOKED_TEXTURE_MAGIC;
+    Header.Reserved1[1] = COOKED_TEXTURE_VERSION;
+    memcpy(&Header.Reserved1[2], &SourceSize, sizeof(u64));
+    memcpy(&Header.Reserved1[4], &SourceModificationTime, sizeof(u64));
+    Header.PixelFormat.Size = sizeof(dds_pixel_format);
+    Header.PixelFormat.Flags = DDPF_FOURCC;
+    Header.PixelFormat.FourCC = FourCC;
+    Header.Caps = DDSCAPS_TEXTURE | ((MipCount > 1) ? (DDSCAPS_MIPMAP | DDSCAPS_COMPLEX) : 0);
+
+    u32 Magic = DDS_MAGIC;
+    bool Success = (fwrite(&Magic, sizeof(Magic), 1, File) == 1 &&
+                    fwrite(&Header, sizeof(Header), 1, File) == 1 &&
+                    fwrite(Blocks, BlocksSize, 1, File) == 1);
+
+    Success = CloseReplacingFile(File, CookedPath, Success);
+    if (!Success)
+    {
+        fprintf(stderr, "Couldn't write cooked texture: %s\n", CookedPath);
+    }
+
+    return Success;
+}
+
+static void
+DDS_GetSourceStamp(const char *SourcePath, u64 *Out_Size, u64 *Out_ModificationTime)
+{
+    if (!GetFileInfo(SourcePath, Out_Size, Out_ModificationTime))
+    {
+        *Out_Size = 0;
+        *Out_ModificationTime = 0;
+    }
+}
+
+// NOTE: Decoded from a mapped view rather than by stbi_load, so images come out of a mounted pack
+//       like everything else
+static u8 *
+LoadImageFile(const char *Path, int *Out_Width, int *Out_Height, int *Out_ComponentCount, int DesiredComponentCount)
+{
+    mapped_file File;
+    if (!MapFileReadOnly(Path, &File))
+    {
+        return 0;
+    }
+
+    u8 *Pixels = 0;
+    if (File.Size <= INT_MAX)
+    {
+        Pixels = stbi_load_from_memory(File.Data, (int) File.Size, Out_Width, Out_Height, Out_ComponentCount,
+                                       DesiredComponentCount);
+    }
+
+    UnmapFile(&File);
+    return Pixels;
+}
+
+// NOTE: By name first; otherwise nearly every texel has to decode to a unit length vector
+//       facing out of the surface
+static bool
+IsNormalMapImage(const char *Path, const u8 *Pixels, i32 Width, i32 Height)
+{
+    const char *NameHints[] = { "normal", "_nrm", "_nor." };
+    const char *Filename = Path;
+    for (const char *Char = Path; *Char; ++Char)
+    {
+        if (*Char == '/' || *Char == '\\')
+        {
+            Filename = Char + 1;
+        }
+    }
+    for (i32 HintIndex = 0; HintIndex < (i32) (sizeof(NameHints) / sizeof(NameHints[0])); ++HintIndex)
+    {
+        const char *Hint = NameHints[HintIndex];
+        for (const char *Start = Filename; *Start; ++Start)
+        {
+            i32 CharIndex = 0;
+            while (Hint[CharIndex] && Start[CharIndex] &&
+                   tolower((u8) Start[CharIndex]) == Hint[CharIndex])
+            {
+                ++CharIndex;
+            }
+            if (!Hint[CharIndex])
+            {
+                return true;
+            }
+        }
+    }
+
+    size_t PixelCount = (size_t) Width * Height;
+    size_t Stride = (PixelCount > 4096) ? PixelCount / 4096 : 1;
+    size_t SampleCount = 0;
+    size_t UnitCount = 0;
+    for (size_t PixelIndex = 0; PixelIndex < PixelCount; PixelIndex += Stride)
+    {
+        const u8 *Pixel = &Pixels[PixelIndex * 4];
+        f32 X = Pixel[0] / 127.5f - 1.0f;
+        f32 Y = Pixel[1] / 127.5f - 1.0f;
+        f32 Z = Pixel[2] / 127.5f - 1.0f;
+        f32 Length = sqrtf(X * X + Y * Y + Z * Z);
+        if (Z > 0.0f && Length > 0.85f && Length < 1.15f)
+        {
+            ++UnitCount;
+        }
+        ++SampleCount;
+    }
+
+    return (UnitCount * 100 >= SampleCount * 98);
+}
+
+// NOTE: Replaces the stb buffer with one block holding the RGBA mip chain (just level 0 when
+//       GenerateMipmap is off). The block comes from malloc like stb's, so FreeTextureData doesn't
+//       need to know which one it got.
+static void
+BuildRawMipChain(texture_data *TextureData, bool GenerateMipmap)
+{
+    i32 Width = TextureData->Width;
+    i32 Height = TextureData->Height;
+    i32 MipCount = 1;
+    if (GenerateMipmap)
+    {
+        MipCount = GetImageMipCount(Width, Height);
+        if (MipCount > MAX_TEXTURE_MIP_COUNT)
+        {
+            MipCount = MAX_TEXTURE_MIP_COUNT;
+        }
+    }
+
+    size_t ChainSize = 0;
+    for (i32 MipIndex = 0; MipIndex < MipCount; ++MipIndex)
+    {
+        i32 MipWidth = (Width >> MipIndex) > 0 ? (Width >> MipIndex) : 1;
+        i32 MipHeight = (Height >> MipIndex) > 0 ? (Height >> MipIndex) : 1;
+        TextureData->MipSizes[MipIndex] = (u32) ((size_t) MipWidth * MipHeight * 4);
+        ChainSize += TextureData->MipSizes[MipIndex];
+    }
+
+    u8 *Chain = (u8 *) malloc(ChainSize);
+    Assert(Chain);
+
+    size_t PixelCount = (size_t) Width * Height;
+    if (TextureData->ComponentCount == 3)
+    {
+        ExpandRGBToRGBA(TextureData->Pixels, PixelCount, Chain);
+    }
+    else
+    {
+        memcpy(Chain, TextureData->Pixels, PixelCount * 4);
+    }
+
+    u32 Flags = 0;
+    if (MipCount > 1)
+    {
+        if (IsNormalMapImage(TextureData->Path, Chain, Width, Height))
+        {
+            Flags = IMAGE_NORMAL_MAP;
+            RenormalizeNormalMap(Chain, PixelCount);
+        }
+        else
+        {
+            Flags = IMAGE_SRGB;
+            if (TextureData->ComponentCount == 4)
+            {
+                Flags |= IMAGE_ALPHA_WEIGHTED;
+            }
+        }
+    }
+
+    u8 *MipPixels = Chain;
+    for (i32 MipIndex = 0; MipIndex < MipCount; ++MipIndex)
+    {
+        TextureData->MipData[MipIndex] = MipPixels;
+        if (MipIndex + 1 < MipCount)
+        {
+            i32 MipWidth = (Width >> MipIndex) > 0 ? (Width >> MipIndex) : 1;
+            i32 MipHeight = (Height >> MipIndex) > 0 ? (Height >> MipIndex) : 1;
+            DownsampleImage(MipPixels, MipWidth, MipHeight, IMAGE_FILTER_BOX, Flags,
+                            MipPixels + TextureData->MipSizes[MipIndex]);
+        }
+        MipPixels += TextureData->MipSizes[MipIndex];
+    }
+
+    stbi_image_free(TextureData->Pixels);
+    TextureData->Pixels = Chain;
+    TextureData->ComponentCount = 4;
+    TextureData->MipCount = MipCount;
+}
@@ -0,0 +1,136 @@
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include "Common.h"
+#include "FileIO.h"
+#include "TextureFormat.h"
+#include "Util.h"
+
+// NOTE: Decoded pixels or mapped cooked blocks waiting to be uploaded to GL
+struct texture_data
+{
+    char Path[MAX_PATH_LENGTH];
+    i32 Width;
+    i32 Height;
+    i32 ComponentCount;
+    u8 *Pixels;
+
+    // NOTE: Cooked textures: GL compressed format (0 for Pixels) and the full mip chain,
+    //       pointing into CookedFile
+    u32 CompressedFormat;
+    i32 MipCount;
+    u8 *MipData[MAX_TEXTURE_MIP_COUNT];
+    u32 MipSizes[MAX_TEXTURE_MIP_COUNT];
+    mapped_file CookedFile;
+};
+
+struct texture_memory_stats
+{
+    i32 ResidentTextureCount;
+    i32 ReferencedTextureCount;
+    u64 ResidentBytes;
+    u64 BudgetBytes;
+
+    // NOTE: Cooked textures whose mip levels are being streamed on demand
+    i32 StreamedTextureCount;
+    u64 StreamedBytes;
+    u64 StreamingBudgetBytes;
+    // NOTE: Levels every streamed texture is kept coarser than asked for to stay in the budget
+    i32 StreamingMipBias;
+
+    // NOTE: Loads that got a texture already resident under another path with the same contents
+    i32 SharedLoadCount;
+};
+
+// NOTE: Textures loaded from a path are kept in a registry keyed by the contents of the file (see
+//       GetFileContentHash), so copies of one image under different paths share a texture. Every ID
+//       handed out by LoadTexture/UploadTexture/RetainTexture holds a reference that has to be given
+//       back with ReleaseTexture. Unreferenced textures stay resident (a later load of the same
+//       image is free) until the resident total goes over the memory budget; then they're deleted
+//       least recently released first. Referenced textures are never evicted, so the budget can be
+//       exceeded. Everything but DecodeTexture has to run on the GL thread.
+#define DEFAULT_TEXTURE_MEMORY_BUDGET (512ull * 1024 * 1024)
+// NOTE: Share of that for the mip levels of streamed cooked textures (see RequestTextureMip)
+#define DEFAULT_TEXTURE_STREAMING_BUDGET (256ull * 1024 * 1024)
+
+// Texture loading
+// ---------------
+
+u32
+LoadTexture(const char *Path, bool GenerateMipmap);
+// NOTE: DecodeTexture doesn't touch GL, so it can run on any thread. It maps the cooked texture
+//       when there's an up-to-date one and only decodes the source image otherwise; then RGB images
+//       are expanded to RGBA and, with GenerateMipmap, RGB(A) ones get their mips built here instead
+//       of by the driver. UploadTexture has to run on the GL thread and frees the pixels
+bool
+DecodeTexture(const char *Path, bool GenerateMipmap, texture_data *Out_TextureData);
+u32
+UploadTexture(texture_data *TextureData, bool GenerateMipmap);
+void
+FreeTextureData(texture_data *TextureData);
+
+// Texture cooking
+// ---------------
+
+void
+GetCookedTexturePath(const char *SourcePath, char *Out_CookedPath, i32 CookedPathBufferSize);
+// NOTE: BC5 for normal maps, BC3 for images with alpha, BC4 for single channel ones and BC1 for
+//       everything else, with a Kaiser filtered mip chain down to 1x1
+bool
+CookTexture(const char *SourcePath, const char *CookedPath);
+
+// Texture streaming
+// -----------------
+
+struct job_queue;
+
+// NOTE: Decoding and copying into the staging buffers runs on Queue's workers. The queue has to
+//       be destroyed (drained) before ShutdownTextureStreaming.
+void
+InitializeTextureStreaming(job_queue *Queue);
+void
+ShutdownTextureStreaming();
+bool
+IsTextureStreamingActive();
+// NOTE: Same reference as LoadTexture, but returns right away with a texture holding a 1x1
+//       placeholder. The ID stays the same when the real data is swapped in; cooked textures
+//       sharpen a mip level at a time, coarsest first, and only down to the first level that's
+//       128 texels or smaller until RequestTextureMip asks for more.
+u32
+LoadTextureAsync(const char *Path, bool GenerateMipmap);
+// NOTE: How finely the texture is sampled on screen this frame, in UV units per pixel; call it for
+//       every draw that uses the texture. Streamed cooked textures load the finer levels that are
+//       asked for and drop the ones that haven't been for a while; other textures ignore it.
+void
+RequestTextureMip(u32 TextureID, f32 UVsPerPixel);
+// NOTE: When the asked for levels don't fit, every streamed texture is kept the same number of
+//       levels coarser until they do
+void
+SetTextureStreamingBudget(u64 BudgetBytes);
+// NOTE: Call once a frame on the GL thread. Never waits on the GPU: staging buffers are only
+//       reused once their upload's fence has signaled.
+void
+ProcessTextureStreaming();
+// NOTE: Textures with levels on the way; ones idling until more levels are asked for don't count
+i32
+GetPendingTextureStreamCount();
+
+// Texture registry
+// ----------------
+
+// NOTE: IDs the registry doesn't know about (0, textures not created through it) are ignored
+void
+RetainTexture(u32 TextureID);
+void
+ReleaseTexture(u32 TextureID);
+void
+SetTextureMemoryBudget(u64 BudgetBytes);
+// NOTE: Estimated from the dimensions and format, including the mip chain
+u64
+GetTextureResidentBytes(u32 TextureID);
+texture_memory_stats
+GetTextureMemoryStats();
+void
+PrintTextureMemoryReport();
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef TEXTURE_FORMAT_H
+#define TEXTURE_FORMAT_H
+
+#include "Common.h"
+
+// NOTE: Cooked textures are plain DDS files, so they open in any image tool:
+//
+//       u32 magic ('DDS ')
+//       dds_header                          (legacy FourCC, no DX10 header)
+//       [blocks] per mip, largest first     (tightly packed, rows top to bottom like the source)
+//
+//       The cooker stamps COOKED_TEXTURE_MAGIC and COOKED_TEXTURE_VERSION into Reserved1, so DDS
+//       files from other tools and ones from older cookers are recooked rather than trusted.
+//       Reserved1[2..3] and [4..5] hold the source's size and modification time (u64 each) at cook
+//       time; the cooked file is recooked once either stops matching.
+
+#define DDS_MAGIC 0x20534444 // 'DDS '
+#define DDS_FOURCC_DXT1 0x31545844 // 'DXT1' (BC1)
+#define DDS_FOURCC_DXT5 0x35545844 // 'DXT5' (BC3)
+#define DDS_FOURCC_ATI1 0x31495441 // 'ATI1' (BC4)
+#define DDS_FOURCC_ATI2 0x32495441 // 'ATI2' (BC5)
+
+#define DDSD_CAPS 0x1
+#define DDSD_HEIGHT 0x2
+#define DDSD_WIDTH 0x4
+#define DDSD_PIXELFORMAT 0x1000
+#define DDSD_MIPMAPCOUNT 0x20000
+#define DDSD_LINEARSIZE 0x80000
+#define DDPF_FOURCC 0x4
+#define DDSCAPS_COMPLEX 0x8
+#define DDSCAPS_TEXTURE 0x1000
+#define DDSCAPS_MIPMAP 0x400000
+
+#define COOKED_TEXTURE_MAGIC 0x58455443 // 'CTEX'
+#define COOKED_TEXTURE_VERSION 3
+#define COOKED_TEXTURE_EXTENSION ".dds"
+
+#define MAX_TEXTURE_MIP_COUNT 16
+
+struct dds_pixel_format
+{
+    u32 Size;
+    u32 Flags;
+    u32 FourCC;
+    u32 RGBBitCount;
+    u32 RBitMask;
+    u32 GBitMask;
+    u32 BBitMask;
+    u32 ABitMask;
+};
+
+struct dds_header
+{
+    u32 Size;
+    u32 Flags;
+    u32 Height;
+    u32 Width;
+    u32 PitchOrLinearSize;
+    u32 Depth;
+    u32 MipMapCount;
+    u32 Reserved1[11];
+    dds_pixel_format PixelFormat;
+    u32 Caps;
+    u32 Caps2;
+    u32 Caps3;
+    u32 Caps4;
+    u32 Reserved2;
+};
+
+#endif
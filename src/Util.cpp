@@ -1,136 +1,8 @@
 #include "Util.h"
 
-#include <glad/glad.h>
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb/stb_image.h>
-
 #include <cstdlib>
 #include <cstdio>
 
-#define LOADED_TEXTURE_CACHE_BLOCK_SIZE 32
-struct loaded_textures_cache_block
-{
-    i32 Count;
-    u32 TextureIDs[LOADED_TEXTURE_CACHE_BLOCK_SIZE];
-    char TexturePaths[LOADED_TEXTURE_CACHE_BLOCK_SIZE][MAX_PATH_LENGTH];
-};
-
-struct loaded_textures_cache
-{
-    i32 BlockCount;
-    loaded_textures_cache_block **Blocks;
-};
-
-static loaded_textures_cache LoadedTexturesCache;
-
-static void
-InitializeLoadedTexturesCache();
-static u32
-GetTextureFromCache(char *TexturePath);
-static bool
-AddLoadedTexturesCacheBlock();
-static void
-AddTextureToCache(char *TexturePath, u32 TextureID);
-
-// ------------------------
-// TEXTURES ---------------
-// ------------------------
-
-// TODO: STBI is too slow; switch back to SDL image
-u32
-LoadTexture(const char *Path, bool GenerateMipmap)
-{
-    char PathOnStack[MAX_PATH_LENGTH];
-    strncpy_s(PathOnStack, Path, MAX_PATH_LENGTH - 1);
-    u32 TextureID = GetTextureFromCache(PathOnStack);
-    if (TextureID > 0)
-    {
-        return TextureID;
-    }
-
-    int Width, Height, ComponentCount;
-    u8 *Data = stbi_load(Path, &Width, &Height, &ComponentCount, 0);
-    if (Data)
-    {
-        GLenum Format;
-        if (ComponentCount == 1)
-        {
-            Format = GL_RED;
-        }
-        else if (ComponentCount == 3)
-        {
-            Format = GL_RGB;
-        }
-        else if (ComponentCount == 4)
-        {
-            Format = GL_RGBA;
-        }
-        else
-        {
-            fprintf(stderr, "Unknown texture format at path: %s\n", Path);
-            stbi_image_free(Data);
-            return 0;
-        }
-
-        glGenTextures(1, &TextureID);
-        glBindTexture(GL_TEXTURE_2D, TextureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, Format, Width, Height, 0, Format, GL_UNSIGNED_BYTE, Data);
-        if (GenerateMipmap)
-        {
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        if (GenerateMipmap)
-        {
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        }
-        else
-        {
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        }
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glBindTexture(GL_TEXTURE_2D, 0);
-
-        AddTextureToCache(PathOnStack, TextureID);
-
-        stbi_image_free(Data);
-        return TextureID;
-    }
-    else
-    {
-        fprintf(stderr, "Texture failed to load at path: %s\n", Path);
-        return 0;
-    }
-}
-
-// ------------------------
-// FILE IO ----------------
-// ------------------------
-
-char *
-ReadFile(const char *Path, size_t *Out_Size)
-{
-    char *Result = 0;
-
-    FILE *File;
-    fopen_s(&File, Path, "rb");
-    Assert(File);
-
-    fseek(File, 0, SEEK_END);
-    size_t Size = ftell(File);
-    fseek(File, 0, SEEK_SET);
-
-    Result = (char *) malloc(Size + 1);
-    Assert(Result);
-    fread(Result, Size, 1, File);
-    fclose(File);
-    Result[Size] = '\0';
-
-    *Out_Size = Size;
-    return Result;
-}
-
 // ------------------------
 // STRINGS ----------------
 // ------------------------
@@ -200,116 +72,109 @@ GetFileDirectory(char *FilePath, i32 FilePathCount,
     *Out_FileDirectoryCount = Index;
 }
 
-// ----------------------------
-// INTERNAL HELPERS -----------
-// ----------------------------
-
-static void
-InitializeLoadedTexturesCache()
+bool
+HasFileExtension(const char *Path, const char *Extension)
 {
-    if (LoadedTexturesCache.BlockCount == 0)
+    i32 PathCount = GetNullTerminatedStringLength(Path);
+    i32 ExtensionCount = GetNullTerminatedStringLength(Extension);
+    if (PathCount < ExtensionCount)
     {
-        LoadedTexturesCache.Blocks = ((loaded_textures_cache_block **)
-                                      malloc(sizeof(loaded_textures_cache_block *)));
-        if (LoadedTexturesCache.Blocks)
-        {
-            LoadedTexturesCache.Blocks[0] = ((loaded_textures_cache_block *)
-                                             malloc(sizeof(loaded_textures_cache_block)));
-            if (LoadedTexturesCache.Blocks[0])
-            {
-                LoadedTexturesCache.BlockCount = 1;
-                LoadedTexturesCache.Blocks[0]->Count = 0;
-            }
-        }
-    }
-}
-
-static u32
-GetTextureFromCache(char *TexturePath)
-{
-    if (LoadedTexturesCache.BlockCount == 0)
-    {
-        InitializeLoadedTexturesCache();
+        return false;
     }
 
-    for (i32 BlockIndex = 0; BlockIndex < LoadedTexturesCache.BlockCount; ++BlockIndex)
+    const char *PathExtension = Path + PathCount - ExtensionCount;
+    for (i32 CharIndex = 0; CharIndex < ExtensionCount; ++CharIndex)
     {
-        loaded_textures_cache_block *Block = LoadedTexturesCache.Blocks[BlockIndex];
-
-        for (i32 PathIndex = 0; PathIndex < Block->Count; ++PathIndex)
+        char A = PathExtension[CharIndex];
+        char B = Extension[CharIndex];
+        if (A >= 'A' && A <= 'Z') A += 'a' - 'A';
+        if (B >= 'A' && B <= 'Z') B += 'a' - 'A';
+        if (A != B)
         {
-            if (strcmp(Block->TexturePaths[PathIndex], TexturePath) == 0)
-            {
-                return Block->TextureIDs[PathIndex];
-            }
+            return false;
         }
     }
 
-    return 0;
+    return true;
 }
 
-static bool
-AddLoadedTexturesCacheBlock()
+bool
+NormalizePath(const char *Path, char *Out_Path, i32 PathBufferSize)
 {
-    LoadedTexturesCache.Blocks = ((loaded_textures_cache_block **)
-                                  realloc(LoadedTexturesCache.Blocks,
-                                          (LoadedTexturesCache.BlockCount + 1) *
-                                          sizeof(loaded_textures_cache_block *)));
+    Assert(PathBufferSize > 0);
 
-    Assert(LoadedTexturesCache.Blocks);
-    if (LoadedTexturesCache.Blocks)
+    i32 OutCount = 0;
+    // NOTE: Where the segments that ".." can fold start; after the leading slash of absolute paths
+    i32 RootCount = 0;
+    if (Path[0] == '/' || Path[0] == '\\')
     {
-        LoadedTexturesCache.Blocks[LoadedTexturesCache.BlockCount] =
-            (loaded_textures_cache_block *) malloc(sizeof(loaded_textures_cache_block));
-        Assert(LoadedTexturesCache.Blocks[LoadedTexturesCache.BlockCount]);
-        if (LoadedTexturesCache.Blocks[LoadedTexturesCache.BlockCount])
-        {
-            LoadedTexturesCache.Blocks[LoadedTexturesCache.BlockCount]->Count = 0;
-            ++LoadedTexturesCache.BlockCount;
-            return true;
-        }
-        else
+        if (PathBufferSize < 2)
         {
             return false;
         }
+        Out_Path[OutCount++] = '/';
+        RootCount = 1;
     }
-    else
-    {
-        // TODO: Logging
-        return false;
-    }
-}
 
-static void
-AddTextureToCache(char *TexturePath, u32 TextureID)
-{
-    if (LoadedTexturesCache.BlockCount > 0)
+    const char *Segment = Path;
+    while (*Segment)
     {
-        loaded_textures_cache_block *Block =
-            LoadedTexturesCache.Blocks[LoadedTexturesCache.BlockCount - 1];
+        i32 SegmentCount = 0;
+        while (Segment[SegmentCount] != '\0' && Segment[SegmentCount] != '/' && Segment[SegmentCount] != '\\')
+        {
+            ++SegmentCount;
+        }
+
+        bool IsCurrent = (SegmentCount == 1 && Segment[0] == '.');
+        bool IsParent = (SegmentCount == 2 && Segment[0] == '.' && Segment[1] == '.');
 
-        if (Block->Count >= LOADED_TEXTURE_CACHE_BLOCK_SIZE)
+        if (IsParent && OutCount == RootCount && RootCount > 0)
+        {
+            // NOTE: Nothing above the root
+            IsCurrent = true;
+        }
+        else if (IsParent && OutCount > RootCount)
         {
-            if (AddLoadedTexturesCacheBlock())
+            i32 LastSegmentStart = OutCount;
+            while (LastSegmentStart > RootCount && Out_Path[LastSegmentStart - 1] != '/')
             {
-                Block = LoadedTexturesCache.Blocks[LoadedTexturesCache.BlockCount - 1];
+                --LastSegmentStart;
             }
-            else
+
+            bool LastIsParent = (OutCount - LastSegmentStart == 2 &&
+                                 Out_Path[LastSegmentStart] == '.' && Out_Path[LastSegmentStart + 1] == '.');
+            if (!LastIsParent)
             {
-                Block = 0;
+                OutCount = (LastSegmentStart > RootCount) ? LastSegmentStart - 1 : RootCount;
+                IsCurrent = true;
             }
         }
 
-        Assert(Block);
-        if (Block)
+        if (SegmentCount > 0 && !IsCurrent)
         {
-            Block->TextureIDs[Block->Count] = TextureID;
-            strncpy_s(Block->TexturePaths[Block->Count], TexturePath, MAX_PATH_LENGTH - 1);
-            Block->Count++;
+            bool NeedsSeparator = (OutCount > RootCount);
+            if (OutCount + NeedsSeparator + SegmentCount >= PathBufferSize)
+            {
+                return false;
+            }
+
+            if (NeedsSeparator)
+            {
+                Out_Path[OutCount++] = '/';
+            }
+            for (i32 CharIndex = 0; CharIndex < SegmentCount; ++CharIndex)
+            {
+                Out_Path[OutCount++] = Segment[CharIndex];
+            }
         }
-        else
+
+        Segment += SegmentCount;
+        if (*Segment)
         {
-            // TODO: Logging
+            ++Segment;
         }
     }
+
+    Out_Path[OutCount] = '\0';
+    return true;
 }
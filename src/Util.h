@@ -3,11 +3,6 @@
 
 #include "Common.h"
 
-u32
-LoadTexture(const char *Path, bool GenerateMipmap);
-char *
-ReadFile(const char *Path, size_t *Out_Size);
-
 i32
 GetNullTerminatedStringLength(const char *String);
 void 
@@ -18,5 +13,13 @@ void
 GetFileDirectory(char *FilePath, i32 FilePathCount,
                  char *Out_FileDirectory, i32 *Out_FileDirectoryCount,
                  i32 FileDirectoryBufferSize);
+// NOTE: Case-insensitive; Extension includes the dot
+bool
+HasFileExtension(const char *Path, const char *Extension);
+// NOTE: Forward slashes, no empty or "." segments and ".." folded into the segment before it, so
+//       one file always has the same spelling ("resources\models/../textures/a.png" becomes
+//       "resources/textures/a.png"). False if it doesn't fit.
+bool
+NormalizePath(const char *Path, char *Out_Path, i32 PathBufferSize);
 
 #endif